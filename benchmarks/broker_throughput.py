@@ -0,0 +1,193 @@
+# Copyright 2019-2023 Bloomberg Finance L.P.
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Measure post and delivery throughput and latency against a real broker.
+
+Start a broker with the configuration used by the integration tests first:
+
+    ./bmqbrkr.tsk ./tests/broker-config
+
+Then run, for instance:
+
+    python benchmarks/broker_throughput.py --messages 100000 --batch-size 64
+
+Each message is posted with an integer ack id, so acknowledgements are
+delivered in batches to *on_acks*, and consumed by a second session that
+confirms it.  The time each message was posted at is carried in its payload to
+measure its end-to-end latency.
+"""
+
+from __future__ import annotations
+
+import argparse
+import json
+import os
+import struct
+import threading
+import time
+from typing import List
+from typing import Optional
+from typing import Sequence
+import uuid
+
+import blazingmq
+
+TIMESTAMP = struct.Struct("=q")
+
+
+def percentile(sorted_values: Sequence[int], fraction: float) -> float:
+    if not sorted_values:
+        return float("nan")
+    index = min(len(sorted_values) - 1, int(fraction * len(sorted_values)))
+    return sorted_values[index] / 1e3
+
+
+def report(name: str, count: int, elapsed: float, latencies_ns: List[int]) -> None:
+    latencies_ns.sort()
+    print(
+        f"{name}: {count} messages in {elapsed:.3f}s ({count / elapsed:,.0f} msg/s),"
+        f" latency p50={percentile(latencies_ns, 0.5):.1f}us"
+        f" p90={percentile(latencies_ns, 0.9):.1f}us"
+        f" p99={percentile(latencies_ns, 0.99):.1f}us"
+        f" max={percentile(latencies_ns, 1.0):.1f}us"
+    )
+
+
+class Consumer:
+    def __init__(self, expected: int) -> None:
+        self.expected = expected
+        self.latencies_ns: List[int] = []
+        self.done = threading.Event()
+        self.finished_at = 0.0
+
+    def on_message(
+        self, message: blazingmq.Message, message_handle: blazingmq.MessageHandle
+    ) -> None:
+        (posted_at_ns,) = TIMESTAMP.unpack_from(message.data)
+        self.latencies_ns.append(time.perf_counter_ns() - posted_at_ns)
+        message_handle.confirm()
+        if len(self.latencies_ns) == self.expected:
+            self.finished_at = time.perf_counter()
+            self.done.set()
+
+
+class Producer:
+    def __init__(self, expected: int) -> None:
+        self.expected = expected
+        self.posted_at_ns = [0] * expected
+        self.latencies_ns: List[int] = []
+        self.nacks = 0
+        self.done = threading.Event()
+        self.finished_at = 0.0
+
+    def on_acks(self, ack_ids: List[int], statuses: List[blazingmq.AckStatus]) -> None:
+        now_ns = time.perf_counter_ns()
+        for ack_id, status in zip(ack_ids, statuses):
+            if status != blazingmq.AckStatus.SUCCESS:
+                self.nacks += 1
+            self.latencies_ns.append(now_ns - self.posted_at_ns[ack_id])
+        if len(self.latencies_ns) == self.expected:
+            self.finished_at = time.perf_counter()
+            self.done.set()
+
+
+def main(argv: Optional[Sequence[str]] = None) -> None:
+    parser = argparse.ArgumentParser(
+        description="Measure post and delivery throughput against a broker."
+    )
+    parser.add_argument(
+        "--broker", default=os.environ.get("BMQ_BROKER_URI", "tcp://localhost:30114")
+    )
+    parser.add_argument(
+        "--queue", default=f"bmq://bmq.test.mmap.priority/benchmark-{uuid.uuid4()}"
+    )
+    parser.add_argument("--messages", type=int, default=10000)
+    parser.add_argument("--payload-size", type=int, default=1024)
+    parser.add_argument("--properties", type=int, default=0)
+    parser.add_argument(
+        "--batch-size",
+        type=int,
+        default=1,
+        help="messages per post_many call, or 1 to use post",
+    )
+    parser.add_argument("--timeout", type=float, default=60.0)
+    parser.add_argument(
+        "--stats", action="store_true", help="print the producer's session.stats()"
+    )
+    args = parser.parse_args(argv)
+
+    if args.payload_size < TIMESTAMP.size:
+        parser.error(f"--payload-size must be at least {TIMESTAMP.size}")
+    padding = b"x" * (args.payload_size - TIMESTAMP.size)
+    properties = {f"property{i}": i for i in range(args.properties)} or None
+
+    consumer = Consumer(args.messages)
+    producer = Producer(args.messages)
+    log = blazingmq.session_events.log_session_event
+    with blazingmq.Session(
+        log, consumer.on_message, broker=args.broker
+    ) as consumer_session, blazingmq.Session(
+        log, broker=args.broker, on_acks=producer.on_acks
+    ) as producer_session:
+        consumer_session.open_queue(args.queue, read=True)
+        producer_session.open_queue(args.queue, write=True)
+
+        started_at = time.perf_counter()
+        for first in range(0, args.messages, args.batch_size):
+            ids = range(first, min(first + args.batch_size, args.messages))
+            payloads = []
+            for ack_id in ids:
+                producer.posted_at_ns[ack_id] = now_ns = time.perf_counter_ns()
+                payloads.append(TIMESTAMP.pack(now_ns) + padding)
+            if args.batch_size == 1:
+                producer_session.post(
+                    args.queue, payloads[0], properties, ack_id=ids[0]
+                )
+            else:
+                producer_session.post_many(
+                    args.queue,
+                    [(p, properties, ack_id) for p, ack_id in zip(payloads, ids)],
+                )
+        posted_at = time.perf_counter()
+
+        if not producer.done.wait(args.timeout):
+            raise SystemExit("timed out waiting for acknowledgements")
+        if not consumer.done.wait(args.timeout):
+            raise SystemExit("timed out waiting for messages")
+
+        print(
+            f"post: {args.messages} messages in {posted_at - started_at:.3f}s"
+            f" ({args.messages / (posted_at - started_at):,.0f} msg/s)"
+        )
+        report(
+            "post-to-ack",
+            args.messages,
+            producer.finished_at - started_at,
+            producer.latencies_ns,
+        )
+        report(
+            "end-to-end",
+            args.messages,
+            consumer.finished_at - started_at,
+            consumer.latencies_ns,
+        )
+        if producer.nacks:
+            print(f"{producer.nacks} messages were not acknowledged successfully")
+        if args.stats:
+            print(json.dumps(producer_session.stats(), indent=2))
+
+
+if __name__ == "__main__":
+    main()
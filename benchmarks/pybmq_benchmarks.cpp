@@ -0,0 +1,540 @@
+// Copyright 2019-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Microbenchmarks for the conversions between BlazingMQ events and Python
+// objects, and for posting through 'pybmq::Session' backed by
+// 'pybmq::MockSession'.  Build with 'make benchmarks'.
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <pybmq_messageutils.h>
+#include <pybmq_refutils.h>
+#include <pybmq_session.h>
+#include <pybmq_stringcache.h>
+
+#include <bmqa_event.h>
+#include <bmqa_message.h>
+#include <bmqa_messageevent.h>
+#include <bmqa_messageiterator.h>
+#include <bmqa_messageproperties.h>
+#include <bmqa_mocksession.h>
+#include <bmqa_queueid.h>
+#include <bmqt_ackresult.h>
+#include <bmqt_compressionalgorithmtype.h>
+#include <bmqt_correlationid.h>
+#include <bmqt_messageguid.h>
+#include <bmqt_propertytype.h>
+
+#include <bdlbb_blob.h>
+#include <bdlbb_blobutil.h>
+#include <bdlbb_simpleblobbufferfactory.h>
+#include <bsl_iostream.h>
+#include <bsl_memory.h>
+#include <bsl_optional.h>
+#include <bsl_sstream.h>
+#include <bsl_stdexcept.h>
+#include <bsl_string.h>
+#include <bsl_vector.h>
+#include <bslma_default.h>
+#include <bslma_managedptr.h>
+#include <bsls_timeinterval.h>
+
+#include <benchmark/benchmark.h>
+
+using namespace BloombergLP;
+
+namespace {
+
+const char k_QUEUE_URI[] = "bmq://bmq.test.mmap.priority/benchmark";
+
+const char k_GUID[] = "1000000000003039CD8101000000270F";
+
+const char k_MOCK_SOURCE[] =
+        "class BenchmarkMock:\n"
+        "    options = None\n"
+        "    def start(self, **kwargs):\n"
+        "        return 0\n"
+        "    def stop(self, **kwargs):\n"
+        "        return None\n"
+        "    def openQueueSync(self, **kwargs):\n"
+        "        return 0\n"
+        "    def post(self, **kwargs):\n"
+        "        return 0\n"
+        "mock = BenchmarkMock()\n"
+        "callback = lambda *args: None\n";
+
+const int k_STRING = bmqt::PropertyType::e_STRING;
+const int k_INT64 = bmqt::PropertyType::e_INT64;
+
+class Fixture
+{
+    // The embedded interpreter's objects and a session opened on
+    // 'k_QUEUE_URI', shared by every benchmark.  The GIL is held throughout.
+
+  private:
+    // DATA
+    PyObject* d_namespace;
+    bslma::ManagedPtr<pybmq::Session> d_session_mp;
+    bmqa::QueueId d_queue_id;
+    bdlbb::SimpleBlobBufferFactory d_factory;
+
+  public:
+    Fixture();
+    ~Fixture();
+
+    PyObject* callback() const;
+    // Return a borrowed reference to a Python callable that does nothing.
+
+    pybmq::Session& session();
+    // Return the session, started and with 'k_QUEUE_URI' open for writing.
+
+    bmqa::Event make_push_event(int payload_size, int num_properties, int batch_size);
+    // Return a PUSH event holding the specified 'batch_size' messages with a
+    // payload of the specified 'payload_size' bytes and the specified
+    // 'num_properties' properties each.
+
+    bmqa::Event make_ack_event(int batch_size, bool numeric);
+    // Return an ACK event holding the specified 'batch_size' acknowledgements,
+    // correlated with an integer ack id if the specified 'numeric' is true and
+    // with 'callback()' otherwise.  An acknowledgement correlated with
+    // 'callback()' owns a reference to it, which the caller must acquire before
+    // converting the event, just as 'Session::post' does.
+};
+
+Fixture* g_fixture_p = NULL;
+
+PyObject*
+makePyProperties(int num_properties)
+{
+    // Return a new 'dict' of the specified 'num_properties' properties, in the
+    // format expected by 'MessageUtils::load_message_properties', alternating
+    // between string and 64-bit integer properties.
+    bslma::ManagedPtr<PyObject> properties =
+            pybmq::RefUtils::toManagedPtr(PyDict_New());
+    if (!properties) {
+        return NULL;
+    }
+    for (int i = 0; i < num_properties; ++i) {
+        bsl::ostringstream name;
+        name << "property" << i;
+        bslma::ManagedPtr<PyObject> key =
+                pybmq::RefUtils::toManagedPtr(PyBytes_FromString(name.str().c_str()));
+        bslma::ManagedPtr<PyObject> value = pybmq::RefUtils::toManagedPtr(
+                i % 2 ? Py_BuildValue("(Li)", 1234567890LL * i, k_INT64)
+                      : Py_BuildValue("(yi)", "a string value", k_STRING));
+        if (!key || !value || PyDict_SetItem(properties.get(), key.get(), value.get()))
+        {
+            return NULL;
+        }
+    }
+    return properties.release().first;
+}
+
+void
+checkPython(PyObject* result, benchmark::State& state)
+{
+    // Consume the specified 'result' of a conversion, and make the specified
+    // 'state' report an error if it is NULL.
+    if (!result) {
+        PyErr_Print();
+        state.SkipWithError("Python error");
+        return;
+    }
+    Py_DECREF(result);
+}
+
+Fixture::Fixture()
+: d_namespace(PyDict_New())
+, d_session_mp()
+, d_queue_id()
+, d_factory(1024)
+{
+    PyDict_SetItemString(d_namespace, "__builtins__", PyEval_GetBuiltins());
+    bslma::ManagedPtr<PyObject> rv = pybmq::RefUtils::toManagedPtr(
+            PyRun_String(k_MOCK_SOURCE, Py_file_input, d_namespace, d_namespace));
+    if (!rv) {
+        PyErr_Print();
+        throw bsl::runtime_error("failed to create the mock session");
+    }
+
+    PyObject* mock = PyDict_GetItemString(d_namespace, "mock");
+    d_session_mp.load(new pybmq::Session(
+            callback(),
+            callback(),
+            callback(),
+            callback(),
+            callback(),
+            "tcp://localhost:30114",
+            "pybmq_benchmarks",
+            bmqt::CompressionAlgorithmType::e_NONE,
+            bsl::nullopt,
+            bsl::nullopt,
+            bsl::nullopt,
+            bsl::nullopt,
+            bsls::TimeInterval(),
+            bsls::TimeInterval(),
+            bsls::TimeInterval(),
+            bsls::TimeInterval(),
+            bsls::TimeInterval(),
+            bsls::TimeInterval(),
+            false,
+            bsl::shared_ptr<bmqa::ManualHostHealthMonitor>(),
+            bsl::shared_ptr<pybmq::SystemHostHealthMonitor>(),
+            false,
+            false,
+            0,
+            false,
+            bsls::TimeInterval(),
+            PyExc_RuntimeError,
+            PyExc_RuntimeError,
+            NULL,
+            mock));
+
+    bslma::ManagedPtr<PyObject> started = pybmq::RefUtils::toManagedPtr(
+            d_session_mp->start(bsls::TimeInterval(5.0)));
+    bslma::ManagedPtr<PyObject> opened =
+            pybmq::RefUtils::toManagedPtr(d_session_mp->open_queue_sync(
+                    &d_queue_id,
+                    k_QUEUE_URI,
+                    true,
+                    true,
+                    bsl::nullopt,
+                    bsl::nullopt,
+                    bsl::nullopt,
+                    bsl::nullopt,
+                    Py_None,
+                    bsls::TimeInterval(5.0),
+                    false,
+                    Py_None,
+                    NULL,
+                    Py_None,
+                    NULL));
+    if (!started || !opened) {
+        PyErr_Print();
+        throw bsl::runtime_error("failed to open the benchmark queue");
+    }
+}
+
+Fixture::~Fixture()
+{
+    bslma::ManagedPtr<PyObject> stopped =
+            pybmq::RefUtils::toManagedPtr(d_session_mp->stop(false));
+    d_session_mp.reset();
+    Py_DECREF(d_namespace);
+}
+
+PyObject*
+Fixture::callback() const
+{
+    return PyDict_GetItemString(d_namespace, "callback");
+}
+
+pybmq::Session&
+Fixture::session()
+{
+    return *d_session_mp;
+}
+
+bmqa::Event
+Fixture::make_push_event(int payload_size, int num_properties, int batch_size)
+{
+    bsl::string payload_data(payload_size, 'x');
+    bdlbb::Blob payload(&d_factory);
+    bdlbb::BlobUtil::append(&payload, payload_data.data(), payload_size);
+
+    bmqt::MessageGUID guid;
+    guid.fromHex(k_GUID);
+
+    bmqa::MessageProperties properties;
+    for (int i = 0; i < num_properties; ++i) {
+        bsl::ostringstream name;
+        name << "property" << i;
+        if (i % 2) {
+            properties.setPropertyAsInt64(name.str(), 1234567890LL * i);
+        } else {
+            properties.setPropertyAsString(name.str(), "a string value");
+        }
+    }
+
+    bsl::vector<bmqa::MockSessionUtil::PushMessageParams> params;
+    for (int i = 0; i < batch_size; ++i) {
+        params.emplace_back(payload, d_queue_id, guid, properties);
+    }
+    return bmqa::MockSessionUtil::createPushEvent(
+            params,
+            &d_factory,
+            bslma::Default::defaultAllocator());
+}
+
+bmqa::Event
+Fixture::make_ack_event(int batch_size, bool numeric)
+{
+    bmqt::MessageGUID guid;
+    guid.fromHex(k_GUID);
+
+    bsl::vector<bmqa::MockSessionUtil::AckParams> params;
+    for (int i = 0; i < batch_size; ++i) {
+        bmqt::CorrelationId correlation_id =
+                numeric ? bmqt::CorrelationId(static_cast<bsls::Types::Int64>(i))
+                        : bmqt::CorrelationId(callback());
+        params.emplace_back(
+                bmqt::AckResult::e_SUCCESS,
+                correlation_id,
+                guid,
+                d_queue_id);
+    }
+    return bmqa::MockSessionUtil::createAckEvent(
+            params,
+            &d_factory,
+            bslma::Default::defaultAllocator());
+}
+
+void
+BM_GetMessages(benchmark::State& state, bool zero_copy_payloads)
+{
+    const int payload_size = static_cast<int>(state.range(0));
+    const int batch_size = static_cast<int>(state.range(2));
+    const bmqa::MessageEvent event =
+            g_fixture_p
+                    ->make_push_event(
+                            payload_size,
+                            static_cast<int>(state.range(1)),
+                            batch_size)
+                    .messageEvent();
+    const pybmq::PropertyPolicies policies;
+    pybmq::StringCache string_cache;
+
+    for (auto _ : state) {
+        checkPython(
+                pybmq::MessageUtils::get_messages(
+                        event,
+                        g_fixture_p->callback(),
+                        zero_copy_payloads,
+                        policies,
+                        NULL,
+                        &string_cache),
+                state);
+    }
+    string_cache.clear();
+    state.SetItemsProcessed(state.iterations() * batch_size);
+    state.SetBytesProcessed(state.iterations() * batch_size * payload_size);
+}
+
+void
+BM_GetAcks(benchmark::State& state)
+{
+    const int batch_size = static_cast<int>(state.range(0));
+    const bool numeric = state.range(1);
+    const bmqa::MessageEvent event =
+            g_fixture_p->make_ack_event(batch_size, numeric).messageEvent();
+    pybmq::StringCache string_cache;
+
+    for (auto _ : state) {
+        bslma::ManagedPtr<PyObject> ack_ids =
+                pybmq::RefUtils::toManagedPtr(PyList_New(0));
+        bslma::ManagedPtr<PyObject> ack_statuses =
+                pybmq::RefUtils::toManagedPtr(PyList_New(0));
+        if (!numeric) {
+            // Each conversion consumes the reference owned by every ack.
+            for (int i = 0; i < batch_size; ++i) {
+                Py_INCREF(g_fixture_p->callback());
+            }
+        }
+        checkPython(
+                pybmq::MessageUtils::get_acks(
+                        event,
+                        &string_cache,
+                        ack_ids.get(),
+                        ack_statuses.get()),
+                state);
+    }
+    string_cache.clear();
+    state.SetItemsProcessed(state.iterations() * batch_size);
+}
+
+void
+BM_GetMessageProperties(benchmark::State& state)
+{
+    const bmqa::MessageEvent event =
+            g_fixture_p->make_push_event(64, static_cast<int>(state.range(0)), 1)
+                    .messageEvent();
+    bmqa::MessageIterator iterator = event.messageIterator();
+    iterator.nextMessage();
+    const bmqa::Message& message = iterator.message();
+
+    for (auto _ : state) {
+        bsl::vector<bsl::string> collated_errors;
+        checkPython(
+                pybmq::MessageUtils::get_message_properties(
+                        &collated_errors,
+                        message,
+                        NULL),
+                state);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void
+BM_LoadMessageProperties(benchmark::State& state)
+{
+    bslma::ManagedPtr<PyObject> py_properties = pybmq::RefUtils::toManagedPtr(
+            makePyProperties(static_cast<int>(state.range(0))));
+    if (!py_properties) {
+        PyErr_Print();
+        state.SkipWithError("Python error");
+        return;
+    }
+
+    for (auto _ : state) {
+        bmqa::MessageProperties properties;
+        if (!pybmq::MessageUtils::load_message_properties(
+                    &properties,
+                    py_properties.get()))
+        {
+            PyErr_Print();
+            state.SkipWithError("Python error");
+            break;
+        }
+        benchmark::DoNotOptimize(properties);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void
+BM_SessionPost(benchmark::State& state)
+{
+    // Every message posted is also passed to the Python mock, whose cost is
+    // included in the measurement.
+    const int payload_size = static_cast<int>(state.range(0));
+    const int num_properties = static_cast<int>(state.range(1));
+    const bsl::string payload(payload_size, 'x');
+    bslma::ManagedPtr<PyObject> py_properties;
+    if (num_properties) {
+        py_properties = pybmq::RefUtils::toManagedPtr(
+                makePyProperties(num_properties));
+        if (!py_properties) {
+            PyErr_Print();
+            state.SkipWithError("Python error");
+            return;
+        }
+    }
+
+    for (auto _ : state) {
+        checkPython(
+                g_fixture_p->session().post(
+                        k_QUEUE_URI,
+                        payload.data(),
+                        payload.size(),
+                        py_properties ? py_properties.get() : Py_None,
+                        NULL,
+                        Py_None,
+                        bsl::optional<bmqt::CompressionAlgorithmType::Enum>(),
+                        false,
+                        bsl::optional<bsls::TimeInterval>(),
+                        true),
+                state);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * payload_size);
+}
+
+void
+BM_SessionPostMany(benchmark::State& state)
+{
+    const int payload_size = static_cast<int>(state.range(0));
+    const int batch_size = static_cast<int>(state.range(1));
+    bslma::ManagedPtr<PyObject> payload = pybmq::RefUtils::toManagedPtr(
+            PyBytes_FromStringAndSize(NULL, payload_size));
+    bslma::ManagedPtr<PyObject> messages =
+            pybmq::RefUtils::toManagedPtr(PyList_New(batch_size));
+    if (!payload || !messages) {
+        PyErr_Print();
+        state.SkipWithError("Python error");
+        return;
+    }
+    for (int i = 0; i < batch_size; ++i) {
+        PyObject* message = Py_BuildValue("(OOO)", payload.get(), Py_None, Py_None);
+        if (!message) {
+            PyErr_Print();
+            state.SkipWithError("Python error");
+            return;
+        }
+        PyList_SET_ITEM(messages.get(), i, message);
+    }
+
+    for (auto _ : state) {
+        checkPython(
+                g_fixture_p->session().post_many(k_QUEUE_URI, messages.get(), NULL),
+                state);
+    }
+    state.SetItemsProcessed(state.iterations() * batch_size);
+    state.SetBytesProcessed(state.iterations() * batch_size * payload_size);
+}
+
+void
+BM_GetMessagesCopied(benchmark::State& state)
+{
+    BM_GetMessages(state, false);
+}
+
+void
+BM_GetMessagesZeroCopy(benchmark::State& state)
+{
+    BM_GetMessages(state, true);
+}
+
+}  // namespace
+
+BENCHMARK(BM_GetMessagesCopied)
+        ->ArgsProduct({{64, 4096, 65536},
+                       {0, 4, 16},
+                       {1, 64, 1024}});
+BENCHMARK(BM_GetMessagesZeroCopy)
+        ->ArgsProduct({{64, 4096, 65536},
+                       {0},
+                       {1, 64, 1024}});
+BENCHMARK(BM_GetAcks)->ArgsProduct({{1, 64, 1024}, {0, 1}});
+BENCHMARK(BM_GetMessageProperties)->Arg(1)->Arg(4)->Arg(16)->Arg(64);
+BENCHMARK(BM_LoadMessageProperties)->Arg(1)->Arg(4)->Arg(16)->Arg(64);
+BENCHMARK(BM_SessionPost)
+        ->ArgsProduct({{64, 4096, 65536},
+                       {0, 4, 16}});
+BENCHMARK(BM_SessionPostMany)
+        ->ArgsProduct({{64, 4096, 65536},
+                       {1, 64, 1024}});
+
+int
+main(int argc, char** argv)
+{
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+
+    Py_Initialize();
+    int rc = 0;
+    try {
+        Fixture fixture;
+        g_fixture_p = &fixture;
+        benchmark::RunSpecifiedBenchmarks();
+        g_fixture_p = NULL;
+    } catch (const bsl::exception& exc) {
+        bsl::cerr << "pybmq_benchmarks: " << exc.what() << bsl::endl;
+        rc = 1;
+    }
+    Py_Finalize();
+    return rc;
+}
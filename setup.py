@@ -16,12 +16,14 @@
 import os
 import platform
 import sys
+import sysconfig
 
 import pkgconfig
 from setuptools import Extension
 from setuptools import setup
 
 # XXX: Cython imports must come after importing setuptools
+from Cython import __version__ as CYTHON_VERSION  # isort:skip
 from Cython.Build import cythonize  # isort:skip
 from Cython.Compiler import Options  # isort:skip
 
@@ -50,6 +52,16 @@ if "--test-build" in sys.argv:
 if os.getenv("CYTHON_TEST_MACROS", None) is not None:
     TEST_BUILD = True
 
+# A free-threaded (PEP 703) interpreter re-enables the GIL when importing an
+# extension that doesn't declare it can run without it, which only Cython 3.1
+# and later can do.
+IS_FREE_THREADED = bool(sysconfig.get_config_var("Py_GIL_DISABLED"))
+if IS_FREE_THREADED and tuple(map(int, CYTHON_VERSION.split(".")[:2])) < (3, 1):
+    sys.exit(
+        "Cython 3.1 or later is required for free-threaded Python builds, "
+        f"found {CYTHON_VERSION}"
+    )
+
 
 COMPILER_DIRECTIVES = {
     "language_level": "3str",
@@ -79,6 +91,9 @@ if TEST_BUILD:
     }
     DEFINE_MACROS.extend([("CYTHON_TRACE", "1"), ("CYTHON_TRACE_NOGIL", "1")])
 
+if IS_FREE_THREADED:
+    COMPILER_DIRECTIVES["freethreading_compatible"] = True
+
 
 def create_extension(name, libraries, **kwargs):
     extra_compile_args = []
@@ -156,13 +171,29 @@ EXTENSIONS = [
         sources=[
             "src/blazingmq/_ext.pyx",
             "src/cpp/pybmq_ballutil.cpp",
+            "src/cpp/pybmq_bufferutils.cpp",
+            "src/cpp/pybmq_compressionpolicy.cpp",
+            "src/cpp/pybmq_criticalsectionguard.cpp",
+            "src/cpp/pybmq_flowcontroller.cpp",
             "src/cpp/pybmq_gilacquireguard.cpp",
             "src/cpp/pybmq_gilreleaseguard.cpp",
+            "src/cpp/pybmq_hosthealthmonitor.cpp",
+            "src/cpp/pybmq_loopbacksession.cpp",
+            "src/cpp/pybmq_messagedispatcher.cpp",
+            "src/cpp/pybmq_messagetypes.cpp",
             "src/cpp/pybmq_messageutils.cpp",
             "src/cpp/pybmq_mocksession.cpp",
+            "src/cpp/pybmq_openqueuebatch.cpp",
+            "src/cpp/pybmq_payloaddecoder.cpp",
+            "src/cpp/pybmq_propertiestemplate.cpp",
             "src/cpp/pybmq_refutils.cpp",
             "src/cpp/pybmq_session.cpp",
             "src/cpp/pybmq_sessioneventhandler.cpp",
+            "src/cpp/pybmq_sessionstate.cpp",
+            "src/cpp/pybmq_stats.cpp",
+            "src/cpp/pybmq_stringcache.cpp",
+            "src/cpp/pybmq_subscriptionutils.cpp",
+            "src/cpp/pybmq_writablesignal.cpp",
         ],
         language="c++",
         include_dirs=["src/cpp", "src"],
@@ -197,11 +228,13 @@ setup(
         "Programming Language :: Python :: 3.10",
         "Programming Language :: Python :: 3.11",
         "Programming Language :: Python :: 3.12",
+        "Programming Language :: Python :: 3.13",
+        "Programming Language :: Python :: Free Threading :: 2 - Beta",
         "Programming Language :: Python :: Implementation :: CPython",
         "Topic :: Software Development :: Libraries :: Python Modules",
         "Typing :: Typed",
     ],
-    package_data={"blazingmq": ["py.typed", "_ext.pyi"]},
+    package_data={"blazingmq": ["py.typed", "_ext.pyi", "blazingmq_decoder.h"]},
     package_dir={"": "src"},
     packages=["blazingmq"],
     ext_modules=cythonize(
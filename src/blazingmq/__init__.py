@@ -16,17 +16,27 @@
 from . import exceptions
 from . import session_events
 from ._about import __version__
+from ._aio import AsyncSession
 from ._enums import AckStatus
 from ._enums import CompressionAlgorithmType
 from ._enums import PropertyType
-from ._messages import Ack
-from ._messages import Message
-from ._messages import MessageHandle
+from ._ext import Ack
+from ._ext import Message
+from ._ext import MessageHandle
+from ._logging import set_sdk_log_level
 from ._monitors import BasicHealthMonitor
+from ._monitors import SystemHealthMonitor
+from ._pool import SessionPool
+from ._session import AdaptiveFlowControl
+from ._session import CompressionPolicy
+from ._session import PropertiesTemplate
+from ._session import Queue
 from ._session import QueueOptions
 from ._session import Session
 from ._session import SessionOptions
+from ._session import Subscription
 from ._timeouts import Timeouts
+from ._typing import PayloadType
 from ._typing import PropertyTypeDict
 from ._typing import PropertyValueDict
 from .exceptions import Error
@@ -34,19 +44,29 @@ from .exceptions import Error
 __all__ = [
     "Ack",
     "AckStatus",
+    "AdaptiveFlowControl",
+    "AsyncSession",
     "BasicHealthMonitor",
     "CompressionAlgorithmType",
+    "CompressionPolicy",
     "Error",
+    "PayloadType",
+    "PropertiesTemplate",
     "PropertyType",
     "PropertyTypeDict",
     "PropertyValueDict",
+    "Queue",
     "QueueOptions",
     "Message",
     "MessageHandle",
     "Session",
     "SessionOptions",
+    "SessionPool",
+    "Subscription",
+    "SystemHealthMonitor",
     "Timeouts",
     "__version__",
     "exceptions",
     "session_events",
+    "set_sdk_log_level",
 ]
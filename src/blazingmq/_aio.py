@@ -0,0 +1,259 @@
+# Copyright 2019-2023 Bloomberg Finance L.P.
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import annotations
+
+import asyncio
+import copy
+from typing import Any
+from typing import Callable
+from typing import Iterable
+from typing import Optional
+from typing import Union
+
+from ._enums import CompressionAlgorithmType
+from ._ext import Ack
+from ._ext import Message
+from ._ext import MessageHandle
+from ._ext import create_message_handle
+from ._loopback import LoopbackBroker
+from ._session import DEFAULT_TIMEOUT
+from ._session import AdaptiveFlowControl
+from ._session import CompressionPolicy
+from ._session import PropertiesTemplate
+from ._session import Queue
+from ._session import QueueOptions
+from ._session import Session
+from ._session import SessionOptions
+from ._typing import PayloadType
+from ._typing import PropertyTypeDict
+from ._typing import PropertyValueDict
+from .exceptions import Error
+from .session_events import SessionEvent
+
+
+def _resolve_ack(future: asyncio.Future[Ack], ack: Ack) -> None:
+    if not future.cancelled():
+        future.set_result(ack)
+
+
+class AsyncSession:
+    """A `Session` whose operations are driven by an `asyncio` event loop.
+
+    Received messages are kept by the SDK, without acquiring the GIL, until
+    the event loop is woken up through a file descriptor registered with
+    ``loop.add_reader``.  The loop then retrieves them in batches of up to
+    *max_batch_size* messages and passes each to *on_message*, which is
+    invoked on the event loop's thread.
+
+    Constructing an *AsyncSession* starts the session, blocking until the
+    broker is connected as `Session` does.
+
+    Args:
+        on_session_event: a required callback to process `.SessionEvent` events
+            received by the session.  It is invoked on a thread owned by the
+            session, not on the event loop's thread.
+        on_message: an optional callback to process `Message` objects received
+            by the session, on the event loop's thread.
+        broker: TCP address of the broker (default: 'tcp://localhost:30114'),
+            or a `.LoopbackBroker` to simulate one.
+        session_options: an instance of `.SessionOptions` that represents the
+            session's configuration.  Its *pull_messages* option is ignored.
+        max_batch_size: the maximum number of messages retrieved each time the
+            event loop is woken up.
+        loop: the event loop to use.  Defaults to the running loop.
+
+    Raises:
+        `~blazingmq.Error`: If the session start request was not successful.
+        `RuntimeError`: If *loop* is not provided and no loop is running.
+    """
+
+    def __init__(
+        self,
+        on_session_event: Callable[[SessionEvent], None],
+        on_message: Optional[Callable[[Message, MessageHandle], None]] = None,
+        broker: Union[str, LoopbackBroker] = "tcp://localhost:30114",
+        session_options: SessionOptions = (SessionOptions()),
+        max_batch_size: int = 1024,
+        loop: Optional[asyncio.AbstractEventLoop] = None,
+    ) -> None:
+        if max_batch_size <= 0:
+            raise ValueError(f"max_batch_size must be positive, was {max_batch_size}")
+
+        self._loop = asyncio.get_running_loop() if loop is None else loop
+        self._on_message = on_message
+        self._max_batch_size = max_batch_size
+
+        options = copy.copy(session_options)
+        options.pull_messages = True
+        self._session = Session.with_options(
+            on_session_event, broker=broker, session_options=options
+        )
+
+        self._fd: Optional[int] = None
+        if on_message is not None:
+            self._fd = self._session._ext.notification_fd()
+            self._loop.add_reader(self._fd, self._on_readable)
+
+    def _on_readable(self) -> None:
+        assert self._on_message is not None
+        ext_session = self._session._ext
+        for message in self._session.receive(self._max_batch_size, timeout=0):
+            self._on_message(message, create_message_handle(message, ext_session))
+
+    async def open_queue(
+        self,
+        queue_uri: str,
+        read: bool = False,
+        write: bool = False,
+        options: QueueOptions = QueueOptions(),
+        timeout: float = DEFAULT_TIMEOUT,
+        lazy_properties: bool = False,
+        property_projection: Optional[Iterable[str]] = None,
+        compression_policy: Optional[CompressionPolicy] = None,
+        payload_decoder: Optional[Any] = None,
+        flow_control: Optional[AdaptiveFlowControl] = None,
+    ) -> Queue:
+        """Open a queue without blocking the event loop.
+
+        See `Session.open_queue` for the meaning of each argument.
+
+        Raises:
+            `~blazingmq.Error`: If the queue can't be opened, or if *read* is
+                set but no *on_message* callback was provided.
+            `~blazingmq.exceptions.BrokerTimeoutError`: If the broker didn't
+                respond in time.
+        """
+        if read and self._on_message is None:
+            raise Error(
+                "Can't open queue {} in read mode: no on_message "
+                "callback was provided at AsyncSession construction".format(queue_uri)
+            )
+        return await asyncio.wrap_future(
+            self._session.open_queue_async(
+                queue_uri,
+                read=read,
+                write=write,
+                options=options,
+                timeout=timeout,
+                lazy_properties=lazy_properties,
+                property_projection=property_projection,
+                compression_policy=compression_policy,
+                payload_decoder=payload_decoder,
+                flow_control=flow_control,
+            ),
+            loop=self._loop,
+        )
+
+    async def configure_queue(
+        self,
+        queue_uri: str,
+        options: QueueOptions,
+        timeout: float = DEFAULT_TIMEOUT,
+    ) -> None:
+        """Configure an opened queue without blocking the event loop.
+
+        See `Session.configure_queue` for the meaning of each argument.
+        """
+        await asyncio.wrap_future(
+            self._session.configure_queue_async(queue_uri, options, timeout),
+            loop=self._loop,
+        )
+
+    async def close_queue(
+        self, queue_uri: str, timeout: float = DEFAULT_TIMEOUT
+    ) -> None:
+        """Close an opened queue without blocking the event loop.
+
+        See `Session.close_queue` for the meaning of each argument.
+        """
+        await asyncio.wrap_future(
+            self._session.close_queue_async(queue_uri, timeout), loop=self._loop
+        )
+
+    def get_queue_options(self, queue_uri: str) -> QueueOptions:
+        """Get the previously set options of an opened queue.
+
+        See `Session.get_queue_options`.
+        """
+        return self._session.get_queue_options(queue_uri)
+
+    async def post(
+        self,
+        queue_uri: str,
+        message: PayloadType,
+        properties: Optional[PropertyValueDict] = None,
+        property_type_overrides: Optional[PropertyTypeDict] = None,
+        properties_template: Optional[PropertiesTemplate] = None,
+        compression_algorithm: Optional[CompressionAlgorithmType] = None,
+    ) -> Ack:
+        """Post a message and wait for the broker to acknowledge it.
+
+        See `Session.post` for the meaning of each argument.
+
+        Returns:
+            ~blazingmq.Ack: the acknowledgment received for the message.  Its
+            *status* tells whether the message was accepted.
+
+        Raises:
+            `~blazingmq.Error`: If the post request was not successful.
+        """
+        future = self._loop.create_future()
+
+        def on_ack(ack: Ack) -> None:
+            self._loop.call_soon_threadsafe(_resolve_ack, future, ack)
+
+        self._session.post(
+            queue_uri,
+            message,
+            properties=properties,
+            property_type_overrides=property_type_overrides,
+            on_ack=on_ack,
+            properties_template=properties_template,
+            compression_algorithm=compression_algorithm,
+        )
+        return await future
+
+    async def confirm(self, message: Message) -> None:
+        """Confirm the specified message.
+
+        See `Session.confirm`.  Confirming never waits for the broker.
+        """
+        self._session.confirm(message)
+
+    async def confirm_many(self, messages: Iterable[Message]) -> None:
+        """Confirm each of the specified messages.
+
+        See `Session.confirm_many`.  Confirming never waits for the broker.
+        """
+        self._session.confirm_many(messages)
+
+    async def stop(self) -> None:
+        """Stop the session without blocking the event loop.
+
+        No more messages are delivered to *on_message* once this is called.
+        """
+        if self._fd is not None:
+            self._loop.remove_reader(self._fd)
+            self._fd = None
+        await self._loop.run_in_executor(None, self._session.stop)
+
+    async def __aenter__(self) -> AsyncSession:
+        return self
+
+    async def __aexit__(
+        self, exc_type: Any, exc_value: Any, exc_traceback: Any
+    ) -> None:
+        await self.stop()
@@ -21,22 +21,14 @@ from typing import Any
 from typing import Callable
 from typing import Dict
 from typing import Iterable
-from typing import Mapping
+from typing import List
 from typing import Optional
 from typing import TYPE_CHECKING
 from typing import Tuple
 from typing import Type
-from typing import Union
 import weakref
 
 from ._enums import AckStatus
-from ._enums import PropertyType
-from ._messages import Ack
-from ._messages import Message
-from ._messages import MessageHandle
-from ._messages import create_ack
-from ._messages import create_message
-from ._messages import create_message_handle
 from .session_events import InterfaceError
 from .session_events import QueueEvent
 from .session_events import QueueReopenFailed
@@ -46,10 +38,14 @@ from .session_events import QueueResumed
 from .session_events import QueueSuspendFailed
 from .session_events import QueueSuspended
 from .session_events import SessionEvent
+from .session_events import SlowCallback
 
 if TYPE_CHECKING:
     # Safely perform circular references only during static type analysis
     from . import _ext  # pragma: no cover
+    from ._ext import Ack  # pragma: no cover
+    from ._ext import Message  # pragma: no cover
+    from ._ext import MessageHandle  # pragma: no cover
 
 
 def on_session_event(
@@ -100,25 +96,15 @@ def on_session_event(
     user_callback(event)
 
 
-PropertiesAndTypesDictsType = Tuple[Dict[str, Union[int, bytes]], Dict[str, int]]
-
-
 def on_message(
     user_callback: Callable[[Message, MessageHandle], None],
     ext_session_wr: weakref.ref[_ext.Session],
-    property_type_to_py: Mapping[int, PropertyType],
-    messages: Iterable[Tuple[bytes, bytes, bytes, PropertiesAndTypesDictsType]],
+    create_message_handle: Callable[[Message, _ext.Session], MessageHandle],
+    messages: Iterable[Message],
 ) -> None:
     ext_session = ext_session_wr()
     assert ext_session is not None, "ext.Session has been deleted"
-    for data, guid, queue_uri, properties_tuple in messages:
-        properties, property_types = properties_tuple
-        property_types_py = {
-            k: property_type_to_py[v] for k, v in property_types.items()
-        }
-        message = create_message(
-            data, guid, queue_uri.decode(), properties, property_types_py
-        )
+    for message in messages:
         message_handle = create_message_handle(message, ext_session)
         user_callback(message, message_handle)
 
@@ -141,20 +127,44 @@ def on_message(
             os.abort()
 
 
-def on_ack(
+def on_ack(acks: Iterable[Tuple[Ack, Callable[[Ack], None]]]) -> None:
+    for ack, user_callback in acks:
+        user_callback(ack)
+
+
+def on_acks(
+    user_callback: Callable[[List[int], List[AckStatus]], None],
     ack_status_mapping: Dict[int, AckStatus],
-    acks: Iterable[Tuple[int, bytes, Optional[bytes], bytes, Callable[[Ack], None]]],
+    ack_ids: List[int],
+    statuses: List[int],
+) -> None:
+    py_statuses = [
+        ack_status_mapping.get(status, AckStatus.UNRECOGNIZED) for status in statuses
+    ]
+    user_callback(ack_ids, py_statuses)
+
+
+def on_acks_create_interface_error(
+    user_on_session_event: Callable[[SessionEvent], None],
+    _ack_ids: Any,
+    _statuses: Any,
+) -> None:
+    error_description = "Acks received but no on_acks callback configured"
+    user_on_session_event(InterfaceError(error_description))
+
+
+def on_slow_callback(
+    user_on_session_event: Callable[[SessionEvent], None],
+    callback_name: str,
+    duration: float,
+    threshold: float,
 ) -> None:
-    for status, status_description, guid, queue_uri, user_callback in acks:
-        py_status = ack_status_mapping.get(status, AckStatus.UNRECOGNIZED)
-        user_callback(
-            create_ack(
-                guid,
-                py_status,
-                status_description.decode(),
-                queue_uri.decode(),
-            )
+    user_on_session_event(
+        SlowCallback(
+            "%s took %.3fs, exceeding the %.3fs threshold"
+            % (callback_name, duration, threshold)
         )
+    )
 
 
 def on_message_create_interface_error(
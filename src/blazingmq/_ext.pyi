@@ -13,18 +13,23 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
+from typing import Any
 from typing import Callable
 from typing import Dict
+from typing import Iterable
+from typing import List
 from typing import Optional
 from typing import Tuple
 from typing import Union
 
-from blazingmq import Ack
+from blazingmq import AckStatus
 from blazingmq import CompressionAlgorithmType
-from blazingmq import Message
-from blazingmq import MessageHandle
+from blazingmq import PayloadType
 from blazingmq import PropertyType
+from blazingmq import PropertyTypeDict
+from blazingmq import PropertyValueDict
 from blazingmq import Timeouts
+from blazingmq.exceptions import Error
 from blazingmq.session_events import SessionEvent
 
 DEFAULT_MAX_UNCONFIRMED_MESSAGES: int = ...
@@ -32,17 +37,91 @@ DEFAULT_MAX_UNCONFIRMED_BYTES: int = ...
 DEFAULT_CONSUMER_PRIORITY: int = ...
 DEFAULT_SUSPENDS_ON_BAD_HOST_HEALTH: bool = ...
 
+def set_sdk_log_level(category_prefix: bytes, level: int) -> None: ...
+
+class Message:
+    data: Union[bytes, memoryview]
+    data_buffers: List[memoryview]
+    guid: bytes
+    queue_uri: str
+    properties: PropertyValueDict
+    property_types: PropertyTypeDict
+
+class MessageHandle:
+    _message: Message
+    _ext_session: Session
+    def confirm(self) -> None: ...
+    @staticmethod
+    def confirm_many(handles: Iterable[MessageHandle]) -> None: ...
+
+class Ack:
+    guid: Optional[bytes]
+    status: AckStatus
+    _status_description: str
+    queue_uri: str
+
+def create_message(
+    data: Optional[Union[bytes, memoryview]],
+    guid: bytes,
+    queue_uri: str,
+    properties: PropertyValueDict,
+    property_types: PropertyTypeDict,
+    data_buffers: Optional[List[memoryview]] = None,
+) -> Message: ...
+def create_message_handle(message: Message, ext_session: Session) -> MessageHandle: ...
+def create_ack(
+    guid: Optional[bytes], status: AckStatus, status_description: str, queue_uri: str
+) -> Ack: ...
+
 class FakeHostHealthMonitor:
     def __init__(self) -> None: ...
     def set_healthy(self) -> None: ...
     def set_unhealthy(self) -> None: ...
 
+class SystemHostHealthMonitor:
+    def __init__(
+        self,
+        *,
+        max_load_average: Optional[float],
+        min_available_memory: Optional[float],
+        probe_file: bytes,
+        probe_command: bytes,
+        interval: float,
+    ) -> None: ...
+
+class CompressionPolicy:
+    def __init__(
+        self, algorithm: CompressionAlgorithmType, min_size: int, adaptive: bool
+    ) -> None: ...
+
+class FlowControlPolicy:
+    def __init__(
+        self,
+        min_messages: int,
+        max_messages: int,
+        min_bytes: int,
+        max_bytes: int,
+        window: float,
+        interval: float,
+    ) -> None: ...
+
+class LoopbackBroker:
+    def __init__(
+        self, *, latency: float, batch_size: int, nack_ratio: float
+    ) -> None: ...
+
+class PropertiesTemplate:
+    def __init__(
+        self, properties: Dict[bytes, Tuple[Union[int, bytes], int]]
+    ) -> None: ...
+
 class Session:
     def __init__(
         self,
         on_session_event: Callable[[SessionEvent], None],
         *,
         on_message: Optional[Callable[[Message, MessageHandle], None]] = None,
+        on_acks: Optional[Callable[[List[int], List[AckStatus]], None]] = None,
         broker: bytes,
         message_compression_algorithm: CompressionAlgorithmType,
         num_processing_threads: Optional[int] = None,
@@ -53,6 +132,13 @@ class Session:
         timeouts: Timeouts = Timeouts(),
         monitor_host_health: bool = False,
         fake_host_health_monitor: Optional[FakeHostHealthMonitor] = None,
+        system_host_health_monitor: Optional[SystemHostHealthMonitor] = None,
+        zero_copy_payloads: bool = False,
+        pull_messages: bool = False,
+        num_dispatch_threads: int = 0,
+        time_callbacks: bool = False,
+        slow_callback_threshold: Optional[float] = None,
+        loopback: Optional[LoopbackBroker] = None,
     ) -> None: ...
     def stop(self) -> None: ...
     def open_queue_sync(
@@ -65,19 +151,124 @@ class Session:
         max_unconfirmed_messages: Optional[int] = None,
         max_unconfirmed_bytes: Optional[int] = None,
         suspends_on_bad_host_health: Optional[bool] = None,
+        subscriptions: Optional[
+            List[Tuple[bytes, Optional[int], Optional[int], Optional[int]]]
+        ] = None,
         timeout: Optional[float] = None,
-    ) -> None: ...
+        lazy_properties: bool = False,
+        property_projection: Optional[List[bytes]] = None,
+        compression_policy: Optional[CompressionPolicy] = None,
+        payload_decoder: Optional[object] = None,
+        flow_control: Optional[FlowControlPolicy] = None,
+    ) -> Queue: ...
     def close_queue_sync(
         self, queue_uri: bytes, *, timeout: Optional[float] = None
     ) -> None: ...
-    def get_queue_options(self, queue_uri: bytes) -> Tuple[int, int, int]: ...
+    def open_queue_async(
+        self,
+        queue_uri: bytes,
+        *,
+        read: bool,
+        write: bool,
+        consumer_priority: Optional[int] = None,
+        max_unconfirmed_messages: Optional[int] = None,
+        max_unconfirmed_bytes: Optional[int] = None,
+        suspends_on_bad_host_health: Optional[bool] = None,
+        subscriptions: Optional[
+            List[Tuple[bytes, Optional[int], Optional[int], Optional[int]]]
+        ] = None,
+        timeout: Optional[float] = None,
+        lazy_properties: bool = False,
+        property_projection: Optional[List[bytes]] = None,
+        compression_policy: Optional[CompressionPolicy] = None,
+        payload_decoder: Optional[object] = None,
+        flow_control: Optional[FlowControlPolicy] = None,
+        on_complete: Callable[[Optional[Queue], Optional[Exception]], None],
+    ) -> None: ...
+    def open_queues(
+        self,
+        queue_uris: List[bytes],
+        *,
+        read: bool,
+        write: bool,
+        consumer_priority: Optional[int] = None,
+        max_unconfirmed_messages: Optional[int] = None,
+        max_unconfirmed_bytes: Optional[int] = None,
+        suspends_on_bad_host_health: Optional[bool] = None,
+        subscriptions: Optional[
+            List[Tuple[bytes, Optional[int], Optional[int], Optional[int]]]
+        ] = None,
+        timeout: Optional[float] = None,
+        lazy_properties: bool = False,
+        property_projection: Optional[List[bytes]] = None,
+        compression_policy: Optional[CompressionPolicy] = None,
+        payload_decoder: Optional[object] = None,
+        flow_control: Optional[FlowControlPolicy] = None,
+        max_in_flight: int,
+    ) -> List[Union[Queue, Error]]: ...
+    def configure_queue_async(
+        self,
+        queue_uri: bytes,
+        *,
+        max_unconfirmed_messages: Optional[int] = None,
+        max_unconfirmed_bytes: Optional[int] = None,
+        consumer_priority: Optional[int] = None,
+        suspends_on_bad_host_health: Optional[bool] = None,
+        subscriptions: Optional[
+            List[Tuple[bytes, Optional[int], Optional[int], Optional[int]]]
+        ] = None,
+        timeout: Optional[float] = None,
+        on_complete: Callable[[None, Optional[Exception]], None],
+    ) -> None: ...
+    def close_queue_async(
+        self,
+        queue_uri: bytes,
+        *,
+        timeout: Optional[float] = None,
+        on_complete: Callable[[None, Optional[Exception]], None],
+    ) -> None: ...
+    def get_queue_options(
+        self, queue_uri: bytes
+    ) -> Tuple[
+        int,
+        int,
+        int,
+        bool,
+        List[Tuple[bytes, Optional[int], Optional[int], Optional[int]]],
+    ]: ...
     def post(
         self,
         queue_uri: bytes,
-        payload: bytes,
+        payload: PayloadType,
         *,
         properties: Optional[Dict[bytes, Tuple[Union[int, bytes], int]]] = None,
-        on_ack: Optional[Callable[[Ack], None]] = None,
+        on_ack: Optional[Union[Callable[[Ack], None], int]] = None,
+        properties_template: Optional[PropertiesTemplate] = None,
+        compression_algorithm: Optional[CompressionAlgorithmType] = None,
+        block: bool = False,
+        timeout: Optional[float] = None,
+    ) -> None: ...
+    def try_post(
+        self,
+        queue_uri: bytes,
+        payload: PayloadType,
+        *,
+        properties: Optional[Dict[bytes, Tuple[Union[int, bytes], int]]] = None,
+        on_ack: Optional[Union[Callable[[Ack], None], int]] = None,
+        properties_template: Optional[PropertiesTemplate] = None,
+        compression_algorithm: Optional[CompressionAlgorithmType] = None,
+    ) -> bool: ...
+    def post_many(
+        self,
+        queue_uri: bytes,
+        messages: Iterable[
+            Tuple[
+                PayloadType,
+                Optional[Dict[bytes, Tuple[Union[int, bytes], int]]],
+                Optional[Union[Callable[[Ack], None], int]],
+            ]
+        ],
+        properties_template: Optional[PropertiesTemplate] = None,
     ) -> None: ...
     def configure_queue_sync(
         self,
@@ -87,10 +278,41 @@ class Session:
         max_unconfirmed_bytes: Optional[int] = None,
         consumer_priority: Optional[int] = None,
         suspends_on_bad_host_health: Optional[bool] = None,
+        subscriptions: Optional[
+            List[Tuple[bytes, Optional[int], Optional[int], Optional[int]]]
+        ] = None,
         timeout: Optional[float] = None,
     ) -> None: ...
     def confirm(self, message: Message) -> None: ...
+    def confirm_many(self, messages: Iterable[Message]) -> None: ...
+    def receive(
+        self, max_messages: int, timeout: Optional[float] = None
+    ) -> List[Message]: ...
+    def notification_fd(self) -> int: ...
+    def stats(self) -> Dict[str, Any]: ...
     @property
     def monitor_host_health(self) -> bool: ...
 
+class Queue:
+    uri: bytes
+    def post(
+        self,
+        payload: PayloadType,
+        properties: Optional[Dict[bytes, Tuple[Union[int, bytes], int]]] = None,
+        on_ack: Optional[Union[Callable[[Ack], None], int]] = None,
+        properties_template: Optional[PropertiesTemplate] = None,
+        compression_algorithm: Optional[CompressionAlgorithmType] = None,
+        block: bool = False,
+        timeout: Optional[float] = None,
+    ) -> None: ...
+    def try_post(
+        self,
+        payload: PayloadType,
+        properties: Optional[Dict[bytes, Tuple[Union[int, bytes], int]]] = None,
+        on_ack: Optional[Union[Callable[[Ack], None], int]] = None,
+        properties_template: Optional[PropertiesTemplate] = None,
+        compression_algorithm: Optional[CompressionAlgorithmType] = None,
+    ) -> bool: ...
+    def confirm(self, message: Message) -> None: ...
+
 PROPERTY_TYPES_FROM_PY_MAPPING: Dict[PropertyType, int]
@@ -21,11 +21,17 @@ import weakref
 from bsl cimport optional
 from bsl cimport pair
 from bsl cimport shared_ptr
+from bsl cimport string
+from bsl cimport vector
 from bsl.bsls cimport TimeInterval
+from cpython.buffer cimport PyBUF_SIMPLE
+from cpython.buffer cimport PyBuffer_Release
+from cpython.buffer cimport PyObject_GetBuffer
 from cpython.ceval cimport PyEval_InitThreads
 from libcpp cimport bool as cppbool
 
 from bmq.bmqa cimport ManualHostHealthMonitor
+from bmq.bmqa cimport QueueId
 from bmq.bmqt cimport AckResult
 from bmq.bmqt cimport CompressionAlgorithmType
 from bmq.bmqt cimport HostHealthState
@@ -36,7 +42,13 @@ from bmq.bmqt cimport k_DEFAULT_MAX_UNCONFIRMED_BYTES
 from bmq.bmqt cimport k_DEFAULT_MAX_UNCONFIRMED_MESSAGES
 from bmq.bmqt cimport k_DEFAULT_SUSPENDS_ON_BAD_HOST_HEALTH
 from pybmq cimport BallUtil
+from pybmq cimport CompressionPolicy as NativeCompressionPolicy
+from pybmq cimport FlowControlPolicy as NativeFlowControlPolicy
+from pybmq cimport LoopbackOptions as NativeLoopbackOptions
+from pybmq cimport MessageTypes
+from pybmq cimport PropertiesTemplate as NativePropertiesTemplate
 from pybmq cimport Session as NativeSession
+from pybmq cimport SystemHostHealthMonitor as NativeSystemHostHealthMonitor
 
 from typing import Optional
 
@@ -65,6 +77,10 @@ cdef _log_callback(const char *name,
     LOGGER.handle(rec)
 
 
+def set_sdk_log_level(category_prefix: bytes, level: int) -> None:
+    BallUtil.setCategoryLevel(category_prefix, level)
+
+
 SESSION_EVENT_TYPE_MAPPING = {
     SessionEventEnum.e_CONNECTED: session_events.Connected,
     SessionEventEnum.e_DISCONNECTED: session_events.Disconnected,
@@ -84,18 +100,18 @@ SESSION_EVENT_TYPE_MAPPING = {
 
 
 ACK_STATUS_MAPPING = {
-    AckResult.e_SUCCESS: _messages.AckStatus.SUCCESS,
-    AckResult.e_UNKNOWN: _messages.AckStatus.UNKNOWN,
-    AckResult.e_TIMEOUT: _messages.AckStatus.TIMEOUT,
-    AckResult.e_NOT_CONNECTED: _messages.AckStatus.NOT_CONNECTED,
-    AckResult.e_CANCELED: _messages.AckStatus.CANCELED,
-    AckResult.e_NOT_SUPPORTED: _messages.AckStatus.NOT_SUPPORTED,
-    AckResult.e_REFUSED: _messages.AckStatus.REFUSED,
-    AckResult.e_INVALID_ARGUMENT: _messages.AckStatus.INVALID_ARGUMENT,
-    AckResult.e_NOT_READY: _messages.AckStatus.NOT_READY,
-    AckResult.e_LIMIT_BYTES: _messages.AckStatus.LIMIT_BYTES,
-    AckResult.e_LIMIT_MESSAGES: _messages.AckStatus.LIMIT_MESSAGES,
-    AckResult.e_STORAGE_FAILURE: _messages.AckStatus.STORAGE_FAILURE,
+    AckResult.e_SUCCESS: _enums.AckStatus.SUCCESS,
+    AckResult.e_UNKNOWN: _enums.AckStatus.UNKNOWN,
+    AckResult.e_TIMEOUT: _enums.AckStatus.TIMEOUT,
+    AckResult.e_NOT_CONNECTED: _enums.AckStatus.NOT_CONNECTED,
+    AckResult.e_CANCELED: _enums.AckStatus.CANCELED,
+    AckResult.e_NOT_SUPPORTED: _enums.AckStatus.NOT_SUPPORTED,
+    AckResult.e_REFUSED: _enums.AckStatus.REFUSED,
+    AckResult.e_INVALID_ARGUMENT: _enums.AckStatus.INVALID_ARGUMENT,
+    AckResult.e_NOT_READY: _enums.AckStatus.NOT_READY,
+    AckResult.e_LIMIT_BYTES: _enums.AckStatus.LIMIT_BYTES,
+    AckResult.e_LIMIT_MESSAGES: _enums.AckStatus.LIMIT_MESSAGES,
+    AckResult.e_STORAGE_FAILURE: _enums.AckStatus.STORAGE_FAILURE,
 }
 
 PROPERTY_TYPES_TO_PY_MAPPING = {
@@ -110,6 +126,33 @@ PROPERTY_TYPES_TO_PY_MAPPING = {
 
 PROPERTY_TYPES_FROM_PY_MAPPING = {v: k for k, v in PROPERTY_TYPES_TO_PY_MAPPING.items()}
 
+MessageTypes.initialize(
+    Error,
+    PROPERTY_TYPES_TO_PY_MAPPING,
+    ACK_STATUS_MAPPING,
+    _enums.AckStatus.UNRECOGNIZED,
+    partial(_messages.create_lazy_properties, PROPERTY_TYPES_TO_PY_MAPPING),
+)
+
+Message = <object>MessageTypes.message_type()
+MessageHandle = <object>MessageTypes.message_handle_type()
+Ack = <object>MessageTypes.ack_type()
+
+
+def create_message(data, guid, queue_uri, properties, property_types, data_buffers=None):
+    if data is None and data_buffers is None:
+        raise ValueError("either data or data_buffers must be provided")
+    return MessageTypes.create_message(
+        data, data_buffers, guid, queue_uri, properties, property_types, False)
+
+
+def create_message_handle(message not None, ext_session not None):
+    return MessageTypes.create_message_handle(message, ext_session)
+
+
+def create_ack(guid, status not None, status_description not None, queue_uri not None):
+    return MessageTypes.create_ack(guid, status, status_description, queue_uri)
+
 COMPRESSION_ALGO_FROM_PY_MAPPING = {
     _enums.CompressionAlgorithmType.NONE: CompressionAlgorithmType.e_NONE,
     _enums.CompressionAlgorithmType.ZLIB: CompressionAlgorithmType.e_ZLIB,
@@ -154,16 +197,143 @@ cdef class FakeHostHealthMonitor:
             self._monitor.get().setState(HostHealthState.e_UNHEALTHY)
 
 
+cdef class SystemHostHealthMonitor:
+    cdef shared_ptr[NativeSystemHostHealthMonitor] _monitor
+
+    def __cinit__(
+        self,
+        *,
+        max_load_average: Optional[float],
+        min_available_memory: Optional[float],
+        probe_file not None: bytes,
+        probe_command not None: bytes,
+        interval: float,
+    ):
+        cdef optional[double] c_max_load_average
+        cdef optional[double] c_min_available_memory
+        if max_load_average is not None:
+            c_max_load_average = optional[double](<double>max_load_average)
+        if min_available_memory is not None:
+            c_min_available_memory = optional[double](<double>min_available_memory)
+        cdef string c_probe_file = probe_file
+        cdef string c_probe_command = probe_command
+        cdef TimeInterval c_interval = TimeInterval(interval)
+        with nogil:
+            self._monitor = shared_ptr[NativeSystemHostHealthMonitor](
+                new NativeSystemHostHealthMonitor(
+                    c_max_load_average,
+                    c_min_available_memory,
+                    c_probe_file,
+                    c_probe_command,
+                    c_interval,
+                )
+            )
+
+
+cdef class PropertiesTemplate:
+    cdef NativePropertiesTemplate _template
+
+    def __init__(self, properties not None: dict) -> None:
+        self._template.load(properties)
+
+
+cdef const NativePropertiesTemplate* _native_template(PropertiesTemplate template):
+    if template is None:
+        return NULL
+    return &template._template
+
+
+cdef class CompressionPolicy:
+    cdef shared_ptr[NativeCompressionPolicy] _policy
+
+    def __cinit__(self, algorithm not None, min_size: int, adaptive: bool):
+        cdef CompressionAlgorithmType c_algorithm = (
+            COMPRESSION_ALGO_FROM_PY_MAPPING[algorithm]
+        )
+        cdef size_t c_min_size = min_size
+        cdef cppbool c_adaptive = adaptive
+        self._policy = shared_ptr[NativeCompressionPolicy](
+            new NativeCompressionPolicy(c_algorithm, c_min_size, c_adaptive)
+        )
+
+
+cdef const NativeCompressionPolicy* _native_compression_policy(
+        CompressionPolicy policy):
+    if policy is None:
+        return NULL
+    return policy._policy.get()
+
+
+cdef class FlowControlPolicy:
+    cdef shared_ptr[NativeFlowControlPolicy] _policy
+
+    def __cinit__(self,
+                  min_messages: int,
+                  max_messages: int,
+                  min_bytes: int,
+                  max_bytes: int,
+                  window: int|float,
+                  interval: int|float):
+        cdef TimeInterval c_window = create_time_interval(window)
+        cdef TimeInterval c_interval = create_time_interval(interval)
+        self._policy = shared_ptr[NativeFlowControlPolicy](
+            new NativeFlowControlPolicy(min_messages,
+                                        max_messages,
+                                        min_bytes,
+                                        max_bytes,
+                                        c_window,
+                                        c_interval)
+        )
+
+
+cdef const NativeFlowControlPolicy* _native_flow_control(FlowControlPolicy policy):
+    if policy is None:
+        return NULL
+    return policy._policy.get()
+
+
+cdef class LoopbackBroker:
+    cdef shared_ptr[NativeLoopbackOptions] _options
+
+    def __cinit__(self, *, latency: float, batch_size: int, nack_ratio: float):
+        cdef TimeInterval c_latency = TimeInterval(latency)
+        cdef int c_batch_size = batch_size
+        cdef double c_nack_ratio = nack_ratio
+        self._options = shared_ptr[NativeLoopbackOptions](
+            new NativeLoopbackOptions(c_latency, c_batch_size, c_nack_ratio)
+        )
+
+
+cdef const NativeLoopbackOptions* _native_loopback_options(LoopbackBroker loopback):
+    if loopback is None:
+        return NULL
+    return loopback._options.get()
+
+
+cdef optional[CompressionAlgorithmType] _compression_algorithm(algorithm):
+    cdef optional[CompressionAlgorithmType] c_algorithm
+    if algorithm is not None:
+        c_algorithm = optional[CompressionAlgorithmType](
+            <CompressionAlgorithmType>COMPRESSION_ALGO_FROM_PY_MAPPING[algorithm]
+        )
+    return c_algorithm
+
+
+cdef class Queue
+
+
 cdef class Session:
     cdef object __weakref__
     cdef NativeSession* _session
     cdef readonly object monitor_host_health
+    cdef dict _queues
 
     def __cinit__(
         self,
         on_session_event not None,
         *,
         on_message=None,
+        on_acks=None,
         broker not None: bytes = b'tcp://localhost:30114',
         message_compression_algorithm not None=_enums.CompressionAlgorithmType.NONE,
         num_processing_threads: Optional[int] = None,
@@ -174,9 +344,17 @@ cdef class Session:
         timeouts: _timeouts.Timeouts = _timeouts.Timeouts(),
         monitor_host_health: bool = False,
         fake_host_health_monitor: FakeHostHealthMonitor = None,
+        system_host_health_monitor: SystemHostHealthMonitor = None,
+        zero_copy_payloads: bool = False,
+        pull_messages: bool = False,
+        num_dispatch_threads: int = 0,
+        time_callbacks: bool = False,
+        slow_callback_threshold: Optional[int|float] = None,
+        LoopbackBroker loopback = None,
         _mock: Optional[object] = None,
     ) -> None:
         cdef shared_ptr[ManualHostHealthMonitor] fake_host_health_monitor_sp
+        cdef shared_ptr[NativeSystemHostHealthMonitor] system_host_health_monitor_sp
         cdef optional[int] c_num_processing_threads
         cdef optional[int] c_blob_buffer_size
         cdef optional[int] c_channel_high_watermark
@@ -187,6 +365,7 @@ cdef class Session:
         cdef TimeInterval c_open_queue_timeout = create_time_interval(timeouts.open_queue_timeout)
         cdef TimeInterval c_configure_queue_timeout = create_time_interval(timeouts.configure_queue_timeout)
         cdef TimeInterval c_close_queue_timeout = create_time_interval(timeouts.close_queue_timeout)
+        cdef TimeInterval c_slow_callback_threshold = create_time_interval(slow_callback_threshold)
 
         PyEval_InitThreads()
 
@@ -201,9 +380,12 @@ cdef class Session:
                 pair[int,int](event_queue_watermarks[0], event_queue_watermarks[1]))
 
         self.monitor_host_health = monitor_host_health
+        self._queues = {}
 
         if fake_host_health_monitor:
             fake_host_health_monitor_sp = fake_host_health_monitor._monitor
+        if system_host_health_monitor:
+            system_host_health_monitor_sp = system_host_health_monitor._monitor
 
         session_cb = partial(_callbacks.on_session_event,
                              on_session_event,
@@ -215,9 +397,14 @@ cdef class Session:
                 _callbacks.on_message,
                 on_message,
                 weakref.ref(self),
-                PROPERTY_TYPES_TO_PY_MAPPING,
+                create_message_handle,
             )
-        ack_cb = partial(_callbacks.on_ack, ACK_STATUS_MAPPING)
+        ack_cb = _callbacks.on_ack
+        if on_acks is None:
+            acks_cb = partial(_callbacks.on_acks_create_interface_error, on_session_event)
+        else:
+            acks_cb = partial(_callbacks.on_acks, on_acks, ACK_STATUS_MAPPING)
+        slow_callback_cb = partial(_callbacks.on_slow_callback, on_session_event)
         cdef char *c_broker_uri = broker
         script_name = _script_name.get_script_name()
         cdef char *c_script_name = script_name
@@ -225,6 +412,8 @@ cdef class Session:
             session_cb,
             message_cb,
             ack_cb,
+            acks_cb,
+            slow_callback_cb,
             c_broker_uri,
             c_script_name,
             COMPRESSION_ALGO_FROM_PY_MAPPING[message_compression_algorithm],
@@ -240,8 +429,15 @@ cdef class Session:
             c_close_queue_timeout,
             monitor_host_health,
             fake_host_health_monitor_sp,
+            system_host_health_monitor_sp,
+            zero_copy_payloads,
+            pull_messages,
+            num_dispatch_threads,
+            time_callbacks,
+            c_slow_callback_threshold,
             Error,
             BrokerTimeoutError,
+            _native_loopback_options(loopback),
             _mock)
         self._session.start(c_connect_timeout)
         atexit.register(ensure_stop_session_impl, weakref.ref(self))
@@ -258,12 +454,19 @@ cdef class Session:
                         max_unconfirmed_messages: Optional[int] = None,
                         max_unconfirmed_bytes: Optional[int] = None,
                         suspends_on_bad_host_health: Optional[bool] = None,
-                        timeout: Optional[int|float] = None) -> None:
+                        subscriptions: Optional[list] = None,
+                        timeout: Optional[int|float] = None,
+                        lazy_properties: bool = False,
+                        property_projection: Optional[list] = None,
+                        CompressionPolicy compression_policy = None,
+                        payload_decoder: object = None,
+                        FlowControlPolicy flow_control = None) -> object:
         cdef optional[int] c_consumer_priority
         cdef optional[int] c_max_unconfirmed_messages
         cdef optional[int] c_max_unconfirmed_bytes
         cdef optional[cppbool] c_suspends_on_bad_host_health
         cdef TimeInterval c_timeout = create_time_interval(timeout)
+        cdef Queue queue = Queue.__new__(Queue)
 
         if consumer_priority is not None:
             c_consumer_priority = optional[int](consumer_priority)
@@ -277,14 +480,27 @@ cdef class Session:
         if suspends_on_bad_host_health is not None:
             c_suspends_on_bad_host_health = optional[cppbool](suspends_on_bad_host_health)
 
-        self._session.open_queue_sync(queue_uri,
+        self._session.open_queue_sync(&queue._queue_id,
+                                      queue_uri,
                                       read,
                                       write,
                                       c_consumer_priority,
                                       c_max_unconfirmed_messages,
                                       c_max_unconfirmed_bytes,
                                       c_suspends_on_bad_host_health,
-                                      c_timeout)
+                                      subscriptions,
+                                      c_timeout,
+                                      lazy_properties,
+                                      property_projection,
+                                      _native_compression_policy(compression_policy),
+                                      payload_decoder,
+                                      _native_flow_control(flow_control))
+
+        queue._session = self
+        queue.uri = queue_uri
+        queue._valid = True
+        self._track_queue(queue)
+        return queue
 
     def configure_queue_sync(self,
                              queue_uri not None: bytes,
@@ -293,6 +509,7 @@ cdef class Session:
                              max_unconfirmed_messages: Optional[int] = None,
                              max_unconfirmed_bytes: Optional[int] = None,
                              suspends_on_bad_host_health: Optional[bool] = None,
+                             subscriptions: Optional[list] = None,
                              timeout: Optional[int|float] = None) -> None:
         cdef optional[int] c_consumer_priority
         cdef optional[int] c_max_unconfirmed_messages
@@ -317,6 +534,7 @@ cdef class Session:
                                            c_max_unconfirmed_messages,
                                            c_max_unconfirmed_bytes,
                                            c_suspends_on_bad_host_health,
+                                           subscriptions,
                                            c_timeout)
 
     def close_queue_sync(self,
@@ -324,24 +542,429 @@ cdef class Session:
                          timeout: Optional[int|float] = None) -> None:
         cdef TimeInterval c_timeout = create_time_interval(timeout)
         self._session.close_queue_sync(queue_uri, c_timeout)
+        self._invalidate_queues(queue_uri)
+
+    def open_queue_async(self,
+                         queue_uri not None: bytes,
+                         *,
+                         read: bool,
+                         write: bool,
+                         consumer_priority: Optional[int] = None,
+                         max_unconfirmed_messages: Optional[int] = None,
+                         max_unconfirmed_bytes: Optional[int] = None,
+                         suspends_on_bad_host_health: Optional[bool] = None,
+                         subscriptions: Optional[list] = None,
+                         timeout: Optional[int|float] = None,
+                         lazy_properties: bool = False,
+                         property_projection: Optional[list] = None,
+                         CompressionPolicy compression_policy = None,
+                         payload_decoder: object = None,
+                         FlowControlPolicy flow_control = None,
+                         on_complete not None) -> None:
+        cdef optional[int] c_consumer_priority
+        cdef optional[int] c_max_unconfirmed_messages
+        cdef optional[int] c_max_unconfirmed_bytes
+        cdef optional[cppbool] c_suspends_on_bad_host_health
+        cdef TimeInterval c_timeout = create_time_interval(timeout)
+        cdef Queue queue = Queue.__new__(Queue)
+
+        if consumer_priority is not None:
+            c_consumer_priority = optional[int](consumer_priority)
+
+        if max_unconfirmed_messages is not None:
+            c_max_unconfirmed_messages = optional[int](max_unconfirmed_messages)
+
+        if max_unconfirmed_bytes is not None:
+            c_max_unconfirmed_bytes = optional[int](max_unconfirmed_bytes)
+
+        if suspends_on_bad_host_health is not None:
+            c_suspends_on_bad_host_health = optional[cppbool](suspends_on_bad_host_health)
+
+        queue.uri = queue_uri
+        self._session.open_queue_async(&queue._queue_id,
+                                       queue_uri,
+                                       read,
+                                       write,
+                                       c_consumer_priority,
+                                       c_max_unconfirmed_messages,
+                                       c_max_unconfirmed_bytes,
+                                       c_suspends_on_bad_host_health,
+                                       subscriptions,
+                                       c_timeout,
+                                       lazy_properties,
+                                       property_projection,
+                                       _native_compression_policy(compression_policy),
+                                       payload_decoder,
+                                       _native_flow_control(flow_control),
+                                       partial(_on_queue_opened,
+                                               weakref.ref(self),
+                                               queue,
+                                               on_complete))
+
+    def open_queues(self,
+                    queue_uris not None: list,
+                    *,
+                    read: bool,
+                    write: bool,
+                    consumer_priority: Optional[int] = None,
+                    max_unconfirmed_messages: Optional[int] = None,
+                    max_unconfirmed_bytes: Optional[int] = None,
+                    suspends_on_bad_host_health: Optional[bool] = None,
+                    subscriptions: Optional[list] = None,
+                    timeout: Optional[int|float] = None,
+                    lazy_properties: bool = False,
+                    property_projection: Optional[list] = None,
+                    CompressionPolicy compression_policy = None,
+                    payload_decoder: object = None,
+                    FlowControlPolicy flow_control = None,
+                    int max_in_flight) -> list:
+        cdef optional[int] c_consumer_priority
+        cdef optional[int] c_max_unconfirmed_messages
+        cdef optional[int] c_max_unconfirmed_bytes
+        cdef optional[cppbool] c_suspends_on_bad_host_health
+        cdef TimeInterval c_timeout = create_time_interval(timeout)
+        cdef vector[QueueId*] c_queue_ids
+        cdef vector[string] c_queue_uris
+        cdef Queue queue
+
+        if consumer_priority is not None:
+            c_consumer_priority = optional[int](consumer_priority)
+
+        if max_unconfirmed_messages is not None:
+            c_max_unconfirmed_messages = optional[int](max_unconfirmed_messages)
+
+        if max_unconfirmed_bytes is not None:
+            c_max_unconfirmed_bytes = optional[int](max_unconfirmed_bytes)
+
+        if suspends_on_bad_host_health is not None:
+            c_suspends_on_bad_host_health = optional[cppbool](suspends_on_bad_host_health)
+
+        queues = []
+        for queue_uri in queue_uris:
+            queue = Queue.__new__(Queue)
+            queue.uri = queue_uri
+            queues.append(queue)
+            c_queue_ids.push_back(&queue._queue_id)
+            c_queue_uris.push_back(string(<char*>queue.uri))
+
+        errors = self._session.open_queues(c_queue_ids,
+                                           c_queue_uris,
+                                           read,
+                                           write,
+                                           c_consumer_priority,
+                                           c_max_unconfirmed_messages,
+                                           c_max_unconfirmed_bytes,
+                                           c_suspends_on_bad_host_health,
+                                           subscriptions,
+                                           c_timeout,
+                                           lazy_properties,
+                                           property_projection,
+                                           _native_compression_policy(compression_policy),
+                                           payload_decoder,
+                                           _native_flow_control(flow_control),
+                                           max_in_flight)
+
+        results = []
+        for queue, error in zip(queues, errors):
+            if error is not None:
+                results.append(_queue_operation_error(*error))
+                continue
+            queue._session = self
+            queue._valid = True
+            self._track_queue(queue)
+            results.append(queue)
+        return results
+
+    def configure_queue_async(self,
+                              queue_uri not None: bytes,
+                              *,
+                              consumer_priority: Optional[int] = None,
+                              max_unconfirmed_messages: Optional[int] = None,
+                              max_unconfirmed_bytes: Optional[int] = None,
+                              suspends_on_bad_host_health: Optional[bool] = None,
+                              subscriptions: Optional[list] = None,
+                              timeout: Optional[int|float] = None,
+                              on_complete not None) -> None:
+        cdef optional[int] c_consumer_priority
+        cdef optional[int] c_max_unconfirmed_messages
+        cdef optional[int] c_max_unconfirmed_bytes
+        cdef optional[cppbool] c_suspends_on_bad_host_health
+        cdef TimeInterval c_timeout = create_time_interval(timeout)
+
+        if consumer_priority is not None:
+            c_consumer_priority = optional[int](consumer_priority)
+
+        if max_unconfirmed_messages is not None:
+            c_max_unconfirmed_messages = optional[int](max_unconfirmed_messages)
+
+        if max_unconfirmed_bytes is not None:
+            c_max_unconfirmed_bytes = optional[int](max_unconfirmed_bytes)
+
+        if suspends_on_bad_host_health is not None:
+            c_suspends_on_bad_host_health = optional[cppbool](suspends_on_bad_host_health)
+
+        self._session.configure_queue_async(queue_uri,
+                                            c_consumer_priority,
+                                            c_max_unconfirmed_messages,
+                                            c_max_unconfirmed_bytes,
+                                            c_suspends_on_bad_host_health,
+                                            subscriptions,
+                                            c_timeout,
+                                            partial(_on_queue_configured, on_complete))
+
+    def close_queue_async(self,
+                          queue_uri not None: bytes,
+                          *,
+                          timeout: Optional[int|float] = None,
+                          on_complete not None) -> None:
+        cdef TimeInterval c_timeout = create_time_interval(timeout)
+        self._session.close_queue_async(queue_uri,
+                                        c_timeout,
+                                        partial(_on_queue_closed,
+                                                weakref.ref(self),
+                                                queue_uri,
+                                                on_complete))
+
+    cdef _track_queue(self, Queue queue):
+        self._queues.setdefault(queue.uri, weakref.WeakSet()).add(queue)
+
+    cdef _invalidate_queues(self, bytes queue_uri):
+        for queue in self._queues.pop(queue_uri, ()):
+            (<Queue>queue)._invalidate()
 
     def get_queue_options(self,
                           queue_uri not None: bytes) -> object:
         return self._session.get_queue_options(queue_uri)
 
+    cdef _post(self,
+               bytes queue_uri,
+               payload,
+               properties,
+               on_ack,
+               PropertiesTemplate properties_template,
+               compression_algorithm,
+               cppbool block,
+               timeout,
+               cppbool raise_on_bw_limit):
+        cdef Py_buffer view
+        cdef optional[TimeInterval] c_timeout
+        if timeout is not None:
+            c_timeout = optional[TimeInterval](TimeInterval(timeout))
+        PyObject_GetBuffer(payload, &view, PyBUF_SIMPLE)
+        try:
+            return self._session.post(
+                queue_uri,
+                <const char*>view.buf,
+                view.len,
+                properties,
+                _native_template(properties_template),
+                on_ack,
+                _compression_algorithm(compression_algorithm),
+                block,
+                c_timeout,
+                raise_on_bw_limit)
+        finally:
+            PyBuffer_Release(&view)
+
     def post(self,
              queue_uri not None: bytes,
-             payload not None: bytes,
+             payload not None,
              properties=None,
-             on_ack=None) -> None:
-        self._session.post(queue_uri, payload, len(payload), properties, on_ack)
+             on_ack=None,
+             PropertiesTemplate properties_template=None,
+             compression_algorithm=None,
+             block=False,
+             timeout: Optional[int|float] = None) -> None:
+        self._post(queue_uri,
+                   payload,
+                   properties,
+                   on_ack,
+                   properties_template,
+                   compression_algorithm,
+                   block,
+                   timeout,
+                   True)
+
+    def try_post(self,
+                 queue_uri not None: bytes,
+                 payload not None,
+                 properties=None,
+                 on_ack=None,
+                 PropertiesTemplate properties_template=None,
+                 compression_algorithm=None) -> bool:
+        return self._post(queue_uri,
+                          payload,
+                          properties,
+                          on_ack,
+                          properties_template,
+                          compression_algorithm,
+                          False,
+                          None,
+                          False)
+
+    def post_many(self,
+                  queue_uri not None: bytes,
+                  messages not None,
+                  PropertiesTemplate properties_template=None) -> None:
+        self._session.post_many(
+            queue_uri, messages, _native_template(properties_template))
 
     def confirm(self, message not None) -> None:
         self._session.confirm(message.queue_uri, message.guid, len(message.guid))
 
+    def confirm_many(self, messages not None) -> None:
+        self._session.confirm_many(messages)
+
+    def receive(self,
+                int max_messages,
+                timeout: Optional[int|float] = None) -> list:
+        cdef optional[TimeInterval] c_timeout
+        if timeout is not None:
+            c_timeout = optional[TimeInterval](TimeInterval(timeout))
+        return self._session.receive(max_messages, c_timeout)
+
+    def notification_fd(self) -> int:
+        return self._session.notification_fd()
+
+    def stats(self) -> dict:
+        return self._session.stats()
+
     def __dealloc__(self) -> None:
         if self._session:
             try:
                 self._session.stop(True)
             finally:
                 del self._session
+
+
+def _queue_operation_error(error, timed_out):
+    error_class = BrokerTimeoutError if timed_out else Error
+    return error_class(error.decode('utf-8'))
+
+
+def _on_queue_opened(session_ref, Queue queue, on_complete, error, timed_out):
+    cdef Session session = session_ref()
+    if error is not None:
+        on_complete(None, _queue_operation_error(error, timed_out))
+        return
+    if session is None:
+        # The session is being destroyed without having been stopped.
+        on_complete(None, Error("Session was destroyed before the queue was opened"))
+        return
+    queue._session = session
+    queue._valid = True
+    session._track_queue(queue)
+    on_complete(queue, None)
+
+
+def _on_queue_configured(on_complete, error, timed_out):
+    if error is not None:
+        on_complete(None, _queue_operation_error(error, timed_out))
+    else:
+        on_complete(None, None)
+
+
+def _on_queue_closed(session_ref, queue_uri, on_complete, error, timed_out):
+    cdef Session session = session_ref()
+    if error is not None:
+        on_complete(None, _queue_operation_error(error, timed_out))
+        return
+    if session is not None:
+        session._invalidate_queues(queue_uri)
+    on_complete(None, None)
+
+
+cdef class Queue:
+    cdef object __weakref__
+    cdef QueueId _queue_id
+    cdef Session _session
+    cdef readonly bytes uri
+    cdef bint _valid
+
+    def __init__(self) -> None:
+        raise Error("The Queue class does not have a public constructor.")
+
+    cdef _invalidate(self):
+        self._valid = False
+        self._queue_id = QueueId()
+
+    cdef _check_valid(self):
+        if not self._valid:
+            raise Error("Queue %s is no longer open" % self.uri.decode('utf-8'))
+
+    cdef _post(self,
+               payload,
+               properties,
+               on_ack,
+               PropertiesTemplate properties_template,
+               compression_algorithm,
+               cppbool block,
+               timeout,
+               cppbool raise_on_bw_limit):
+        cdef Py_buffer view
+        cdef optional[TimeInterval] c_timeout
+        self._check_valid()
+        if timeout is not None:
+            c_timeout = optional[TimeInterval](TimeInterval(timeout))
+        PyObject_GetBuffer(payload, &view, PyBUF_SIMPLE)
+        try:
+            return self._session._session.post_to_queue(
+                self._queue_id,
+                <const char*>view.buf,
+                view.len,
+                properties,
+                _native_template(properties_template),
+                on_ack,
+                _compression_algorithm(compression_algorithm),
+                block,
+                c_timeout,
+                raise_on_bw_limit)
+        finally:
+            PyBuffer_Release(&view)
+
+    def post(self,
+             payload not None,
+             properties=None,
+             on_ack=None,
+             PropertiesTemplate properties_template=None,
+             compression_algorithm=None,
+             block=False,
+             timeout: Optional[int|float] = None) -> None:
+        self._post(payload,
+                   properties,
+                   on_ack,
+                   properties_template,
+                   compression_algorithm,
+                   block,
+                   timeout,
+                   True)
+
+    def try_post(self,
+                 payload not None,
+                 properties=None,
+                 on_ack=None,
+                 PropertiesTemplate properties_template=None,
+                 compression_algorithm=None) -> bool:
+        return self._post(payload,
+                          properties,
+                          on_ack,
+                          properties_template,
+                          compression_algorithm,
+                          False,
+                          None,
+                          False)
+
+    def confirm(self, message not None) -> None:
+        self._check_valid()
+        queue_uri = message.queue_uri
+        if isinstance(queue_uri, str):
+            queue_uri = queue_uri.encode('utf-8')
+        if queue_uri != self.uri:
+            raise Error("Message from queue %s cannot be confirmed on queue %s"
+                        % (queue_uri.decode('utf-8'), self.uri.decode('utf-8')))
+        self._session._session.confirm_on_queue(
+            self._queue_id, message.guid, len(message.guid))
+
+    def __repr__(self) -> str:
+        state = "" if self._valid else " (closed)"
+        return "<Queue %s%s>" % (self.uri.decode('utf-8'), state)
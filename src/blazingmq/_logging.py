@@ -0,0 +1,37 @@
+# Copyright 2019-2023 Bloomberg Finance L.P.
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from . import _ext
+
+
+def set_sdk_log_level(level: int, category: str = "") -> None:
+    """Set the minimum level of the log records forwarded from the C++ SDK.
+
+    The log records of the BlazingMQ C++ SDK are forwarded to the ``blazingmq``
+    logger, under a child logger named after their category.  They are handed
+    over to `logging` in batches by a dedicated thread, so the SDK's own
+    threads never wait for the GIL to log.
+
+    Records below *level*, in categories whose name starts with *category*,
+    are discarded by the SDK itself from then on, before they are formatted.
+    This is much cheaper than filtering them with a `logging.Filter`.  Where
+    several prefixes match a category, the longest one applies.
+
+    Args:
+        level: a `logging` level, such as ``logging.WARNING``.
+        category: the prefix of the SDK log categories the level applies to.
+            Defaults to every category.
+    """
+    _ext.set_sdk_log_level(category.encode("utf-8"), level)
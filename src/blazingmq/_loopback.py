@@ -0,0 +1,74 @@
+# Copyright 2019-2023 Bloomberg Finance L.P.
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from ._ext import LoopbackBroker as ExtLoopbackBroker
+
+
+class LoopbackBroker:
+    """A broker simulated by the `.Session` itself, to load-test applications.
+
+    When a *LoopbackBroker* is passed as the `.Session` constructor's *broker*,
+    the session doesn't connect to any broker.  Instead, each message posted
+    to a queue is held for *latency* seconds, then acknowledged and, if the
+    session opened that queue for reading, delivered back to it.  Posting,
+    acknowledging, delivering and confirming are all handled by native code,
+    which never takes the GIL except to invoke your callbacks, so an
+    application's pipeline can be benchmarked or soak-tested at realistic
+    rates without a broker.
+
+    Acknowledgments and messages are delivered in batches of up to
+    *batch_size* messages.  One in every ``1 / nack_ratio`` posted messages is
+    rejected with `.AckStatus.REFUSED` instead, and never delivered.  The
+    messages still held when the session stops are acknowledged with
+    `.AckStatus.CANCELED`.  Opening, configuring and closing queues always
+    succeeds immediately.
+
+    Args:
+        latency: the number of seconds between posting a message and its
+            acknowledgment and delivery.  Defaults to 0.
+        batch_size: the maximum number of messages acknowledged or delivered
+            at once.  Defaults to 1024.
+        nack_ratio: the fraction of the posted messages, between 0 and 1, that
+            are rejected.  Defaults to 0.
+
+    Raises:
+        `ValueError`: If *latency* is < 0.0, *batch_size* is not > 0, or
+            *nack_ratio* is not between 0.0 and 1.0.
+    """
+
+    def __init__(
+        self, latency: float = 0.0, batch_size: int = 1024, nack_ratio: float = 0.0
+    ) -> None:
+        if latency < 0.0:
+            raise ValueError(f"latency must be >= 0.0, was {latency}")
+        if batch_size <= 0:
+            raise ValueError(f"batch_size must be > 0, was {batch_size}")
+        if not 0.0 <= nack_ratio <= 1.0:
+            raise ValueError(
+                f"nack_ratio must be between 0.0 and 1.0, was {nack_ratio}"
+            )
+        self.latency = latency
+        self.batch_size = batch_size
+        self.nack_ratio = nack_ratio
+        self._options = ExtLoopbackBroker(
+            latency=latency, batch_size=batch_size, nack_ratio=nack_ratio
+        )
+
+    def __repr__(self) -> str:
+        return (
+            f"LoopbackBroker(latency={self.latency!r},"
+            f" batch_size={self.batch_size!r},"
+            f" nack_ratio={self.nack_ratio!r})"
+        )
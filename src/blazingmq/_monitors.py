@@ -13,7 +13,10 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
+from typing import Optional
+
 from ._ext import FakeHostHealthMonitor
+from ._ext import SystemHostHealthMonitor
 
 
 class BasicHealthMonitor:
@@ -39,3 +42,75 @@ class BasicHealthMonitor:
 
     def __repr__(self) -> str:
         return "BasicHealthMonitor()"
+
+
+class SystemHealthMonitor:
+    """Let a `.Session` see the host as unhealthy when it is overloaded.
+
+    When a *SystemHealthMonitor* is passed for the `.Session` constructor's
+    *host_health_monitor* parameter, the host's health is sampled every
+    *interval* seconds by a native thread, without ever taking the GIL, so
+    queues opened with *suspends_on_bad_host_health* are suspended promptly
+    even when the Python process itself is too busy to run.
+
+    The host is seen as unhealthy as soon as a sample fails any of the checks
+    requested by the arguments, and as healthy again once three samples in a
+    row have passed all of them.  The same instance may be shared by several
+    sessions.
+
+    Args:
+        max_load_average: the one minute load average above which the host is
+            unhealthy.  Not checked by default.
+        min_available_memory: the fraction of the host's memory, between 0
+            and 1, below which the host is unhealthy when that much memory is
+            no longer available.  Only checked on Linux.  Defaults to 0.05,
+            and not checked if `None`.
+        probe_file: a path at which the host is unhealthy whenever a file
+            exists, for example to drain a host manually.  Not checked by
+            default.
+        probe_command: a shell command run on every sample, which makes the
+            host unhealthy when it exits with a non-zero status.  Not run by
+            default.
+        interval: the number of seconds between samples.  Defaults to 1.
+
+    Raises:
+        `ValueError`: If *interval* is not > 0.0, *max_load_average* is
+            < 0.0, or *min_available_memory* is not between 0.0 and 1.0.
+    """
+
+    def __init__(
+        self,
+        max_load_average: Optional[float] = None,
+        min_available_memory: Optional[float] = 0.05,
+        probe_file: Optional[str] = None,
+        probe_command: Optional[str] = None,
+        interval: float = 1.0,
+    ) -> None:
+        if interval <= 0.0:
+            raise ValueError(f"interval must be > 0.0, was {interval}")
+        if max_load_average is not None and max_load_average < 0.0:
+            raise ValueError(
+                f"max_load_average must be >= 0.0, was {max_load_average}"
+            )
+        if min_available_memory is not None and not 0.0 <= min_available_memory <= 1.0:
+            raise ValueError(
+                "min_available_memory must be between 0.0 and 1.0,"
+                f" was {min_available_memory}"
+            )
+        self._args = (
+            max_load_average,
+            min_available_memory,
+            probe_file,
+            probe_command,
+            interval,
+        )
+        self._monitor = SystemHostHealthMonitor(
+            max_load_average=max_load_average,
+            min_available_memory=min_available_memory,
+            probe_file=(probe_file or "").encode("utf-8"),
+            probe_command=(probe_command or "").encode("utf-8"),
+            interval=interval,
+        )
+
+    def __repr__(self) -> str:
+        return "SystemHealthMonitor(%r, %r, %r, %r, %r)" % self._args
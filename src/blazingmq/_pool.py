@@ -0,0 +1,337 @@
+# Copyright 2019-2023 Bloomberg Finance L.P.
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import annotations
+
+import itertools
+from typing import Any
+from typing import Callable
+from typing import Dict
+from typing import Hashable
+from typing import Iterable
+from typing import List
+from typing import Optional
+from typing import Sequence
+from typing import Tuple
+from typing import Union
+
+from ._enums import AckStatus
+from ._enums import CompressionAlgorithmType
+from ._ext import Ack
+from ._loopback import LoopbackBroker
+from ._session import DEFAULT_TIMEOUT
+from ._session import CompressionPolicy
+from ._session import PropertiesTemplate
+from ._session import QueueOptions
+from ._session import Session
+from ._session import SessionOptions
+from ._typing import PayloadType
+from ._typing import PropertyTypeDict
+from ._typing import PropertyValueDict
+from .session_events import SessionEvent
+
+
+def _merge_stats(total: Dict[str, Any], stats: Dict[str, Any]) -> None:
+    for key, value in stats.items():
+        if isinstance(value, dict):
+            _merge_stats(total.setdefault(key, {}), value)
+        elif key not in total or key == "bounds":
+            total[key] = value
+        elif isinstance(value, list):
+            total[key] = [a + b for a, b in zip(total[key], value)]
+        else:
+            total[key] += value
+
+
+class SessionPool:
+    """A producer posting through several sessions, each with its own channel.
+
+    A `Session` posts every message over a single connection to the broker,
+    so its throughput is bounded by that connection's *channel_high_watermark*
+    and by the SDK's I/O threads serving it.  A *SessionPool* starts
+    *num_sessions* sessions, each with its own connection and SDK threads, and
+    spreads the messages it posts across them.
+
+    Each `post` is routed to the next session in round-robin order, unless a
+    *key* is provided: the messages posted with equal keys are then always
+    routed to the same session, so they're received in the order they were
+    posted.  Messages posted without a key carry no ordering guarantee.
+
+    The pool's queues are opened for writing only, on every session.  The
+    acknowledgments of the messages posted are delivered to their own
+    *on_ack* callback or to the pool's *on_acks*, and the events of every
+    session are passed to *on_session_event*; either may be invoked from
+    several sessions' threads at the same time.
+
+    Args:
+        on_session_event: a required callback to process `.SessionEvent` events
+            received by any session of the pool.
+        num_sessions: the number of sessions to start.  Defaults to 2.
+        broker: TCP address of the broker (default: 'tcp://localhost:30114'),
+            or a `.LoopbackBroker` to simulate one.  A sequence of addresses
+            connects the sessions to each of them in turn, for example to
+            reach the broker through different network interfaces.
+        session_options: an instance of `.SessionOptions` that represents the
+            configuration of every session.
+        on_acks: an optional callback receiving batches of acknowledgments
+            for messages posted with an *ack_id*, as `Session` does.
+
+    Raises:
+        `~blazingmq.Error`: If any session start request was not successful.
+            The sessions already started are then stopped.
+        `ValueError`: If *num_sessions* is not > 0 or *broker* is an empty
+            sequence.
+    """
+
+    def __init__(
+        self,
+        on_session_event: Callable[[SessionEvent], None],
+        num_sessions: int = 2,
+        broker: Union[str, LoopbackBroker, Sequence[str]] = "tcp://localhost:30114",
+        session_options: SessionOptions = (SessionOptions()),
+        on_acks: Optional[Callable[[List[int], List[AckStatus]], None]] = None,
+    ) -> None:
+        if num_sessions <= 0:
+            raise ValueError(f"num_sessions must be > 0, was {num_sessions}")
+
+        brokers: Sequence[Union[str, LoopbackBroker]]
+        if isinstance(broker, (str, LoopbackBroker)):
+            brokers = [broker]
+        else:
+            brokers = list(broker)
+            if not brokers:
+                raise ValueError("broker must hold at least one address")
+
+        self._sessions: List[Session] = []
+        try:
+            for i in range(num_sessions):
+                self._sessions.append(
+                    Session.with_options(
+                        on_session_event,
+                        broker=brokers[i % len(brokers)],
+                        session_options=session_options,
+                        on_acks=on_acks,
+                    )
+                )
+        except BaseException:
+            self.stop()
+            raise
+
+        self._next_session = itertools.count()
+
+    def _session_for(self, key: Optional[Hashable]) -> Session:
+        if key is None:
+            index = next(self._next_session)
+        else:
+            index = hash(key)
+        return self._sessions[index % len(self._sessions)]
+
+    @property
+    def sessions(self) -> Tuple[Session, ...]:
+        """The sessions of the pool, in routing order."""
+        return tuple(self._sessions)
+
+    def open_queue(
+        self,
+        queue_uri: str,
+        options: QueueOptions = QueueOptions(),
+        timeout: float = DEFAULT_TIMEOUT,
+        compression_policy: Optional[CompressionPolicy] = None,
+    ) -> None:
+        """Open a queue for writing on every session of the pool.
+
+        The queue is opened by all the sessions concurrently, so this takes
+        about as long as `Session.open_queue` does.  See `Session.open_queue`
+        for the meaning of each argument.
+
+        Raises:
+            `~blazingmq.Error`: If the queue couldn't be opened by any of the
+                sessions.  The first error is raised after every session's
+                request completes.
+            `~blazingmq.exceptions.BrokerTimeoutError`: If the broker didn't
+                respond in time.
+        """
+        futures = [
+            session.open_queue_async(
+                queue_uri,
+                write=True,
+                options=options,
+                timeout=timeout,
+                compression_policy=compression_policy,
+            )
+            for session in self._sessions
+        ]
+        errors = [future.exception() for future in futures]
+        for error in errors:
+            if error is not None:
+                raise error
+
+    def close_queue(self, queue_uri: str, timeout: float = DEFAULT_TIMEOUT) -> None:
+        """Close a queue opened with `open_queue` on every session of the pool.
+
+        See `Session.close_queue` for the meaning of each argument.
+
+        Raises:
+            `~blazingmq.Error`: If the queue couldn't be closed by any of the
+                sessions.  The first error is raised after every session's
+                request completes.
+            `~blazingmq.exceptions.BrokerTimeoutError`: If the broker didn't
+                respond in time.
+        """
+        futures = [
+            session.close_queue_async(queue_uri, timeout) for session in self._sessions
+        ]
+        errors = [future.exception() for future in futures]
+        for error in errors:
+            if error is not None:
+                raise error
+
+    def post(
+        self,
+        queue_uri: str,
+        message: PayloadType,
+        properties: Optional[PropertyValueDict] = None,
+        property_type_overrides: Optional[PropertyTypeDict] = None,
+        on_ack: Optional[Callable[[Ack], None]] = None,
+        ack_id: Optional[int] = None,
+        properties_template: Optional[PropertiesTemplate] = None,
+        compression_algorithm: Optional[CompressionAlgorithmType] = None,
+        block: bool = False,
+        timeout: Optional[float] = None,
+        key: Optional[Hashable] = None,
+    ) -> None:
+        """Post a message to a queue through one of the sessions of the pool.
+
+        See `Session.post` for the meaning of each argument.
+
+        Args:
+            key: optionally provided value choosing the session the message is
+                posted through, so that it's received after the messages
+                previously posted with an equal key.  It must be hashable,
+                and is hashed with `hash`, so the keys of a given type must
+                hash consistently within the process.
+
+        Raises:
+            `~blazingmq.Error`: If the post request was not successful.
+        """
+        self._session_for(key).post(
+            queue_uri,
+            message,
+            properties=properties,
+            property_type_overrides=property_type_overrides,
+            on_ack=on_ack,
+            ack_id=ack_id,
+            properties_template=properties_template,
+            compression_algorithm=compression_algorithm,
+            block=block,
+            timeout=timeout,
+        )
+
+    def try_post(
+        self,
+        queue_uri: str,
+        message: PayloadType,
+        properties: Optional[PropertyValueDict] = None,
+        property_type_overrides: Optional[PropertyTypeDict] = None,
+        on_ack: Optional[Callable[[Ack], None]] = None,
+        ack_id: Optional[int] = None,
+        properties_template: Optional[PropertiesTemplate] = None,
+        compression_algorithm: Optional[CompressionAlgorithmType] = None,
+        key: Optional[Hashable] = None,
+    ) -> bool:
+        """Post a message through one of the sessions unless its channel is full.
+
+        See `Session.try_post` for the meaning of each argument, and `post`
+        for how *key* chooses the session.  The message is not retried on
+        another session when the chosen session's channel is full.
+
+        Returns:
+            bool: whether the message was posted.
+        """
+        return self._session_for(key).try_post(
+            queue_uri,
+            message,
+            properties=properties,
+            property_type_overrides=property_type_overrides,
+            on_ack=on_ack,
+            ack_id=ack_id,
+            properties_template=properties_template,
+            compression_algorithm=compression_algorithm,
+        )
+
+    def post_many(
+        self,
+        queue_uri: str,
+        messages: Iterable[
+            Tuple[
+                PayloadType,
+                Optional[PropertyValueDict],
+                Union[Callable[[Ack], None], int, None],
+            ]
+        ],
+        property_type_overrides: Optional[PropertyTypeDict] = None,
+        properties_template: Optional[PropertiesTemplate] = None,
+        key: Optional[Hashable] = None,
+    ) -> None:
+        """Post several messages through one of the sessions of the pool.
+
+        The whole batch is posted through the same session, chosen as `post`
+        does, so its messages are received in order.  See `Session.post_many`
+        for the meaning of each argument.
+        """
+        self._session_for(key).post_many(
+            queue_uri,
+            messages,
+            property_type_overrides=property_type_overrides,
+            properties_template=properties_template,
+        )
+
+    def stats(self) -> Dict[str, Any]:
+        """Return a snapshot of the performance counters of the whole pool.
+
+        The snapshot has the same keys as the one returned by `Session.stats`,
+        and each counter and histogram bucket holds the sum of its values
+        across the sessions of the pool.  Use `sessions` to get the counters of
+        a single session.
+
+        Returns:
+            Dict[str, Any]: the current value of every counter.
+        """
+        total: Dict[str, Any] = {}
+        for session in self._sessions:
+            _merge_stats(total, session.stats())
+        return total
+
+    def stop(self) -> None:
+        """Stop every session of the pool.
+
+        Each session is stopped in turn, even if stopping a previous one
+        failed.  See `Session.stop`.
+        """
+        error: Optional[BaseException] = None
+        for session in self._sessions:
+            try:
+                session.stop()
+            except BaseException as exc:
+                if error is None:
+                    error = exc
+        if error is not None:
+            raise error
+
+    def __enter__(self) -> SessionPool:
+        return self
+
+    def __exit__(self, exc_type: Any, exc_value: Any, exc_traceback: Any) -> None:
+        self.stop()
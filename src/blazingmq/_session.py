@@ -15,14 +15,19 @@
 
 from __future__ import annotations
 
+import concurrent.futures
+from functools import partial
 from typing import Any
 from typing import Callable
 from typing import Dict
+from typing import Iterable
+from typing import List
 from typing import Optional
 from typing import Tuple
 from typing import Union
 
 from . import _six as six
+from ._enums import AckStatus
 from ._enums import CompressionAlgorithmType
 from ._enums import PropertyType
 from ._ext import DEFAULT_CONSUMER_PRIORITY
@@ -30,12 +35,19 @@ from ._ext import DEFAULT_MAX_UNCONFIRMED_BYTES
 from ._ext import DEFAULT_MAX_UNCONFIRMED_MESSAGES
 from ._ext import DEFAULT_SUSPENDS_ON_BAD_HOST_HEALTH
 from ._ext import PROPERTY_TYPES_FROM_PY_MAPPING
+from ._ext import Ack
+from ._ext import CompressionPolicy as ExtCompressionPolicy
+from ._ext import FlowControlPolicy as ExtFlowControlPolicy
+from ._ext import Message
+from ._ext import MessageHandle
+from ._ext import PropertiesTemplate as ExtPropertiesTemplate
+from ._ext import Queue as ExtQueue
 from ._ext import Session as ExtSession
-from ._messages import Ack
-from ._messages import Message
-from ._messages import MessageHandle
+from ._loopback import LoopbackBroker
 from ._monitors import BasicHealthMonitor
+from ._monitors import SystemHealthMonitor
 from ._timeouts import Timeouts
+from ._typing import PayloadType
 from ._typing import PropertyTypeDict
 from ._typing import PropertyValueDict
 from ._typing import PropertyValueType
@@ -48,12 +60,13 @@ class DefaultTimeoutType(float):
         return "..."
 
 
-def DefaultMonitor() -> Union[BasicHealthMonitor, None]:
+def DefaultMonitor() -> Union[BasicHealthMonitor, SystemHealthMonitor, None]:
     return None
 
 
 DEFAULT_TIMEOUT = DefaultTimeoutType()
-KNOWN_MONITORS = ("blazingmq.BasicHealthMonitor",)
+LOOPBACK_BROKER_URI = "loopback"
+KNOWN_MONITORS = ("blazingmq.BasicHealthMonitor", "blazingmq.SystemHealthMonitor")
 
 
 def _validate_timeouts(timeouts: Timeouts) -> Timeouts:
@@ -86,6 +99,18 @@ def _convert_timeout(timeout: Optional[float]) -> Optional[float]:
     raise ValueError(f"timeout must be greater than 0.0, was {timeout}")
 
 
+def _convert_post_timeout(block: bool, timeout: Optional[float]) -> Optional[float]:
+    """Convert the timeout of a blocking post for use by the Cython layer.
+
+    Raises:
+        `ValueError`: If *timeout* is provided without *block*, or is not
+            greater than 0.0.
+    """
+    if timeout is not None and not block:
+        raise ValueError("timeout can only be provided when block is True")
+    return _convert_timeout(timeout)
+
+
 def _convert_stats_dump_interval(interval: Optional[float]) -> Optional[float]:
     """Convert the stats dump interval for use by the Cython layer.
 
@@ -146,6 +171,90 @@ def _collect_properties_and_types(
     return merged
 
 
+class Subscription:
+    """A filter evaluated by the broker on the properties of each message.
+
+    A queue opened with subscriptions only receives the messages whose
+    properties match the *expression* of one of them, so the messages that
+    would be thrown away are never delivered, converted, or confirmed.  For
+    example, ``Subscription("firmId == 1234 && price > 25")`` selects the
+    messages whose *firmId* property is 1234 and whose *price* property is
+    greater than 25.  See the BlazingMQ documentation on subscriptions for the
+    syntax of expressions.
+
+    The other options apply to the messages matching this subscription, in
+    place of the options of the same name of the `QueueOptions`, and default
+    to those of the queue when `None`.
+
+    Args:
+        expression: the condition that the properties of a message must meet
+            for this subscription to receive it.
+        max_unconfirmed_messages: the maximum number of messages matching this
+            subscription that can be delivered without confirmation.
+        max_unconfirmed_bytes: the maximum number of bytes of the messages
+            matching this subscription that can be delivered without
+            confirmation.
+        consumer_priority: the precedence of this subscription compared to the
+            subscriptions of other consumers of the same queue.
+    """
+
+    def __init__(
+        self,
+        expression: str,
+        max_unconfirmed_messages: Optional[int] = None,
+        max_unconfirmed_bytes: Optional[int] = None,
+        consumer_priority: Optional[int] = None,
+    ) -> None:
+        self.expression = expression
+        self.max_unconfirmed_messages = max_unconfirmed_messages
+        self.max_unconfirmed_bytes = max_unconfirmed_bytes
+        self.consumer_priority = consumer_priority
+
+    def __eq__(self, other: object) -> bool:
+        if not isinstance(other, Subscription):
+            return False
+        return (
+            self.expression == other.expression
+            and self.max_unconfirmed_messages == other.max_unconfirmed_messages
+            and self.max_unconfirmed_bytes == other.max_unconfirmed_bytes
+            and self.consumer_priority == other.consumer_priority
+        )
+
+    def __ne__(self, other: object) -> bool:
+        return not self == other
+
+    def __repr__(self) -> str:
+        attrs = (
+            "max_unconfirmed_messages",
+            "max_unconfirmed_bytes",
+            "consumer_priority",
+        )
+
+        params = [repr(self.expression)]
+        for attr in attrs:
+            value = getattr(self, attr)
+            if value is not None:
+                params.append(f"{attr}={value!r}")
+
+        return f"Subscription({', '.join(params)})"
+
+
+def _convert_subscriptions(
+    subscriptions: Optional[List[Subscription]],
+) -> Optional[List[Tuple[bytes, Optional[int], Optional[int], Optional[int]]]]:
+    if subscriptions is None:
+        return None
+    return [
+        (
+            six.ensure_binary(subscription.expression),
+            subscription.consumer_priority,
+            subscription.max_unconfirmed_messages,
+            subscription.max_unconfirmed_bytes,
+        )
+        for subscription in subscriptions
+    ]
+
+
 class QueueOptions:
     """A value semantic type representing the settings for a queue.
 
@@ -182,6 +291,12 @@ class QueueOptions:
             with ``read=True`` will not receive messages and a queue opened
             with ``write=True`` will raise if you try to `.post` a message.
             By default, queues are not sensitive to the host's health.
+        subscriptions:
+            The `Subscription` filters selecting the messages that the broker
+            delivers to this queue.  Passing them to `.configure_queue`
+            replaces those of the queue, and an empty list removes them all, so
+            that every message is delivered again.  By default, every message
+            is delivered.
     """
 
     DEFAULT_MAX_UNCONFIRMED_MESSAGES = DEFAULT_MAX_UNCONFIRMED_MESSAGES
@@ -202,11 +317,13 @@ class QueueOptions:
         max_unconfirmed_bytes: Optional[int] = None,
         consumer_priority: Optional[int] = None,
         suspends_on_bad_host_health: Optional[bool] = None,
+        subscriptions: Optional[Iterable[Subscription]] = None,
     ) -> None:
         self.max_unconfirmed_messages = max_unconfirmed_messages
         self.max_unconfirmed_bytes = max_unconfirmed_bytes
         self.consumer_priority = consumer_priority
         self.suspends_on_bad_host_health = suspends_on_bad_host_health
+        self.subscriptions = None if subscriptions is None else list(subscriptions)
 
     def __eq__(self, other: object) -> bool:
         if not isinstance(other, QueueOptions):
@@ -216,6 +333,7 @@ class QueueOptions:
             and self.max_unconfirmed_bytes == other.max_unconfirmed_bytes
             and self.consumer_priority == other.consumer_priority
             and self.suspends_on_bad_host_health == other.suspends_on_bad_host_health
+            and self.subscriptions == other.subscriptions
         )
 
     def __ne__(self, other: object) -> bool:
@@ -227,6 +345,7 @@ class QueueOptions:
             "max_unconfirmed_bytes",
             "consumer_priority",
             "suspends_on_bad_host_health",
+            "subscriptions",
         )
 
         params = []
@@ -264,6 +383,8 @@ class SessionOptions:
             healthy, `.HostUnhealthy` and `.HostHealthRestored` events with
             never be emitted, and the *suspends_on_bad_host_health* option of
             `QueueOptions` cannot be used.
+            Pass a `.SystemHealthMonitor` to have the session see the machine
+            as unhealthy whenever it is overloaded.
         num_processing_threads:
             The number of threads for the SDK to use for processing events.
             This defaults to 1.
@@ -287,18 +408,46 @@ class SessionOptions:
             0, disable the recurring dump of stats (final stats are always
             dumped at the end of the session).  The default is 5min; the value
             must be a multiple of 30s, in the range ``[0s - 60min]``.
+        zero_copy_payloads:
+            Whether received messages should expose their payloads as
+            read-only views over the SDK's buffers instead of copying them
+            into `bytes`.  See `Message.data_buffers`.  The default is `False`.
+        pull_messages:
+            Whether received messages should be kept until retrieved in
+            batches by calling `Session.receive`, instead of being delivered
+            to an ``on_message`` callback.  The default is `False`.
+        num_dispatch_threads:
+            The number of native threads delivering received messages to the
+            ``on_message`` callback, in batches.  Each queue is assigned to one
+            of them, so the messages of a queue are still delivered in order.
+            By default, messages are delivered by the SDK's own processing
+            threads, one event at a time.  Ignored if *pull_messages* is set.
+        time_callbacks:
+            Whether to measure how long every callback invocation waits for the
+            GIL, spends converting its event, and runs, as histograms reported
+            by `Session.stats`.  The default is `False`.
+        slow_callback_threshold:
+            The number of seconds beyond which a callback invocation emits a
+            `.SlowCallback` event.  Setting it implies *time_callbacks*.
     """
 
     def __init__(
         self,
         message_compression_algorithm: Optional[CompressionAlgorithmType] = None,
         timeouts: Optional[Timeouts] = None,
-        host_health_monitor: Union[BasicHealthMonitor, None] = (DefaultMonitor()),
+        host_health_monitor: Union[
+            BasicHealthMonitor, SystemHealthMonitor, None
+        ] = DefaultMonitor(),
         num_processing_threads: Optional[int] = None,
         blob_buffer_size: Optional[int] = None,
         channel_high_watermark: Optional[int] = None,
         event_queue_watermarks: Optional[tuple[int, int]] = None,
         stats_dump_interval: Optional[float] = None,
+        zero_copy_payloads: Optional[bool] = None,
+        pull_messages: Optional[bool] = None,
+        num_dispatch_threads: Optional[int] = None,
+        time_callbacks: Optional[bool] = None,
+        slow_callback_threshold: Optional[float] = None,
     ) -> None:
         self.message_compression_algorithm = message_compression_algorithm
         self.timeouts = timeouts
@@ -308,6 +457,11 @@ class SessionOptions:
         self.channel_high_watermark = channel_high_watermark
         self.event_queue_watermarks = event_queue_watermarks
         self.stats_dump_interval = stats_dump_interval
+        self.zero_copy_payloads = zero_copy_payloads
+        self.pull_messages = pull_messages
+        self.num_dispatch_threads = num_dispatch_threads
+        self.time_callbacks = time_callbacks
+        self.slow_callback_threshold = slow_callback_threshold
 
     def __eq__(self, other: object) -> bool:
         if not isinstance(other, SessionOptions):
@@ -321,6 +475,11 @@ class SessionOptions:
             and self.channel_high_watermark == other.channel_high_watermark
             and self.event_queue_watermarks == other.event_queue_watermarks
             and self.stats_dump_interval == other.stats_dump_interval
+            and self.zero_copy_payloads == other.zero_copy_payloads
+            and self.pull_messages == other.pull_messages
+            and self.num_dispatch_threads == other.num_dispatch_threads
+            and self.time_callbacks == other.time_callbacks
+            and self.slow_callback_threshold == other.slow_callback_threshold
         )
 
     def __ne__(self, other: object) -> bool:
@@ -336,6 +495,11 @@ class SessionOptions:
             "channel_high_watermark",
             "event_queue_watermarks",
             "stats_dump_interval",
+            "zero_copy_payloads",
+            "pull_messages",
+            "num_dispatch_threads",
+            "time_callbacks",
+            "slow_callback_threshold",
         )
 
         params = []
@@ -347,6 +511,401 @@ class SessionOptions:
         return f"SessionOptions({', '.join(params)})"
 
 
+def _complete_future(
+    future: concurrent.futures.Future[Any],
+    convert: Callable[[Any], Any],
+    result: Any,
+    error: Optional[BaseException],
+) -> None:
+    if not future.set_running_or_notify_cancel():
+        return
+    if error is not None:
+        future.set_exception(error)
+    else:
+        future.set_result(convert(result))
+
+
+def _ignore_result(result: Any) -> None:
+    return None
+
+
+def _select_on_ack(
+    on_ack: Optional[Callable[[Ack], None]], ack_id: Optional[int]
+) -> Union[Callable[[Ack], None], int, None]:
+    if ack_id is None:
+        return on_ack
+    if on_ack is not None:
+        raise Error("on_ack and ack_id can't both be provided")
+    return ack_id
+
+
+class PropertiesTemplate:
+    """Message properties converted once, to be attached to many messages.
+
+    Posting with *properties* converts and validates every property of every
+    message.  A producer sending the same properties on each message can
+    instead build them into a template once, and pass it as the
+    *properties_template* of `Session.post`, `Session.post_many` or
+    `Queue.post`.  The properties passed alongside the template then only need
+    to hold the values that change between messages: each one replaces the
+    template's property of the same name, keeping its type unless
+    *property_type_overrides* says otherwise, and any other name is added to
+    the message as usual.
+
+    Args:
+        properties (`~blazingmq.PropertyValueDict`): the properties of every
+            message posted with this template.
+        property_type_overrides (Optional[`~blazingmq.PropertyTypeDict`]):
+            optionally provided type overrides for the properties.
+
+    Raises:
+        `~blazingmq.Error`: If a property value has an unsupported type.
+        `TypeError`: If a property value doesn't match its overridden type.
+    """
+
+    def __init__(
+        self,
+        properties: PropertyValueDict,
+        property_type_overrides: Optional[PropertyTypeDict] = None,
+    ) -> None:
+        merged = _collect_properties_and_types(properties, property_type_overrides)
+        types_by_code = {
+            code: property_type
+            for property_type, code in PROPERTY_TYPES_FROM_PY_MAPPING.items()
+        }
+        self._property_types: Dict[str, PropertyType] = {
+            name.decode("utf-8"): types_by_code[code]
+            for name, (_, code) in merged.items()
+        }
+        self._ext = ExtPropertiesTemplate(merged)
+
+    @property
+    def property_types(self) -> PropertyTypeDict:
+        """PropertyTypeDict: the type of each property of this template."""
+        return dict(self._property_types)
+
+    def _overrides_for(
+        self,
+        properties: PropertyValueDict,
+        property_type_overrides: Optional[PropertyTypeDict],
+    ) -> Dict[str, PropertyType]:
+        overrides = {
+            name: property_type
+            for name, property_type in self._property_types.items()
+            if name in properties
+        }
+        if property_type_overrides:
+            overrides.update(property_type_overrides)
+        return overrides
+
+    def __repr__(self) -> str:
+        return "<PropertiesTemplate {}>".format(sorted(self._property_types))
+
+
+class CompressionPolicy:
+    """How the messages posted to a queue are compressed.
+
+    By default, every message is compressed with the session's
+    *message_compression_algorithm*.  A policy passed as the
+    *compression_policy* of `Session.open_queue` replaces it for that queue:
+    payloads smaller than *min_payload_size* bytes are sent uncompressed, as
+    compressing them costs more than it saves, and the others are compressed
+    with *algorithm*.
+
+    With *adaptive* set, the compression ratio of a sample of the messages
+    posted to the queue is measured, and compression is turned off while it
+    doesn't pay, such as when the payloads are already compressed or
+    encrypted.  Messages keep being sampled so that compression is turned
+    back on if the payloads change.
+
+    The *compression_algorithm* argument of `Session.post` overrides the
+    policy for a single message.
+
+    Args:
+        algorithm (~blazingmq.CompressionAlgorithmType): the algorithm
+            compressing the payloads that are large enough.
+        min_payload_size: the size in bytes under which a payload is never
+            compressed.
+        adaptive: stop compressing the payloads of the queue while
+            compression doesn't reduce their size enough.
+
+    Raises:
+        `ValueError`: If *min_payload_size* is negative.
+    """
+
+    def __init__(
+        self,
+        algorithm: CompressionAlgorithmType = CompressionAlgorithmType.ZLIB,
+        min_payload_size: int = 0,
+        adaptive: bool = False,
+    ) -> None:
+        if min_payload_size < 0:
+            raise ValueError(
+                f"min_payload_size must be non-negative, was {min_payload_size}"
+            )
+        self.algorithm = algorithm
+        self.min_payload_size = min_payload_size
+        self.adaptive = adaptive
+        self._ext = ExtCompressionPolicy(algorithm, min_payload_size, adaptive)
+
+    def __eq__(self, other: object) -> bool:
+        if not isinstance(other, CompressionPolicy):
+            return False
+        return (
+            self.algorithm == other.algorithm
+            and self.min_payload_size == other.min_payload_size
+            and self.adaptive == other.adaptive
+        )
+
+    def __ne__(self, other: object) -> bool:
+        return not self == other
+
+    def __repr__(self) -> str:
+        return (
+            f"CompressionPolicy(algorithm={self.algorithm!r},"
+            f" min_payload_size={self.min_payload_size!r},"
+            f" adaptive={self.adaptive!r})"
+        )
+
+
+class AdaptiveFlowControl:
+    """Bounds within which the unconfirmed limits of a queue are tuned.
+
+    A policy passed as the *flow_control* of `Session.open_queue` makes the
+    session measure the rate at which the messages of that queue are
+    confirmed, and every *interval* seconds reconfigure its
+    *max_unconfirmed_messages* and *max_unconfirmed_bytes* so that the
+    broker delivers about *window* seconds worth of messages ahead of the
+    consumer.  A consumer that keeps up gets a larger window, so that it
+    doesn't starve between round-trips to the broker, while a slow one gets
+    a smaller window, leaving the other consumers of the queue the messages
+    it wouldn't get to in time.
+
+    The limits are kept between the bounds of the policy, and are only
+    changed when they would move by more than a few percent.  Failures to
+    reconfigure the queue are reported as an `.InterfaceError`.
+
+    Note:
+        The limits passed to `Session.configure_queue` for a queue with a
+        flow control policy only hold until the next adjustment.
+
+    Args:
+        min_unconfirmed_messages: the lowest *max_unconfirmed_messages* the
+            queue is configured with.
+        max_unconfirmed_messages: the highest *max_unconfirmed_messages* the
+            queue is configured with.
+        min_unconfirmed_bytes: the lowest *max_unconfirmed_bytes* the queue
+            is configured with.
+        max_unconfirmed_bytes: the highest *max_unconfirmed_bytes* the queue
+            is configured with.
+        window: the number of seconds worth of messages to keep delivered
+            ahead of the consumer.
+        interval: the number of seconds between two adjustments.
+
+    Raises:
+        `ValueError`: If a bound is not positive, if a lower bound exceeds
+            its upper bound, or if *window* or *interval* is not > 0.0.
+    """
+
+    def __init__(
+        self,
+        min_unconfirmed_messages: int = 100,
+        max_unconfirmed_messages: int = 100_000,
+        min_unconfirmed_bytes: int = 1024 * 1024,
+        max_unconfirmed_bytes: int = 1024 * 1024 * 1024,
+        window: float = 1.0,
+        interval: float = 1.0,
+    ) -> None:
+        for name, low, high in (
+            ("messages", min_unconfirmed_messages, max_unconfirmed_messages),
+            ("bytes", min_unconfirmed_bytes, max_unconfirmed_bytes),
+        ):
+            if low <= 0:
+                raise ValueError(f"min_unconfirmed_{name} must be positive, was {low}")
+            if low > high:
+                raise ValueError(
+                    f"min_unconfirmed_{name} ({low}) must not exceed"
+                    f" max_unconfirmed_{name} ({high})"
+                )
+        if window <= 0.0:
+            raise ValueError(f"window must be > 0.0, was {window}")
+        if interval <= 0.0:
+            raise ValueError(f"interval must be > 0.0, was {interval}")
+        self.min_unconfirmed_messages = min_unconfirmed_messages
+        self.max_unconfirmed_messages = max_unconfirmed_messages
+        self.min_unconfirmed_bytes = min_unconfirmed_bytes
+        self.max_unconfirmed_bytes = max_unconfirmed_bytes
+        self.window = window
+        self.interval = interval
+        self._ext = ExtFlowControlPolicy(
+            min_unconfirmed_messages,
+            max_unconfirmed_messages,
+            min_unconfirmed_bytes,
+            max_unconfirmed_bytes,
+            window,
+            interval,
+        )
+
+    def __eq__(self, other: object) -> bool:
+        if not isinstance(other, AdaptiveFlowControl):
+            return False
+        return (
+            self.min_unconfirmed_messages == other.min_unconfirmed_messages
+            and self.max_unconfirmed_messages == other.max_unconfirmed_messages
+            and self.min_unconfirmed_bytes == other.min_unconfirmed_bytes
+            and self.max_unconfirmed_bytes == other.max_unconfirmed_bytes
+            and self.window == other.window
+            and self.interval == other.interval
+        )
+
+    def __ne__(self, other: object) -> bool:
+        return not self == other
+
+    def __repr__(self) -> str:
+        return (
+            "AdaptiveFlowControl("
+            f"min_unconfirmed_messages={self.min_unconfirmed_messages!r},"
+            f" max_unconfirmed_messages={self.max_unconfirmed_messages!r},"
+            f" min_unconfirmed_bytes={self.min_unconfirmed_bytes!r},"
+            f" max_unconfirmed_bytes={self.max_unconfirmed_bytes!r},"
+            f" window={self.window!r},"
+            f" interval={self.interval!r})"
+        )
+
+
+def _collect_post_properties(
+    properties: Optional[PropertyValueDict],
+    property_type_overrides: Optional[PropertyTypeDict],
+    properties_template: Optional[PropertiesTemplate],
+) -> Tuple[
+    Optional[Dict[bytes, Tuple[Union[int, bytes], int]]],
+    Optional[ExtPropertiesTemplate],
+]:
+    if properties_template is None:
+        if not (properties or property_type_overrides):
+            return None, None
+        merged = _collect_properties_and_types(properties, property_type_overrides)
+        return merged, None
+
+    if not (properties or property_type_overrides):
+        return None, properties_template._ext
+    overrides = properties_template._overrides_for(
+        properties or {}, property_type_overrides
+    )
+    merged = _collect_properties_and_types(properties, overrides)
+    return merged, properties_template._ext
+
+
+def create_queue(ext_queue: ExtQueue) -> Queue:
+    inst = Queue.__new__(Queue)
+    assert isinstance(inst, Queue)
+    inst._set_attrs(ext_queue)
+    return inst
+
+
+class Queue:
+    """A handle to a queue opened by `Session.open_queue`.
+
+    The handle remembers the queue it was opened for, so posting and
+    confirming through it skips looking the queue up by its URI, which
+    `Session.post` and `Session.confirm` must do on every call.
+
+    Once the queue is closed with `Session.close_queue`, the handle is no
+    longer usable, even if the same URI is opened again.  Use the handle
+    returned by the new `Session.open_queue` call instead.
+    """
+
+    def post(
+        self,
+        message: PayloadType,
+        properties: Optional[PropertyValueDict] = None,
+        property_type_overrides: Optional[PropertyTypeDict] = None,
+        on_ack: Optional[Callable[[Ack], None]] = None,
+        ack_id: Optional[int] = None,
+        properties_template: Optional[PropertiesTemplate] = None,
+        compression_algorithm: Optional[CompressionAlgorithmType] = None,
+        block: bool = False,
+        timeout: Optional[float] = None,
+    ) -> None:
+        """Post a message to this queue.
+
+        See `Session.post` for more details.
+
+        Raises:
+            `~blazingmq.Error`: If the queue has been closed, or if the post
+                request was not successful.
+        """
+        props, ext_template = _collect_post_properties(
+            properties, property_type_overrides, properties_template
+        )
+        self._ext_queue.post(
+            message,
+            properties=props,
+            on_ack=_select_on_ack(on_ack, ack_id),
+            properties_template=ext_template,
+            compression_algorithm=compression_algorithm,
+            block=block,
+            timeout=_convert_post_timeout(block, timeout),
+        )
+
+    def try_post(
+        self,
+        message: PayloadType,
+        properties: Optional[PropertyValueDict] = None,
+        property_type_overrides: Optional[PropertyTypeDict] = None,
+        on_ack: Optional[Callable[[Ack], None]] = None,
+        ack_id: Optional[int] = None,
+        properties_template: Optional[PropertiesTemplate] = None,
+        compression_algorithm: Optional[CompressionAlgorithmType] = None,
+    ) -> bool:
+        """Post a message to this queue unless the channel is full.
+
+        See `Session.try_post` for more details.
+
+        Raises:
+            `~blazingmq.Error`: If the queue has been closed, or if the post
+                request was not successful for any other reason.
+        """
+        props, ext_template = _collect_post_properties(
+            properties, property_type_overrides, properties_template
+        )
+        return self._ext_queue.try_post(
+            message,
+            properties=props,
+            on_ack=_select_on_ack(on_ack, ack_id),
+            properties_template=ext_template,
+            compression_algorithm=compression_algorithm,
+        )
+
+    def confirm(self, message: Message) -> None:
+        """Confirm the specified message received from this queue.
+
+        See `Session.confirm` for more details.
+
+        Raises:
+            `~blazingmq.Error`: If the queue has been closed, if the message
+                was received from another queue, or if the confirm message
+                request was not successful.
+        """
+        self._ext_queue.confirm(message)
+
+    @property
+    def uri(self) -> str:
+        """str: URI of the queue this handle was opened for."""
+        return self._uri
+
+    def _set_attrs(self, ext_queue: ExtQueue) -> None:
+        """Teach mypy what our instance variables are despite our private __init__"""
+        self._ext_queue = ext_queue
+        self._uri = ext_queue.uri.decode("utf-8")
+
+    def __init__(self) -> None:
+        raise Error("The Queue class does not have a public constructor.")
+
+    def __repr__(self) -> str:
+        return "<Queue for {}>".format(self._uri)
+
+
 class Session:
     """Represents a connection with the BlazingMQ broker.
 
@@ -363,6 +922,8 @@ class Session:
         broker: TCP address of the broker (default: 'tcp://localhost:30114').
             If the environment variable ``BMQ_BROKER_URI`` is set, its value
             will override whatever broker address is passed via this argument.
+            Pass a `.LoopbackBroker` to have the session simulate the broker
+            instead of connecting to one.
         message_compression_algorithm: the type of compression to apply to messages
             being posted via this session object.
         timeout: maximum number of seconds to wait for requests on this
@@ -378,6 +939,8 @@ class Session:
             `.HostHealthRestored` events will never be emitted, and the
             *suspends_on_bad_host_health* option of `QueueOptions` cannot be
             used.
+            Pass a `.SystemHealthMonitor` to have the session see the machine
+            as unhealthy whenever it is overloaded.
         num_processing_threads: The number of threads for the SDK to use for
             processing events.  This defaults to 1.
         blob_buffer_size: The size (in bytes) of the blob buffers to use.  This
@@ -398,42 +961,105 @@ class Session:
             stats are always dumped at the end of the session).  The default is
             5min; the value must be a multiple of 30s, in the range
             ``[0s - 60min]``.
+        zero_copy_payloads: Whether received messages should expose their
+            payloads as read-only views over the SDK's buffers instead of
+            copying them into `bytes`.  See `Message.data_buffers`.
+        pull_messages: Whether received messages should be kept until
+            retrieved in batches by calling `receive`, instead of being
+            delivered to *on_message*, which must then be `None`.
+        on_acks: an optional callback receiving the acknowledgments of
+            messages posted with an *ack_id*.  It is invoked once per batch of
+            acknowledgments received from the broker, with a list of ack ids
+            and a list of the matching `AckStatus` values.
+        num_dispatch_threads: The number of native threads delivering received
+            messages to *on_message*, in batches.  Each queue is assigned to
+            one of them, so the messages of a queue are still delivered in
+            order, but *on_message* may be invoked for different queues at the
+            same time.  When the session is stopped, the messages already
+            handed to these threads are delivered first, while they can still
+            be confirmed.  By default, messages are delivered by the SDK's
+            processing threads, so these threads wait for the GIL whenever
+            *on_message* is slow.
+        time_callbacks: Whether to measure how long every callback invocation
+            waits for the GIL, spends converting the event it receives, and
+            runs.  The measurements are reported by `stats` as histograms.
+        slow_callback_threshold: The number of seconds beyond which a callback
+            invocation is reported with a `.SlowCallback` event, passed to
+            *on_session_event* once it returns.  Setting it implies
+            *time_callbacks*.
 
     Raises:
         `~blazingmq.Error`: If the session start request was not successful.
         `~blazingmq.exceptions.BrokerTimeoutError`: If the broker didn't respond
             to the request within a reasonable amount of time.
-        `ValueError`: If any of the timeouts are provided and not > 0.0, or if
-            the ``stats_dump_interval`` is provided and is < 0.0.
+        `ValueError`: If any of the timeouts are provided and not > 0.0, if
+            the ``stats_dump_interval`` is provided and is < 0.0, if
+            ``num_dispatch_threads`` is provided and is not > 0, or if
+            ``slow_callback_threshold`` is provided and is not > 0.0.
     """
 
     def __init__(
         self,
         on_session_event: Callable[[SessionEvent], None],
         on_message: Optional[Callable[[Message, MessageHandle], None]] = None,
-        broker: str = "tcp://localhost:30114",
+        broker: Union[str, LoopbackBroker] = "tcp://localhost:30114",
         message_compression_algorithm: CompressionAlgorithmType = (
             CompressionAlgorithmType.NONE
         ),
         timeout: Union[Timeouts, float] = DEFAULT_TIMEOUT,
-        host_health_monitor: Union[BasicHealthMonitor, None] = (DefaultMonitor()),
+        host_health_monitor: Union[
+            BasicHealthMonitor, SystemHealthMonitor, None
+        ] = DefaultMonitor(),
         num_processing_threads: Optional[int] = None,
         blob_buffer_size: Optional[int] = None,
         channel_high_watermark: Optional[int] = None,
         event_queue_watermarks: Optional[tuple[int, int]] = None,
         stats_dump_interval: Optional[float] = None,
+        zero_copy_payloads: bool = False,
+        pull_messages: bool = False,
+        on_acks: Optional[Callable[[List[int], List[AckStatus]], None]] = None,
+        num_dispatch_threads: Optional[int] = None,
+        time_callbacks: bool = False,
+        slow_callback_threshold: Optional[float] = None,
     ) -> None:
+        if pull_messages and on_message is not None:
+            raise Error("on_message can't be provided when pull_messages is set")
+
+        if num_dispatch_threads is not None and num_dispatch_threads <= 0:
+            raise ValueError(
+                f"num_dispatch_threads must be > 0, was {num_dispatch_threads}"
+            )
+
+        if slow_callback_threshold is not None and not slow_callback_threshold > 0.0:
+            raise ValueError(
+                "slow_callback_threshold must be > 0.0, "
+                f"was {slow_callback_threshold}"
+            )
+
         if host_health_monitor is not None:
-            if not isinstance(host_health_monitor, BasicHealthMonitor):
+            if not isinstance(
+                host_health_monitor, (BasicHealthMonitor, SystemHealthMonitor)
+            ):
                 raise TypeError(
                     f"host_health_monitor must be None or an instance of "
                     f"{' or '.join(KNOWN_MONITORS)}"
                 )
 
         monitor_host_health = host_health_monitor is not None
-        fake_host_health_monitor = getattr(host_health_monitor, "_monitor", None)
+        fake_host_health_monitor = None
+        system_host_health_monitor = None
+        if isinstance(host_health_monitor, BasicHealthMonitor):
+            fake_host_health_monitor = host_health_monitor._monitor
+        elif isinstance(host_health_monitor, SystemHealthMonitor):
+            system_host_health_monitor = host_health_monitor._monitor
+
+        loopback = None
+        if isinstance(broker, LoopbackBroker):
+            loopback = broker._options
+            broker = LOOPBACK_BROKER_URI
 
         self._has_no_on_message = on_message is None
+        self._pull_messages = pull_messages
 
         # Using our Timeouts class, preserve the old behavior of passing in a
         # simple float as a timeout.  Avoid setting the `connect_timeout` and
@@ -448,6 +1074,7 @@ class Session:
         self._ext = ExtSession(
             on_session_event,
             on_message=on_message,
+            on_acks=on_acks,
             broker=six.ensure_binary(broker),
             message_compression_algorithm=message_compression_algorithm,
             num_processing_threads=num_processing_threads,
@@ -458,6 +1085,13 @@ class Session:
             timeouts=_validate_timeouts(timeout),
             monitor_host_health=monitor_host_health,
             fake_host_health_monitor=fake_host_health_monitor,
+            system_host_health_monitor=system_host_health_monitor,
+            zero_copy_payloads=zero_copy_payloads,
+            pull_messages=pull_messages,
+            num_dispatch_threads=num_dispatch_threads or 0,
+            time_callbacks=time_callbacks or slow_callback_threshold is not None,
+            slow_callback_threshold=slow_callback_threshold,
+            loopback=loopback,
         )
 
     @classmethod
@@ -465,8 +1099,9 @@ class Session:
         cls,
         on_session_event: Callable[[SessionEvent], None],
         on_message: Optional[Callable[[Message, MessageHandle], None]] = None,
-        broker: str = "tcp://localhost:30114",
+        broker: Union[str, LoopbackBroker] = "tcp://localhost:30114",
         session_options: SessionOptions = (SessionOptions()),
+        on_acks: Optional[Callable[[List[int], List[AckStatus]], None]] = None,
     ) -> Session:
         """Construct a *Session* instance using `.SessionOptions`.
 
@@ -482,8 +1117,11 @@ class Session:
             broker: TCP address of the broker (default: 'tcp://localhost:30114').
                 If the environment variable ``BMQ_BROKER_URI`` is set, its value
                 will override whatever broker address is passed via this argument.
+                Pass a `.LoopbackBroker` to have the session simulate the broker.
             session_options: an instance of `.SessionOptions` that represents the
                 session's configuration.
+            on_acks: an optional callback receiving batches of acknowledgments
+                for messages posted with an *ack_id*.
 
         Raises:
             `~blazingmq.Error`: If the session start request was not successful.
@@ -509,6 +1147,12 @@ class Session:
                 session_options.channel_high_watermark,
                 session_options.event_queue_watermarks,
                 session_options.stats_dump_interval,
+                bool(session_options.zero_copy_payloads),
+                bool(session_options.pull_messages),
+                on_acks,
+                session_options.num_dispatch_threads,
+                bool(session_options.time_callbacks),
+                session_options.slow_callback_threshold,
             )
         else:
             return cls(
@@ -523,6 +1167,12 @@ class Session:
                 session_options.channel_high_watermark,
                 session_options.event_queue_watermarks,
                 session_options.stats_dump_interval,
+                bool(session_options.zero_copy_payloads),
+                bool(session_options.pull_messages),
+                on_acks,
+                session_options.num_dispatch_threads,
+                bool(session_options.time_callbacks),
+                session_options.slow_callback_threshold,
             )
 
     def open_queue(
@@ -532,11 +1182,19 @@ class Session:
         write: bool = False,
         options: QueueOptions = QueueOptions(),
         timeout: float = DEFAULT_TIMEOUT,
-    ) -> None:
+        lazy_properties: bool = False,
+        property_projection: Optional[Iterable[str]] = None,
+        compression_policy: Optional[CompressionPolicy] = None,
+        payload_decoder: Optional[Any] = None,
+        flow_control: Optional[AdaptiveFlowControl] = None,
+    ) -> Queue:
         """Open a queue with the specified parameters
 
         Open a queue at the specified *queue_uri*. The *queue_uri* is the
         identifier for any future interactions with this opened queue.
+        Alternatively, the returned `Queue` handle can be used to post to and
+        confirm messages from this queue without repeating the lookup of
+        *queue_uri* each time.
 
         Note:
             Invoking this method from the ``on_message`` or
@@ -560,36 +1218,235 @@ class Session:
                 If not provided, the *timeout* provided to the `Session` when
                 it was created it used.  If that was not provided either,
                 a reasonable default is used.
+            lazy_properties: decode the properties of each `Message` received
+                on this queue only when they are accessed, rather than all of
+                them as soon as the message is received.
+            property_projection: the names of the only properties of each
+                `Message` received on this queue that should ever be decoded.
+                Other properties are left out of `Message.properties`.
+            compression_policy (Optional[`CompressionPolicy`]): how the
+                messages posted to this queue are compressed.  By default,
+                they are all compressed with the session's
+                *message_compression_algorithm*.
+            payload_decoder: a `PyCapsule` exported by another extension
+                module, holding a native decoder run on the payload of every
+                `Message` received on this queue before the GIL is acquired
+                to deliver it, as described in :ref:`payload-decoders-label`.
+                The messages it rejects are confirmed and reported as an
+                `.InterfaceError` instead of being delivered.
+            flow_control (Optional[`AdaptiveFlowControl`]): bounds within
+                which the *max_unconfirmed_messages* and
+                *max_unconfirmed_bytes* of this queue are tuned to the rate at
+                which its messages are confirmed.  The limits of *options* are
+                clamped to these bounds.
+
+        Returns:
+            Queue: a handle to the opened queue.
 
         Raises:
             `~blazingmq.Error`: If the open queue request was not successful.
             `~blazingmq.exceptions.BrokerTimeoutError`: If the broker didn't
                 respond to the request within a reasonable amount of time.
-            `ValueError`: If *timeout* is not > 0.0.
+            `ValueError`: If *timeout* is not > 0.0, or if *payload_decoder*
+                holds a decoder of an unsupported version.
+        """
+        args = self._open_queue_args(
+            queue_uri,
+            read,
+            write,
+            options,
+            timeout,
+            lazy_properties,
+            property_projection,
+            compression_policy,
+            payload_decoder,
+            flow_control,
+        )
+        ext_queue = self._ext.open_queue_sync(six.ensure_binary(queue_uri), **args)
+        return create_queue(ext_queue)
+
+    def open_queue_async(
+        self,
+        queue_uri: str,
+        read: bool = False,
+        write: bool = False,
+        options: QueueOptions = QueueOptions(),
+        timeout: float = DEFAULT_TIMEOUT,
+        lazy_properties: bool = False,
+        property_projection: Optional[Iterable[str]] = None,
+        compression_policy: Optional[CompressionPolicy] = None,
+        payload_decoder: Optional[Any] = None,
+        flow_control: Optional[AdaptiveFlowControl] = None,
+    ) -> concurrent.futures.Future[Queue]:
+        """Start opening a queue, without waiting for the broker to respond.
+
+        This takes the same arguments as `open_queue`, but returns as soon as
+        the request has been sent.  Many queues can be opened concurrently
+        this way, in the time it takes to open a single one with
+        `open_queue`.  To wait for the queue from a coroutine, use
+        `asyncio.wrap_future` on the returned future.
+
+        Note:
+            The returned future is completed on a thread owned by the
+            `Session`, which is also the thread that invokes any callbacks
+            added to it.  Those callbacks are subject to the same restrictions
+            as the ``on_message`` and ``on_session_event`` callbacks of the
+            `Session`.
+
+        Returns:
+            concurrent.futures.Future[Queue]: a future that will hold the
+            `Queue` handle once the queue is opened, or the
+            `~blazingmq.Error` or `~blazingmq.exceptions.BrokerTimeoutError`
+            that `open_queue` would have raised otherwise.
+
+        Raises:
+            `~blazingmq.Error`: If the open queue request could not be sent.
+            `ValueError`: If *timeout* is not > 0.0, or if *payload_decoder*
+                holds a decoder of an unsupported version.
+        """
+        args = self._open_queue_args(
+            queue_uri,
+            read,
+            write,
+            options,
+            timeout,
+            lazy_properties,
+            property_projection,
+            compression_policy,
+            payload_decoder,
+            flow_control,
+        )
+        future: concurrent.futures.Future[Queue] = concurrent.futures.Future()
+        self._ext.open_queue_async(
+            six.ensure_binary(queue_uri),
+            on_complete=partial(_complete_future, future, create_queue),
+            **args,
+        )
+        return future
+
+    def open_queues(
+        self,
+        queue_uris: Iterable[str],
+        read: bool = False,
+        write: bool = False,
+        options: QueueOptions = QueueOptions(),
+        timeout: float = DEFAULT_TIMEOUT,
+        lazy_properties: bool = False,
+        property_projection: Optional[Iterable[str]] = None,
+        compression_policy: Optional[CompressionPolicy] = None,
+        payload_decoder: Optional[Any] = None,
+        flow_control: Optional[AdaptiveFlowControl] = None,
+        max_in_flight: int = 64,
+    ) -> List[Union[Queue, Error]]:
+        """Open many queues with the same parameters at once.
+
+        The request to open each queue of *queue_uris* is sent without waiting
+        for the broker to respond to the previous ones, keeping at most
+        *max_in_flight* requests outstanding, and this waits for all of them
+        with the GIL released.  Opening hundreds of queues this way takes
+        about as long as a few calls to `open_queue`, instead of one
+        round-trip to the broker per queue.
+
+        Each queue is opened as `open_queue` would open it with the other
+        arguments.  A queue failing to open doesn't prevent the others from
+        being opened.
+
+        Note:
+            Invoking this method from the ``on_message`` or
+            ``on_session_event`` of the `Session` or the ``on_ack`` callback of
+            a posted message will cause a deadlock.
+
+        Args:
+            queue_uris: the URIs of the queues to open.
+            max_in_flight: the maximum number of queues being opened at any
+                time.
+
+        Returns:
+            List[Union[Queue, ~blazingmq.Error]]: for each URI of
+            *queue_uris*, in the same order, a handle to the opened queue, or
+            the `~blazingmq.Error` or `~blazingmq.exceptions.BrokerTimeoutError`
+            that `open_queue` would have raised for it.
+
+        Raises:
+            `~blazingmq.Error`: If no queue could be opened because the session
+                was stopped or the arguments are invalid.
+            `ValueError`: If *timeout* is not > 0.0, if *max_in_flight* is not
+                > 0, or if *payload_decoder* holds a decoder of an unsupported
+                version.
         """
-        if read and self._has_no_on_message:
+        if max_in_flight <= 0:
+            raise ValueError(f"max_in_flight must be > 0, was {max_in_flight}")
+        uris = [six.ensure_binary(uri) for uri in queue_uris]
+        if not uris:
+            return []
+        args = self._open_queue_args(
+            uris[0].decode(),
+            read,
+            write,
+            options,
+            timeout,
+            lazy_properties,
+            property_projection,
+            compression_policy,
+            payload_decoder,
+            flow_control,
+        )
+        results = self._ext.open_queues(uris, max_in_flight=max_in_flight, **args)
+        return [
+            result if isinstance(result, Error) else create_queue(result)
+            for result in results
+        ]
+
+    def _open_queue_args(
+        self,
+        queue_uri: str,
+        read: bool,
+        write: bool,
+        options: QueueOptions,
+        timeout: float,
+        lazy_properties: bool,
+        property_projection: Optional[Iterable[str]],
+        compression_policy: Optional[CompressionPolicy],
+        payload_decoder: Optional[Any],
+        flow_control: Optional[AdaptiveFlowControl],
+    ) -> Dict[str, Any]:
+        if read and self._has_no_on_message and not self._pull_messages:
             raise Error(
                 "Can't open queue {} in read mode: no on_message "
                 "callback was provided at Session construction".format(queue_uri)
             )
 
-        if options.suspends_on_bad_host_health and not self._ext.monitor_host_health:
-            raise Error(
-                "Queues cannot use suspends_on_bad_host_health if host health"
-                " monitoring was disabled when the Session was created"
-            )
+        self._check_queue_options(options)
 
-        self._ext.open_queue_sync(
-            six.ensure_binary(queue_uri),
+        return dict(
             read=read,
             write=write,
             consumer_priority=options.consumer_priority,
             max_unconfirmed_messages=options.max_unconfirmed_messages,
             max_unconfirmed_bytes=options.max_unconfirmed_bytes,
             suspends_on_bad_host_health=options.suspends_on_bad_host_health,
+            subscriptions=_convert_subscriptions(options.subscriptions),
             timeout=_convert_timeout(timeout),
+            lazy_properties=lazy_properties,
+            property_projection=(
+                None
+                if property_projection is None
+                else [six.ensure_binary(name) for name in property_projection]
+            ),
+            compression_policy=(
+                None if compression_policy is None else compression_policy._ext
+            ),
+            payload_decoder=payload_decoder,
+            flow_control=None if flow_control is None else flow_control._ext,
         )
 
+    def _check_queue_options(self, options: QueueOptions) -> None:
+        if options.suspends_on_bad_host_health and not self._ext.monitor_host_health:
+            raise Error(
+                "Queues cannot use suspends_on_bad_host_health if host health"
+                " monitoring was disabled when the Session was created"
+            )
+
     def close_queue(self, queue_uri: str, timeout: float = DEFAULT_TIMEOUT) -> None:
         """Close an opened queue at the specified *queue_uri*.
 
@@ -620,6 +1477,33 @@ class Session:
             timeout=_convert_timeout(timeout),
         )
 
+    def close_queue_async(
+        self, queue_uri: str, timeout: float = DEFAULT_TIMEOUT
+    ) -> concurrent.futures.Future[None]:
+        """Start closing a queue, without waiting for the broker to respond.
+
+        This takes the same arguments as `close_queue`, but returns a future
+        instead of blocking until the queue is closed.  See `open_queue_async`
+        for how the future is completed.
+
+        Returns:
+            concurrent.futures.Future[None]: a future that will hold `None` once
+            the queue is closed, or the `~blazingmq.Error` or
+            `~blazingmq.exceptions.BrokerTimeoutError` that `close_queue` would
+            have raised otherwise.
+
+        Raises:
+            `~blazingmq.Error`: If the close queue request could not be sent.
+            `ValueError`: If *timeout* is not > 0.0.
+        """
+        future: concurrent.futures.Future[None] = concurrent.futures.Future()
+        self._ext.close_queue_async(
+            six.ensure_binary(queue_uri),
+            timeout=_convert_timeout(timeout),
+            on_complete=partial(_complete_future, future, _ignore_result),
+        )
+        return future
+
     def configure_queue(
         self,
         queue_uri: str,
@@ -651,11 +1535,7 @@ class Session:
                 respond to the request within a reasonable amount of time.
             `ValueError`: If *timeout* is not > 0.0.
         """
-        if options.suspends_on_bad_host_health and not self._ext.monitor_host_health:
-            raise Error(
-                "Queues cannot use suspends_on_bad_host_health if host health"
-                " monitoring was disabled when the Session was created"
-            )
+        self._check_queue_options(options)
 
         self._ext.configure_queue_sync(
             six.ensure_binary(queue_uri),
@@ -663,8 +1543,46 @@ class Session:
             max_unconfirmed_messages=options.max_unconfirmed_messages,
             max_unconfirmed_bytes=options.max_unconfirmed_bytes,
             suspends_on_bad_host_health=options.suspends_on_bad_host_health,
+            subscriptions=_convert_subscriptions(options.subscriptions),
+            timeout=_convert_timeout(timeout),
+        )
+
+    def configure_queue_async(
+        self,
+        queue_uri: str,
+        options: QueueOptions,
+        timeout: float = DEFAULT_TIMEOUT,
+    ) -> concurrent.futures.Future[None]:
+        """Start modifying the options of a queue, without waiting for the broker.
+
+        This takes the same arguments as `configure_queue`, but returns a future
+        instead of blocking until the queue is configured.  See
+        `open_queue_async` for how the future is completed.
+
+        Returns:
+            concurrent.futures.Future[None]: a future that will hold `None` once
+            the queue is configured, or the `~blazingmq.Error` or
+            `~blazingmq.exceptions.BrokerTimeoutError` that `configure_queue`
+            would have raised otherwise.
+
+        Raises:
+            `~blazingmq.Error`: If the configure queue request could not be sent.
+            `ValueError`: If *timeout* is not > 0.0.
+        """
+        self._check_queue_options(options)
+
+        future: concurrent.futures.Future[None] = concurrent.futures.Future()
+        self._ext.configure_queue_async(
+            six.ensure_binary(queue_uri),
+            consumer_priority=options.consumer_priority,
+            max_unconfirmed_messages=options.max_unconfirmed_messages,
+            max_unconfirmed_bytes=options.max_unconfirmed_bytes,
+            suspends_on_bad_host_health=options.suspends_on_bad_host_health,
+            subscriptions=_convert_subscriptions(options.subscriptions),
             timeout=_convert_timeout(timeout),
+            on_complete=partial(_complete_future, future, _ignore_result),
         )
+        return future
 
     def get_queue_options(self, queue_uri: str) -> QueueOptions:
         """Get configured options of an opened queue.
@@ -690,8 +1608,24 @@ class Session:
             a write-only queue won't be reflected in the `QueueOptions`
             returned by a later call to *get_queue_options*.
         """
-        options = self._ext.get_queue_options(six.ensure_binary(queue_uri))
-        return QueueOptions(*options)
+        (
+            max_unconfirmed_messages,
+            max_unconfirmed_bytes,
+            consumer_priority,
+            suspends_on_bad_host_health,
+            subscriptions,
+        ) = self._ext.get_queue_options(six.ensure_binary(queue_uri))
+        return QueueOptions(
+            max_unconfirmed_messages,
+            max_unconfirmed_bytes,
+            consumer_priority,
+            suspends_on_bad_host_health,
+            [
+                Subscription(expression.decode(), max_messages, max_bytes, priority)
+                for expression, priority, max_messages, max_bytes in subscriptions
+            ]
+            or None,
+        )
 
     def stop(self) -> None:
         """Teardown the broker connection
@@ -711,10 +1645,15 @@ class Session:
     def post(
         self,
         queue_uri: str,
-        message: bytes,
+        message: PayloadType,
         properties: Optional[PropertyValueDict] = None,
         property_type_overrides: Optional[PropertyTypeDict] = None,
         on_ack: Optional[Callable[[Ack], None]] = None,
+        ack_id: Optional[int] = None,
+        properties_template: Optional[PropertiesTemplate] = None,
+        compression_algorithm: Optional[CompressionAlgorithmType] = None,
+        block: bool = False,
+        timeout: Optional[float] = None,
     ) -> None:
         """Post a message to an opened queue specified by *queue_uri*.
 
@@ -724,7 +1663,11 @@ class Session:
 
         Args:
             queue_uri: unique resource identifier for the queue to posted to.
-            message: the payload of the message.
+            message (`~blazingmq.PayloadType`): the payload of the message.
+                Besides `bytes`, any object exporting a contiguous buffer,
+                such as a `bytearray`, a `memoryview` or a numpy array, is
+                posted without first being copied into `bytes`.  The buffer
+                is only used until `post` returns.
             properties (Optional[`~blazingmq.PropertyValueDict`]): optionally
                 provided properties to be associated with the message.
             property_type_overrides (Optional[`~blazingmq.PropertyTypeDict`]):
@@ -732,19 +1675,154 @@ class Session:
             on_ack (Optional[Callable[[~blazingmq.Ack], None]]): optionally
                 specified callback which is invoked with the acknowledgment
                 status of the message being posted.
+            ack_id (Optional[int]): optionally specified non-negative integer
+                identifying the message in the batches passed to the
+                session's *on_acks* callback.  Tracking acknowledgments by
+                ack id avoids creating an `Ack` object per message, and can't
+                be combined with *on_ack*.
+            properties_template (Optional[`PropertiesTemplate`]): optionally
+                provided properties converted ahead of time, which
+                *properties* then only needs to override or extend.
+            compression_algorithm (Optional[~blazingmq.CompressionAlgorithmType]):
+                optionally provided algorithm compressing this message,
+                regardless of the *compression_policy* of the queue and of
+                the session's *message_compression_algorithm*.
+            block (bool): if the session's channel to the broker has reached
+                its *channel_high_watermark*, wait for it to drain and post
+                the message then, instead of raising.  The GIL is released
+                while waiting.
+            timeout (Optional[float]): maximum number of seconds to wait when
+                *block* is set.  By default, wait for as long as it takes.
 
         Raises:
-            `~blazingmq.Error`: If the post request was not successful.
+            `~blazingmq.Error`: If the post request was not successful, or if
+                both *on_ack* and *ack_id* are provided.
+            `ValueError`: If *ack_id* is negative, or if *timeout* is provided
+                without *block* or is not greater than 0.0.
         """
-        props: Optional[Dict[bytes, Tuple[Union[int, bytes], int]]] = None
-        if properties or property_type_overrides:
-            props = _collect_properties_and_types(properties, property_type_overrides)
-
+        props, ext_template = _collect_post_properties(
+            properties, property_type_overrides, properties_template
+        )
         self._ext.post(
             six.ensure_binary(queue_uri),
             message,
             properties=props,
-            on_ack=on_ack,
+            on_ack=_select_on_ack(on_ack, ack_id),
+            properties_template=ext_template,
+            compression_algorithm=compression_algorithm,
+            block=block,
+            timeout=_convert_post_timeout(block, timeout),
+        )
+
+    def try_post(
+        self,
+        queue_uri: str,
+        message: PayloadType,
+        properties: Optional[PropertyValueDict] = None,
+        property_type_overrides: Optional[PropertyTypeDict] = None,
+        on_ack: Optional[Callable[[Ack], None]] = None,
+        ack_id: Optional[int] = None,
+        properties_template: Optional[PropertiesTemplate] = None,
+        compression_algorithm: Optional[CompressionAlgorithmType] = None,
+    ) -> bool:
+        """Post a message to an opened queue unless the channel is full.
+
+        Behave like `post`, except that if the session's channel to the
+        broker has reached its *channel_high_watermark*, the message is
+        dropped and `False` is returned instead of raising.  Its *on_ack*
+        callback is then never invoked.
+
+        Returns:
+            bool: whether the message was posted.
+
+        Raises:
+            `~blazingmq.Error`: If the post request was not successful for any
+                other reason, or if both *on_ack* and *ack_id* are provided.
+            `ValueError`: If *ack_id* is negative.
+        """
+        props, ext_template = _collect_post_properties(
+            properties, property_type_overrides, properties_template
+        )
+        return self._ext.try_post(
+            six.ensure_binary(queue_uri),
+            message,
+            properties=props,
+            on_ack=_select_on_ack(on_ack, ack_id),
+            properties_template=ext_template,
+            compression_algorithm=compression_algorithm,
+        )
+
+    def post_many(
+        self,
+        queue_uri: str,
+        messages: Iterable[
+            Tuple[
+                PayloadType,
+                Optional[PropertyValueDict],
+                Union[Callable[[Ack], None], int, None],
+            ]
+        ],
+        property_type_overrides: Optional[PropertyTypeDict] = None,
+        properties_template: Optional[PropertiesTemplate] = None,
+    ) -> None:
+        """Post several messages to an opened queue specified by *queue_uri*.
+
+        Each entry of *messages* is a ``(message, properties, on_ack)`` tuple
+        holding the same values that would be passed to `post`.  The messages
+        are packed into as few events as possible and posted without
+        reacquiring the GIL between them, which is considerably cheaper than
+        calling `post` once per message.
+
+        If posting fails part way through the batch, the messages before the
+        failing one have already been posted and their *on_ack* callbacks will
+        still be invoked.
+
+        Args:
+            queue_uri: unique resource identifier for the queue to posted to.
+            messages: the ``(message, properties, on_ack)`` tuples to post, in
+                order.  *properties* and *on_ack* may be `None`, and *on_ack*
+                may also be an integer ack id, as would be passed to `post`
+                as *ack_id*.
+            property_type_overrides (Optional[`~blazingmq.PropertyTypeDict`]):
+                optionally provided type overrides, applied to the matching
+                properties of every message in the batch.
+            properties_template (Optional[`PropertiesTemplate`]): optionally
+                provided properties carried by every message in the batch,
+                overridden or extended by each message's *properties*.
+
+        Raises:
+            `~blazingmq.Error`: If the post request was not successful.
+        """
+        ext_messages: List[
+            Tuple[
+                PayloadType,
+                Optional[Dict[bytes, Tuple[Union[int, bytes], int]]],
+                Union[Callable[[Ack], None], int, None],
+            ]
+        ] = []
+        for message, properties, on_ack in messages:
+            props: Optional[Dict[bytes, Tuple[Union[int, bytes], int]]] = None
+            if properties:
+                overrides = property_type_overrides
+                if overrides:
+                    overrides = {
+                        name: override_type
+                        for name, override_type in overrides.items()
+                        if name in properties
+                    }
+                if properties_template is not None:
+                    overrides = properties_template._overrides_for(
+                        properties, overrides
+                    )
+                props = _collect_properties_and_types(properties, overrides)
+            ext_messages.append((message, props, on_ack))
+
+        self._ext.post_many(
+            six.ensure_binary(queue_uri),
+            ext_messages,
+            properties_template=(
+                None if properties_template is None else properties_template._ext
+            ),
         )
 
     def confirm(self, message: Message) -> None:
@@ -768,6 +1846,106 @@ class Session:
         """
         self._ext.confirm(message)
 
+    def confirm_many(self, messages: Iterable[Message]) -> None:
+        """Confirm each of the specified messages.
+
+        This has the same effect as calling `confirm` for each message, but
+        the confirmations are packed into as few events as possible and sent
+        without reacquiring the GIL between them.
+
+        If confirming fails part way through the batch, the messages before
+        the failing one have already been confirmed.
+
+        Args:
+            messages (Iterable[~blazingmq.Message]): messages to be confirmed.
+
+        Raises:
+            `~blazingmq.Error`: If the confirm message request was not
+                successful.
+        """
+        self._ext.confirm_many(messages)
+
+    def receive(
+        self, max_messages: int = 1, timeout: Optional[float] = None
+    ) -> List[Message]:
+        """Retrieve up to *max_messages* of the messages received so far.
+
+        This can only be used on a session created with *pull_messages* set.
+        If no message has been received yet, wait for at most *timeout*
+        seconds for one to arrive, or indefinitely if *timeout* is `None`.
+        Every message returned is converted in a single pass, releasing the
+        GIL only while waiting, and must be confirmed with `confirm` or
+        `confirm_many` once processed.
+
+        Messages are kept until they are retrieved, up to 65536 of them.
+        Beyond that, the session stops reading from the broker until enough of
+        them are retrieved, so a consumer that calls `receive` less often than
+        messages arrive exerts backpressure instead of growing without bound.
+        The unconfirmed limits of the queues (*max_unconfirmed_messages* and
+        *max_unconfirmed_bytes* in `QueueOptions`) bound them further.
+
+        Args:
+            max_messages: the maximum number of messages to return.
+            timeout: the maximum number of seconds to wait for a message.  If
+                0, return immediately.
+
+        Returns:
+            List[~blazingmq.Message]: the messages retrieved, in the order they
+            were received, or an empty list if none arrived in time or the
+            session was stopped while waiting.
+
+        Raises:
+            `~blazingmq.Error`: If the session wasn't created with
+                *pull_messages* set, or has been stopped.
+            `ValueError`: If *max_messages* is not > 0, or *timeout* is < 0.0.
+        """
+        if not self._pull_messages:
+            raise Error("receive() requires a Session created with pull_messages")
+        if max_messages <= 0:
+            raise ValueError(f"max_messages must be positive, was {max_messages}")
+        if timeout is not None and not 0.0 <= timeout < 2**63:
+            raise ValueError(f"timeout must be nonnegative, was {timeout}")
+        return self._ext.receive(max_messages, timeout)
+
+    def stats(self) -> Dict[str, Any]:
+        """Return a snapshot of the performance counters kept by this session.
+
+        The counters are maintained by the native layer as messages flow, at a
+        cost of a few atomic increments per message, and this method only
+        copies their current values.  The snapshot is a `dict` with these keys:
+
+        * ``message_callback`` and ``ack_callback``: a `dict` holding the
+          number of ``calls`` made to the *on_message* callback, or to the ack
+          callbacks, and the total ``seconds`` spent in them.
+        * ``queues``: a `dict` mapping the URI of every queue opened by the
+          session to a `dict` of its counters: ``messages_posted``,
+          ``bytes_posted``, ``acks`` (the number of acknowledgements received
+          by `AckStatus` name), ``nacks`` (those whose status wasn't
+          ``SUCCESS``), ``confirms``, ``messages_delivered``,
+          ``bytes_delivered``, ``messages_rejected`` (those whose payload was
+          rejected by the *payload_decoder* of the queue), and
+          ``post_to_ack_latency``.
+        * ``callback_timing``: only present if the session was created with
+          *time_callbacks* or a *slow_callback_threshold*, a `dict` holding
+          the ``gil_wait``, ``conversion`` and ``callback`` histograms of how
+          long each callback invocation waited for the GIL, spent converting
+          its event into Python objects, and ran.
+
+        The ``post_to_ack_latency`` histogram is measured on a sample of the
+        posted messages that requested an acknowledgement.  Every histogram
+        holds the upper ``bounds`` of its buckets in seconds, doubling from one
+        microsecond, the ``counts`` of each bucket, with one more for the
+        samples beyond the last bound, and the total ``count`` and ``sum`` in
+        seconds of the samples.
+
+        Counters are never reset, and those of a queue are kept after it is
+        closed, so rates can be derived by comparing two snapshots.
+
+        Returns:
+            Dict[str, Any]: the current value of every counter.
+        """
+        return self._ext.stats()
+
     def __enter__(self) -> Session:
         return self
 
@@ -23,3 +23,5 @@ PropertyValueType = Union[int, bytes, str]
 PropertyValueDict = Mapping[str, PropertyValueType]
 
 PropertyTypeDict = Mapping[str, PropertyType]
+
+PayloadType = Union[bytes, bytearray, memoryview]
@@ -0,0 +1,95 @@
+// Copyright 2019-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/* The interface between the BlazingMQ Python SDK and the payload decoders
+ * provided by other extension modules.  Such a module exports a
+ * 'blazingmq_PayloadDecoder' through a 'PyCapsule' named
+ * 'BLAZINGMQ_PAYLOAD_DECODER_CAPSULE_NAME', which is passed as the
+ * 'payload_decoder' of 'Session.open_queue'.  The decoder is then called on the
+ * payload of every message received on that queue, before the GIL is acquired
+ * to deliver it.  This header only depends on the C standard library, so
+ * that it can be included by extension modules built without BlazingMQ.
+ */
+
+#ifndef INCLUDED_BLAZINGMQ_DECODER
+#define INCLUDED_BLAZINGMQ_DECODER
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BLAZINGMQ_PAYLOAD_DECODER_CAPSULE_NAME "blazingmq.PayloadDecoder"
+#define BLAZINGMQ_PAYLOAD_DECODER_VERSION 1
+
+typedef struct blazingmq_PayloadSegment
+{
+    /* One contiguous part of a payload. */
+
+    const char* data;
+    size_t length;
+} blazingmq_PayloadSegment;
+
+typedef struct blazingmq_DecodeResult
+{
+    /* Where a decoder stores its output. */
+
+    void* sink;
+    /* To be passed back to 'allocate'. */
+
+    char* (*allocate)(void* sink, size_t length);
+    /* Return a buffer of 'length' bytes that replaces the payload of the
+     * message if the decoder accepts it, or NULL if it can't be allocated.
+     * Calling it again discards the buffer returned previously. */
+
+    const char* reason;
+    /* May be set to a null-terminated description of why the payload was
+     * rejected, such as a string literal, which must stay valid after
+     * 'decode' returns until the next call on the same thread.  NULL on
+     * entry. */
+} blazingmq_DecodeResult;
+
+typedef int (*blazingmq_DecodeFunction)(
+        void* context,
+        const blazingmq_PayloadSegment* segments,
+        size_t num_segments,
+        blazingmq_DecodeResult* result);
+/* Decode the payload made of the 'num_segments' specified 'segments', in
+ * order.  Return 0 to accept it, either as it is or as the buffer most
+ * recently obtained from 'result->allocate', or any other value to reject it,
+ * in which case the message is confirmed without ever being delivered.  This
+ * is called without the GIL, from several threads at once, and must not call
+ * into Python. */
+
+typedef struct blazingmq_PayloadDecoder
+{
+    /* What a decoder exports.  It must stay valid for as long as the capsule
+     * holding it is alive. */
+
+    int version;
+    /* Must be 'BLAZINGMQ_PAYLOAD_DECODER_VERSION'. */
+
+    blazingmq_DecodeFunction decode;
+
+    void* context;
+    /* Passed to every call of 'decode'. */
+} blazingmq_PayloadDecoder;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
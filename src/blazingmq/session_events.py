@@ -223,6 +223,16 @@ class SlowConsumerHighWaterMark(SessionEvent):
     """Notification that the consumer is consuming at the lowest rate acceptable"""
 
 
+class SlowCallback(SessionEvent):
+    """Notification that a callback took longer than the slow callback threshold.
+
+    This is emitted only if a *slow_callback_threshold* was provided when the
+    `.Session` was created, after each invocation of a callback lasting longer
+    than it.  A slow callback delays the delivery of the events received after
+    the one it is processing.
+    """
+
+
 class Error(SessionEvent):
     """Notification of a miscellaneous error"""
 
@@ -238,9 +248,9 @@ def log_session_event(event: SessionEvent) -> None:
     parameter on the `.Session` object. All `.Connected`, `.Disconnected`,
     `.StateRestored`, `.SlowConsumerNormal`, and `.QueueReopened` events are
     logged at INFO level, and any `.ConnectionLost`, `.SlowConsumerHighWaterMark`,
-    and `.Reconnected` events are logged at WARN level, as they may indicate issues
-    with the application. Any other events are most likely an error in the
-    application and are logged at ERROR level.
+    `.SlowCallback`, and `.Reconnected` events are logged at WARN level, as they may
+    indicate issues with the application. Any other events are most likely an error
+    in the application and are logged at ERROR level.
 
     Args:
         event (~blazingmq.session_events.SessionEvent): incoming `SessionEvent`
@@ -261,7 +271,9 @@ def log_session_event(event: SessionEvent) -> None:
         ),
     ):
         level = logging.INFO
-    elif isinstance(event, (ConnectionLost, Reconnected, SlowConsumerHighWaterMark)):
+    elif isinstance(
+        event, (ConnectionLost, Reconnected, SlowConsumerHighWaterMark, SlowCallback)
+    ):
         level = logging.WARN
     else:
         # ConnectionTimeout, Error, InterfaceError, QueueReopenFailed,
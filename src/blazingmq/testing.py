@@ -19,6 +19,7 @@ Nothing in this module should ever be used outside of the context of performing
 integration tests on your subscribers and publishers.
 """
 
+from ._loopback import LoopbackBroker
 from ._monitors import BasicHealthMonitor
 
 HostHealth = BasicHealthMonitor
@@ -28,3 +29,5 @@ This was originally exposed only for testing purposes, but is now supported for
 general use. The original name has been retained for backwards compatibility,
 but new code should prefer to use `blazingmq.BasicHealthMonitor` directly.
 """
+
+__all__ = ["HostHealth", "LoopbackBroker"]
@@ -15,17 +15,30 @@
 
 #include <pybmq_ballutil.h>
 #include <pybmq_gilacquireguard.h>
+#include <pybmq_gilreleaseguard.h>
 #include <pybmq_refutils.h>
 
+#include <ball_category.h>
 #include <ball_context.h>
 #include <ball_log.h>
 #include <ball_loggermanager.h>
 #include <ball_observeradapter.h>
 #include <ball_record.h>
 #include <ball_severity.h>
+#include <bdlf_memfn.h>
+#include <bsl_memory.h>
+#include <bsl_sstream.h>
 #include <bsl_string.h>
+#include <bsl_utility.h>
+#include <bsl_vector.h>
 #include <bslma_managedptr.h>
+#include <bslmt_condition.h>
+#include <bslmt_lockguard.h>
+#include <bslmt_mutex.h>
+#include <bslmt_threadutil.h>
+#include <bsls_atomic.h>
 #include <bsls_keyword.h>
+#include <bsls_types.h>
 
 #include <cstdlib>
 
@@ -34,18 +47,18 @@ namespace pybmq {
 
 namespace {  // unnamed
 
+// Documented in the "logging" module's public documentation.
+enum {
+    FATAL = 50,
+    ERROR = 40,
+    WARN = 30,
+    INFO = 20,
+    DEBUG = 10,
+};
+
 int
 ball_severity_to_python_level(int severity)
 {
-    // Documented in the "logging" module's public documentation.
-    enum {
-        FATAL = 50,
-        ERROR = 40,
-        WARN = 30,
-        INFO = 20,
-        DEBUG = 10,
-    };
-
     if (severity > ball::Severity::e_INFO) return DEBUG;
     if (severity > ball::Severity::e_WARN) return INFO;
     if (severity > ball::Severity::e_ERROR) return WARN;
@@ -53,17 +66,145 @@ ball_severity_to_python_level(int severity)
     return FATAL;
 }
 
+int
+python_level_to_ball_severity(int level)
+{
+    // Return the least severe BALL severity whose records are logged at a
+    // Python level of at least the specified 'level'.
+    if (level <= DEBUG) return ball::Severity::e_TRACE;
+    if (level <= INFO) return ball::Severity::e_INFO;
+    if (level <= WARN) return ball::Severity::e_WARN;
+    if (level <= ERROR) return ball::Severity::e_ERROR;
+    if (level <= FATAL) return ball::Severity::e_FATAL;
+    return ball::Severity::e_OFF;
+}
+
+class CategoryLevels
+{
+    // The severity threshold for publishing the records of each category,
+    // determined by the longest matching prefix set with 'set'.
+
+  private:
+    // DATA
+    mutable bslmt::Mutex d_lock;
+    int d_default_severity;
+    bsl::vector<bsl::pair<bsl::string, int> > d_prefixes;
+
+  public:
+    CategoryLevels()
+    : d_lock()
+    , d_default_severity(ball::Severity::e_INFO)
+    , d_prefixes()
+    {
+    }
+
+    void set_default(int severity)
+    {
+        bslmt::LockGuard<bslmt::Mutex> lock(&d_lock);
+        d_default_severity = severity;
+    }
+
+    void set(const bsl::string& prefix, int severity)
+    {
+        bslmt::LockGuard<bslmt::Mutex> lock(&d_lock);
+        for (size_t i = 0; i < d_prefixes.size(); ++i) {
+            if (d_prefixes[i].first == prefix) {
+                d_prefixes[i].second = severity;
+                return;
+            }
+        }
+        d_prefixes.push_back(bsl::make_pair(prefix, severity));
+    }
+
+    int severity(const char* category) const
+    {
+        bslmt::LockGuard<bslmt::Mutex> lock(&d_lock);
+        const bsl::string name(category);
+        int severity = d_default_severity;
+        size_t matched_length = 0;
+        for (size_t i = 0; i < d_prefixes.size(); ++i) {
+            const bsl::string& prefix = d_prefixes[i].first;
+            if (prefix.length() >= matched_length
+                && 0 == name.compare(0, prefix.length(), prefix))
+            {
+                severity = d_prefixes[i].second;
+                matched_length = prefix.length();
+            }
+        }
+        return severity;
+    }
+};
+
+CategoryLevels g_category_levels;
+
+void
+loadThresholdLevels(
+        int* record_level,
+        int* pass_level,
+        int* trigger_level,
+        int* trigger_all_level,
+        const char* category)
+{
+    // Load the threshold levels of the newly created specified 'category',
+    // which only publishes records immediately.
+    *record_level = ball::Severity::e_OFF;
+    *pass_level = g_category_levels.severity(category);
+    *trigger_level = ball::Severity::e_OFF;
+    *trigger_all_level = ball::Severity::e_OFF;
+}
+
+struct CategoryNameCollector
+{
+    // Visitor appending the name of every category to a vector.
+
+    bsl::vector<bsl::string>* d_names_p;
+
+    void operator()(const ball::Category* category) const
+    {
+        d_names_p->push_back(category->categoryName());
+    }
+};
+
+struct LogEntry
+{
+    // A log record waiting to be passed to the Python callback.
+
+    bsl::string d_name;
+    int d_level;
+    bsl::string d_file;
+    int d_line;
+    bsl::string d_message;
+};
+
 class Observer : public ball::ObserverAdapter
 {
   private:
+    // PRIVATE TYPES
+    enum { k_MAX_PENDING_ENTRIES = 4096 };
+
     // DATA
     BallUtil::LogEntryCallback d_cb;
     bslma::ManagedPtr<PyObject> d_context;
+    bslmt::Mutex d_lock;
+    bslmt::Condition d_condition;
+    bsl::vector<LogEntry> d_pending;  // protected by 'd_lock'
+    bool d_stopping;  // protected by 'd_lock'
+    bsls::AtomicInt64 d_num_dropped;
+    bslmt::ThreadUtil::Handle d_thread;
 
     // NOT IMPLEMENTED
     Observer(const Observer&) BSLS_KEYWORD_DELETED;
     Observer& operator=(const Observer&) BSLS_KEYWORD_DELETED;
 
+    // PRIVATE MANIPULATORS
+    void drain();
+    // Pass batches of pending records to the callback until 'stop' is called.
+
+    void forward(const bsl::vector<LogEntry>& entries, bsls::Types::Int64 num_dropped);
+    // Pass the specified 'entries' to the callback, preceded by a warning if
+    // the specified 'num_dropped' records had to be dropped.  The GIL must be
+    // held.
+
   public:
     // CREATORS
     Observer(BallUtil::LogEntryCallback cb, PyObject* context);
@@ -72,35 +213,139 @@ class Observer : public ball::ObserverAdapter
     }
 
     // MANIPULATORS
+    int start();
+    // Start the thread passing records to the callback, and return 0 on
+    // success.
+
+    void stop();
+    // Pass every pending record to the callback and stop the thread started by
+    // 'start'.  Records published afterwards are dropped.  The GIL must be
+    // held.
+
     void publish(const ball::Record&, const ball::Context&);
+    // Keep a copy of the record for the thread started by 'start', or drop it
+    // if too many records are pending.  Never acquires the GIL.
 };
 
 // CREATORS
 Observer::Observer(BallUtil::LogEntryCallback cb, PyObject* context)
 : d_cb(cb)
+, d_stopping(false)
+, d_num_dropped(0)
+, d_thread(bslmt::ThreadUtil::invalidHandle())
 {
     d_context = RefUtils::toManagedPtr(RefUtils::ref(context));
 }
 
 // MANIPULATORS
+int
+Observer::start()
+{
+    return bslmt::ThreadUtil::create(
+            &d_thread,
+            bdlf::MemFnUtil::memFn(&Observer::drain, this));
+}
+
 void
-Observer::publish(const ball::Record& record, const ball::Context&)
+Observer::stop()
+{
+    {
+        bslmt::LockGuard<bslmt::Mutex> lock(&d_lock);
+        if (d_stopping) {
+            return;
+        }
+        d_stopping = true;
+    }
+    d_condition.signal();
+
+    // The thread needs the GIL to pass the last records to the callback.
+    GilReleaseGuard guard;
+    bslmt::ThreadUtil::join(d_thread);
+}
+
+void
+Observer::drain()
+{
+    bsl::vector<LogEntry> entries;
+    bool stopping = false;
+    while (!stopping) {
+        {
+            bslmt::LockGuard<bslmt::Mutex> lock(&d_lock);
+            while (d_pending.empty() && !d_stopping) {
+                d_condition.wait(&d_lock);
+            }
+            entries.swap(d_pending);
+            stopping = d_stopping;
+        }
+        bsls::Types::Int64 num_dropped = d_num_dropped.swap(0);
+        if (!entries.empty() || num_dropped) {
+            GilAcquireGuard guard;
+            forward(entries, num_dropped);
+        }
+        entries.clear();
+    }
+}
+
+void
+Observer::forward(const bsl::vector<LogEntry>& entries, bsls::Types::Int64 num_dropped)
 {
-    bsl::string name = bsl::string("blazingmq.") + record.fixedFields().category();
+    if (num_dropped) {
+        bsl::ostringstream oss;
+        oss << "Dropped " << num_dropped << " log records because more than "
+            << k_MAX_PENDING_ENTRIES << " were waiting to be logged";
+        bslma::ManagedPtr<PyObject> ret = RefUtils::toManagedPtr(
+                d_cb("blazingmq.pybmq_ballutil",
+                     WARN,
+                     __FILE__,
+                     __LINE__,
+                     oss.str().c_str()));
+        if (!ret) {
+            PyErr_WriteUnraisable(d_context.get());
+        }
+    }
 
-    GilAcquireGuard guard;
-    bslma::ManagedPtr<PyObject> ret = RefUtils::toManagedPtr(
-            d_cb(name.c_str(),
-                 ball_severity_to_python_level(record.fixedFields().severity()),
-                 record.fixedFields().fileName(),
-                 record.fixedFields().lineNumber(),
-                 record.fixedFields().message()));
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const LogEntry& entry = entries[i];
+        bslma::ManagedPtr<PyObject> ret = RefUtils::toManagedPtr(
+                d_cb(entry.d_name.c_str(),
+                     entry.d_level,
+                     entry.d_file.c_str(),
+                     entry.d_line,
+                     entry.d_message.c_str()));
+        if (!ret) {
+            PyErr_WriteUnraisable(d_context.get());
+        }
+    }
+}
 
-    if (!ret) {
-        PyErr_WriteUnraisable(d_context.get());
+void
+Observer::publish(const ball::Record& record, const ball::Context&)
+{
+    LogEntry entry;
+    entry.d_name = bsl::string("blazingmq.") + record.fixedFields().category();
+    entry.d_level = ball_severity_to_python_level(record.fixedFields().severity());
+    entry.d_file = record.fixedFields().fileName();
+    entry.d_line = record.fixedFields().lineNumber();
+    entry.d_message = record.fixedFields().message();
+
+    bool was_empty;
+    {
+        bslmt::LockGuard<bslmt::Mutex> lock(&d_lock);
+        if (d_stopping || d_pending.size() >= k_MAX_PENDING_ENTRIES) {
+            d_num_dropped.addRelaxed(1);
+            return;
+        }
+        was_empty = d_pending.empty();
+        d_pending.emplace_back();
+        bsl::swap(d_pending.back(), entry);
+    }
+    if (was_empty) {
+        d_condition.signal();
     }
 }
 
+bsl::shared_ptr<Observer> g_observer_sp;
+
 }  // unnamed namespace
 
 PyObject*
@@ -110,6 +355,7 @@ BallUtil::initBallSingleton(BallUtil::LogEntryCallback cb, PyObject* context)
     if (getenv("_PYBMQ_ENABLE_DIAGNOSTICS")) {
         severity = ball::Severity::DEBUG;
     }
+    g_category_levels.set_default(severity);
 
     ball::LoggerManagerConfiguration lmc;
     lmc.setDefaultThresholdLevelsIfValid(
@@ -117,9 +363,17 @@ BallUtil::initBallSingleton(BallUtil::LogEntryCallback cb, PyObject* context)
             severity,  // cutoff for publishing immediately
             ball::Severity::OFF,  // cutoff for publishing this thread's log buffer
             ball::Severity::OFF);  // cutoff for publishing all threads' log buffers
+    lmc.setDefaultThresholdLevelsCallback(&loadThresholdLevels);
+
+    g_observer_sp = bsl::make_shared<Observer>(cb, context);
+    if (g_observer_sp->start()) {
+        g_observer_sp.reset();
+        PyErr_SetString(PyExc_RuntimeError, "Failed to start log forwarding thread");
+        return NULL;
+    }
 
     ball::LoggerManager& manager = ball::LoggerManager::initSingleton(lmc);
-    if (manager.registerObserver(bsl::make_shared<Observer>(cb, context), "default")) {
+    if (manager.registerObserver(g_observer_sp, "default")) {
         PyErr_SetString(PyExc_RuntimeError, "Failed to register observer");
         return NULL;
     }
@@ -127,12 +381,43 @@ BallUtil::initBallSingleton(BallUtil::LogEntryCallback cb, PyObject* context)
     Py_RETURN_NONE;
 }
 
+PyObject*
+BallUtil::setCategoryLevel(const char* category_prefix, int level)
+{
+    const bsl::string prefix(category_prefix);
+    const int severity = python_level_to_ball_severity(level);
+    g_category_levels.set(prefix, severity);
+
+    // New categories pick their levels up from 'loadThresholdLevels', but the
+    // existing ones must be updated.
+    bsl::vector<bsl::string> names;
+    ball::LoggerManager& manager = ball::LoggerManager::singleton();
+    CategoryNameCollector collector = {&names};
+    manager.visitCategories(collector);
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (0 != names[i].compare(0, prefix.length(), prefix)) {
+            continue;
+        }
+        manager.setCategory(
+                names[i].c_str(),
+                ball::Severity::e_OFF,
+                g_category_levels.severity(names[i].c_str()),
+                ball::Severity::e_OFF,
+                ball::Severity::e_OFF);
+    }
+    Py_RETURN_NONE;
+}
+
 PyObject*
 BallUtil::shutDownBallSingleton()
 {
     BALL_LOG_SET_CATEGORY("pybmq_ballutil");
     BALL_LOG_DEBUG << "Shutting down BALL redirection";
+    if (g_observer_sp) {
+        g_observer_sp->stop();
+    }
     ball::LoggerManager::shutDownSingleton();
+    g_observer_sp.reset();
     Py_RETURN_NONE;
 }
 
@@ -40,10 +40,20 @@ struct BallUtil
     // CLASS METHODS
     static PyObject* initBallSingleton(LogEntryCallback cb, PyObject* context);
     // Given a callback function, create the BALL singleton and set up an
-    // observer that calls that callback for each log record.
+    // observer that calls that callback for each log record.  Records are
+    // published without the GIL into a bounded buffer, dropping them if it is
+    // full, and passed to the callback in batches by a dedicated thread.
+
+    static PyObject* setCategoryLevel(const char* category_prefix, int level);
+    // Only publish the records of categories whose name starts with the
+    // specified 'category_prefix' if their severity corresponds to at least
+    // the specified Python logging 'level', overriding the level of any
+    // shorter prefix.  Records below the level are discarded before they are
+    // formatted.
 
     static PyObject* shutDownBallSingleton();
-    // Destroy the BALL singleton created by 'initBallSingleton'.
+    // Pass any buffered records to the callback, then destroy the BALL
+    // singleton created by 'initBallSingleton'.  The GIL must be held.
 };
 
 }  // namespace pybmq
@@ -0,0 +1,144 @@
+// Copyright 2019-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <pybmq_bufferutils.h>
+#include <pybmq_refutils.h>
+
+#include <bslma_managedptr.h>
+
+#include <new>
+
+namespace BloombergLP {
+namespace pybmq {
+
+namespace {
+
+typedef bsl::shared_ptr<char> BufferSp;
+
+struct SharedBuffer
+{
+    // The Python object exporting a 'bdlbb::BlobBuffer' through the buffer
+    // protocol.  It is never exposed directly; users only ever see the
+    // 'memoryview' objects wrapping it.
+
+    PyObject ob_base;
+    BufferSp d_buffer_sp;
+    Py_ssize_t d_length;
+};
+
+extern "C" void
+shared_buffer_dealloc(PyObject* self)
+{
+    reinterpret_cast<SharedBuffer*>(self)->d_buffer_sp.~BufferSp();
+    PyObject_Del(self);
+}
+
+extern "C" int
+shared_buffer_getbuffer(PyObject* self, Py_buffer* view, int flags)
+{
+    SharedBuffer* shared_buffer = reinterpret_cast<SharedBuffer*>(self);
+    return PyBuffer_FillInfo(
+            view,
+            self,
+            shared_buffer->d_buffer_sp.get(),
+            shared_buffer->d_length,
+            1,  // read-only
+            flags);
+}
+
+PyBufferProcs shared_buffer_as_buffer;
+PyTypeObject shared_buffer_type = {PyVarObject_HEAD_INIT(NULL, 0)};
+
+bool
+ready_shared_buffer_type_unlocked()
+{
+    if (shared_buffer_type.tp_flags & Py_TPFLAGS_READY) {
+        return true;
+    }
+
+    shared_buffer_as_buffer.bf_getbuffer = shared_buffer_getbuffer;
+
+    shared_buffer_type.tp_name = "blazingmq._ext.SharedBuffer";
+    shared_buffer_type.tp_doc = "A buffer received from BlazingMQ";
+    shared_buffer_type.tp_basicsize = sizeof(SharedBuffer);
+    shared_buffer_type.tp_flags = Py_TPFLAGS_DEFAULT;
+    shared_buffer_type.tp_dealloc = shared_buffer_dealloc;
+    shared_buffer_type.tp_as_buffer = &shared_buffer_as_buffer;
+    return 0 == PyType_Ready(&shared_buffer_type);
+}
+
+bool
+ready_shared_buffer_type()
+{
+#ifdef Py_GIL_DISABLED
+    // Without a GIL, the SDK's threads and the dispatch threads may all try to
+    // ready the type at once.  As in 'MessageUtils', a 'PyMutex' detaches the
+    // threads waiting for it, so they can't block a garbage collection.
+    static PyMutex lock = {0};
+    PyMutex_Lock(&lock);
+    bool ready = ready_shared_buffer_type_unlocked();
+    PyMutex_Unlock(&lock);
+    return ready;
+#else
+    return ready_shared_buffer_type_unlocked();
+#endif
+}
+
+}  // namespace
+
+PyObject*
+BufferUtils::get_buffer_view(const bsl::shared_ptr<char>& buffer, int length)
+{
+    if (!ready_shared_buffer_type()) {
+        return NULL;
+    }
+
+    SharedBuffer* shared_buffer = PyObject_New(SharedBuffer, &shared_buffer_type);
+    if (!shared_buffer) {
+        return NULL;
+    }
+    new (&shared_buffer->d_buffer_sp) BufferSp(buffer);
+    shared_buffer->d_length = length;
+
+    bslma::ManagedPtr<PyObject> owner =
+            RefUtils::toManagedPtr(reinterpret_cast<PyObject*>(shared_buffer));
+    return PyMemoryView_FromObject(owner.get());
+}
+
+PyObject*
+BufferUtils::get_blob_buffers(const bdlbb::Blob& blob)
+{
+    const int num_buffers = blob.numDataBuffers();
+    bslma::ManagedPtr<PyObject> buffers =
+            RefUtils::toManagedPtr(PyList_New(num_buffers));
+    if (!buffers) {
+        return NULL;
+    }
+
+    for (int i = 0; i < num_buffers; ++i) {
+        const bdlbb::BlobBuffer& blob_buffer = blob.buffer(i);
+        const int length = (i == num_buffers - 1) ? blob.lastDataBufferLength()
+                                                  : blob_buffer.size();
+        PyObject* view = get_buffer_view(blob_buffer.buffer(), length);
+        if (!view) {
+            return NULL;
+        }
+        PyList_SET_ITEM(buffers.get(), i, view);
+    }
+    return buffers.release().first;
+}
+
+}  // namespace pybmq
+}  // namespace BloombergLP
@@ -0,0 +1,48 @@
+// Copyright 2019-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_PYBMQ_BUFFERUTILS
+#define INCLUDED_PYBMQ_BUFFERUTILS
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <bdlbb_blob.h>
+
+#include <bsl_memory.h>
+
+namespace BloombergLP {
+namespace pybmq {
+
+struct BufferUtils
+{
+    // This utility provides functions for exposing the buffers of a
+    // 'bdlbb::Blob' to Python without copying them.
+
+    // CLASS METHODS
+    static PyObject* get_buffer_view(const bsl::shared_ptr<char>& buffer, int length);
+    // Return a read-only 'memoryview' over the first 'length' bytes of the
+    // specified 'buffer'.  The 'memoryview' shares ownership of 'buffer', so
+    // the memory stays valid for as long as Python holds a reference to it.
+
+    static PyObject* get_blob_buffers(const bdlbb::Blob& blob);
+    // Return a list of read-only 'memoryview' objects, one per data buffer of
+    // the specified 'blob', as created by 'get_buffer_view'.
+};
+
+}  // namespace pybmq
+}  // namespace BloombergLP
+
+#endif
@@ -0,0 +1,92 @@
+// Copyright 2019-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <pybmq_compressionpolicy.h>
+
+#include <bslmt_lockguard.h>
+
+namespace BloombergLP {
+namespace pybmq {
+
+CompressionPolicy::CompressionPolicy(
+        bmqt::CompressionAlgorithmType::Enum algorithm,
+        bsl::size_t min_size,
+        bool adaptive)
+: d_algorithm(algorithm)
+, d_min_size(min_size)
+, d_adaptive(adaptive)
+, d_num_eligible(0)
+, d_compressing(true)
+, d_window_lock()
+, d_window_original_size(0)
+, d_window_packed_size(0)
+, d_window_num_samples(0)
+{
+}
+
+bmqt::CompressionAlgorithmType::Enum
+CompressionPolicy::algorithm_for(bsl::size_t size, bool* sample)
+{
+    *sample = false;
+    if (d_algorithm == bmqt::CompressionAlgorithmType::e_NONE || size < d_min_size) {
+        return bmqt::CompressionAlgorithmType::e_NONE;
+    }
+    if (!d_adaptive) {
+        return d_algorithm;
+    }
+    *sample = d_num_eligible.addRelaxed(1) % k_SAMPLE_PERIOD == 1;
+    if (*sample || d_compressing.loadRelaxed()) {
+        return d_algorithm;
+    }
+    return bmqt::CompressionAlgorithmType::e_NONE;
+}
+
+void
+CompressionPolicy::record_sample(bsl::size_t original_size, bsl::size_t packed_size)
+{
+    bslmt::LockGuard<bslmt::Mutex> lock(&d_window_lock);
+    d_window_original_size += static_cast<bsls::Types::Int64>(original_size);
+    d_window_packed_size += static_cast<bsls::Types::Int64>(packed_size);
+    if (++d_window_num_samples < k_WINDOW_SIZE) {
+        return;
+    }
+    d_compressing.storeRelaxed(
+            d_window_packed_size * 100
+            <= d_window_original_size * k_MAX_RATIO_PERCENT);
+    d_window_original_size = 0;
+    d_window_packed_size = 0;
+    d_window_num_samples = 0;
+}
+
+bmqt::CompressionAlgorithmType::Enum
+CompressionPolicy::algorithm() const
+{
+    return d_algorithm;
+}
+
+bsl::size_t
+CompressionPolicy::min_size() const
+{
+    return d_min_size;
+}
+
+bool
+CompressionPolicy::adaptive() const
+{
+    return d_adaptive;
+}
+
+}  // namespace pybmq
+}  // namespace BloombergLP
@@ -0,0 +1,95 @@
+// Copyright 2019-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_PYBMQ_COMPRESSIONPOLICY
+#define INCLUDED_PYBMQ_COMPRESSIONPOLICY
+
+#include <bmqt_compressionalgorithmtype.h>
+
+#include <bsl_cstddef.h>
+#include <bslmt_mutex.h>
+#include <bsls_atomic.h>
+#include <bsls_types.h>
+
+namespace BloombergLP {
+namespace pybmq {
+
+class CompressionPolicy
+{
+    // How to compress the messages posted to a queue: with one algorithm,
+    // unless their application data, the payload and properties together, is
+    // smaller than a minimum size.  An adaptive policy also samples how much
+    // its messages shrink, one in every 'k_SAMPLE_PERIOD' eligible messages,
+    // and after every 'k_WINDOW_SIZE' samples stops compressing if they were
+    // not packed to at most 'k_MAX_RATIO_PERCENT' percent of their size on
+    // average, or starts again if they were.  Sampled messages are compressed
+    // either way.  Every method may be called from any thread.  A policy is
+    // meant for a single queue; use the accessors to create another one with
+    // the same configuration for another queue.
+
+  public:
+    // TYPES
+    enum { k_SAMPLE_PERIOD = 64, k_WINDOW_SIZE = 16, k_MAX_RATIO_PERCENT = 90 };
+
+  private:
+    // DATA
+    bmqt::CompressionAlgorithmType::Enum d_algorithm;
+    bsl::size_t d_min_size;
+    bool d_adaptive;
+    bsls::AtomicUint64 d_num_eligible;
+    bsls::AtomicBool d_compressing;
+    bslmt::Mutex d_window_lock;
+    bsls::Types::Int64 d_window_original_size;  // protected by 'd_window_lock'
+    bsls::Types::Int64 d_window_packed_size;  // protected by 'd_window_lock'
+    int d_window_num_samples;  // protected by 'd_window_lock'
+
+    // NOT IMPLEMENTED
+    CompressionPolicy(const CompressionPolicy&);
+    CompressionPolicy& operator=(const CompressionPolicy&);
+
+  public:
+    CompressionPolicy(
+            bmqt::CompressionAlgorithmType::Enum algorithm,
+            bsl::size_t min_size,
+            bool adaptive);
+    // Create a policy compressing messages whose application data is at least
+    // the specified 'min_size' bytes with the specified 'algorithm', adapting
+    // to how well they compress if the specified 'adaptive' is true.
+
+    bmqt::CompressionAlgorithmType::Enum
+    algorithm_for(bsl::size_t size, bool* sample);
+    // Return the algorithm to compress a message whose application data is
+    // the specified 'size' bytes with, and load into the specified 'sample'
+    // whether 'record_sample' should be called once it is packed.
+
+    void record_sample(bsl::size_t original_size, bsl::size_t packed_size);
+    // Note that a message sampled by 'algorithm_for' whose application data
+    // is the specified 'original_size' bytes took the specified 'packed_size'
+    // bytes once packed into its event.
+
+    bmqt::CompressionAlgorithmType::Enum algorithm() const;
+    // Return the algorithm this policy compresses messages with.
+
+    bsl::size_t min_size() const;
+    // Return the size of the smallest application data this policy compresses.
+
+    bool adaptive() const;
+    // Return whether this policy adapts to how well messages compress.
+};
+
+}  // namespace pybmq
+}  // namespace BloombergLP
+
+#endif
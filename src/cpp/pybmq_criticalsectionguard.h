@@ -0,0 +1,83 @@
+// Copyright 2019-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_PYBMQ_CRITICALSECTIONGUARD
+#define INCLUDED_PYBMQ_CRITICALSECTIONGUARD
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <bsls_keyword.h>
+
+namespace BloombergLP {
+namespace pybmq {
+
+class CriticalSectionGuard
+{
+    // Keep other threads from modifying a Python object, such as a list or a
+    // dict that is being iterated over, for the lifetime of this guard.  On
+    // free-threaded builds this locks the object's own mutex, otherwise
+    // holding the GIL is enough and this guard does nothing.  The calling
+    // thread must hold the GIL, or be attached to the interpreter where there
+    // is no GIL.
+
+  private:
+#ifdef Py_GIL_DISABLED
+    // DATA
+    PyCriticalSection d_critical_section;
+#endif
+
+    // NOT IMPLEMENTED
+    CriticalSectionGuard(const CriticalSectionGuard&) BSLS_KEYWORD_DELETED;
+    CriticalSectionGuard&
+    operator=(const CriticalSectionGuard&) BSLS_KEYWORD_DELETED;
+
+  public:
+    // CREATORS
+    explicit CriticalSectionGuard(PyObject* object);
+    // Construct this guard, locking the specified 'object' if needed.
+
+    ~CriticalSectionGuard();
+    // Destroy this guard, unlocking the object if it was locked.
+};
+
+// ===========================================================================
+//                              INLINE DEFINITIONS
+// ===========================================================================
+
+#ifdef Py_GIL_DISABLED
+inline CriticalSectionGuard::CriticalSectionGuard(PyObject* object)
+{
+    PyCriticalSection_Begin(&d_critical_section, object);
+}
+
+inline CriticalSectionGuard::~CriticalSectionGuard()
+{
+    PyCriticalSection_End(&d_critical_section);
+}
+#else
+inline CriticalSectionGuard::CriticalSectionGuard(PyObject*)
+{
+}
+
+inline CriticalSectionGuard::~CriticalSectionGuard()
+{
+}
+#endif
+
+}  // namespace pybmq
+}  // namespace BloombergLP
+
+#endif
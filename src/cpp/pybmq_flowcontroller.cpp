@@ -0,0 +1,311 @@
+// Copyright 2019-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <pybmq_flowcontroller.h>
+
+#include <pybmq_sessioneventhandler.h>
+#include <pybmq_sessionstate.h>
+#include <pybmq_stats.h>
+
+#include <bmqa_queueid.h>
+#include <bmqt_sessioneventtype.h>
+#include <bmqt_uri.h>
+
+#include <bdlf_memfn.h>
+#include <bsl_algorithm.h>
+#include <bsl_cmath.h>
+#include <bsl_stdexcept.h>
+#include <bsl_utility.h>
+#include <bsl_vector.h>
+#include <bslmt_lockguard.h>
+#include <bsls_systemtime.h>
+#include <bsls_timeutil.h>
+
+namespace BloombergLP {
+namespace pybmq {
+
+namespace {  // unnamed
+
+int
+clamp(double value, int min_value, int max_value)
+{
+    // Return the specified 'value' rounded up, or the specified 'min_value' or
+    // 'max_value' if it falls outside of them.
+
+    if (!(value < max_value)) {
+        return max_value;
+    }
+    if (value < min_value) {
+        return min_value;
+    }
+    return static_cast<int>(bsl::ceil(value));
+}
+
+bool
+changes_significantly(int current, int target)
+{
+    // Return whether replacing the specified 'current' limit by the specified
+    // 'target' one changes it by at least 'k_MIN_CHANGE_PERCENT' percent.
+
+    const bsls::Types::Int64 difference =
+            target > current ? bsls::Types::Int64(target) - current
+                             : bsls::Types::Int64(current) - target;
+    return difference > 0
+           && difference * 100 >= static_cast<bsls::Types::Int64>(current)
+                                          * FlowController::k_MIN_CHANGE_PERCENT;
+}
+
+}  // namespace
+
+FlowControlPolicy::FlowControlPolicy(
+        int min_messages,
+        int max_messages,
+        int min_bytes,
+        int max_bytes,
+        const bsls::TimeInterval& window,
+        const bsls::TimeInterval& interval)
+: d_min_messages(min_messages)
+, d_max_messages(max_messages)
+, d_min_bytes(min_bytes)
+, d_max_bytes(max_bytes)
+, d_window(window)
+, d_interval(interval)
+{
+}
+
+int
+FlowControlPolicy::clamp_messages(double messages) const
+{
+    return clamp(messages, d_min_messages, d_max_messages);
+}
+
+int
+FlowControlPolicy::clamp_bytes(double bytes) const
+{
+    return clamp(bytes, d_min_bytes, d_max_bytes);
+}
+
+const bsls::TimeInterval&
+FlowControlPolicy::window() const
+{
+    return d_window;
+}
+
+const bsls::TimeInterval&
+FlowControlPolicy::interval() const
+{
+    return d_interval;
+}
+
+FlowController::FlowController(
+        SessionState* state,
+        bmqa::AbstractSession* session,
+        SessionEventHandler* event_handler,
+        const SessionStats* stats)
+: d_state_p(state)
+, d_session_p(session)
+, d_event_handler_p(event_handler)
+, d_stats_p(stats)
+, d_lock()
+, d_condition()
+, d_queues()
+, d_stopping(false)
+, d_thread(bslmt::ThreadUtil::invalidHandle())
+{
+    int rc = bslmt::ThreadUtil::create(
+            &d_thread,
+            bdlf::MemFnUtil::memFn(&FlowController::run, this));
+    if (rc) {
+        throw bsl::runtime_error("Failed to start the flow control thread");
+    }
+}
+
+FlowController::~FlowController()
+{
+    {
+        bslmt::LockGuard<bslmt::Mutex> lock(&d_lock);
+        d_stopping = true;
+    }
+    d_condition.signal();
+    bslmt::ThreadUtil::join(d_thread);
+}
+
+// PRIVATE MANIPULATORS
+void
+FlowController::run()
+{
+    bslmt::ThreadUtil::setThreadName("bmqFlowControl");
+    typedef bsl::vector<bsl::pair<bsl::string, QueueFlow> > DueFlows;
+
+    bslmt::LockGuard<bslmt::Mutex> lock(&d_lock);
+    while (!d_stopping) {
+        const bsls::TimeInterval now = bsls::SystemTime::nowRealtimeClock();
+        DueFlows due;
+        bsls::TimeInterval next_adjustment;
+        for (QueueFlows::const_iterator it = d_queues.begin(); it != d_queues.end();
+             ++it)
+        {
+            if (it->second.d_next_adjustment <= now) {
+                due.push_back(*it);
+            } else if (
+                    next_adjustment == bsls::TimeInterval()
+                    || it->second.d_next_adjustment < next_adjustment)
+            {
+                next_adjustment = it->second.d_next_adjustment;
+            }
+        }
+
+        if (due.empty()) {
+            if (next_adjustment == bsls::TimeInterval()) {
+                d_condition.wait(&d_lock);
+            } else {
+                d_condition.timedWait(&d_lock, next_adjustment);
+            }
+            continue;
+        }
+
+        // Reconfiguring a queue may call into the SDK, so it's done without
+        // holding 'd_lock', and the queues whose policy was replaced meanwhile
+        // keep their new state.
+        {
+            bslmt::LockGuardUnlock<bslmt::Mutex> unlock(&d_lock);
+            SessionStateGuard guard(d_state_p);
+            for (DueFlows::iterator it = due.begin(); it != due.end(); ++it) {
+                if (guard.started()) {
+                    adjust(it->first, &it->second);
+                }
+                it->second.d_next_adjustment =
+                        bsls::SystemTime::nowRealtimeClock()
+                        + it->second.d_policy_sp->interval();
+            }
+        }
+
+        for (DueFlows::const_iterator it = due.begin(); it != due.end(); ++it) {
+            QueueFlows::iterator flow = d_queues.find(it->first);
+            if (flow != d_queues.end()
+                && flow->second.d_policy_sp == it->second.d_policy_sp)
+            {
+                flow->second = it->second;
+            }
+        }
+    }
+}
+
+void
+FlowController::adjust(const bsl::string& queue_uri, QueueFlow* flow)
+{
+    bmqa::QueueId queue_id;
+    if (d_session_p->getQueueId(&queue_id, bmqt::Uri(queue_uri))) {
+        return;
+    }
+    const QueueStats* queue_stats = QueueStats::from_queue_id(queue_id);
+    if (!queue_stats) {
+        return;
+    }
+
+    const bsls::Types::Int64 now_ns = bsls::TimeUtil::getTimer();
+    const bsls::Types::Int64 confirms = queue_stats->confirms();
+    const bsls::Types::Int64 delivered = queue_stats->messages_delivered();
+    const bsls::Types::Int64 bytes_delivered = queue_stats->bytes_delivered();
+    const bsls::Types::Int64 callback_ns = d_stats_p->message_callback_ns();
+
+    // The first measurement only sets the baseline of the next one, so that
+    // the time the queue took to open is not taken into account.
+    const bool has_baseline = flow->d_measured_at_ns != 0;
+    const double elapsed_ns = static_cast<double>(now_ns - flow->d_measured_at_ns);
+    const bsls::Types::Int64 new_confirms = confirms - flow->d_confirms;
+    const double busy_ns = static_cast<double>(callback_ns - flow->d_callback_ns);
+    flow->d_measured_at_ns = now_ns;
+    flow->d_confirms = confirms;
+    flow->d_callback_ns = callback_ns;
+    if (!has_baseline || elapsed_ns <= 0) {
+        return;
+    }
+
+    const double rate = new_confirms * 1e9 / elapsed_ns;
+    flow->d_confirm_rate =
+            flow->d_confirm_rate < 0 ? rate : (flow->d_confirm_rate + rate) / 2;
+
+    const bsls::Types::Int64 outstanding = delivered - confirms;
+    if (!new_confirms && outstanding <= 0) {
+        return;
+    }
+
+    const bmqt::QueueOptions& current = queue_id.options();
+    const int current_messages = current.maxUnconfirmedMessages();
+    const int current_bytes = current.maxUnconfirmedBytes();
+    const double mean_size =
+            delivered ? static_cast<double>(bytes_delivered) / delivered : 0.0;
+    const FlowControlPolicy& policy = *flow->d_policy_sp;
+
+    double messages = flow->d_confirm_rate * policy.window().totalSecondsAsDouble();
+    const bool full =
+            outstanding * 100.0 >= current_messages * double(k_FULL_PERCENT)
+            || outstanding * mean_size * 100.0
+                       >= current_bytes * double(k_FULL_PERCENT);
+    if (full && busy_ns * 100.0 < elapsed_ns * k_SATURATED_PERCENT) {
+        messages = bsl::max(messages, current_messages * 2.0);
+    }
+    const int max_messages = policy.clamp_messages(messages);
+    const int max_bytes = policy.clamp_bytes(
+            mean_size > 0 ? max_messages * mean_size : double(current_bytes));
+    if (!changes_significantly(current_messages, max_messages)
+        && !changes_significantly(current_bytes, max_bytes))
+    {
+        return;
+    }
+
+    bmqt::QueueOptions options(current);
+    options.setMaxUnconfirmedMessages(max_messages).setMaxUnconfirmedBytes(max_bytes);
+    const bsl::string uri = queue_id.uri().asString();
+    d_event_handler_p->add_pending_operation(
+            bmqt::SessionEventType::e_QUEUE_CONFIGURE_RESULT,
+            uri,
+            NULL,
+            false);
+    if (d_session_p->configureQueueAsync(&queue_id, options)) {
+        d_event_handler_p->cancel_pending_operation(
+                bmqt::SessionEventType::e_QUEUE_CONFIGURE_RESULT,
+                uri,
+                NULL);
+    }
+}
+
+// MANIPULATORS
+void
+FlowController::set_policy(
+        const bsl::string& queue_uri,
+        const bsl::shared_ptr<const FlowControlPolicy>& policy)
+{
+    {
+        bslmt::LockGuard<bslmt::Mutex> lock(&d_lock);
+        if (!policy) {
+            d_queues.erase(queue_uri);
+            return;
+        }
+        QueueFlow flow = {
+                policy,
+                bsls::SystemTime::nowRealtimeClock() + policy->interval(),
+                0,
+                0,
+                0,
+                -1.0};
+        d_queues[queue_uri] = flow;
+    }
+    d_condition.signal();
+}
+
+}  // namespace pybmq
+}  // namespace BloombergLP
@@ -0,0 +1,179 @@
+// Copyright 2019-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_PYBMQ_FLOWCONTROLLER
+#define INCLUDED_PYBMQ_FLOWCONTROLLER
+
+#include <bmqa_abstractsession.h>
+#include <bmqt_queueoptions.h>
+
+#include <bsl_map.h>
+#include <bsl_memory.h>
+#include <bsl_string.h>
+#include <bslmt_condition.h>
+#include <bslmt_mutex.h>
+#include <bslmt_threadutil.h>
+#include <bsls_timeinterval.h>
+#include <bsls_types.h>
+
+namespace BloombergLP {
+namespace pybmq {
+
+class SessionEventHandler;
+class SessionState;
+class SessionStats;
+
+class FlowControlPolicy
+{
+    // The bounds within which a 'FlowController' keeps the limits on the
+    // unconfirmed messages and bytes of a queue, how many seconds' worth of
+    // messages it lets the consumer hold, and how often it adjusts them.
+    // Policies are immutable, so one may be shared by several queues.
+
+  private:
+    // DATA
+    int d_min_messages;
+    int d_max_messages;
+    int d_min_bytes;
+    int d_max_bytes;
+    bsls::TimeInterval d_window;
+    bsls::TimeInterval d_interval;
+
+  public:
+    FlowControlPolicy(
+            int min_messages,
+            int max_messages,
+            int min_bytes,
+            int max_bytes,
+            const bsls::TimeInterval& window,
+            const bsls::TimeInterval& interval);
+    // Create a policy keeping the limits of a queue between the specified
+    // 'min_messages' and 'max_messages', and between the specified 'min_bytes'
+    // and 'max_bytes', sized to hold the messages the consumer confirms in the
+    // specified 'window', and adjusted every specified 'interval'.  The
+    // bounds must be positive and ordered, and 'window' and 'interval'
+    // positive.
+
+    int clamp_messages(double messages) const;
+    // Return the specified 'messages' limit, rounded up and clamped to the
+    // bounds of this policy.
+
+    int clamp_bytes(double bytes) const;
+    // Return the specified 'bytes' limit, rounded up and clamped to the
+    // bounds of this policy.
+
+    const bsls::TimeInterval& window() const;
+    // Return the duration whose worth of messages a consumer may hold.
+
+    const bsls::TimeInterval& interval() const;
+    // Return the time between two adjustments of the limits of a queue.
+};
+
+class FlowController
+{
+    // Adjust, on its own thread, the limits on the unconfirmed messages and
+    // bytes of the queues given a 'FlowControlPolicy', without ever taking
+    // the GIL.  Every interval, the rate at which the consumer confirmed the
+    // messages of a queue is measured and smoothed, and the limits are set to
+    // hold that rate's worth of messages over the policy's window.  If the
+    // consumer had received nearly as many messages as the current limits
+    // allow while spending less than 'k_SATURATED_PERCENT' percent of the
+    // interval in the message callback, the limits may be what held it back,
+    // so they are at least doubled instead.  Limits that would change by less
+    // than 'k_MIN_CHANGE_PERCENT' percent are left as they are, and the
+    // limits of a queue on which nothing was received or confirmed are never
+    // changed.  Only a failure to reconfigure a queue is reported, to the
+    // session event callback, and the adjustment is retried on the next
+    // interval.
+
+  public:
+    // TYPES
+    enum {
+        k_FULL_PERCENT = 75,  // of a limit reached for the window to be full
+        k_SATURATED_PERCENT = 90,  // of an interval spent in the callback
+        k_MIN_CHANGE_PERCENT = 12
+    };
+
+  private:
+    // PRIVATE TYPES
+    struct QueueFlow
+    {
+        // The measurements taken at the last adjustment of a queue's limits.
+
+        bsl::shared_ptr<const FlowControlPolicy> d_policy_sp;
+        bsls::TimeInterval d_next_adjustment;  // on the realtime clock
+        bsls::Types::Int64 d_measured_at_ns;  // from 'bsls::TimeUtil'
+        bsls::Types::Int64 d_confirms;
+        bsls::Types::Int64 d_callback_ns;
+        double d_confirm_rate;  // smoothed, in messages/s, < 0 until measured
+    };
+
+    typedef bsl::map<bsl::string, QueueFlow> QueueFlows;
+
+    // DATA
+    SessionState* d_state_p;  // held, not owned
+    bmqa::AbstractSession* d_session_p;  // held, not owned
+    SessionEventHandler* d_event_handler_p;  // held, not owned
+    const SessionStats* d_stats_p;  // held, not owned
+    bslmt::Mutex d_lock;
+    bslmt::Condition d_condition;
+    QueueFlows d_queues;  // protected by 'd_lock'
+    bool d_stopping;  // protected by 'd_lock'
+    bslmt::ThreadUtil::Handle d_thread;
+
+    // NOT IMPLEMENTED
+    FlowController(const FlowController&);
+    FlowController& operator=(const FlowController&);
+
+    // PRIVATE MANIPULATORS
+    void run();
+    // Adjust the limits of each queue when they're due, until the destructor
+    // is called.
+
+    void adjust(const bsl::string& queue_uri, QueueFlow* flow);
+    // Measure the consumption of the queue with the specified 'queue_uri'
+    // since the specified 'flow' was last updated, update it, and reconfigure
+    // the queue if its limits should change.  The session must be started,
+    // and 'd_lock' must not be held.
+
+  public:
+    FlowController(
+            SessionState* state,
+            bmqa::AbstractSession* session,
+            SessionEventHandler* event_handler,
+            const SessionStats* stats);
+    // Create a controller reconfiguring the queues of the specified 'session'
+    // while the specified 'state' is started, through pending operations of
+    // the specified 'event_handler', from the counters of the specified
+    // 'stats', and start its thread.  Throw 'bsl::runtime_error' if that
+    // thread cannot be started.
+
+    ~FlowController();
+    // Stop the controller's thread, waiting for any ongoing adjustment to
+    // complete.
+
+    void set_policy(
+            const bsl::string& queue_uri,
+            const bsl::shared_ptr<const FlowControlPolicy>& policy);
+    // Adjust the limits of the queue with the specified 'queue_uri' as the
+    // specified 'policy' decides from now on, or stop adjusting them if it is
+    // null.  The consumption of the queue is first measured one interval
+    // after this call, and its limits adjusted from the next interval on.
+};
+
+}  // namespace pybmq
+}  // namespace BloombergLP
+
+#endif
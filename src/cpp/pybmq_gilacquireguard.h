@@ -20,6 +20,8 @@
 #include <Python.h>
 
 #include <bsls_keyword.h>
+#include <bsls_timeutil.h>
+#include <bsls_types.h>
 
 namespace BloombergLP {
 namespace pybmq {
@@ -39,6 +41,11 @@ class GilAcquireGuard
     GilAcquireGuard();
     // Construct this guard, acquiring the GIL if needed.
 
+    explicit GilAcquireGuard(bsls::Types::Int64* wait_ns);
+    // Construct this guard, acquiring the GIL if needed, and load into the
+    // specified 'wait_ns', unless it is null, the number of nanoseconds spent
+    // waiting for it.
+
     ~GilAcquireGuard();
     // Destroy this guard, releasing the GIL if we acquired it.
 };
@@ -52,6 +59,17 @@ inline GilAcquireGuard::GilAcquireGuard()
 {
 }
 
+inline GilAcquireGuard::GilAcquireGuard(bsls::Types::Int64* wait_ns)
+{
+    if (!wait_ns) {
+        d_saved_gil_state = PyGILState_Ensure();
+        return;
+    }
+    const bsls::Types::Int64 start_ns = bsls::TimeUtil::getTimer();
+    d_saved_gil_state = PyGILState_Ensure();
+    *wait_ns = bsls::TimeUtil::getTimer() - start_ns;
+}
+
 inline GilAcquireGuard::~GilAcquireGuard()
 {
     PyGILState_Release(d_saved_gil_state);
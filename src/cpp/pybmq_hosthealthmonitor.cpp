@@ -0,0 +1,198 @@
+// Copyright 2019-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <pybmq_hosthealthmonitor.h>
+
+#include <bdlf_memfn.h>
+#include <bdls_filesystemutil.h>
+#include <bsl_fstream.h>
+#include <bsl_stdexcept.h>
+#include <bsl_string.h>
+#include <bslmt_lockguard.h>
+#include <bsls_platform.h>
+#include <bsls_systemtime.h>
+#include <bsls_types.h>
+
+#include <stdlib.h>
+
+namespace BloombergLP {
+namespace pybmq {
+
+namespace {  // unnamed
+
+bool
+load_average_exceeds(double max_load_average)
+{
+    // Return whether the one minute load average of the host is greater than
+    // the specified 'max_load_average'.  Return false if it can't be read.
+
+    double load_average;
+    if (getloadavg(&load_average, 1) != 1) {
+        return false;
+    }
+    return load_average > max_load_average;
+}
+
+bool
+available_memory_below(double min_available_memory)
+{
+    // Return whether the fraction of the host's memory that is available is
+    // lower than the specified 'min_available_memory'.  Return false if it
+    // can't be read, which is always the case on platforms other than Linux.
+
+#ifdef BSLS_PLATFORM_OS_LINUX
+    bsl::ifstream meminfo("/proc/meminfo");
+    bsls::Types::Int64 total_kb = 0;
+    bsls::Types::Int64 available_kb = 0;
+    bsl::string key;
+    bsls::Types::Int64 value;
+    bsl::string unit;
+    while ((!total_kb || !available_kb) && meminfo >> key >> value >> unit) {
+        if (key == "MemTotal:") {
+            total_kb = value;
+        } else if (key == "MemAvailable:") {
+            available_kb = value;
+        }
+    }
+    if (!total_kb || !available_kb) {
+        return false;
+    }
+    return static_cast<double>(available_kb) / total_kb < min_available_memory;
+#else
+    (void)min_available_memory;
+    return false;
+#endif
+}
+
+}  // namespace
+
+SystemHostHealthMonitor::SystemHostHealthMonitor(
+        const bsl::optional<double>& max_load_average,
+        const bsl::optional<double>& min_available_memory,
+        const bsl::string& probe_file,
+        const bsl::string& probe_command,
+        const bsls::TimeInterval& interval)
+: d_max_load_average(max_load_average)
+, d_min_available_memory(min_available_memory)
+, d_probe_file(probe_file)
+, d_probe_command(probe_command)
+, d_interval(interval)
+, d_state(sample() ? bmqt::HostHealthState::e_HEALTHY
+                   : bmqt::HostHealthState::e_UNHEALTHY)
+, d_num_healthy_samples(0)
+, d_signaler()
+, d_lock()
+, d_condition()
+, d_stopping(false)
+, d_thread(bslmt::ThreadUtil::invalidHandle())
+{
+    int rc = bslmt::ThreadUtil::create(
+            &d_thread,
+            bdlf::MemFnUtil::memFn(&SystemHostHealthMonitor::run, this));
+    if (rc) {
+        throw bsl::runtime_error("Failed to start the host health monitor thread");
+    }
+}
+
+SystemHostHealthMonitor::~SystemHostHealthMonitor()
+{
+    {
+        bslmt::LockGuard<bslmt::Mutex> lock(&d_lock);
+        d_stopping = true;
+    }
+    d_condition.signal();
+    bslmt::ThreadUtil::join(d_thread);
+}
+
+// PRIVATE MANIPULATORS
+void
+SystemHostHealthMonitor::run()
+{
+    bslmt::ThreadUtil::setThreadName("bmqHostHealth");
+    while (true) {
+        {
+            bslmt::LockGuard<bslmt::Mutex> lock(&d_lock);
+            bsls::TimeInterval deadline =
+                    bsls::SystemTime::nowRealtimeClock() + d_interval;
+            while (!d_stopping) {
+                if (d_condition.timedWait(&d_lock, deadline)) {
+                    break;
+                }
+            }
+            if (d_stopping) {
+                return;
+            }
+        }
+        update(sample());
+    }
+}
+
+void
+SystemHostHealthMonitor::update(bool healthy)
+{
+    bmqt::HostHealthState::Enum state =
+            static_cast<bmqt::HostHealthState::Enum>(d_state.loadRelaxed());
+    if (!healthy) {
+        d_num_healthy_samples = 0;
+        if (state != bmqt::HostHealthState::e_UNHEALTHY) {
+            d_state = bmqt::HostHealthState::e_UNHEALTHY;
+            d_signaler(bmqt::HostHealthState::e_UNHEALTHY);
+        }
+    } else if (state != bmqt::HostHealthState::e_HEALTHY
+               && ++d_num_healthy_samples >= k_HEALTHY_SAMPLES_TO_RECOVER)
+    {
+        d_state = bmqt::HostHealthState::e_HEALTHY;
+        d_signaler(bmqt::HostHealthState::e_HEALTHY);
+    }
+}
+
+// PRIVATE ACCESSORS
+bool
+SystemHostHealthMonitor::sample() const
+{
+    if (d_max_load_average.has_value()
+        && load_average_exceeds(d_max_load_average.value()))
+    {
+        return false;
+    }
+    if (d_min_available_memory.has_value()
+        && available_memory_below(d_min_available_memory.value()))
+    {
+        return false;
+    }
+    if (!d_probe_file.empty() && bdls::FilesystemUtil::exists(d_probe_file)) {
+        return false;
+    }
+    if (!d_probe_command.empty() && system(d_probe_command.c_str()) != 0) {
+        return false;
+    }
+    return true;
+}
+
+bdlmt::SignalerConnection
+SystemHostHealthMonitor::observeHostHealth(
+        const bsl::function<HostHealthChangeFn>& cb)
+{
+    return d_signaler.connect(cb);
+}
+
+bmqt::HostHealthState::Enum
+SystemHostHealthMonitor::hostState() const
+{
+    return static_cast<bmqt::HostHealthState::Enum>(d_state.load());
+}
+
+}  // namespace pybmq
+}  // namespace BloombergLP
@@ -0,0 +1,113 @@
+// Copyright 2019-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_PYBMQ_HOSTHEALTHMONITOR
+#define INCLUDED_PYBMQ_HOSTHEALTHMONITOR
+
+#include <bmqpi_hosthealthmonitor.h>
+#include <bmqt_hosthealthstate.h>
+
+#include <bdlmt_signaler.h>
+#include <bsl_functional.h>
+#include <bsl_optional.h>
+#include <bsl_string.h>
+#include <bslmt_condition.h>
+#include <bslmt_mutex.h>
+#include <bslmt_threadutil.h>
+#include <bsls_atomic.h>
+#include <bsls_keyword.h>
+#include <bsls_timeinterval.h>
+
+namespace BloombergLP {
+namespace pybmq {
+
+class SystemHostHealthMonitor : public bmqpi::HostHealthMonitor
+{
+    // A host health monitor that samples signals of the host's health on its
+    // own thread, without ever taking the GIL.  The host is unhealthy as soon
+    // as any sample fails one of the configured checks, and healthy again
+    // once 'k_HEALTHY_SAMPLES_TO_RECOVER' consecutive samples have passed all
+    // of them.
+
+  public:
+    // TYPES
+    enum { k_HEALTHY_SAMPLES_TO_RECOVER = 3 };
+
+  private:
+    // DATA
+    bsl::optional<double> d_max_load_average;
+    bsl::optional<double> d_min_available_memory;
+    bsl::string d_probe_file;
+    bsl::string d_probe_command;
+    bsls::TimeInterval d_interval;
+    bsls::AtomicInt d_state;  // a 'bmqt::HostHealthState::Enum'
+    int d_num_healthy_samples;  // only used by the sampling thread
+    bdlmt::Signaler<bmqpi::HostHealthMonitor::HostHealthChangeFn> d_signaler;
+    bslmt::Mutex d_lock;
+    bslmt::Condition d_condition;
+    bool d_stopping;  // protected by 'd_lock'
+    bslmt::ThreadUtil::Handle d_thread;
+
+    // NOT IMPLEMENTED
+    SystemHostHealthMonitor(const SystemHostHealthMonitor&);
+    SystemHostHealthMonitor& operator=(const SystemHostHealthMonitor&);
+
+    // PRIVATE MANIPULATORS
+    void run();
+    // Sample the host's health every interval until the destructor is called.
+
+    void update(bool healthy);
+    // Take into account that the latest sample found the host to be healthy if
+    // the specified 'healthy' is true, and unhealthy otherwise, notifying the
+    // observers of any resulting change of state.
+
+    // PRIVATE ACCESSORS
+    bool sample() const;
+    // Return whether the host currently passes every configured check.
+
+  public:
+    SystemHostHealthMonitor(
+            const bsl::optional<double>& max_load_average,
+            const bsl::optional<double>& min_available_memory,
+            const bsl::string& probe_file,
+            const bsl::string& probe_command,
+            const bsls::TimeInterval& interval);
+    // Create a monitor that samples the host's health every specified
+    // 'interval', and finds it unhealthy whenever the one minute load average
+    // exceeds the specified 'max_load_average', the fraction of the memory
+    // that is available falls below the specified 'min_available_memory', a
+    // file exists at the specified 'probe_file', or the specified
+    // 'probe_command' exits with a non-zero status.  A threshold without a
+    // value or an empty path or command disables the corresponding check.
+    // The host's health is sampled once before returning, and then on a
+    // thread started by this constructor.  Throw 'bsl::runtime_error' if that
+    // thread cannot be started.
+
+    ~SystemHostHealthMonitor() BSLS_KEYWORD_OVERRIDE;
+    // Stop the sampling thread, waiting for any ongoing sample to complete.
+
+    bdlmt::SignalerConnection observeHostHealth(
+            const bsl::function<HostHealthChangeFn>& cb) BSLS_KEYWORD_OVERRIDE;
+    // Invoke the specified 'cb' with the new state each time the host's health
+    // changes, from the sampling thread.
+
+    bmqt::HostHealthState::Enum hostState() const BSLS_KEYWORD_OVERRIDE;
+    // Return the host's health as of the latest sample.
+};
+
+}  // namespace pybmq
+}  // namespace BloombergLP
+
+#endif
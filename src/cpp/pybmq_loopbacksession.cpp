@@ -0,0 +1,628 @@
+// Copyright 2019-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <pybmq_loopbacksession.h>
+
+#include <bmqa_confirmeventbuilder.h>
+#include <bmqa_event.h>
+#include <bmqa_message.h>
+#include <bmqa_messageiterator.h>
+#include <bmqt_queueflags.h>
+#include <bmqt_resultcode.h>
+
+#include <bdlf_memfn.h>
+#include <bsl_stdexcept.h>
+#include <bslma_allocator.h>
+#include <bslma_default.h>
+#include <bslmt_lockguard.h>
+#include <bsls_atomic.h>
+#include <bsls_platform.h>
+#include <bsls_systemtime.h>
+
+namespace BloombergLP {
+namespace pybmq {
+
+namespace {
+
+bsls::AtomicUint64 g_num_sessions(0);
+
+#ifdef BSLS_PLATFORM_CMP_GNU
+void
+assertNotCalled() __attribute__((noreturn));
+#endif
+
+void
+assertNotCalled()
+{
+    throw bsl::runtime_error("loopback method not implemented");
+}
+
+bmqt::MessageGUID
+make_guid(bsls::Types::Uint64 session_id, bsls::Types::Uint64 sequence_number)
+{
+    // Return a GUID unique to the specified 'sequence_number' among the
+    // messages posted to the session with the specified 'session_id'.
+
+    unsigned char buffer[bmqt::MessageGUID::e_SIZE_BINARY];
+    for (int i = 0; i < 8; ++i) {
+        buffer[7 - i] = static_cast<unsigned char>(session_id >> (8 * i));
+        buffer[15 - i] = static_cast<unsigned char>(sequence_number >> (8 * i));
+    }
+    bmqt::MessageGUID guid;
+    guid.fromBinary(buffer);
+    return guid;
+}
+
+}  // namespace
+
+LoopbackOptions::LoopbackOptions(
+        const bsls::TimeInterval& latency,
+        int batch_size,
+        double nack_ratio)
+: d_latency(latency)
+, d_batch_size(batch_size)
+, d_nack_ratio(nack_ratio)
+{
+}
+
+const bsls::TimeInterval&
+LoopbackOptions::latency() const
+{
+    return d_latency;
+}
+
+int
+LoopbackOptions::batch_size() const
+{
+    return d_batch_size;
+}
+
+double
+LoopbackOptions::nack_ratio() const
+{
+    return d_nack_ratio;
+}
+
+// CREATORS
+LoopbackSession::LoopbackSession(
+        const LoopbackOptions& loopback_options,
+        bslma::ManagedPtr<bmqa::SessionEventHandler> eventHandler,
+        const bmqt::SessionOptions& options)
+: d_options(loopback_options)
+, d_event_handler_p(eventHandler.get())
+, d_blob_buffer_factory(options.blobBufferSize())
+, d_session_id(g_num_sessions.add(1))
+, d_mock_lock()
+, d_mock_session(eventHandler, options)
+, d_lock()
+, d_condition()
+, d_pending()
+, d_read_queues()
+, d_num_posted(0)
+, d_nack_credit(0.0)
+, d_running(false)
+, d_thread(bslmt::ThreadUtil::invalidHandle())
+{
+}
+
+LoopbackSession::~LoopbackSession()
+{
+    stop();
+}
+
+// PRIVATE MANIPULATORS
+void
+LoopbackSession::run()
+{
+    bslmt::ThreadUtil::setThreadName("bmqLoopback");
+    emit_session_event(bmqt::SessionEventType::e_CONNECTED);
+
+    const bsl::size_t batch_size = d_options.batch_size();
+    bsl::vector<PendingMessage> batch;
+    batch.reserve(batch_size);
+    while (true) {
+        {
+            bslmt::LockGuard<bslmt::Mutex> lock(&d_lock);
+            bsls::TimeInterval now = bsls::SystemTime::nowRealtimeClock();
+            while (d_running && (d_pending.empty() || now < d_pending.front().d_due)) {
+                if (d_pending.empty()) {
+                    d_condition.wait(&d_lock);
+                } else {
+                    d_condition.timedWait(&d_lock, d_pending.front().d_due);
+                }
+                now = bsls::SystemTime::nowRealtimeClock();
+            }
+            if (!d_running) {
+                return;
+            }
+
+            // Messages are posted with the same latency, so they become due in
+            // the order they are held in.
+            while (!d_pending.empty() && batch.size() < batch_size
+                   && !(now < d_pending.front().d_due))
+            {
+                PendingMessage& message = d_pending.front();
+                message.d_deliver =
+                        !message.d_nack
+                        && d_read_queues.count(message.d_queue_id.uri().asString());
+                batch.push_back(message);
+                d_pending.pop_front();
+            }
+        }
+        deliver(batch, false);
+        batch.clear();
+    }
+}
+
+void
+LoopbackSession::deliver(const bsl::vector<PendingMessage>& batch, bool cancel)
+{
+    bsl::vector<bmqa::MockSessionUtil::AckParams> ack_params;
+    bsl::vector<bmqa::MockSessionUtil::PushMessageParams> push_msg_params;
+    for (bsl::size_t i = 0; i < batch.size(); ++i) {
+        const PendingMessage& message = batch[i];
+        if (!message.d_correlation_id.isUnset()) {
+            bmqt::AckResult::Enum status = cancel ? bmqt::AckResult::e_CANCELED
+                                           : message.d_nack
+                                                   ? bmqt::AckResult::e_REFUSED
+                                                   : bmqt::AckResult::e_SUCCESS;
+            ack_params.emplace_back(
+                    status,
+                    message.d_correlation_id,
+                    message.d_guid,
+                    message.d_queue_id);
+        }
+        if (!cancel && message.d_deliver) {
+            push_msg_params.emplace_back(
+                    message.d_payload,
+                    message.d_queue_id,
+                    message.d_guid,
+                    message.d_properties);
+        }
+    }
+
+    bslma::Allocator* allocator_p = bslma::Default::defaultAllocator();
+    if (!ack_params.empty()) {
+        bmqa::Event event = bmqa::MockSessionUtil::createAckEvent(
+                ack_params,
+                &d_blob_buffer_factory,
+                allocator_p);
+        d_event_handler_p->onMessageEvent(event.messageEvent());
+    }
+    if (!push_msg_params.empty()) {
+        bmqa::Event event = bmqa::MockSessionUtil::createPushEvent(
+                push_msg_params,
+                &d_blob_buffer_factory,
+                allocator_p);
+        d_event_handler_p->onMessageEvent(event.messageEvent());
+    }
+}
+
+void
+LoopbackSession::emit_session_event(bmqt::SessionEventType::Enum type)
+{
+    bmqa::Event event = bmqa::MockSessionUtil::createSessionEvent(
+            type,
+            bmqt::CorrelationId(),
+            0,
+            "",
+            bslma::Default::defaultAllocator());
+    d_event_handler_p->onSessionEvent(event.sessionEvent());
+}
+
+void
+LoopbackSession::emit_queue_result(
+        bmqt::SessionEventType::Enum type,
+        bmqa::QueueId* queue_id)
+{
+    d_mock_session.enqueueEvent(bmqa::MockSessionUtil::createQueueSessionEvent(
+            type,
+            queue_id,
+            queue_id->correlationId(),
+            0,
+            "",
+            &d_blob_buffer_factory,
+            bslma::Default::defaultAllocator()));
+    if (!d_mock_session.emitEvent()) {
+        throw bsl::runtime_error("Failed to emit event");
+    }
+}
+
+void
+LoopbackSession::track_queue(const bmqt::Uri& uri, bsls::Types::Uint64 flags)
+{
+    bslmt::LockGuard<bslmt::Mutex> lock(&d_lock);
+    if (bmqt::QueueFlagsUtil::isReader(flags)) {
+        d_read_queues.insert(uri.asString());
+    } else {
+        d_read_queues.erase(uri.asString());
+    }
+}
+
+void
+LoopbackSession::untrack_queue(const bmqa::QueueId& queue_id)
+{
+    bslmt::LockGuard<bslmt::Mutex> lock(&d_lock);
+    d_read_queues.erase(queue_id.uri().asString());
+}
+
+int
+LoopbackSession::start(const bsls::TimeInterval& timeout)
+{
+    {
+        bslmt::LockGuard<bslmt::RecursiveMutex> lock(&d_mock_lock);
+        BMQA_EXPECT_CALL(d_mock_session, start(timeout));
+        d_mock_session.start(timeout);
+    }
+
+    bslmt::LockGuard<bslmt::Mutex> lock(&d_lock);
+    if (d_running) {
+        return bmqt::GenericResult::e_SUCCESS;
+    }
+    d_running = true;
+    int rc = bslmt::ThreadUtil::create(
+            &d_thread,
+            bdlf::MemFnUtil::memFn(&LoopbackSession::run, this));
+    if (rc) {
+        d_running = false;
+        return bmqt::GenericResult::e_UNKNOWN;
+    }
+    return bmqt::GenericResult::e_SUCCESS;
+}
+
+int
+LoopbackSession::startAsync(const bsls::TimeInterval& timeout)
+{
+    (void)timeout;
+    assertNotCalled();
+    return -1;
+}
+
+void
+LoopbackSession::stop()
+{
+    bsl::vector<PendingMessage> canceled;
+    {
+        bslmt::LockGuard<bslmt::Mutex> lock(&d_lock);
+        if (!d_running) {
+            return;
+        }
+        d_running = false;
+        canceled.assign(d_pending.begin(), d_pending.end());
+        d_pending.clear();
+    }
+    d_condition.signal();
+    bslmt::ThreadUtil::join(d_thread);
+    d_thread = bslmt::ThreadUtil::invalidHandle();
+
+    // Release the callbacks of the messages that will never be acknowledged.
+    deliver(canceled, true);
+    emit_session_event(bmqt::SessionEventType::e_DISCONNECTED);
+
+    bslmt::LockGuard<bslmt::RecursiveMutex> lock(&d_mock_lock);
+    BMQA_EXPECT_CALL(d_mock_session, stop());
+    d_mock_session.stop();
+}
+
+void
+LoopbackSession::stopAsync()
+{
+    assertNotCalled();
+}
+
+void
+LoopbackSession::finalizeStop()
+{
+    assertNotCalled();
+}
+
+void
+LoopbackSession::loadMessageEventBuilder(bmqa::MessageEventBuilder* builder)
+{
+    bslmt::LockGuard<bslmt::RecursiveMutex> lock(&d_mock_lock);
+    d_mock_session.loadMessageEventBuilder(builder);
+}
+
+void
+LoopbackSession::loadConfirmEventBuilder(bmqa::ConfirmEventBuilder* builder)
+{
+    bslmt::LockGuard<bslmt::RecursiveMutex> lock(&d_mock_lock);
+    d_mock_session.loadConfirmEventBuilder(builder);
+}
+
+void
+LoopbackSession::loadMessageProperties(bmqa::MessageProperties* buffer)
+{
+    // This may be called with the GIL held, while an event emitted through
+    // 'd_mock_session' waits for it, so don't lock 'd_mock_lock'.
+    buffer->clear();
+}
+
+int
+LoopbackSession::getQueueId(bmqa::QueueId* queueId, const bmqt::Uri& uri)
+{
+    bslmt::LockGuard<bslmt::RecursiveMutex> lock(&d_mock_lock);
+    return d_mock_session.getQueueId(queueId, uri);
+}
+
+int
+LoopbackSession::getQueueId(
+        bmqa::QueueId* queueId,
+        const bmqt::CorrelationId& correlationId)
+{
+    bslmt::LockGuard<bslmt::RecursiveMutex> lock(&d_mock_lock);
+    return d_mock_session.getQueueId(queueId, correlationId);
+}
+
+int
+LoopbackSession::openQueue(
+        bmqa::QueueId* queueId,
+        const bmqt::Uri& uri,
+        bsls::Types::Uint64 flags,
+        const bmqt::QueueOptions& options,
+        const bsls::TimeInterval& timeout)
+{
+    (void)queueId;
+    (void)uri;
+    (void)flags;
+    (void)options;
+    (void)timeout;
+    assertNotCalled();
+    return -1;
+}
+
+int
+LoopbackSession::openQueueAsync(
+        bmqa::QueueId* queueId,
+        const bmqt::Uri& uri,
+        bsls::Types::Uint64 flags,
+        const bmqt::QueueOptions& options,
+        const bsls::TimeInterval& timeout)
+{
+    bslmt::LockGuard<bslmt::RecursiveMutex> lock(&d_mock_lock);
+    BMQA_EXPECT_CALL(d_mock_session, openQueueAsync(uri, flags, options, timeout))
+            .returning(0);
+    int rc = d_mock_session.openQueueAsync(queueId, uri, flags, options, timeout);
+    track_queue(uri, flags);
+    emit_queue_result(bmqt::SessionEventType::e_QUEUE_OPEN_RESULT, queueId);
+    return rc;
+}
+
+void
+LoopbackSession::openQueueAsync(
+        bmqa::QueueId* queueId,
+        const bmqt::Uri& uri,
+        bsls::Types::Uint64 flags,
+        const OpenQueueCallback& callback,
+        const bmqt::QueueOptions& options,
+        const bsls::TimeInterval& timeout)
+{
+    (void)queueId;
+    (void)uri;
+    (void)flags;
+    (void)callback;
+    (void)options;
+    (void)timeout;
+    assertNotCalled();
+}
+
+bmqa::OpenQueueStatus
+LoopbackSession::openQueueSync(
+        bmqa::QueueId* queueId,
+        const bmqt::Uri& uri,
+        bsls::Types::Uint64 flags,
+        const bmqt::QueueOptions& options,
+        const bsls::TimeInterval& timeout)
+{
+    bslmt::LockGuard<bslmt::RecursiveMutex> lock(&d_mock_lock);
+    BMQA_EXPECT_CALL(
+            d_mock_session,
+            openQueueSync(queueId, uri, flags, options, timeout));
+    d_mock_session.openQueueSync(queueId, uri, flags, options, timeout);
+    track_queue(uri, flags);
+    return bmqa::OpenQueueStatus(*queueId, bmqt::OpenQueueResult::e_SUCCESS, "");
+}
+
+int
+LoopbackSession::configureQueue(
+        bmqa::QueueId* queueId,
+        const bmqt::QueueOptions& options,
+        const bsls::TimeInterval& timeout)
+{
+    (void)queueId;
+    (void)options;
+    (void)timeout;
+    assertNotCalled();
+    return -1;
+}
+
+int
+LoopbackSession::configureQueueAsync(
+        bmqa::QueueId* queueId,
+        const bmqt::QueueOptions& options,
+        const bsls::TimeInterval& timeout)
+{
+    bslmt::LockGuard<bslmt::RecursiveMutex> lock(&d_mock_lock);
+    BMQA_EXPECT_CALL(d_mock_session, configureQueueAsync(queueId, options, timeout))
+            .returning(0);
+    int rc = d_mock_session.configureQueueAsync(queueId, options, timeout);
+    emit_queue_result(bmqt::SessionEventType::e_QUEUE_CONFIGURE_RESULT, queueId);
+    return rc;
+}
+
+void
+LoopbackSession::configureQueueAsync(
+        bmqa::QueueId* queueId,
+        const bmqt::QueueOptions& options,
+        const ConfigureQueueCallback& callback,
+        const bsls::TimeInterval& timeout)
+{
+    (void)queueId;
+    (void)options;
+    (void)callback;
+    (void)timeout;
+    assertNotCalled();
+}
+
+bmqa::ConfigureQueueStatus
+LoopbackSession::configureQueueSync(
+        bmqa::QueueId* queueId,
+        const bmqt::QueueOptions& options,
+        const bsls::TimeInterval& timeout)
+{
+    bslmt::LockGuard<bslmt::RecursiveMutex> lock(&d_mock_lock);
+    BMQA_EXPECT_CALL(d_mock_session, configureQueueSync(queueId, options, timeout));
+    d_mock_session.configureQueueSync(queueId, options, timeout);
+    return bmqa::ConfigureQueueStatus(
+            *queueId,
+            bmqt::ConfigureQueueResult::e_SUCCESS,
+            "");
+}
+
+int
+LoopbackSession::closeQueue(bmqa::QueueId* queueId, const bsls::TimeInterval& timeout)
+{
+    (void)queueId;
+    (void)timeout;
+    assertNotCalled();
+    return -1;
+}
+
+int
+LoopbackSession::closeQueueAsync(
+        bmqa::QueueId* queueId,
+        const bsls::TimeInterval& timeout)
+{
+    bslmt::LockGuard<bslmt::RecursiveMutex> lock(&d_mock_lock);
+    untrack_queue(*queueId);
+    BMQA_EXPECT_CALL(d_mock_session, closeQueueAsync(queueId, timeout)).returning(0);
+    int rc = d_mock_session.closeQueueAsync(queueId, timeout);
+    emit_queue_result(bmqt::SessionEventType::e_QUEUE_CLOSE_RESULT, queueId);
+    return rc;
+}
+
+void
+LoopbackSession::closeQueueAsync(
+        bmqa::QueueId* queueId,
+        const CloseQueueCallback& callback,
+        const bsls::TimeInterval& timeout)
+{
+    (void)queueId;
+    (void)callback;
+    (void)timeout;
+    assertNotCalled();
+}
+
+bmqa::CloseQueueStatus
+LoopbackSession::closeQueueSync(
+        bmqa::QueueId* queueId,
+        const bsls::TimeInterval& timeout)
+{
+    bslmt::LockGuard<bslmt::RecursiveMutex> lock(&d_mock_lock);
+    untrack_queue(*queueId);
+    BMQA_EXPECT_CALL(d_mock_session, closeQueueSync(queueId, timeout));
+    d_mock_session.closeQueueSync(queueId, timeout);
+    return bmqa::CloseQueueStatus(*queueId, bmqt::CloseQueueResult::e_SUCCESS, "");
+}
+
+bmqa::Event
+LoopbackSession::nextEvent(const bsls::TimeInterval& timeout)
+{
+    (void)timeout;
+    assertNotCalled();
+    return bmqa::Event();
+}
+
+int
+LoopbackSession::post(const bmqa::MessageEvent& event)
+{
+    const bsls::TimeInterval due =
+            bsls::SystemTime::nowRealtimeClock() + d_options.latency();
+
+    // Copy the messages out of the event without holding 'd_lock', which the
+    // thread delivering them needs.
+    bsl::vector<PendingMessage> posted;
+    bmqa::MessageIterator message_iterator = event.messageIterator();
+    while (message_iterator.nextMessage()) {
+        const bmqa::Message& message = message_iterator.message();
+        posted.resize(posted.size() + 1);
+        PendingMessage& pending = posted.back();
+        pending.d_due = due;
+        message.getData(&pending.d_payload);
+        pending.d_queue_id = message.queueId();
+        if (message.hasProperties()) {
+            message.loadProperties(&pending.d_properties);
+        }
+        pending.d_correlation_id = message.correlationId();
+        pending.d_nack = false;
+        pending.d_deliver = false;
+    }
+
+    {
+        bslmt::LockGuard<bslmt::Mutex> lock(&d_lock);
+        if (!d_running) {
+            return bmqt::PostResult::e_NOT_CONNECTED;
+        }
+        const double nack_ratio = d_options.nack_ratio();
+        for (bsl::size_t i = 0; i < posted.size(); ++i) {
+            PendingMessage& pending = posted[i];
+            pending.d_guid = make_guid(d_session_id, ++d_num_posted);
+
+            // Spread the rejected messages evenly rather than randomly, so
+            // that a run rejects the same messages every time.
+            d_nack_credit += nack_ratio;
+            if (d_nack_credit >= 1.0) {
+                d_nack_credit -= 1.0;
+                pending.d_nack = true;
+            }
+            d_pending.push_back(pending);
+        }
+    }
+    d_condition.signal();
+    return bmqt::PostResult::e_SUCCESS;
+}
+
+int
+LoopbackSession::confirmMessage(const bmqa::Message& message)
+{
+    (void)message;
+    assertNotCalled();
+    return -1;
+}
+
+int
+LoopbackSession::confirmMessage(const bmqa::MessageConfirmationCookie& cookie)
+{
+    (void)cookie;
+    return bmqt::GenericResult::e_SUCCESS;
+}
+
+int
+LoopbackSession::confirmMessages(bmqa::ConfirmEventBuilder* builder)
+{
+    builder->reset();
+    return bmqt::GenericResult::e_SUCCESS;
+}
+
+int
+LoopbackSession::configureMessageDumping(const bslstl::StringRef& command)
+{
+    (void)command;
+    assertNotCalled();
+    return -1;
+}
+
+}  // namespace pybmq
+}  // namespace BloombergLP
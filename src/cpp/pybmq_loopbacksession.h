@@ -0,0 +1,317 @@
+// Copyright 2019-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_PYBMQ_LOOPBACKSESSION
+#define INCLUDED_PYBMQ_LOOPBACKSESSION
+
+#include <bmqa_abstractsession.h>
+#include <bmqa_closequeuestatus.h>
+#include <bmqa_configurequeuestatus.h>
+#include <bmqa_messageevent.h>
+#include <bmqa_messageproperties.h>
+#include <bmqa_mocksession.h>
+#include <bmqa_openqueuestatus.h>
+#include <bmqa_queueid.h>
+#include <bmqa_sessionevent.h>
+
+#include <bmqt_correlationid.h>
+#include <bmqt_messageguid.h>
+#include <bmqt_sessioneventtype.h>
+#include <bmqt_sessionoptions.h>
+#include <bmqt_uri.h>
+
+#include <bdlbb_blob.h>
+#include <bdlbb_simpleblobbufferfactory.h>
+#include <bsl_deque.h>
+#include <bsl_string.h>
+#include <bsl_unordered_set.h>
+#include <bsl_vector.h>
+#include <bslma_managedptr.h>
+#include <bslmt_condition.h>
+#include <bslmt_mutex.h>
+#include <bslmt_recursivemutex.h>
+#include <bslmt_threadutil.h>
+#include <bsls_keyword.h>
+#include <bsls_timeinterval.h>
+#include <bsls_types.h>
+
+namespace BloombergLP {
+namespace pybmq {
+
+class LoopbackOptions
+{
+    // How a 'LoopbackSession' simulates the broker: how long it holds each
+    // posted message before acknowledging and delivering it, how many
+    // messages it delivers per event at most, and which fraction of them it
+    // rejects instead.
+
+  private:
+    // DATA
+    bsls::TimeInterval d_latency;
+    int d_batch_size;
+    double d_nack_ratio;
+
+  public:
+    LoopbackOptions(
+            const bsls::TimeInterval& latency,
+            int batch_size,
+            double nack_ratio);
+    // Create options holding posted messages for the specified 'latency',
+    // delivering up to the specified 'batch_size' of them per event, and
+    // rejecting the specified 'nack_ratio' of them, between 0 and 1.
+
+    const bsls::TimeInterval& latency() const;
+    // Return how long a posted message is held before it is acknowledged.
+
+    int batch_size() const;
+    // Return the maximum number of messages acknowledged or delivered by a
+    // single event.
+
+    double nack_ratio() const;
+    // Return the fraction of the posted messages that are rejected.
+};
+
+class LoopbackSession : public bmqa::AbstractSession
+{
+    // Concrete implementation of an bmqa::AbstractSession that simulates a
+    // broker within the process, without ever acquiring the GIL itself.  Each
+    // message posted to a queue is held for the configured latency, then
+    // acknowledged and, if the queue was opened for reading, delivered back
+    // to this session.  A deterministic fraction of the messages is instead
+    // rejected with 'e_REFUSED' and not delivered, and the messages still
+    // held when the session stops are canceled.  Acks and deliveries are
+    // emitted in events of up to the configured batch size, from a thread
+    // running between 'start' and 'stop'.  Queues are tracked by a
+    // 'bmqa::MockSession', so queue requests always succeed immediately.
+
+  private:
+    // PRIVATE TYPES
+    struct PendingMessage
+    {
+        // A posted message held until it is due.
+
+        bsls::TimeInterval d_due;
+        bdlbb::Blob d_payload;
+        bmqa::QueueId d_queue_id;
+        bmqt::MessageGUID d_guid;
+        bmqa::MessageProperties d_properties;
+        bmqt::CorrelationId d_correlation_id;
+        bool d_nack;
+        bool d_deliver;  // set once due, if the queue is open for reading
+    };
+
+    // DATA
+    LoopbackOptions d_options;
+    bmqa::SessionEventHandler* d_event_handler_p;  // owned by 'd_mock_session'
+    bdlbb::SimpleBlobBufferFactory d_blob_buffer_factory;
+    bsls::Types::Uint64 d_session_id;
+    bslmt::RecursiveMutex d_mock_lock;
+    bmqa::MockSession d_mock_session;  // protected by 'd_mock_lock'
+    bslmt::Mutex d_lock;
+    bslmt::Condition d_condition;
+    bsl::deque<PendingMessage> d_pending;  // protected by 'd_lock'
+    bsl::unordered_set<bsl::string> d_read_queues;  // protected by 'd_lock'
+    bsls::Types::Uint64 d_num_posted;  // protected by 'd_lock'
+    double d_nack_credit;  // protected by 'd_lock'
+    bool d_running;  // protected by 'd_lock'
+    bslmt::ThreadUtil::Handle d_thread;
+
+    // NOT IMPLEMENTED
+    LoopbackSession(const LoopbackSession&);
+    LoopbackSession& operator=(const LoopbackSession&);
+
+    // PRIVATE MANIPULATORS
+    void run();
+    // Acknowledge and deliver the posted messages as they become due, until
+    // 'stop' is called.
+
+    void deliver(const bsl::vector<PendingMessage>& batch, bool cancel);
+    // Emit one event acknowledging the messages of the specified 'batch' that
+    // were posted with a correlation id, with 'e_CANCELED' if the specified
+    // 'cancel' is true, followed unless it is by one event delivering those
+    // to deliver.
+
+    void emit_session_event(bmqt::SessionEventType::Enum type);
+    // Emit a session event of the specified 'type' with no error.
+
+    void emit_queue_result(
+            bmqt::SessionEventType::Enum type,
+            bmqa::QueueId* queue_id);
+    // Emit a successful queue result event of the specified 'type' for the
+    // specified 'queue_id' through 'd_mock_session', which must be locked.
+
+    void track_queue(const bmqt::Uri& uri, bsls::Types::Uint64 flags);
+    // Deliver the messages subsequently posted to the queue with the
+    // specified 'uri' if the specified 'flags' include 'e_READ'.
+
+    void untrack_queue(const bmqa::QueueId& queue_id);
+    // Stop delivering the messages posted to the queue with the specified
+    // 'queue_id'.
+
+  public:
+    // CREATORS
+    LoopbackSession(
+            const LoopbackOptions& loopback_options,
+            bslma::ManagedPtr<bmqa::SessionEventHandler> eventHandler,
+            const bmqt::SessionOptions& options);
+    // Create a session simulating a broker according to the specified
+    // 'loopback_options', and delivering events to the specified
+    // 'eventHandler'.
+
+    ~LoopbackSession() BSLS_KEYWORD_OVERRIDE;
+    // Destroy this object, stopping it first if needed.
+
+    // Session management
+    ///----------------
+
+    int start(const bsls::TimeInterval& timeout = bsls::TimeInterval())
+            BSLS_KEYWORD_OVERRIDE;
+    // Start the thread acknowledging and delivering posted messages, which
+    // first emits 'e_CONNECTED'.  Return 0 on success.
+
+    int startAsync(const bsls::TimeInterval& timeout = bsls::TimeInterval())
+            BSLS_KEYWORD_OVERRIDE;
+    // Throw an exception if called.
+
+    void stop() BSLS_KEYWORD_OVERRIDE;
+    // Stop the thread, cancel the messages still held, and emit
+    // 'e_DISCONNECTED'.
+
+    void stopAsync() BSLS_KEYWORD_OVERRIDE;
+    // Throw an exception if called.
+
+    void finalizeStop() BSLS_KEYWORD_OVERRIDE;
+    // Throw an exception if called.
+
+    void
+    loadMessageEventBuilder(bmqa::MessageEventBuilder* builder) BSLS_KEYWORD_OVERRIDE;
+
+    void
+    loadConfirmEventBuilder(bmqa::ConfirmEventBuilder* builder) BSLS_KEYWORD_OVERRIDE;
+
+    void loadMessageProperties(bmqa::MessageProperties* buffer) BSLS_KEYWORD_OVERRIDE;
+
+    /// Queue management
+    ///----------------
+    int getQueueId(bmqa::QueueId* queueId, const bmqt::Uri& uri) BSLS_KEYWORD_OVERRIDE;
+
+    int getQueueId(bmqa::QueueId* queueId, const bmqt::CorrelationId& correlationId)
+            BSLS_KEYWORD_OVERRIDE;
+
+    int openQueue(
+            bmqa::QueueId* queueId,
+            const bmqt::Uri& uri,
+            bsls::Types::Uint64 flags,
+            const bmqt::QueueOptions& options = bmqt::QueueOptions(),
+            const bsls::TimeInterval& timeout = bsls::TimeInterval())
+            BSLS_KEYWORD_OVERRIDE;
+
+    int openQueueAsync(
+            bmqa::QueueId* queueId,
+            const bmqt::Uri& uri,
+            bsls::Types::Uint64 flags,
+            const bmqt::QueueOptions& options = bmqt::QueueOptions(),
+            const bsls::TimeInterval& timeout = bsls::TimeInterval())
+            BSLS_KEYWORD_OVERRIDE;
+
+    void openQueueAsync(
+            bmqa::QueueId* queueId,
+            const bmqt::Uri& uri,
+            bsls::Types::Uint64 flags,
+            const OpenQueueCallback& callback,
+            const bmqt::QueueOptions& options = bmqt::QueueOptions(),
+            const bsls::TimeInterval& timeout = bsls::TimeInterval())
+            BSLS_KEYWORD_OVERRIDE;
+
+    bmqa::OpenQueueStatus openQueueSync(
+            bmqa::QueueId* queueId,
+            const bmqt::Uri& uri,
+            bsls::Types::Uint64 flags,
+            const bmqt::QueueOptions& options = bmqt::QueueOptions(),
+            const bsls::TimeInterval& timeout = bsls::TimeInterval())
+            BSLS_KEYWORD_OVERRIDE;
+
+    int configureQueue(
+            bmqa::QueueId* queueId,
+            const bmqt::QueueOptions& options,
+            const bsls::TimeInterval& timeout = bsls::TimeInterval())
+            BSLS_KEYWORD_OVERRIDE;
+
+    int configureQueueAsync(
+            bmqa::QueueId* queueId,
+            const bmqt::QueueOptions& options,
+            const bsls::TimeInterval& timeout = bsls::TimeInterval())
+            BSLS_KEYWORD_OVERRIDE;
+
+    void configureQueueAsync(
+            bmqa::QueueId* queueId,
+            const bmqt::QueueOptions& options,
+            const ConfigureQueueCallback& callback,
+            const bsls::TimeInterval& timeout = bsls::TimeInterval())
+            BSLS_KEYWORD_OVERRIDE;
+
+    bmqa::ConfigureQueueStatus configureQueueSync(
+            bmqa::QueueId* queueId,
+            const bmqt::QueueOptions& options,
+            const bsls::TimeInterval& timeout = bsls::TimeInterval())
+            BSLS_KEYWORD_OVERRIDE;
+
+    int closeQueue(
+            bmqa::QueueId* queueId,
+            const bsls::TimeInterval& timeout = bsls::TimeInterval())
+            BSLS_KEYWORD_OVERRIDE;
+
+    int closeQueueAsync(
+            bmqa::QueueId* queueId,
+            const bsls::TimeInterval& timeout = bsls::TimeInterval())
+            BSLS_KEYWORD_OVERRIDE;
+
+    void closeQueueAsync(
+            bmqa::QueueId* queueId,
+            const CloseQueueCallback& callback,
+            const bsls::TimeInterval& timeout = bsls::TimeInterval())
+            BSLS_KEYWORD_OVERRIDE;
+
+    bmqa::CloseQueueStatus closeQueueSync(
+            bmqa::QueueId* queueId,
+            const bsls::TimeInterval& timeout = bsls::TimeInterval())
+            BSLS_KEYWORD_OVERRIDE;
+
+    /// Queue manipulation
+    ///------------------
+    bmqa::Event nextEvent(const bsls::TimeInterval& timeout = bsls::TimeInterval())
+            BSLS_KEYWORD_OVERRIDE;
+
+    int post(const bmqa::MessageEvent& event) BSLS_KEYWORD_OVERRIDE;
+    // Hold each message packed into the specified 'event' until it is due.
+    // Return 'e_NOT_CONNECTED' unless the session is started.
+
+    int confirmMessage(const bmqa::Message& message) BSLS_KEYWORD_OVERRIDE;
+
+    int
+    confirmMessage(const bmqa::MessageConfirmationCookie& cookie) BSLS_KEYWORD_OVERRIDE;
+
+    int confirmMessages(bmqa::ConfirmEventBuilder* builder) BSLS_KEYWORD_OVERRIDE;
+    // Reset the specified 'builder', as confirmed messages are not redelivered.
+
+    /// Debugging related
+    ///-----------------
+    int configureMessageDumping(const bslstl::StringRef& command) BSLS_KEYWORD_OVERRIDE;
+};
+
+}  // namespace pybmq
+}  // namespace BloombergLP
+
+#endif
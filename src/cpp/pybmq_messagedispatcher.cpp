@@ -0,0 +1,152 @@
+// Copyright 2019-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <pybmq_messagedispatcher.h>
+
+#include <bmqa_messageiterator.h>
+#include <bmqa_queueid.h>
+#include <bmqt_uri.h>
+
+#include <bdlf_bind.h>
+#include <bdlf_memfn.h>
+#include <bsl_cstddef.h>
+#include <bsl_string.h>
+#include <bslmt_lockguard.h>
+#include <bsls_assert.h>
+
+namespace BloombergLP {
+namespace pybmq {
+
+MessageDispatcher::MessageDispatcher(int num_threads, const DeliverFn& deliver)
+: d_deliver(deliver)
+, d_shards()
+, d_started(false)
+{
+    BSLS_ASSERT(num_threads > 0);
+    for (int i = 0; i < num_threads; ++i) {
+        bsl::shared_ptr<Shard> shard = bsl::make_shared<Shard>();
+        shard->d_stopping = false;
+        shard->d_thread = bslmt::ThreadUtil::invalidHandle();
+        d_shards.push_back(shard);
+    }
+}
+
+MessageDispatcher::~MessageDispatcher()
+{
+    BSLS_ASSERT(!d_started);
+}
+
+// PRIVATE MANIPULATORS
+void
+MessageDispatcher::run(Shard* shard)
+{
+    bsl::vector<bmqa::Message> batch;
+    bool stopping = false;
+    while (!stopping) {
+        {
+            bslmt::LockGuard<bslmt::Mutex> lock(&shard->d_lock);
+            while (shard->d_pending.empty() && !shard->d_stopping) {
+                shard->d_condition.wait(&shard->d_lock);
+            }
+            batch.swap(shard->d_pending);
+            stopping = shard->d_stopping;
+        }
+        if (!batch.empty()) {
+            d_deliver(batch);
+            batch.clear();
+        }
+    }
+}
+
+// MANIPULATORS
+int
+MessageDispatcher::start()
+{
+    for (bsl::size_t i = 0; i < d_shards.size(); ++i) {
+        int rc = bslmt::ThreadUtil::create(
+                &d_shards[i]->d_thread,
+                bdlf::BindUtil::bind(
+                        bdlf::MemFnUtil::memFn(&MessageDispatcher::run, this),
+                        d_shards[i].get()));
+        if (rc) {
+            d_shards.resize(i);
+            d_started = true;
+            stop();
+            return rc;
+        }
+        d_started = true;
+    }
+    return 0;
+}
+
+void
+MessageDispatcher::dispatch(const bmqa::MessageEvent& event)
+{
+    // Batch the messages of the event per shard first, so that each shard's
+    // lock is taken at most once.
+    bsl::vector<bsl::vector<bmqa::Message> > batches(d_shards.size());
+    bsl::hash<bsl::string> hasher;
+    bmqa::MessageIterator message_iterator = event.messageIterator();
+    while (message_iterator.nextMessage()) {
+        const bmqa::Message& message = message_iterator.message();
+        bsl::size_t index =
+                hasher(message.queueId().uri().canonical()) % d_shards.size();
+        batches[index].push_back(message.clone());
+    }
+
+    for (bsl::size_t i = 0; i < d_shards.size(); ++i) {
+        if (batches[i].empty()) {
+            continue;
+        }
+        Shard* shard = d_shards[i].get();
+        {
+            bslmt::LockGuard<bslmt::Mutex> lock(&shard->d_lock);
+            if (shard->d_stopping) {
+                continue;
+            }
+            if (shard->d_pending.empty()) {
+                shard->d_pending.swap(batches[i]);
+            } else {
+                shard->d_pending.insert(
+                        shard->d_pending.end(),
+                        batches[i].begin(),
+                        batches[i].end());
+            }
+        }
+        shard->d_condition.signal();
+    }
+}
+
+void
+MessageDispatcher::stop()
+{
+    if (!d_started) {
+        return;
+    }
+    for (bsl::size_t i = 0; i < d_shards.size(); ++i) {
+        {
+            bslmt::LockGuard<bslmt::Mutex> lock(&d_shards[i]->d_lock);
+            d_shards[i]->d_stopping = true;
+        }
+        d_shards[i]->d_condition.signal();
+    }
+    for (bsl::size_t i = 0; i < d_shards.size(); ++i) {
+        bslmt::ThreadUtil::join(d_shards[i]->d_thread);
+    }
+    d_started = false;
+}
+
+}  // namespace pybmq
+}  // namespace BloombergLP
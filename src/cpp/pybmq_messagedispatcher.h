@@ -0,0 +1,97 @@
+// Copyright 2019-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_PYBMQ_MESSAGEDISPATCHER
+#define INCLUDED_PYBMQ_MESSAGEDISPATCHER
+
+#include <bmqa_message.h>
+#include <bmqa_messageevent.h>
+
+#include <bsl_functional.h>
+#include <bsl_memory.h>
+#include <bsl_vector.h>
+#include <bslmt_condition.h>
+#include <bslmt_mutex.h>
+#include <bslmt_threadutil.h>
+
+namespace BloombergLP {
+namespace pybmq {
+
+class MessageDispatcher
+{
+    // Hand received messages over to a fixed set of worker threads, each
+    // delivering the messages of the queues assigned to it in batches, so that
+    // the SDK's threads never wait for the GIL.  Every queue is assigned to a
+    // single worker, by hashing its URI, so the messages of a queue are always
+    // delivered in the order they were received.
+
+  public:
+    // TYPES
+    typedef bsl::function<void(const bsl::vector<bmqa::Message>&)> DeliverFn;
+    // Called by a worker thread, without the GIL, with a batch of messages.
+
+  private:
+    struct Shard
+    {
+        // The messages waiting to be delivered by one worker thread.
+
+        // DATA
+        bslmt::Mutex d_lock;
+        bslmt::Condition d_condition;
+        bsl::vector<bmqa::Message> d_pending;  // protected by 'd_lock'
+        bool d_stopping;  // protected by 'd_lock'
+        bslmt::ThreadUtil::Handle d_thread;
+    };
+
+    // DATA
+    DeliverFn d_deliver;
+    bsl::vector<bsl::shared_ptr<Shard> > d_shards;
+    bool d_started;
+
+    // NOT IMPLEMENTED
+    MessageDispatcher(const MessageDispatcher&);
+    MessageDispatcher& operator=(const MessageDispatcher&);
+
+    // PRIVATE MANIPULATORS
+    void run(Shard* shard);
+    // Deliver batches of the messages waiting in the specified 'shard' until
+    // 'stop' is called.
+
+  public:
+    MessageDispatcher(int num_threads, const DeliverFn& deliver);
+    // Create a dispatcher delivering messages to the specified 'deliver' from
+    // the specified 'num_threads' worker threads, which must be positive.  The
+    // threads are started by 'start'.
+
+    ~MessageDispatcher();
+    // Destroy this object.  'stop' must have been called if 'start' was.
+
+    int start();
+    // Start the worker threads, returning a non-zero value if any of them can't
+    // be started.
+
+    void dispatch(const bmqa::MessageEvent& event);
+    // Queue every message in the specified 'event' for delivery by the worker
+    // thread assigned to its queue.  The GIL need not be held.
+
+    void stop();
+    // Deliver every queued message, then stop the worker threads.  Messages
+    // dispatched afterwards are dropped.  The GIL must not be held.
+};
+
+}  // namespace pybmq
+}  // namespace BloombergLP
+
+#endif
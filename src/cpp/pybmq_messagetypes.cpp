@@ -0,0 +1,889 @@
+// Copyright 2019-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <pybmq_criticalsectionguard.h>
+#include <pybmq_messagetypes.h>
+#include <pybmq_refutils.h>
+
+#include <bsl_cstddef.h>
+#include <bsl_cstring.h>
+#include <bsl_string.h>
+#include <bslma_managedptr.h>
+
+namespace BloombergLP {
+namespace pybmq {
+
+namespace {
+
+// The objects passed to 'MessageTypes::initialize', kept for the lifetime of
+// the process.
+PyObject* g_error;
+PyObject* g_property_types;
+PyObject* g_ack_statuses;
+PyObject* g_unrecognized_ack_status;
+PyObject* g_lazy_properties_factory;
+
+PyTypeObject g_message_type = {PyVarObject_HEAD_INIT(NULL, 0)};
+PyTypeObject g_message_handle_type = {PyVarObject_HEAD_INIT(NULL, 0)};
+PyTypeObject g_ack_type = {PyVarObject_HEAD_INIT(NULL, 0)};
+
+extern "C" PyObject*
+no_public_constructor(PyTypeObject* type, PyObject*, PyObject*)
+{
+    // Instances are only created by 'MessageTypes', as received from the SDK.
+    const char* name = bsl::strrchr(type->tp_name, '.') + 1;
+    PyErr_Format(g_error, "The %s class does not have a public constructor.", name);
+    return NULL;
+}
+
+PyObject*
+prettyHex(PyObject* guid)
+{
+    // Return the specified 'guid' as a 'str' of upper case hexadecimal digits.
+    char* data;
+    Py_ssize_t length;
+    if (PyBytes_AsStringAndSize(guid, &data, &length)) {
+        return NULL;
+    }
+    static const char k_DIGITS[] = "0123456789ABCDEF";
+    bsl::string hex(2 * length, '0');
+    for (Py_ssize_t i = 0; i < length; ++i) {
+        const unsigned char byte = static_cast<unsigned char>(data[i]);
+        hex[2 * i] = k_DIGITS[byte >> 4];
+        hex[2 * i + 1] = k_DIGITS[byte & 0xf];
+    }
+    return PyUnicode_FromStringAndSize(hex.c_str(), hex.length());
+}
+
+PyObject*
+newReference(PyObject* object)
+{
+    Py_INCREF(object);
+    return object;
+}
+
+PyObject**
+memberAt(PyObject* self, void* closure)
+{
+    // Return the address of the member of 'self' at the offset given by the
+    // specified 'closure' of a 'PyGetSetDef' entry.
+    return reinterpret_cast<PyObject**>(
+            reinterpret_cast<char*>(self) + reinterpret_cast<bsl::size_t>(closure));
+}
+
+extern "C" PyObject*
+get_member(PyObject* self, void* closure)
+{
+    // Return a new reference to the member of 'self' at the offset given by
+    // the specified 'closure'.
+    CriticalSectionGuard guard(self);
+    return newReference(*memberAt(self, closure));
+}
+
+int
+replaceMember(
+        PyObject* self,
+        PyObject** member,
+        PyObject* value,
+        PyObject** stale = NULL)
+{
+    // Make the specified 'member' of 'self' refer to the specified 'value'
+    // instead, as assigning the plain attribute of a Python object would, and
+    // clear the optionally specified 'stale' member derived from it.  Return
+    // 0 on success, or -1 with an 'AttributeError' set if 'value' is null
+    // because the attribute is being deleted.
+    if (!value) {
+        PyErr_SetString(PyExc_AttributeError, "attribute cannot be deleted");
+        return -1;
+    }
+    PyObject* old;
+    PyObject* old_stale = NULL;
+    {
+        CriticalSectionGuard guard(self);
+        old = *member;
+        *member = newReference(value);
+        if (stale) {
+            old_stale = *stale;
+            *stale = NULL;
+        }
+    }
+    // Released outside of the critical section, as it may run arbitrary code.
+    Py_XDECREF(old);
+    Py_XDECREF(old_stale);
+    return 0;
+}
+
+extern "C" int
+set_member(PyObject* self, PyObject* value, void* closure)
+{
+    return replaceMember(self, memberAt(self, closure), value);
+}
+
+struct Message
+{
+    // The Python 'Message' object.
+
+    PyObject ob_base;
+    PyObject* d_data;  // null until computed from 'd_data_buffers'
+    PyObject* d_data_buffers;  // null until computed from 'd_data'
+    PyObject* d_guid;
+    PyObject* d_queue_uri;
+    PyObject* d_properties;
+    PyObject* d_property_types;
+    bool d_property_type_codes;  // whether 'd_property_types' holds SDK codes
+    PyObject* d_dict;  // null until an attribute of its own is set
+};
+
+extern "C" int
+message_traverse(PyObject* self, visitproc visit, void* arg)
+{
+    Message* message = reinterpret_cast<Message*>(self);
+    Py_VISIT(message->d_data);
+    Py_VISIT(message->d_data_buffers);
+    Py_VISIT(message->d_guid);
+    Py_VISIT(message->d_queue_uri);
+    Py_VISIT(message->d_properties);
+    Py_VISIT(message->d_property_types);
+    Py_VISIT(message->d_dict);
+    return 0;
+}
+
+extern "C" int
+message_clear(PyObject* self)
+{
+    Message* message = reinterpret_cast<Message*>(self);
+    Py_CLEAR(message->d_data);
+    Py_CLEAR(message->d_data_buffers);
+    Py_CLEAR(message->d_guid);
+    Py_CLEAR(message->d_queue_uri);
+    Py_CLEAR(message->d_properties);
+    Py_CLEAR(message->d_property_types);
+    Py_CLEAR(message->d_dict);
+    return 0;
+}
+
+extern "C" void
+message_dealloc(PyObject* self)
+{
+    PyObject_GC_UnTrack(self);
+    message_clear(self);
+    PyObject_GC_Del(self);
+}
+
+extern "C" PyObject*
+message_get_data(PyObject* self, void*)
+{
+    CriticalSectionGuard guard(self);
+    Message* message = reinterpret_cast<Message*>(self);
+    if (!message->d_data) {
+        // A payload spanning several buffers is only flattened on demand.
+        bslma::ManagedPtr<PyObject> empty =
+                RefUtils::toManagedPtr(PyBytes_FromStringAndSize(NULL, 0));
+        if (!empty) {
+            return NULL;
+        }
+        bslma::ManagedPtr<PyObject> joined =
+                RefUtils::toManagedPtr(PyObject_CallMethod(
+                        empty.get(),
+                        "join",
+                        "(O)",
+                        message->d_data_buffers));
+        if (!joined) {
+            return NULL;
+        }
+        message->d_data = PyMemoryView_FromObject(joined.get());
+        if (!message->d_data) {
+            return NULL;
+        }
+    }
+    return newReference(message->d_data);
+}
+
+extern "C" PyObject*
+message_get_data_buffers(PyObject* self, void*)
+{
+    CriticalSectionGuard guard(self);
+    Message* message = reinterpret_cast<Message*>(self);
+    if (!message->d_data_buffers) {
+        bslma::ManagedPtr<PyObject> view =
+                RefUtils::toManagedPtr(PyMemoryView_FromObject(message->d_data));
+        if (!view) {
+            return NULL;
+        }
+        message->d_data_buffers = PyList_New(1);
+        if (!message->d_data_buffers) {
+            return NULL;
+        }
+        PyList_SET_ITEM(message->d_data_buffers, 0, view.release().first);
+    }
+    return newReference(message->d_data_buffers);
+}
+
+extern "C" int
+message_set_data(PyObject* self, PyObject* value, void*)
+{
+    // A new payload replaces both of its representations.
+    Message* message = reinterpret_cast<Message*>(self);
+    return replaceMember(
+            self,
+            &message->d_data,
+            value,
+            &message->d_data_buffers);
+}
+
+extern "C" int
+message_set_data_buffers(PyObject* self, PyObject* value, void*)
+{
+    Message* message = reinterpret_cast<Message*>(self);
+    return replaceMember(
+            self,
+            &message->d_data_buffers,
+            value,
+            &message->d_data);
+}
+
+extern "C" PyObject*
+message_get_property_types(PyObject* self, void*)
+{
+    CriticalSectionGuard guard(self);
+    Message* message = reinterpret_cast<Message*>(self);
+    if (message->d_property_type_codes) {
+        bslma::ManagedPtr<PyObject> property_types =
+                RefUtils::toManagedPtr(PyDict_New());
+        if (!property_types) {
+            return NULL;
+        }
+        PyObject* name;
+        PyObject* code;
+        Py_ssize_t pos = 0;
+        while (PyDict_Next(message->d_property_types, &pos, &name, &code)) {
+            PyObject* property_type = PyDict_GetItemWithError(g_property_types, code);
+            if (!property_type) {
+                if (!PyErr_Occurred()) {
+                    PyErr_SetObject(PyExc_KeyError, code);
+                }
+                return NULL;
+            }
+            if (PyDict_SetItem(property_types.get(), name, property_type)) {
+                return NULL;
+            }
+        }
+        Py_DECREF(message->d_property_types);
+        message->d_property_types = property_types.release().first;
+        message->d_property_type_codes = false;
+    }
+    return newReference(message->d_property_types);
+}
+
+extern "C" int
+message_set_property_types(PyObject* self, PyObject* value, void*)
+{
+    if (!value) {
+        PyErr_SetString(PyExc_AttributeError, "attribute cannot be deleted");
+        return -1;
+    }
+    Message* message = reinterpret_cast<Message*>(self);
+    PyObject* old;
+    {
+        CriticalSectionGuard guard(self);
+        old = message->d_property_types;
+        message->d_property_types = newReference(value);
+        message->d_property_type_codes = false;
+    }
+    Py_DECREF(old);
+    return 0;
+}
+
+extern "C" PyObject*
+message_repr(PyObject* self)
+{
+    CriticalSectionGuard guard(self);
+    Message* message = reinterpret_cast<Message*>(self);
+    bslma::ManagedPtr<PyObject> guid =
+            RefUtils::toManagedPtr(prettyHex(message->d_guid));
+    if (!guid) {
+        return NULL;
+    }
+    return PyUnicode_FromFormat(
+            "<Message[%U] for %S>",
+            guid.get(),
+            message->d_queue_uri);
+}
+
+PyGetSetDef message_getset[] = {
+        {const_cast<char*>("data"),
+         message_get_data,
+         message_set_data,
+         const_cast<char*>("bytes: the payload of the message"),
+         NULL},
+        {const_cast<char*>("data_buffers"),
+         message_get_data_buffers,
+         message_set_data_buffers,
+         const_cast<char*>("list[memoryview]: the payload of the message, as "
+                           "views over the buffers it was received in"),
+         NULL},
+        {const_cast<char*>("guid"),
+         get_member,
+         set_member,
+         const_cast<char*>("bytes: the globally unique id of the message"),
+         reinterpret_cast<void*>(offsetof(Message, d_guid))},
+        {const_cast<char*>("queue_uri"),
+         get_member,
+         set_member,
+         const_cast<char*>("str: the URI of the queue the message is for"),
+         reinterpret_cast<void*>(offsetof(Message, d_queue_uri))},
+        {const_cast<char*>("properties"),
+         get_member,
+         set_member,
+         const_cast<char*>("dict: the properties of the message"),
+         reinterpret_cast<void*>(offsetof(Message, d_properties))},
+        {const_cast<char*>("property_types"),
+         message_get_property_types,
+         message_set_property_types,
+         const_cast<char*>("dict: the `PropertyType` of each property"),
+         NULL},
+        {const_cast<char*>("__dict__"),
+         PyObject_GenericGetDict,
+         PyObject_GenericSetDict,
+         NULL,
+         NULL},
+        {NULL, NULL, NULL, NULL, NULL}};
+
+struct MessageHandle
+{
+    // The Python 'MessageHandle' object.
+
+    PyObject ob_base;
+    PyObject* d_message;  // always a 'Message'
+    PyObject* d_ext_session;
+    PyObject* d_dict;  // null until an attribute of its own is set
+};
+
+extern "C" int
+message_handle_traverse(PyObject* self, visitproc visit, void* arg)
+{
+    MessageHandle* handle = reinterpret_cast<MessageHandle*>(self);
+    Py_VISIT(handle->d_message);
+    Py_VISIT(handle->d_ext_session);
+    Py_VISIT(handle->d_dict);
+    return 0;
+}
+
+extern "C" int
+message_handle_clear(PyObject* self)
+{
+    MessageHandle* handle = reinterpret_cast<MessageHandle*>(self);
+    Py_CLEAR(handle->d_message);
+    Py_CLEAR(handle->d_ext_session);
+    Py_CLEAR(handle->d_dict);
+    return 0;
+}
+
+extern "C" void
+message_handle_dealloc(PyObject* self)
+{
+    PyObject_GC_UnTrack(self);
+    message_handle_clear(self);
+    PyObject_GC_Del(self);
+}
+
+extern "C" int
+message_handle_set_message(PyObject* self, PyObject* value, void*)
+{
+    // The other methods rely on the message being a 'Message'.
+    if (value && !PyObject_TypeCheck(value, &g_message_type)) {
+        PyErr_Format(
+                PyExc_TypeError,
+                "expected Message, not '%.200s'",
+                Py_TYPE(value)->tp_name);
+        return -1;
+    }
+    return replaceMember(
+            self,
+            &reinterpret_cast<MessageHandle*>(self)->d_message,
+            value);
+}
+
+void
+loadHandle(
+        bslma::ManagedPtr<PyObject>* message,
+        bslma::ManagedPtr<PyObject>* ext_session,
+        PyObject* self)
+{
+    // Load new references to the message and the session of the specified
+    // 'self' handle into the specified 'message' and 'ext_session'.
+    CriticalSectionGuard guard(self);
+    const MessageHandle& handle = *reinterpret_cast<MessageHandle*>(self);
+    *message = RefUtils::toManagedPtr(newReference(handle.d_message));
+    *ext_session = RefUtils::toManagedPtr(newReference(handle.d_ext_session));
+}
+
+extern "C" PyObject*
+message_handle_confirm(PyObject* self, PyObject*)
+{
+    bslma::ManagedPtr<PyObject> message;
+    bslma::ManagedPtr<PyObject> ext_session;
+    loadHandle(&message, &ext_session, self);
+    return PyObject_CallMethod(ext_session.get(), "confirm", "(O)", message.get());
+}
+
+extern "C" PyObject*
+message_handle_confirm_many(PyObject*, PyObject* handles)
+{
+    // Batches are keyed on the identity of their session, in the order the
+    // sessions are first seen.
+    bslma::ManagedPtr<PyObject> batches = RefUtils::toManagedPtr(PyDict_New());
+    bslma::ManagedPtr<PyObject> iterator =
+            RefUtils::toManagedPtr(PyObject_GetIter(handles));
+    if (!batches || !iterator) {
+        return NULL;
+    }
+
+    while (PyObject* item = PyIter_Next(iterator.get())) {
+        bslma::ManagedPtr<PyObject> owner = RefUtils::toManagedPtr(item);
+        if (!PyObject_TypeCheck(item, &g_message_handle_type)) {
+            PyErr_Format(
+                    PyExc_TypeError,
+                    "expected MessageHandle, not '%.200s'",
+                    Py_TYPE(item)->tp_name);
+            return NULL;
+        }
+        bslma::ManagedPtr<PyObject> message;
+        bslma::ManagedPtr<PyObject> ext_session;
+        loadHandle(&message, &ext_session, item);
+        bslma::ManagedPtr<PyObject> key =
+                RefUtils::toManagedPtr(PyLong_FromVoidPtr(ext_session.get()));
+        if (!key) {
+            return NULL;
+        }
+        PyObject* batch = PyDict_GetItemWithError(batches.get(), key.get());
+        if (!batch) {
+            if (PyErr_Occurred()) {
+                return NULL;
+            }
+            bslma::ManagedPtr<PyObject> new_batch = RefUtils::toManagedPtr(
+                    Py_BuildValue("(O N)", ext_session.get(), PyList_New(0)));
+            if (!new_batch
+                || PyDict_SetItem(batches.get(), key.get(), new_batch.get()))
+            {
+                return NULL;
+            }
+            batch = new_batch.get();
+        }
+        if (PyList_Append(PyTuple_GET_ITEM(batch, 1), message.get())) {
+            return NULL;
+        }
+    }
+    if (PyErr_Occurred()) {
+        return NULL;
+    }
+
+    PyObject* key;
+    PyObject* batch;
+    Py_ssize_t pos = 0;
+    while (PyDict_Next(batches.get(), &pos, &key, &batch)) {
+        bslma::ManagedPtr<PyObject> rv = RefUtils::toManagedPtr(PyObject_CallMethod(
+                PyTuple_GET_ITEM(batch, 0),
+                "confirm_many",
+                "(O)",
+                PyTuple_GET_ITEM(batch, 1)));
+        if (!rv) {
+            return NULL;
+        }
+    }
+    Py_RETURN_NONE;
+}
+
+extern "C" PyObject*
+message_handle_repr(PyObject* self)
+{
+    bslma::ManagedPtr<PyObject> message_owner;
+    bslma::ManagedPtr<PyObject> ext_session;
+    loadHandle(&message_owner, &ext_session, self);
+    CriticalSectionGuard guard(message_owner.get());
+    const Message& message = *reinterpret_cast<Message*>(message_owner.get());
+    bslma::ManagedPtr<PyObject> guid =
+            RefUtils::toManagedPtr(prettyHex(message.d_guid));
+    if (!guid) {
+        return NULL;
+    }
+    return PyUnicode_FromFormat(
+            "<MessageHandle[%U] for %S>",
+            guid.get(),
+            message.d_queue_uri);
+}
+
+PyGetSetDef message_handle_getset[] = {
+        {const_cast<char*>("_message"),
+         get_member,
+         message_handle_set_message,
+         NULL,
+         reinterpret_cast<void*>(offsetof(MessageHandle, d_message))},
+        {const_cast<char*>("_ext_session"),
+         get_member,
+         set_member,
+         NULL,
+         reinterpret_cast<void*>(offsetof(MessageHandle, d_ext_session))},
+        {const_cast<char*>("__dict__"),
+         PyObject_GenericGetDict,
+         PyObject_GenericSetDict,
+         NULL,
+         NULL},
+        {NULL, NULL, NULL, NULL, NULL}};
+
+PyMethodDef message_handle_methods[] = {
+        {"confirm",
+         message_handle_confirm,
+         METH_NOARGS,
+         "confirm()\n"
+         "--\n\n"
+         "Confirm the message received along with this handle.\n\n"
+         "See `Session.confirm` for more details.\n\n"
+         "Raises:\n"
+         "    `~blazingmq.Error`: If the confirm message request\n"
+         "        was not successful.\n"},
+        {"confirm_many",
+         message_handle_confirm_many,
+         METH_O | METH_STATIC,
+         "confirm_many(handles)\n"
+         "--\n\n"
+         "Confirm the messages received along with each of *handles*.\n\n"
+         "The confirmations for each `Session` are sent as a single batch. See\n"
+         "`Session.confirm_many` for more details.\n\n"
+         "Raises:\n"
+         "    `~blazingmq.Error`: If the confirm message request\n"
+         "        was not successful.\n"},
+        {NULL, NULL, 0, NULL}};
+
+struct Ack
+{
+    // The Python 'Ack' object.
+
+    PyObject ob_base;
+    PyObject* d_guid;
+    PyObject* d_status;
+    PyObject* d_status_description;
+    PyObject* d_queue_uri;
+    PyObject* d_dict;  // null until an attribute of its own is set
+};
+
+extern "C" int
+ack_traverse(PyObject* self, visitproc visit, void* arg)
+{
+    Ack* ack = reinterpret_cast<Ack*>(self);
+    Py_VISIT(ack->d_guid);
+    Py_VISIT(ack->d_status);
+    Py_VISIT(ack->d_status_description);
+    Py_VISIT(ack->d_queue_uri);
+    Py_VISIT(ack->d_dict);
+    return 0;
+}
+
+extern "C" int
+ack_clear(PyObject* self)
+{
+    Ack* ack = reinterpret_cast<Ack*>(self);
+    Py_CLEAR(ack->d_guid);
+    Py_CLEAR(ack->d_status);
+    Py_CLEAR(ack->d_status_description);
+    Py_CLEAR(ack->d_queue_uri);
+    Py_CLEAR(ack->d_dict);
+    return 0;
+}
+
+extern "C" void
+ack_dealloc(PyObject* self)
+{
+    PyObject_GC_UnTrack(self);
+    ack_clear(self);
+    PyObject_GC_Del(self);
+}
+
+extern "C" PyObject*
+ack_repr(PyObject* self)
+{
+    CriticalSectionGuard guard(self);
+    const Ack& ack = *reinterpret_cast<Ack*>(self);
+    if (ack.d_guid == Py_None) {
+        return PyUnicode_FromFormat(
+                "<Ack %S for %S>",
+                ack.d_status_description,
+                ack.d_queue_uri);
+    }
+    bslma::ManagedPtr<PyObject> guid = RefUtils::toManagedPtr(prettyHex(ack.d_guid));
+    if (!guid) {
+        return NULL;
+    }
+    return PyUnicode_FromFormat(
+            "<Ack[%U] %S for %S>",
+            guid.get(),
+            ack.d_status_description,
+            ack.d_queue_uri);
+}
+
+PyGetSetDef ack_getset[] = {
+        {const_cast<char*>("guid"),
+         get_member,
+         set_member,
+         const_cast<char*>("bytes: the globally unique id of the posted message"),
+         reinterpret_cast<void*>(offsetof(Ack, d_guid))},
+        {const_cast<char*>("status"),
+         get_member,
+         set_member,
+         const_cast<char*>("AckStatus: the result of the post operation"),
+         reinterpret_cast<void*>(offsetof(Ack, d_status))},
+        {const_cast<char*>("queue_uri"),
+         get_member,
+         set_member,
+         const_cast<char*>("str: the URI of the queue the message was posted to"),
+         reinterpret_cast<void*>(offsetof(Ack, d_queue_uri))},
+        {const_cast<char*>("_status_description"),
+         get_member,
+         set_member,
+         NULL,
+         reinterpret_cast<void*>(offsetof(Ack, d_status_description))},
+        {const_cast<char*>("__dict__"),
+         PyObject_GenericGetDict,
+         PyObject_GenericSetDict,
+         NULL,
+         NULL},
+        {NULL, NULL, NULL, NULL, NULL}};
+
+const char k_MESSAGE_DOC[] =
+        "A class representing a message received from BlazingMQ.\n"
+        "\n"
+        "A `Message` represents a message delivered by BlazingMQ from a producer\n"
+        "to this queue. This message can only be received if the queue is\n"
+        "opened with 'read=True' mode enabled.\n"
+        "\n"
+        "Attributes:\n"
+        "    data (bytes): Payload for the message received from BlazingMQ. If the\n"
+        "        `Session` was created with ``zero_copy_payloads=True``, this is a\n"
+        "        read-only :class:`memoryview` instead.\n"
+        "    data_buffers (list[memoryview]): The payload as a list of read-only\n"
+        "        views over the buffers it was received in. With\n"
+        "        ``zero_copy_payloads=True`` these refer to the SDK's own buffers,\n"
+        "        which stay allocated for as long as any view is alive.\n"
+        "    guid (bytes): Globally unique id for this message.\n"
+        "    queue_uri (str): Queue URI this message is for.\n"
+        "    properties (dict): A dictionary of BlazingMQ message properties.\n"
+        "        The dictionary keys must be :class:`str` representing the property\n"
+        "        names and the values must be of type :class:`str`, :class:`bytes`,\n"
+        "        :class:`bool` or :class:`int`.  If the queue was opened with\n"
+        "        ``lazy_properties=True``, this is a read-only mapping that decodes\n"
+        "        each value only when it is looked up.\n"
+        "    property_types (dict): A mapping of property names to\n"
+        "        `PropertyType` types. The dictionary is guaranteed to provide\n"
+        "        a value for each key already present in `Message.properties`\n";
+
+const char k_MESSAGE_HANDLE_DOC[] =
+        "Operations that can be performed on a `Message`.\n"
+        "\n"
+        "An instance of this class is received in the ``on_message``\n"
+        "callback along with an instance of a `Message`.\n";
+
+const char k_ACK_DOC[] =
+        "Acknowledgment message\n"
+        "\n"
+        "An `Ack` is a notification from BlazingMQ to the application,\n"
+        "specifying that the message has been received. This is valuable\n"
+        "for ensuring delivery of messages.\n"
+        "\n"
+        "These messages will be received in the optionally provided callback to\n"
+        "`Session.post()`.\n"
+        "\n"
+        "An `Ack` is by itself not an indication of success unless it has a\n"
+        "status of `AckStatus.SUCCESS`.\n"
+        "\n"
+        "Attributes:\n"
+        "    guid (bytes): a globally unique identifier generated by BlazingMQ for\n"
+        "        the message that was successfully posted. This can be correlated\n"
+        "        between the producer and consumer to verify the flow of messages.\n"
+        "    queue_uri (str): the queue that this message was routed to. This is\n"
+        "        useful if you have many queues and you want to route this\n"
+        "        particular `Ack` to a particular queue.\n"
+        "    status (AckStatus): the `AckStatus` indicating the result of the post\n"
+        "        operation. Unless this is of type `AckStatus.SUCCESS`, the post\n"
+        "        has failed and potentially needs to be dealt with.\n";
+
+}  // namespace
+
+bool
+MessageTypes::initialize(
+        PyObject* error,
+        PyObject* property_types,
+        PyObject* ack_statuses,
+        PyObject* unrecognized_ack_status,
+        PyObject* lazy_properties_factory)
+{
+    g_error = newReference(error);
+    g_property_types = newReference(property_types);
+    g_ack_statuses = newReference(ack_statuses);
+    g_unrecognized_ack_status = newReference(unrecognized_ack_status);
+    g_lazy_properties_factory = newReference(lazy_properties_factory);
+
+    g_message_type.tp_name = "blazingmq.Message";
+    g_message_type.tp_doc = k_MESSAGE_DOC;
+    g_message_type.tp_basicsize = sizeof(Message);
+    g_message_type.tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC;
+    g_message_type.tp_new = no_public_constructor;
+    g_message_type.tp_dealloc = message_dealloc;
+    g_message_type.tp_traverse = message_traverse;
+    g_message_type.tp_clear = message_clear;
+    g_message_type.tp_getset = message_getset;
+    g_message_type.tp_repr = message_repr;
+    g_message_type.tp_dictoffset = offsetof(Message, d_dict);
+
+    g_message_handle_type.tp_name = "blazingmq.MessageHandle";
+    g_message_handle_type.tp_doc = k_MESSAGE_HANDLE_DOC;
+    g_message_handle_type.tp_basicsize = sizeof(MessageHandle);
+    g_message_handle_type.tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC;
+    g_message_handle_type.tp_new = no_public_constructor;
+    g_message_handle_type.tp_dealloc = message_handle_dealloc;
+    g_message_handle_type.tp_traverse = message_handle_traverse;
+    g_message_handle_type.tp_clear = message_handle_clear;
+    g_message_handle_type.tp_methods = message_handle_methods;
+    g_message_handle_type.tp_getset = message_handle_getset;
+    g_message_handle_type.tp_repr = message_handle_repr;
+    g_message_handle_type.tp_dictoffset = offsetof(MessageHandle, d_dict);
+
+    g_ack_type.tp_name = "blazingmq.Ack";
+    g_ack_type.tp_doc = k_ACK_DOC;
+    g_ack_type.tp_basicsize = sizeof(Ack);
+    g_ack_type.tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC;
+    g_ack_type.tp_new = no_public_constructor;
+    g_ack_type.tp_dealloc = ack_dealloc;
+    g_ack_type.tp_traverse = ack_traverse;
+    g_ack_type.tp_clear = ack_clear;
+    g_ack_type.tp_getset = ack_getset;
+    g_ack_type.tp_repr = ack_repr;
+    g_ack_type.tp_dictoffset = offsetof(Ack, d_dict);
+
+    return 0 == PyType_Ready(&g_message_type)
+           && 0 == PyType_Ready(&g_message_handle_type)
+           && 0 == PyType_Ready(&g_ack_type);
+}
+
+PyTypeObject*
+MessageTypes::message_type()
+{
+    return &g_message_type;
+}
+
+PyTypeObject*
+MessageTypes::message_handle_type()
+{
+    return &g_message_handle_type;
+}
+
+PyTypeObject*
+MessageTypes::ack_type()
+{
+    return &g_ack_type;
+}
+
+PyObject*
+MessageTypes::create_message(
+        PyObject* data,
+        PyObject* data_buffers,
+        PyObject* guid,
+        PyObject* queue_uri,
+        PyObject* properties,
+        PyObject* property_types,
+        bool property_type_codes)
+{
+    Message* message = PyObject_GC_New(Message, &g_message_type);
+    if (!message) {
+        return NULL;
+    }
+    message->d_data = data == Py_None ? NULL : data;
+    message->d_data_buffers = data_buffers == Py_None ? NULL : data_buffers;
+    message->d_guid = guid;
+    message->d_queue_uri = queue_uri;
+    message->d_properties = properties;
+    message->d_property_types = property_types;
+    message->d_property_type_codes = property_type_codes;
+    message->d_dict = NULL;
+    Py_XINCREF(message->d_data);
+    Py_XINCREF(message->d_data_buffers);
+    Py_INCREF(guid);
+    Py_INCREF(queue_uri);
+    Py_INCREF(properties);
+    Py_INCREF(property_types);
+    PyObject_GC_Track(message);
+    return reinterpret_cast<PyObject*>(message);
+}
+
+PyObject*
+MessageTypes::wrap_lazy_properties(PyObject* native_properties)
+{
+    return PyObject_CallFunctionObjArgs(
+            g_lazy_properties_factory,
+            native_properties,
+            NULL);
+}
+
+PyObject*
+MessageTypes::create_message_handle(PyObject* message, PyObject* ext_session)
+{
+    if (!PyObject_TypeCheck(message, &g_message_type)) {
+        PyErr_Format(
+                PyExc_TypeError,
+                "expected Message, not '%.200s'",
+                Py_TYPE(message)->tp_name);
+        return NULL;
+    }
+    MessageHandle* handle = PyObject_GC_New(MessageHandle, &g_message_handle_type);
+    if (!handle) {
+        return NULL;
+    }
+    handle->d_message = newReference(message);
+    handle->d_ext_session = newReference(ext_session);
+    handle->d_dict = NULL;
+    PyObject_GC_Track(handle);
+    return reinterpret_cast<PyObject*>(handle);
+}
+
+PyObject*
+MessageTypes::create_ack(
+        PyObject* guid,
+        PyObject* status,
+        PyObject* status_description,
+        PyObject* queue_uri)
+{
+    Ack* ack = PyObject_GC_New(Ack, &g_ack_type);
+    if (!ack) {
+        return NULL;
+    }
+    ack->d_guid = newReference(guid);
+    ack->d_status = newReference(status);
+    ack->d_status_description = newReference(status_description);
+    ack->d_queue_uri = newReference(queue_uri);
+    ack->d_dict = NULL;
+    PyObject_GC_Track(ack);
+    return reinterpret_cast<PyObject*>(ack);
+}
+
+PyObject*
+MessageTypes::ack_status(int status)
+{
+    bslma::ManagedPtr<PyObject> code = RefUtils::toManagedPtr(PyLong_FromLong(status));
+    PyObject* py_status = code ? PyDict_GetItem(g_ack_statuses, code.get()) : NULL;
+    PyErr_Clear();
+    return py_status ? py_status : g_unrecognized_ack_status;
+}
+
+}  // namespace pybmq
+}  // namespace BloombergLP
@@ -0,0 +1,104 @@
+// Copyright 2019-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_PYBMQ_MESSAGETYPES
+#define INCLUDED_PYBMQ_MESSAGETYPES
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+namespace BloombergLP {
+namespace pybmq {
+
+struct MessageTypes
+{
+    // This utility provides the extension types of the 'Message',
+    // 'MessageHandle' and 'Ack' objects passed to Python, so that they are
+    // filled in directly from C++ rather than built by Python code out of
+    // tuples.  Like any other Python object, the objects created here may
+    // only be used with the GIL held.
+
+    // CLASS METHODS
+    static bool initialize(
+            PyObject* error,
+            PyObject* property_types,
+            PyObject* ack_statuses,
+            PyObject* unrecognized_ack_status,
+            PyObject* lazy_properties_factory);
+    // Ready the types, keeping a reference to each of the specified arguments:
+    // the 'error' class raised when Python code tries to construct an object
+    // itself, the 'property_types' and 'ack_statuses' dictionaries mapping SDK
+    // codes to their Python enumerators, the 'unrecognized_ack_status' of
+    // acknowledgements whose code is missing from 'ack_statuses', and the
+    // 'lazy_properties_factory' called by 'wrap_lazy_properties'.  Return false
+    // with a Python exception set on failure.  This must be called once, when
+    // the extension module is imported, before any other method.
+
+    static PyTypeObject* message_type();
+    // Return the 'Message' type.
+
+    static PyTypeObject* message_handle_type();
+    // Return the 'MessageHandle' type.
+
+    static PyTypeObject* ack_type();
+    // Return the 'Ack' type.
+
+    static PyObject* create_message(
+            PyObject* data,
+            PyObject* data_buffers,
+            PyObject* guid,
+            PyObject* queue_uri,
+            PyObject* properties,
+            PyObject* property_types,
+            bool property_type_codes);
+    // Return a new 'Message' holding new references to the specified 'data',
+    // 'data_buffers', 'guid', 'queue_uri', 'properties' and 'property_types',
+    // or null with a Python exception set on failure.  Either of 'data' and
+    // 'data_buffers' may be null or 'None', and is then computed from the
+    // other the first time it is accessed.  If the specified
+    // 'property_type_codes' is true, 'property_types' maps each property name
+    // to its SDK type code, and is only converted to 'PropertyType' values the
+    // first time it is accessed.
+
+    static PyObject* wrap_lazy_properties(PyObject* native_properties);
+    // Return a tuple of the 'properties' and 'property_types' of a 'Message'
+    // received with lazy properties, decoding them on demand from the
+    // specified 'native_properties' returned by
+    // 'MessageUtils::get_lazy_message_properties', or null with a Python
+    // exception set on failure.
+
+    static PyObject* create_message_handle(PyObject* message, PyObject* ext_session);
+    // Return a new 'MessageHandle' confirming the specified 'message' through
+    // the specified 'ext_session', or null with a Python exception set on
+    // failure.
+
+    static PyObject* create_ack(
+            PyObject* guid,
+            PyObject* status,
+            PyObject* status_description,
+            PyObject* queue_uri);
+    // Return a new 'Ack' holding new references to the specified 'guid',
+    // 'status', 'status_description' and 'queue_uri', or null with a Python
+    // exception set on failure.
+
+    static PyObject* ack_status(int status);
+    // Return a borrowed reference to the 'AckStatus' enumerator of the
+    // specified SDK 'status' code.
+};
+
+}  // namespace pybmq
+}  // namespace BloombergLP
+
+#endif
@@ -13,23 +13,37 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <pybmq_bufferutils.h>
+#include <pybmq_criticalsectionguard.h>
+#include <pybmq_messagetypes.h>
 #include <pybmq_messageutils.h>
 #include <pybmq_refutils.h>
+#include <pybmq_stringcache.h>
 
 #include <bdlbb_blob.h>
 #include <bdlbb_blobutil.h>
+#include <bdlma_localsequentialallocator.h>
+#include <bsl_algorithm.h>
+#include <bsl_cstddef.h>
 #include <bsl_sstream.h>
 #include <bslmf_assert.h>
+#include <bsls_types.h>
 
 #include <bmqt_messageguid.h>
 #include <bmqt_propertytype.h>
 #include <bmqt_resultcode.h>
 
+#include <new>
+
 namespace BloombergLP {
 namespace pybmq {
 
 namespace {
 
+enum {
+    k_CONVERSION_ARENA_SIZE = 4096  // bytes of stack used to convert a message
+};
+
 // Support needs to be added in this file for any new property type added to
 // the C++ BlazingMQ SDK.  Since we can't write automated tests for
 // unrecognized property types, any code attempting to handle them cannot be
@@ -79,10 +93,310 @@ toIntegralWithRangeCheck(PyObject* obj, const bsl::string& key)
     return val;
 }
 
+class IteratorPropertyReader
+{
+    // Read the value of the property a 'bmqa::MessagePropertiesIterator' is
+    // positioned at.
+
+    const bmqa::MessagePropertiesIterator& d_iterator;
+
+  public:
+    explicit IteratorPropertyReader(const bmqa::MessagePropertiesIterator& iterator)
+    : d_iterator(iterator)
+    {
+    }
+
+    bool asBool() const { return d_iterator.getAsBool(); }
+    char asChar() const { return d_iterator.getAsChar(); }
+    short asShort() const { return d_iterator.getAsShort(); }
+    int asInt32() const { return d_iterator.getAsInt32(); }
+    bsls::Types::Int64 asInt64() const { return d_iterator.getAsInt64(); }
+    const bsl::string& asString() const { return d_iterator.getAsString(); }
+    const bsl::vector<char>& asBinary() const { return d_iterator.getAsBinary(); }
+};
+
+class NamedPropertyReader
+{
+    // Read the value of the property with a given name in a
+    // 'bmqa::MessageProperties'.
+
+    const bmqa::MessageProperties& d_properties;
+    const bsl::string& d_name;
+
+  public:
+    NamedPropertyReader(
+            const bmqa::MessageProperties& properties,
+            const bsl::string& name)
+    : d_properties(properties)
+    , d_name(name)
+    {
+    }
+
+    bool asBool() const { return d_properties.getPropertyAsBool(d_name); }
+    char asChar() const { return d_properties.getPropertyAsChar(d_name); }
+    short asShort() const { return d_properties.getPropertyAsShort(d_name); }
+    int asInt32() const { return d_properties.getPropertyAsInt32(d_name); }
+    bsls::Types::Int64 asInt64() const
+    {
+        return d_properties.getPropertyAsInt64(d_name);
+    }
+    const bsl::string& asString() const
+    {
+        return d_properties.getPropertyAsString(d_name);
+    }
+    const bsl::vector<char>& asBinary() const
+    {
+        return d_properties.getPropertyAsBinary(d_name);
+    }
+};
+
+template<typename READER>
+PyObject*
+convertPropertyValue(bmqt::PropertyType::Enum ptype, const READER& reader)
+{
+    switch (ptype) {
+        case bmqt::PropertyType::e_BOOL: {
+            return PyBool_FromLong(reader.asBool());
+        }
+
+        case bmqt::PropertyType::e_CHAR: {
+            const char the_char = reader.asChar();
+            return PyBytes_FromStringAndSize(&the_char, 1);
+        }
+
+        case bmqt::PropertyType::e_STRING: {
+            const bsl::string& the_string = reader.asString();
+            return PyUnicode_FromStringAndSize(the_string.c_str(), the_string.length());
+        }
+
+        case bmqt::PropertyType::e_BINARY: {
+            const bsl::vector<char>& the_data = reader.asBinary();
+            return PyBytes_FromStringAndSize(the_data.data(), the_data.size());
+        }
+
+        case bmqt::PropertyType::e_SHORT: {
+            return PyLong_FromLongLong(reader.asShort());
+        }
+
+        case bmqt::PropertyType::e_INT32: {
+            return PyLong_FromLongLong(reader.asInt32());
+        }
+
+        case bmqt::PropertyType::e_INT64: {
+            return PyLong_FromLongLong(reader.asInt64());
+        }
+
+        case bmqt::PropertyType::e_UNDEFINED:
+        default: {
+            bsl::ostringstream oss;
+            oss << "Unsupported property type " << ptype;
+            PyErr_SetString(PyExc_RuntimeError, oss.str().c_str());
+            return NULL;
+        }
+    }
+}
+
+bool
+setPropertyType(
+        PyObject* property_types,
+        const bsl::string& name,
+        bmqt::PropertyType::Enum ptype)
+{
+    bslma::ManagedPtr<PyObject> type_code =
+            RefUtils::toManagedPtr(PyLong_FromLong(ptype));
+    return type_code
+           && 0 == PyDict_SetItemString(property_types, name.c_str(), type_code.get());
+}
+
+template<typename READER>
+bool
+storeProperty(
+        PyObject* properties,
+        PyObject* property_types,
+        bsl::vector<bsl::string>* collated_errors,
+        const bsl::string& name,
+        bmqt::PropertyType::Enum ptype,
+        const READER& reader)
+{
+    if (!MessageUtils::is_supported_property_type(ptype)) {
+        bsl::ostringstream oss;
+        oss << "'" << name << "' property type is unrecognized, type " << ptype
+            << " received.";
+        collated_errors->push_back(oss.str());
+        return true;  // Skip this property; we've enqueued an InterfaceError
+    }
+
+    bslma::ManagedPtr<PyObject> value =
+            RefUtils::toManagedPtr(convertPropertyValue(ptype, reader));
+    if (!value) {
+        if (ptype == bmqt::PropertyType::e_STRING
+            && PyErr_ExceptionMatches(PyExc_UnicodeDecodeError))
+        {
+            PyErr_Clear();
+            collated_errors->push_back(
+                    "STRING property '" + name + "' has non-UTF-8 data");
+            return true;  // Skip this property; we've enqueued an InterfaceError
+        }
+        return false;
+    }
+
+    if (PyDict_SetItemString(properties, name.c_str(), value.get())) {
+        return false;
+    }
+
+    return setPropertyType(property_types, name, ptype);
+}
+
+typedef bsl::shared_ptr<const bsl::vector<bsl::string> > ProjectionSp;
+
+struct LazyProperties
+{
+    // The Python object returned by 'MessageUtils::get_lazy_message_properties'.
+
+    PyObject ob_base;
+    bmqa::MessageProperties d_properties;
+    ProjectionSp d_projection_sp;
+};
+
+bool
+isProjected(const LazyProperties& lazy, const bsl::string& name)
+{
+    return !lazy.d_projection_sp
+           || lazy.d_projection_sp->end()
+                      != bsl::find(
+                              lazy.d_projection_sp->begin(),
+                              lazy.d_projection_sp->end(),
+                              name);
+}
+
+extern "C" void
+lazy_properties_dealloc(PyObject* self)
+{
+    LazyProperties* lazy = reinterpret_cast<LazyProperties*>(self);
+    lazy->d_projection_sp.~ProjectionSp();
+    lazy->d_properties.~MessageProperties();
+    PyObject_Del(self);
+}
+
+extern "C" PyObject*
+lazy_properties_types(PyObject* self, PyObject*)
+{
+    // Decoding properties may update the state of 'd_properties'.
+    CriticalSectionGuard guard(self);
+    const LazyProperties& lazy = *reinterpret_cast<LazyProperties*>(self);
+    bslma::ManagedPtr<PyObject> property_types = RefUtils::toManagedPtr(PyDict_New());
+    if (!property_types) {
+        return NULL;
+    }
+
+    if (lazy.d_projection_sp) {
+        const bsl::vector<bsl::string>& projection = *lazy.d_projection_sp;
+        for (size_t i = 0; i < projection.size(); ++i) {
+            bmqt::PropertyType::Enum ptype;
+            if (lazy.d_properties.hasProperty(projection[i], &ptype)
+                && MessageUtils::is_supported_property_type(ptype)
+                && !setPropertyType(property_types.get(), projection[i], ptype))
+            {
+                return NULL;
+            }
+        }
+    } else {
+        bmqa::MessagePropertiesIterator propIter(&lazy.d_properties);
+        while (propIter.hasNext()) {
+            if (MessageUtils::is_supported_property_type(propIter.type())
+                && !setPropertyType(
+                        property_types.get(),
+                        propIter.name(),
+                        propIter.type()))
+            {
+                return NULL;
+            }
+        }
+    }
+    return property_types.release().first;
+}
+
+extern "C" PyObject*
+lazy_properties_get(PyObject* self, PyObject* py_name)
+{
+    const LazyProperties& lazy = *reinterpret_cast<LazyProperties*>(self);
+    if (!PyUnicode_Check(py_name)) {
+        PyErr_Format(
+                PyExc_TypeError,
+                "property names must be str, not '%.200s'",
+                Py_TYPE(py_name)->tp_name);
+        return NULL;
+    }
+
+    Py_ssize_t length;
+    const char* c_name = PyUnicode_AsUTF8AndSize(py_name, &length);
+    if (!c_name) {
+        return NULL;
+    }
+
+    const bsl::string name(c_name, length);
+    CriticalSectionGuard guard(self);
+    bmqt::PropertyType::Enum ptype;
+    if (!isProjected(lazy, name) || !lazy.d_properties.hasProperty(name, &ptype)
+        || !MessageUtils::is_supported_property_type(ptype))
+    {
+        PyErr_SetObject(PyExc_KeyError, py_name);
+        return NULL;
+    }
+    return MessageUtils::get_message_property_value(lazy.d_properties, name, ptype);
+}
+
+PyMethodDef lazy_properties_methods[] = {
+        {"types",
+         lazy_properties_types,
+         METH_NOARGS,
+         "Return a dict mapping each property name to its type code"},
+        {"get", lazy_properties_get, METH_O, "Return the value of the named property"},
+        {NULL, NULL, 0, NULL}};
+
+PyTypeObject lazy_properties_type = {PyVarObject_HEAD_INIT(NULL, 0)};
+
+bool
+readyLazyPropertiesTypeUnlocked()
+{
+    if (lazy_properties_type.tp_flags & Py_TPFLAGS_READY) {
+        return true;
+    }
+
+    lazy_properties_type.tp_name = "blazingmq._ext.LazyProperties";
+    lazy_properties_type.tp_doc = "The properties of a message received from BlazingMQ";
+    lazy_properties_type.tp_basicsize = sizeof(LazyProperties);
+    lazy_properties_type.tp_flags = Py_TPFLAGS_DEFAULT;
+    lazy_properties_type.tp_dealloc = lazy_properties_dealloc;
+    lazy_properties_type.tp_methods = lazy_properties_methods;
+    return 0 == PyType_Ready(&lazy_properties_type);
+}
+
+bool
+readyLazyPropertiesType()
+{
+#ifdef Py_GIL_DISABLED
+    // Without a GIL, several threads may try to ready the type at once.  A
+    // 'PyMutex' detaches the threads waiting for it, so they can't block a
+    // garbage collection triggered by the thread readying the type.
+    static PyMutex lock = {0};
+    PyMutex_Lock(&lock);
+    bool ready = readyLazyPropertiesTypeUnlocked();
+    PyMutex_Unlock(&lock);
+    return ready;
+#else
+    return readyLazyPropertiesTypeUnlocked();
+#endif
+}
+
 }  // namespace
 
 PyObject*
-MessageUtils::get_acks(const bmqa::MessageEvent& event)
+MessageUtils::get_acks(
+        const bmqa::MessageEvent& event,
+        StringCache* string_cache,
+        PyObject* ack_ids,
+        PyObject* ack_statuses)
 {
     bslma::ManagedPtr<PyObject> acks = RefUtils::toManagedPtr(PyList_New(0));
     if (!acks) return NULL;
@@ -108,16 +422,43 @@ MessageUtils::get_acks(const bmqa::MessageEvent& event)
             continue;
         }
 
+        if (message.correlationId().isNumeric()) {
+            Py_DECREF(guid);
+            bslma::ManagedPtr<PyObject> ack_id = RefUtils::toManagedPtr(
+                    PyLong_FromLongLong(message.correlationId().theNumeric()));
+            bslma::ManagedPtr<PyObject> ack_status =
+                    RefUtils::toManagedPtr(PyLong_FromLong(status));
+            if (!ack_id || !ack_status || 0 != PyList_Append(ack_ids, ack_id.get())
+                || 0 != PyList_Append(ack_statuses, ack_status.get()))
+            {
+                return NULL;
+            }
+            continue;
+        }
+
         PyObject* callback = (PyObject*)message.correlationId().thePointer();
 
-        bslma::ManagedPtr<PyObject> pymessage = RefUtils::toManagedPtr(Py_BuildValue(
-                "(i N N N N)",
-                status,
-                PyBytes_FromString(
-                        bmqt::AckResult::toAscii((bmqt::AckResult::Enum)status)),
-                guid,
-                MessageUtils::get_message_queue_uri(message),
-                callback));
+        bslma::ManagedPtr<PyObject> owner = RefUtils::toManagedPtr(guid);
+        bslma::ManagedPtr<PyObject> status_description =
+                RefUtils::toManagedPtr(string_cache->get(
+                        status,
+                        bmqt::AckResult::toAscii((bmqt::AckResult::Enum)status)));
+        bslma::ManagedPtr<PyObject> queue_uri = RefUtils::toManagedPtr(
+                MessageUtils::get_message_queue_uri(message, string_cache));
+        if (!guid || !status_description || !queue_uri) {
+            return NULL;
+        }
+        bslma::ManagedPtr<PyObject> ack =
+                RefUtils::toManagedPtr(MessageTypes::create_ack(
+                        guid,
+                        MessageTypes::ack_status(status),
+                        status_description.get(),
+                        queue_uri.get()));
+        if (!ack) {
+            return NULL;
+        }
+        bslma::ManagedPtr<PyObject> pymessage =
+                RefUtils::toManagedPtr(Py_BuildValue("(O O)", ack.get(), callback));
         if (!pymessage) {
             return NULL;
         }
@@ -130,9 +471,11 @@ MessageUtils::get_acks(const bmqa::MessageEvent& event)
 }
 
 PyObject*
-MessageUtils::get_message_data(const bmqa::Message& message)
+MessageUtils::get_message_data(
+        const bmqa::Message& message,
+        bslma::Allocator* allocator)
 {
-    bdlbb::Blob blob;
+    bdlbb::Blob blob(allocator);
     message.getData(&blob);
     PyObject* payload = PyBytes_FromStringAndSize(NULL, blob.length());
     if (!payload) {
@@ -142,6 +485,16 @@ MessageUtils::get_message_data(const bmqa::Message& message)
     return payload;
 }
 
+PyObject*
+MessageUtils::get_message_data_buffers(
+        const bmqa::Message& message,
+        bslma::Allocator* allocator)
+{
+    bdlbb::Blob blob(allocator);
+    message.getData(&blob);
+    return BufferUtils::get_blob_buffers(blob);
+}
+
 PyObject*
 MessageUtils::get_message_guid(const bmqa::Message& message)
 {
@@ -161,82 +514,21 @@ MessageUtils::get_message_property_and_type(
         bsl::vector<bsl::string>* collated_errors,
         const bmqa::MessagePropertiesIterator& iterator)
 {
-    bmqt::PropertyType::Enum ptype = iterator.type();
-    bslma::ManagedPtr<PyObject> value;
-    switch (ptype) {
-        case bmqt::PropertyType::e_BOOL: {
-            value = RefUtils::toManagedPtr(PyBool_FromLong(iterator.getAsBool()));
-        } break;
-
-        case bmqt::PropertyType::e_CHAR: {
-            const char the_char = iterator.getAsChar();
-            value = RefUtils::toManagedPtr(PyBytes_FromStringAndSize(&the_char, 1));
-        } break;
-
-        case bmqt::PropertyType::e_STRING: {
-            const bsl::string& the_string = iterator.getAsString();
-            value = RefUtils::toManagedPtr(PyUnicode_FromStringAndSize(
-                    the_string.c_str(),
-                    the_string.length()));
-            if (!value && PyErr_ExceptionMatches(PyExc_UnicodeDecodeError)) {
-                PyErr_Clear();
-                collated_errors->push_back(
-                        "STRING property '" + iterator.name() + "' has non-UTF-8 data");
-                return true;  // Skip this property; we've enqueued an InterfaceError
-            }
-        } break;
-
-        case bmqt::PropertyType::e_BINARY: {
-            const bsl::vector<char>& the_data = iterator.getAsBinary();
-            value = RefUtils::toManagedPtr(
-                    PyBytes_FromStringAndSize(the_data.data(), the_data.size()));
-        } break;
-
-        case bmqt::PropertyType::e_SHORT: {
-            value = RefUtils::toManagedPtr(PyLong_FromLongLong(iterator.getAsShort()));
-        } break;
-
-        case bmqt::PropertyType::e_INT32: {
-            value = RefUtils::toManagedPtr(PyLong_FromLongLong(iterator.getAsInt32()));
-        } break;
-
-        case bmqt::PropertyType::e_INT64: {
-            value = RefUtils::toManagedPtr(PyLong_FromLongLong(iterator.getAsInt64()));
-        } break;
-
-        case bmqt::PropertyType::e_UNDEFINED:
-        default: {
-            bsl::ostringstream oss;
-            oss << "'" << iterator.name() << "' property type is unrecognized, type "
-                << ptype << " received.";
-            collated_errors->push_back(oss.str());
-            return true;  // Skip this property; we've enqueued an InterfaceError
-        }
-    }
-
-    if (!value) {
-        return false;
-    }
-
-    if (PyDict_SetItemString(properties, iterator.name().c_str(), value.get())) {
-        return false;
-    }
-
-    if (PyDict_SetItemString(
-                property_types,
-                iterator.name().c_str(),
-                PyLong_FromLong(ptype)))
-    {
-        return false;
-    }
-
-    return true;
+    return storeProperty(
+            properties,
+            property_types,
+            collated_errors,
+            iterator.name(),
+            iterator.type(),
+            IteratorPropertyReader(iterator));
 }
 
 PyObject*
 MessageUtils::get_message_properties(
         bsl::vector<bsl::string>* collated_errors,
-        const bmqa::Message& message)
+        const bmqa::Message& message,
+        const bsl::vector<bsl::string>* projection,
+        bslma::Allocator* allocator)
 {
     bslma::ManagedPtr<PyObject> py_properties = RefUtils::toManagedPtr(PyDict_New());
     bslma::ManagedPtr<PyObject> py_property_types =
@@ -252,7 +544,7 @@ MessageUtils::get_message_properties(
                 py_property_types.release().first);
     }
 
-    bmqa::MessageProperties properties;
+    bmqa::MessageProperties properties(allocator);
     int rc = message.loadProperties(&properties);
     if (rc != 0) {
         PyErr_SetString(
@@ -260,15 +552,36 @@ MessageUtils::get_message_properties(
                 "Failed to load properties from an incoming message.");
         return NULL;
     }
-    bmqa::MessagePropertiesIterator propIter(&properties);
-    while (propIter.hasNext()) {
-        if (!get_message_property_and_type(
-                    py_properties.get(),
-                    py_property_types.get(),
-                    collated_errors,
-                    propIter))
-        {
-            return NULL;
+
+    if (projection) {
+        for (size_t i = 0; i < projection->size(); ++i) {
+            const bsl::string& name = (*projection)[i];
+            bmqt::PropertyType::Enum ptype;
+            if (!properties.hasProperty(name, &ptype)) {
+                continue;
+            }
+            if (!storeProperty(
+                        py_properties.get(),
+                        py_property_types.get(),
+                        collated_errors,
+                        name,
+                        ptype,
+                        NamedPropertyReader(properties, name)))
+            {
+                return NULL;
+            }
+        }
+    } else {
+        bmqa::MessagePropertiesIterator propIter(&properties);
+        while (propIter.hasNext()) {
+            if (!get_message_property_and_type(
+                        py_properties.get(),
+                        py_property_types.get(),
+                        collated_errors,
+                        propIter))
+            {
+                return NULL;
+            }
         }
     }
     return Py_BuildValue(
@@ -278,16 +591,191 @@ MessageUtils::get_message_properties(
 }
 
 PyObject*
-MessageUtils::get_message_queue_uri(const bmqa::Message& message)
+MessageUtils::get_lazy_message_properties(
+        const bmqa::Message& message,
+        const bsl::shared_ptr<const bsl::vector<bsl::string> >& projection_sp)
 {
-    const bsl::string& uri = message.queueId().uri().asString();
-    return PyBytes_FromStringAndSize(uri.c_str(), uri.length());
+    if (!readyLazyPropertiesType()) {
+        return NULL;
+    }
+
+    LazyProperties* lazy = PyObject_New(LazyProperties, &lazy_properties_type);
+    if (!lazy) {
+        return NULL;
+    }
+    new (&lazy->d_properties) bmqa::MessageProperties();
+    new (&lazy->d_projection_sp) ProjectionSp(projection_sp);
+    bslma::ManagedPtr<PyObject> owner =
+            RefUtils::toManagedPtr(reinterpret_cast<PyObject*>(lazy));
+
+    if (message.hasProperties() && 0 != message.loadProperties(&lazy->d_properties)) {
+        PyErr_SetString(
+                PyExc_RuntimeError,
+                "Failed to load properties from an incoming message.");
+        return NULL;
+    }
+    return owner.release().first;
+}
+
+PyObject*
+MessageUtils::get_message_property_value(
+        const bmqa::MessageProperties& properties,
+        const bsl::string& name,
+        bmqt::PropertyType::Enum type)
+{
+    return convertPropertyValue(type, NamedPropertyReader(properties, name));
+}
+
+PyObject*
+MessageUtils::get_message_queue_uri(
+        const bmqa::Message& message,
+        StringCache* string_cache)
+{
+    return string_cache->get(message.queueId().uri().asString());
+}
+
+bool
+MessageUtils::append_message(
+        PyObject* messages,
+        const bmqa::Message& message,
+        PyObject* session_event_callback,
+        bool zero_copy_payloads,
+        const PropertyPolicies& property_policies,
+        const DecodedPayload* decoded,
+        StringCache* string_cache)
+{
+    if (decoded && decoded->d_rejected) {
+        bsl::ostringstream oss;
+        oss << "Rejected the payload of message " << message.messageGUID()
+            << " received on " << message.queueId().uri().asString();
+        if (!decoded->d_reason.empty()) {
+            oss << ": " << decoded->d_reason;
+        }
+        bslma::ManagedPtr<PyObject> rv = RefUtils::toManagedPtr(PyObject_CallFunction(
+                session_event_callback,
+                "(N)",
+                PyBytes_FromString(oss.str().c_str())));
+        if (!rv) {
+            PyErr_Print();
+        }
+        return true;
+    }
+
+    const PropertyPolicy* policy = NULL;
+    if (!property_policies.empty()) {
+        PropertyPolicies::const_iterator it =
+                property_policies.find(message.queueId().uri().asString());
+        if (it != property_policies.end()) {
+            policy = &it->second;
+        }
+    }
+
+    // Everything allocated while converting the message is released at once
+    // when it goes out of scope, usually without touching the heap at all.
+    bdlma::LocalSequentialAllocator<k_CONVERSION_ARENA_SIZE> arena;
+
+    bsl::vector<bsl::string> collated_errors(&arena);
+    bslma::ManagedPtr<PyObject> py_properties;
+    bool property_type_codes = true;
+    if (policy && policy->d_lazy) {
+        bslma::ManagedPtr<PyObject> native =
+                RefUtils::toManagedPtr(MessageUtils::get_lazy_message_properties(
+                        message,
+                        policy->d_projection_sp));
+        if (!native) {
+            return false;
+        }
+        py_properties = RefUtils::toManagedPtr(
+                MessageTypes::wrap_lazy_properties(native.get()));
+        property_type_codes = false;
+    } else {
+        py_properties = RefUtils::toManagedPtr(MessageUtils::get_message_properties(
+                &collated_errors,
+                message,
+                policy ? policy->d_projection_sp.get() : NULL,
+                &arena));
+    }
+    PyObject* properties;
+    PyObject* property_types;
+    if (!py_properties
+        || !PyArg_ParseTuple(py_properties.get(), "OO", &properties, &property_types))
+    {
+        return false;
+    }
+
+    bslma::ManagedPtr<PyObject> data;
+    bslma::ManagedPtr<PyObject> data_buffers;
+    if (decoded && decoded->d_data_sp) {
+        data = RefUtils::toManagedPtr(
+                BufferUtils::get_buffer_view(decoded->d_data_sp, decoded->d_length));
+        if (!data) {
+            return false;
+        }
+    } else if (zero_copy_payloads) {
+        data_buffers = RefUtils::toManagedPtr(
+                MessageUtils::get_message_data_buffers(message, &arena));
+        if (!data_buffers) {
+            return false;
+        }
+        if (PyList_GET_SIZE(data_buffers.get()) == 1) {
+            // A payload in a single buffer is exposed without flattening it.
+            data = RefUtils::toManagedPtr(
+                    RefUtils::ref(PyList_GET_ITEM(data_buffers.get(), 0)));
+        }
+    } else {
+        data = RefUtils::toManagedPtr(MessageUtils::get_message_data(message, &arena));
+        if (!data) {
+            return false;
+        }
+    }
+
+    bslma::ManagedPtr<PyObject> guid =
+            RefUtils::toManagedPtr(MessageUtils::get_message_guid(message));
+    bslma::ManagedPtr<PyObject> queue_uri = RefUtils::toManagedPtr(
+            MessageUtils::get_message_queue_uri(message, string_cache));
+    if (!guid || !queue_uri) {
+        return false;
+    }
+    bslma::ManagedPtr<PyObject> pymessage =
+            RefUtils::toManagedPtr(MessageTypes::create_message(
+                    data.get(),
+                    data_buffers.get(),
+                    guid.get(),
+                    queue_uri.get(),
+                    properties,
+                    property_types,
+                    property_type_codes));
+
+    if (!pymessage) {
+        return false;
+    }
+    if (0 != PyList_Append(messages, pymessage.get())) {
+        return false;
+    }
+    if (!collated_errors.empty()) {
+        bsl::ostringstream oss;
+        for (size_t i = 0; i < collated_errors.size(); ++i) {
+            oss << collated_errors[i] << "\n";
+        }
+        bslma::ManagedPtr<PyObject> rv = RefUtils::toManagedPtr(PyObject_CallFunction(
+                session_event_callback,
+                "(N)",
+                PyBytes_FromString(oss.str().c_str())));
+        if (!rv) {
+            PyErr_Print();
+        }
+    }
+    return true;
 }
 
 PyObject*
 MessageUtils::get_messages(
         const bmqa::MessageEvent& event,
-        PyObject* session_event_callback)
+        PyObject* session_event_callback,
+        bool zero_copy_payloads,
+        const PropertyPolicies& property_policies,
+        const DecodedPayloads* decoded,
+        StringCache* string_cache)
 {
     bslma::ManagedPtr<PyObject> messages = RefUtils::toManagedPtr(PyList_New(0));
     if (!messages) {
@@ -295,40 +783,56 @@ MessageUtils::get_messages(
     }
 
     bmqa::MessageIterator message_iterator = event.messageIterator();
-    while (message_iterator.nextMessage()) {
-        const bmqa::Message& message = message_iterator.message();
-        bsl::vector<bsl::string> collated_errors;
-        bslma::ManagedPtr<PyObject> pymessage = RefUtils::toManagedPtr(Py_BuildValue(
-                "(N N N N)",
-                MessageUtils::get_message_data(message),
-                MessageUtils::get_message_guid(message),
-                MessageUtils::get_message_queue_uri(message),
-                MessageUtils::get_message_properties(&collated_errors, message)));
-
-        if (!pymessage) {
-            return NULL;
-        }
-        if (0 != PyList_Append(messages.get(), pymessage.get())) {
+    for (bsl::size_t i = 0; message_iterator.nextMessage(); ++i) {
+        if (!append_message(
+                    messages.get(),
+                    message_iterator.message(),
+                    session_event_callback,
+                    zero_copy_payloads,
+                    property_policies,
+                    decoded ? &(*decoded)[i] : NULL,
+                    string_cache))
+        {
             return NULL;
         }
-        if (!collated_errors.empty()) {
-            bsl::ostringstream oss;
-            for (size_t i = 0; i < collated_errors.size(); ++i) {
-                oss << collated_errors[i] << "\n";
-            }
-            bslma::ManagedPtr<PyObject> rv =
-                    RefUtils::toManagedPtr(PyObject_CallFunction(
-                            session_event_callback,
-                            "(N)",
-                            PyBytes_FromString(oss.str().c_str())));
-            if (!rv) {
-                PyErr_Print();
-            }
-        }
     }
     return messages.release().first;
 }
 
+bool
+MessageUtils::decode_payload(
+        DecodedPayload* result,
+        const bmqa::Message& message,
+        const PropertyPolicies& property_policies)
+{
+    PropertyPolicies::const_iterator it =
+            property_policies.find(message.queueId().uri().asString());
+    if (it == property_policies.end() || !it->second.d_decoder_sp) {
+        return false;
+    }
+    bdlma::LocalSequentialAllocator<k_CONVERSION_ARENA_SIZE> arena;
+    bdlbb::Blob blob(&arena);
+    message.getData(&blob);
+    it->second.d_decoder_sp->decode(result, blob);
+    return result->d_rejected;
+}
+
+bool
+MessageUtils::is_supported_property_type(bmqt::PropertyType::Enum type)
+{
+    switch (type) {
+        case bmqt::PropertyType::e_BOOL:
+        case bmqt::PropertyType::e_CHAR:
+        case bmqt::PropertyType::e_SHORT:
+        case bmqt::PropertyType::e_INT32:
+        case bmqt::PropertyType::e_INT64:
+        case bmqt::PropertyType::e_STRING:
+        case bmqt::PropertyType::e_BINARY: return true;
+        case bmqt::PropertyType::e_UNDEFINED:
+        default: return false;
+    }
+}
+
 bool
 MessageUtils::load_message_properties(
         bmqa::MessageProperties* c_properties,
@@ -338,6 +842,7 @@ MessageUtils::load_message_properties(
         PyErr_SetString(PyExc_ValueError, "'properties' is not a dictionary.");
         return false;
     }
+    CriticalSectionGuard guard(py_properties);
 
     PyObject* py_key;
     PyObject* py_value_tuple;
@@ -19,26 +19,76 @@
 #define PY_SSIZE_T_CLEAN
 #include <Python.h>
 
+#include <pybmq_payloaddecoder.h>
+
 #include <bmqa_message.h>
 #include <bmqa_messageevent.h>
 #include <bmqa_messageproperties.h>
+#include <bmqt_propertytype.h>
 
+#include <bsl_memory.h>
 #include <bsl_string.h>
+#include <bsl_unordered_map.h>
 #include <bsl_vector.h>
+#include <bslma_allocator.h>
 
 namespace BloombergLP {
 namespace pybmq {
 
+class StringCache;
+
+struct PropertyPolicy
+{
+    // Describes how the properties, and possibly the payloads, of the messages
+    // received on one queue are converted into Python objects.
+
+    // DATA
+    bool d_lazy;
+    // Whether properties are decoded one at a time, when they are accessed,
+    // rather than all at once when the message is received.
+
+    bsl::shared_ptr<const bsl::vector<bsl::string> > d_projection_sp;
+    // The names of the only properties that are ever decoded, or null to
+    // decode all of them.
+
+    bsl::shared_ptr<const PayloadDecoder> d_decoder_sp;
+    // The decoder run on every payload before the GIL is acquired to convert
+    // the message, or null to deliver payloads as they are received.
+};
+
+typedef bsl::unordered_map<bsl::string, PropertyPolicy> PropertyPolicies;
+// A mapping from queue URI to the 'PropertyPolicy' for that queue.
+
 struct MessageUtils
 {
     // CLASS METHODS
-    static PyObject* get_acks(const bmqa::MessageEvent& event);
-    // Convert every acknowledgement in the specified 'event' into a tuple object,
-    // returning them in a list.
+    static PyObject* get_acks(
+            const bmqa::MessageEvent& event,
+            StringCache* string_cache,
+            PyObject* ack_ids,
+            PyObject* ack_statuses);
+    // Convert every acknowledgement in the specified 'event' into an 'Ack'
+    // created by 'MessageTypes::create_ack', returning them in a list of tuples
+    // of the 'Ack' and the callback it was posted with.  Queue URIs and status
+    // names are taken from the specified 'string_cache'.  Acknowledgements of
+    // messages posted with a numeric ack id are instead appended to the
+    // specified 'ack_ids' and 'ack_statuses' lists, as an 'int' id and an 'int'
+    // status respectively.
 
-    static PyObject* get_message_data(const bmqa::Message& message);
+    static PyObject*
+    get_message_data(const bmqa::Message& message, bslma::Allocator* allocator = 0);
     // Get the payload of a BlazingMQ message and convert it into a tuple
-    // object to be processed in Python.
+    // object to be processed in Python.  Optionally specify an 'allocator'
+    // used for temporary memory.  If 'allocator' is 0, the currently installed
+    // default allocator is used.
+
+    static PyObject* get_message_data_buffers(
+            const bmqa::Message& message,
+            bslma::Allocator* allocator = 0);
+    // Get the payload of a BlazingMQ message as a list of read-only 'memoryview'
+    // objects over the buffers it was received in, without copying it.
+    // Optionally specify an 'allocator' used for temporary memory.  If
+    // 'allocator' is 0, the currently installed default allocator is used.
 
     static PyObject* get_message_guid(const bmqa::Message& message);
     // Get the BlazingMQ message GUID as Python bytes object.
@@ -53,16 +103,81 @@ struct MessageUtils
 
     static PyObject* get_message_properties(
             bsl::vector<bsl::string>* collated_errors,
-            const bmqa::Message& message);
-    // Get the BlazingMQ message properties as Python dictionary object.
+            const bmqa::Message& message,
+            const bsl::vector<bsl::string>* projection,
+            bslma::Allocator* allocator = 0);
+    // Get the BlazingMQ message properties as Python dictionary object.  If the
+    // specified 'projection' is not null, only the properties it names are
+    // decoded.  Optionally specify an 'allocator' used for the native copy of
+    // the properties, which doesn't outlive this call.  If 'allocator' is 0,
+    // the currently installed default allocator is used.
+
+    static PyObject* get_lazy_message_properties(
+            const bmqa::Message& message,
+            const bsl::shared_ptr<const bsl::vector<bsl::string> >& projection_sp);
+    // Return an object holding the native properties of the specified 'message'
+    // and decoding them only on request, restricted to the names in the
+    // specified 'projection_sp' unless it is null.  Its 'types()' method returns
+    // a dictionary mapping each property name to its type code, and its
+    // 'get(name)' method returns the value of a single property, raising
+    // 'KeyError' if there is no such property.
 
-    static PyObject* get_message_queue_uri(const bmqa::Message& message);
-    // Get the BlazingMQ message Queue URI as bytes object
+    static PyObject* get_message_property_value(
+            const bmqa::MessageProperties& properties,
+            const bsl::string& name,
+            bmqt::PropertyType::Enum type);
+    // Convert the value of the property with the specified 'name' and the
+    // specified supported 'type' in the specified 'properties' into a Python
+    // object.
 
     static PyObject*
-    get_messages(const bmqa::MessageEvent& event, PyObject* session_event_callback);
-    // Convert every message in the specified 'event' into a tuple object, returning
-    // them in a list.
+    get_message_queue_uri(const bmqa::Message& message, StringCache* string_cache);
+    // Get the BlazingMQ message Queue URI as a 'str' object from the specified
+    // 'string_cache'.
+
+    static bool append_message(
+            PyObject* messages,
+            const bmqa::Message& message,
+            PyObject* session_event_callback,
+            bool zero_copy_payloads,
+            const PropertyPolicies& property_policies,
+            const DecodedPayload* decoded,
+            StringCache* string_cache);
+    // Convert the specified 'message' into a 'Message' as 'get_messages'
+    // does and append it to the specified 'messages' list, using the payload
+    // in the specified 'decoded' unless it is null.  A message whose payload
+    // was rejected is reported to 'session_event_callback' instead.  Return
+    // false with a Python exception set on failure.
+
+    static PyObject* get_messages(
+            const bmqa::MessageEvent& event,
+            PyObject* session_event_callback,
+            bool zero_copy_payloads,
+            const PropertyPolicies& property_policies,
+            const DecodedPayloads* decoded,
+            StringCache* string_cache);
+    // Convert every message in the specified 'event' into a 'Message' created by
+    // 'MessageTypes::create_message', returning them in a list.  If the
+    // specified 'zero_copy_payloads' is true, each payload is provided by
+    // 'get_message_data_buffers' instead of 'get_message_data'.  The properties
+    // of messages on queues found in the specified 'property_policies' are
+    // converted as their policy describes.  If the specified 'decoded' is not
+    // null, it holds the outcome of 'decode_payload' for every message of
+    // 'event', and the messages whose payload was rejected are left out.
+    // Queue URIs are taken from the specified 'string_cache'.
+
+    static bool decode_payload(
+            DecodedPayload* result,
+            const bmqa::Message& message,
+            const PropertyPolicies& property_policies);
+    // Run the payload decoder that the policy of the queue of the specified
+    // 'message' in the specified 'property_policies' has, if any, on its
+    // payload, and load the outcome into the specified 'result'.  Return
+    // whether the decoder rejected the payload.  The GIL need not be held.
+
+    static bool is_supported_property_type(bmqt::PropertyType::Enum type);
+    // Return whether properties of the specified 'type' can be converted into
+    // Python objects.
 
     static bool load_message_properties(
             bmqa::MessageProperties* c_properties,
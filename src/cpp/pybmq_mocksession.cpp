@@ -19,9 +19,11 @@
 #include <pybmq_gilacquireguard.h>
 #include <pybmq_messageutils.h>
 #include <pybmq_session.h>
+#include <pybmq_subscriptionutils.h>
 
 #include <bmqa_messageproperties.h>
 #include <bmqt_resultcode.h>
+#include <bmqt_sessioneventtype.h>
 
 #include <bdlbb_blob.h>
 #include <bdlbb_blobutil.h>
@@ -32,6 +34,7 @@
 #include <bslma_allocator.h>
 #include <bslma_default.h>
 #include <bslma_managedptr.h>
+#include <bsls_types.h>
 
 namespace BloombergLP {
 namespace pybmq {
@@ -239,7 +242,13 @@ maybe_emit_acks(PyObject* mock, bmqa::MockSession* mock_session)
             throw bsl::runtime_error("propagating Python error");
         }
 
-        bmqt::CorrelationId callback(RefUtils::ref(py_callback));
+        bmqt::CorrelationId callback;
+        if (PyLong_Check(py_callback)) {
+            callback = bmqt::CorrelationId(
+                    static_cast<bsls::Types::Int64>(PyLong_AsLongLong(py_callback)));
+        } else {
+            callback = bmqt::CorrelationId(RefUtils::ref(py_callback));
+        }
 
         ack_params.emplace_back(status, callback, guid, queue_id);
     }
@@ -261,6 +270,29 @@ maybe_emit_acks(PyObject* mock, bmqa::MockSession* mock_session)
     }
 }
 
+void
+emit_queue_result(
+        bmqa::MockSession* mock_session,
+        bmqt::SessionEventType::Enum result_type,
+        bmqa::QueueId* queue_id,
+        int status)
+{
+    bdlbb::SimpleBlobBufferFactory factory(1024);
+    bslma::Allocator* allocator_p = bslma::Default::defaultAllocator();
+    mock_session->enqueueEvent(bmqa::MockSessionUtil::createQueueSessionEvent(
+            result_type,
+            queue_id,
+            queue_id->correlationId(),
+            status,
+            "the_error_string",
+            &factory,
+            allocator_p));
+    if (!mock_session->emitEvent()) {
+        PyErr_SetString(PyExc_RuntimeError, "Failed to emit event");
+        throw bsl::runtime_error("propagating Python error");
+    }
+}
+
 double
 time_interval_to_seconds(const bsls::TimeInterval& time_interval)
 {
@@ -399,8 +431,7 @@ MockSession::loadMessageEventBuilder(bmqa::MessageEventBuilder* builder)
 void
 MockSession::loadConfirmEventBuilder(bmqa::ConfirmEventBuilder* builder)
 {
-    (void)builder;
-    assertNotCalled();
+    d_mock_session.loadConfirmEventBuilder(builder);
 }
 
 void
@@ -463,13 +494,56 @@ MockSession::openQueueAsync(
         const bmqt::QueueOptions& options,
         const bsls::TimeInterval& timeout)
 {
-    (void)queueId;
-    (void)uri;
-    (void)flags;
-    (void)options;
-    (void)timeout;
-    assertNotCalled();
-    return -1;
+    BMQA_EXPECT_CALL(d_mock_session, openQueueAsync(uri, flags, options, timeout))
+            .returning(0);
+    int rc = d_mock_session.openQueueAsync(queueId, uri, flags, options, timeout);
+
+    int result;
+    {
+        GilAcquireGuard guard;
+
+        // Obtain data
+        const bsl::string text_uri = uri.asString();
+        static const char* const option_names[] = {
+                "max_unconfirmed_messages",
+                "max_unconfirmed_bytes",
+                "consumer_priority",
+                "suspends_on_bad_host_health",
+                "subscriptions",
+        };
+        double double_timeout = timeout.seconds() + timeout.nanoseconds() * 1e-9;
+
+        // Call method
+        static const char* const names[] = {"uri", "flags", "options", "timeout"};
+        bslma::ManagedPtr<PyObject> mock_ret = RefUtils::toManagedPtr(_PyMock_Call(
+                d_mock,
+                "openQueueAsync",
+                names,
+                "(N i N f)",
+                PyBytes_FromStringAndSize(text_uri.c_str(), text_uri.length()),
+                flags,
+                _Py_DictBuilder(
+                        option_names,
+                        "(i i i O N)",
+                        options.maxUnconfirmedMessages(),
+                        options.maxUnconfirmedBytes(),
+                        options.consumerPriority(),
+                        options.suspendsOnBadHostHealth() ? Py_True : Py_False,
+                        SubscriptionUtils::get_subscriptions(options)),
+                double_timeout));
+
+        // Obtain the result to report asynchronously
+        if (!mock_ret) throw bsl::runtime_error("propagating Python error");
+        result = PyLong_AsLong(mock_ret.get());
+        if (PyErr_Occurred()) throw bsl::runtime_error("propagating Python error");
+    }
+
+    emit_queue_result(
+            &d_mock_session,
+            bmqt::SessionEventType::e_QUEUE_OPEN_RESULT,
+            queueId,
+            result);
+    return rc;
 }
 
 void
@@ -512,6 +586,7 @@ MockSession::openQueueSync(
             "max_unconfirmed_bytes",
             "consumer_priority",
             "suspends_on_bad_host_health",
+            "subscriptions",
     };
     double double_timeout = timeout.seconds() + timeout.nanoseconds() * 1e-9;
 
@@ -526,11 +601,12 @@ MockSession::openQueueSync(
             flags,
             _Py_DictBuilder(
                     option_names,
-                    "(i i i O)",
+                    "(i i i O N)",
                     options.maxUnconfirmedMessages(),
                     options.maxUnconfirmedBytes(),
                     options.consumerPriority(),
-                    options.suspendsOnBadHostHealth() ? Py_True : Py_False),
+                    options.suspendsOnBadHostHealth() ? Py_True : Py_False,
+                    SubscriptionUtils::get_subscriptions(options)),
             double_timeout));
 
     // Return error code
@@ -563,11 +639,53 @@ MockSession::configureQueueAsync(
         const bmqt::QueueOptions& options,
         const bsls::TimeInterval& timeout)
 {
-    (void)queueId;
-    (void)options;
-    (void)timeout;
-    assertNotCalled();
-    return -1;
+    BMQA_EXPECT_CALL(d_mock_session, configureQueueAsync(queueId, options, timeout))
+            .returning(0);
+    int rc = d_mock_session.configureQueueAsync(queueId, options, timeout);
+
+    int result;
+    {
+        GilAcquireGuard guard;
+
+        // Obtain data
+        static const char* const option_names[] = {
+                "max_unconfirmed_messages",
+                "max_unconfirmed_bytes",
+                "consumer_priority",
+                "suspends_on_bad_host_health",
+                "subscriptions",
+        };
+        double double_timeout = timeout.seconds() + timeout.nanoseconds() * 1e-9;
+
+        // Call method
+        static const char* const names[] = {"options", "timeout"};
+        bslma::ManagedPtr<PyObject> mock_ret = RefUtils::toManagedPtr(_PyMock_Call(
+                d_mock,
+                "configureQueueAsync",
+                names,
+                "(N f)",
+                _Py_DictBuilder(
+                        option_names,
+                        "(i i i O N)",
+                        options.maxUnconfirmedMessages(),
+                        options.maxUnconfirmedBytes(),
+                        options.consumerPriority(),
+                        options.suspendsOnBadHostHealth() ? Py_True : Py_False,
+                        SubscriptionUtils::get_subscriptions(options)),
+                double_timeout));
+
+        // Obtain the result to report asynchronously
+        if (!mock_ret) throw bsl::runtime_error("propagating Python error");
+        result = PyLong_AsLong(mock_ret.get());
+        if (PyErr_Occurred()) throw bsl::runtime_error("propagating Python error");
+    }
+
+    emit_queue_result(
+            &d_mock_session,
+            bmqt::SessionEventType::e_QUEUE_CONFIGURE_RESULT,
+            queueId,
+            result);
+    return rc;
 }
 
 void
@@ -601,6 +719,7 @@ MockSession::configureQueueSync(
             "max_unconfirmed_bytes",
             "consumer_priority",
             "suspends_on_bad_host_health",
+            "subscriptions",
     };
     double double_timeout = timeout.seconds() + timeout.nanoseconds() * 1e-9;
 
@@ -613,11 +732,12 @@ MockSession::configureQueueSync(
             "(N f)",
             _Py_DictBuilder(
                     option_names,
-                    "(i i i O)",
+                    "(i i i O N)",
                     options.maxUnconfirmedMessages(),
                     options.maxUnconfirmedBytes(),
                     options.consumerPriority(),
-                    options.suspendsOnBadHostHealth() ? Py_True : Py_False),
+                    options.suspendsOnBadHostHealth() ? Py_True : Py_False,
+                    SubscriptionUtils::get_subscriptions(options)),
             double_timeout));
 
     // Return error code
@@ -642,10 +762,33 @@ MockSession::closeQueue(bmqa::QueueId* queueId, const bsls::TimeInterval& timeou
 int
 MockSession::closeQueueAsync(bmqa::QueueId* queueId, const bsls::TimeInterval& timeout)
 {
-    (void)queueId;
-    (void)timeout;
-    assertNotCalled();
-    return -1;
+    BMQA_EXPECT_CALL(d_mock_session, closeQueueAsync(queueId, timeout)).returning(0);
+    int rc = d_mock_session.closeQueueAsync(queueId, timeout);
+
+    int result;
+    {
+        GilAcquireGuard guard;
+
+        // Obtain data
+        double double_timeout = timeout.seconds() + timeout.nanoseconds() * 1e-9;
+
+        // Call method
+        static const char* const names[] = {"timeout"};
+        bslma::ManagedPtr<PyObject> mock_ret = RefUtils::toManagedPtr(
+                _PyMock_Call(d_mock, "closeQueueAsync", names, "(f)", double_timeout));
+
+        // Obtain the result to report asynchronously
+        if (!mock_ret) throw bsl::runtime_error("propagating Python error");
+        result = PyLong_AsLong(mock_ret.get());
+        if (PyErr_Occurred()) throw bsl::runtime_error("propagating Python error");
+    }
+
+    emit_queue_result(
+            &d_mock_session,
+            bmqt::SessionEventType::e_QUEUE_CLOSE_RESULT,
+            queueId,
+            result);
+    return rc;
 }
 
 void
@@ -704,28 +847,38 @@ MockSession::post(const bmqa::MessageEvent& event)
 
     GilAcquireGuard guard;
 
+    // Call method once per message packed into the event, returning the first
+    // non-zero error code.
+    int ret = 0;
     bmqa::MessageIterator message_iterator = event.messageIterator();
-    message_iterator.nextMessage();
-    const bmqa::Message& message = message_iterator.message();
-
-    // Call method
-    static const char* const names[] =
-            {"payload", "queue_uri", "properties", "compression_algorithm_type"};
-    bsl::vector<bsl::string> ignored_collated_errors;
-    bslma::ManagedPtr<PyObject> mock_ret = RefUtils::toManagedPtr(_PyMock_Call(
-            d_mock,
-            "post",
-            names,
-            "(N N N i)",
-            MessageUtils::get_message_data(message),
-            MessageUtils::get_message_queue_uri(message),
-            MessageUtils::get_message_properties(&ignored_collated_errors, message),
-            message.compressionAlgorithmType()));
-
-    // Return error code
-    if (!mock_ret) throw bsl::runtime_error("propagating Python error");
-    int ret = PyLong_AsLong(mock_ret.get());
-    if (PyErr_Occurred()) throw bsl::runtime_error("propagating Python error");
+    while (message_iterator.nextMessage()) {
+        const bmqa::Message& message = message_iterator.message();
+        const bsl::string& c_queue_uri = message.queueId().uri().asString();
+
+        static const char* const names[] =
+                {"payload", "queue_uri", "properties", "compression_algorithm_type"};
+        bsl::vector<bsl::string> ignored_collated_errors;
+        bslma::ManagedPtr<PyObject> mock_ret = RefUtils::toManagedPtr(_PyMock_Call(
+                d_mock,
+                "post",
+                names,
+                "(N N N i)",
+                MessageUtils::get_message_data(message),
+                PyBytes_FromStringAndSize(c_queue_uri.c_str(), c_queue_uri.length()),
+                MessageUtils::get_message_properties(
+                        &ignored_collated_errors,
+                        message,
+                        NULL),
+                message.compressionAlgorithmType()));
+
+        // Return error code
+        if (!mock_ret) throw bsl::runtime_error("propagating Python error");
+        int message_ret = PyLong_AsLong(mock_ret.get());
+        if (PyErr_Occurred()) throw bsl::runtime_error("propagating Python error");
+        if (message_ret && !ret) {
+            ret = message_ret;
+        }
+    }
 
     maybe_emit_acks(d_mock, &d_mock_session);
 
@@ -780,9 +933,27 @@ MockSession::confirmMessage(const bmqa::MessageConfirmationCookie& cookie)
 int
 MockSession::confirmMessages(bmqa::ConfirmEventBuilder* builder)
 {
-    (void)builder;
-    assertNotCalled();
-    return -1;
+    // Obtain data before the SDK mock resets the builder
+    int message_count = builder->messageCount();
+
+    BMQA_EXPECT_CALL(d_mock_session, confirmMessages(builder));
+    d_mock_session.confirmMessages(builder);
+    GilAcquireGuard guard;
+
+    // Call method
+    static const char* const names[] = {"message_count"};
+    bslma::ManagedPtr<PyObject> mock_ret = RefUtils::toManagedPtr(
+            _PyMock_Call(d_mock, "confirmMessages", names, "(i)", message_count));
+
+    // Return error code
+    if (!mock_ret) {
+        throw bsl::runtime_error("propagating Python error");
+    }
+    int ret = PyLong_AsLong(mock_ret.get());
+    if (PyErr_Occurred()) {
+        throw bsl::runtime_error("propagating Python error");
+    }
+    return ret;
 }
 
 int
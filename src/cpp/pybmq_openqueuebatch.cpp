@@ -0,0 +1,74 @@
+// Copyright 2019-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <pybmq_openqueuebatch.h>
+
+#include <bslmt_lockguard.h>
+#include <bsls_assert.h>
+
+namespace BloombergLP {
+namespace pybmq {
+
+OpenQueueBatch::OpenQueueBatch(int num_queues, int max_in_flight)
+: d_lock()
+, d_condition()
+, d_max_in_flight(max_in_flight)
+, d_num_in_flight(0)
+, d_results(num_queues)
+{
+    BSLS_ASSERT(max_in_flight > 0);
+}
+
+void
+OpenQueueBatch::acquire()
+{
+    bslmt::LockGuard<bslmt::Mutex> lock(&d_lock);
+    while (d_num_in_flight >= d_max_in_flight) {
+        d_condition.wait(&d_lock);
+    }
+    ++d_num_in_flight;
+}
+
+void
+OpenQueueBatch::complete(int index, int status, const bsl::string& error)
+{
+    {
+        bslmt::LockGuard<bslmt::Mutex> lock(&d_lock);
+        BSLS_ASSERT(d_num_in_flight > 0);
+        d_results[index].d_status = status;
+        d_results[index].d_error = error;
+        --d_num_in_flight;
+    }
+    // Both the submitting thread and 'wait' may be blocked on the condition.
+    d_condition.broadcast();
+}
+
+void
+OpenQueueBatch::wait()
+{
+    bslmt::LockGuard<bslmt::Mutex> lock(&d_lock);
+    while (d_num_in_flight > 0) {
+        d_condition.wait(&d_lock);
+    }
+}
+
+const OpenQueueBatch::Result&
+OpenQueueBatch::result(int index) const
+{
+    return d_results[index];
+}
+
+}  // namespace pybmq
+}  // namespace BloombergLP
@@ -0,0 +1,81 @@
+// Copyright 2019-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_PYBMQ_OPENQUEUEBATCH
+#define INCLUDED_PYBMQ_OPENQUEUEBATCH
+
+#include <bsl_string.h>
+#include <bsl_vector.h>
+#include <bslmt_condition.h>
+#include <bslmt_mutex.h>
+
+namespace BloombergLP {
+namespace pybmq {
+
+class OpenQueueBatch
+{
+    // Collect the outcome of a batch of queues opened asynchronously, keeping
+    // at most a fixed number of requests in flight, so that a single thread can
+    // submit them all and wait for their results without holding the GIL.
+
+  public:
+    // TYPES
+    struct Result
+    {
+        // The outcome of opening one queue of the batch.
+
+        int d_status;  // a 'bmqt::OpenQueueResult' value, zero on success
+        bsl::string d_error;  // empty on success
+    };
+
+  private:
+    // DATA
+    bslmt::Mutex d_lock;
+    bslmt::Condition d_condition;
+    int d_max_in_flight;
+    int d_num_in_flight;  // protected by 'd_lock'
+    bsl::vector<Result> d_results;  // protected by 'd_lock' until 'wait' returns
+
+    // NOT IMPLEMENTED
+    OpenQueueBatch(const OpenQueueBatch&);
+    OpenQueueBatch& operator=(const OpenQueueBatch&);
+
+  public:
+    OpenQueueBatch(int num_queues, int max_in_flight);
+    // Create a batch of the specified 'num_queues' queues, of which at most the
+    // specified 'max_in_flight' are being opened at any time.
+
+    void acquire();
+    // Wait until fewer than 'max_in_flight' queues are being opened, and count
+    // one more.  The GIL must not be held.
+
+    void complete(int index, int status, const bsl::string& error);
+    // Record the specified 'status' and 'error' as the outcome of opening the
+    // queue at the specified 'index', and count one fewer queue being opened.
+    // 'acquire' must have been called for it.  The GIL need not be held.
+
+    void wait();
+    // Wait until every queue counted by 'acquire' has completed.  The GIL must
+    // not be held.
+
+    const Result& result(int index) const;
+    // Return the outcome of opening the queue at the specified 'index'.  Only
+    // valid once 'wait' returned after 'complete' was called for it.
+};
+
+}  // namespace pybmq
+}  // namespace BloombergLP
+
+#endif
@@ -0,0 +1,139 @@
+// Copyright 2019-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <pybmq_payloaddecoder.h>
+
+#include <pybmq_gilacquireguard.h>
+
+#include <bdlma_localsequentialallocator.h>
+#include <bsl_climits.h>
+#include <bsl_cstddef.h>
+#include <bsl_sstream.h>
+#include <bslma_allocator.h>
+#include <bslma_default.h>
+
+namespace BloombergLP {
+namespace pybmq {
+
+namespace {
+
+enum {
+    k_NUM_INLINE_SEGMENTS = 16  // segments kept on the stack
+};
+
+extern "C" char*
+allocateDecodedPayload(void* sink, size_t length)
+{
+    DecodedPayload* result = static_cast<DecodedPayload*>(sink);
+    result->d_data_sp.reset();
+    result->d_length = 0;
+    if (length > INT_MAX) {
+        return NULL;
+    }
+    bslma::Allocator* allocator = bslma::Default::defaultAllocator();
+    try {
+        char* buffer = static_cast<char*>(allocator->allocate(length ? length : 1));
+        result->d_data_sp.reset(buffer, allocator);
+    } catch (...) {
+        return NULL;
+    }
+    result->d_length = static_cast<int>(length);
+    return result->d_data_sp.get();
+}
+
+}  // namespace
+
+DecodedPayload::DecodedPayload()
+: d_rejected(false)
+, d_reason()
+, d_data_sp()
+, d_length(0)
+{
+}
+
+bsl::shared_ptr<const PayloadDecoder>
+PayloadDecoder::from_capsule(PyObject* capsule)
+{
+    const blazingmq_PayloadDecoder* decoder =
+            static_cast<const blazingmq_PayloadDecoder*>(PyCapsule_GetPointer(
+                    capsule,
+                    BLAZINGMQ_PAYLOAD_DECODER_CAPSULE_NAME));
+    if (!decoder) {
+        return bsl::shared_ptr<const PayloadDecoder>();
+    }
+    if (decoder->version != BLAZINGMQ_PAYLOAD_DECODER_VERSION) {
+        bsl::ostringstream oss;
+        oss << "Unsupported payload decoder version " << decoder->version
+            << ", expected " << BLAZINGMQ_PAYLOAD_DECODER_VERSION;
+        PyErr_SetString(PyExc_ValueError, oss.str().c_str());
+        return bsl::shared_ptr<const PayloadDecoder>();
+    }
+    if (!decoder->decode) {
+        PyErr_SetString(PyExc_ValueError, "Payload decoder has no decode function");
+        return bsl::shared_ptr<const PayloadDecoder>();
+    }
+    return bsl::make_shared<PayloadDecoder>(capsule, decoder);
+}
+
+PayloadDecoder::PayloadDecoder(
+        PyObject* capsule,
+        const blazingmq_PayloadDecoder* decoder)
+: d_capsule(capsule)
+, d_decoder_p(decoder)
+{
+    Py_INCREF(d_capsule);
+}
+
+PayloadDecoder::~PayloadDecoder()
+{
+    // The last reference to a decoder may be dropped by whichever thread last
+    // converted a message with the policies holding it.
+    GilAcquireGuard guard;
+    Py_DECREF(d_capsule);
+}
+
+void
+PayloadDecoder::decode(DecodedPayload* result, const bdlbb::Blob& payload) const
+{
+    bdlma::LocalSequentialAllocator<k_NUM_INLINE_SEGMENTS
+                                    * sizeof(blazingmq_PayloadSegment)>
+            arena;
+    bsl::vector<blazingmq_PayloadSegment> segments(&arena);
+    const int num_buffers = payload.numDataBuffers();
+    segments.reserve(num_buffers);
+    for (int i = 0; i < num_buffers; ++i) {
+        const int length = (i == num_buffers - 1) ? payload.lastDataBufferLength()
+                                                  : payload.buffer(i).size();
+        blazingmq_PayloadSegment segment = {payload.buffer(i).data(),
+                                            static_cast<size_t>(length)};
+        segments.push_back(segment);
+    }
+
+    blazingmq_DecodeResult out = {result, &allocateDecodedPayload, NULL};
+    if (d_decoder_p->decode(
+                d_decoder_p->context,
+                segments.data(),
+                segments.size(),
+                &out))
+    {
+        result->d_rejected = true;
+        result->d_data_sp.reset();
+        result->d_length = 0;
+        result->d_reason = out.reason ? out.reason : "";
+    }
+}
+
+}  // namespace pybmq
+}  // namespace BloombergLP
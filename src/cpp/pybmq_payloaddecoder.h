@@ -0,0 +1,89 @@
+// Copyright 2019-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_PYBMQ_PAYLOADDECODER
+#define INCLUDED_PYBMQ_PAYLOADDECODER
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <blazingmq/blazingmq_decoder.h>
+
+#include <bdlbb_blob.h>
+
+#include <bsl_memory.h>
+#include <bsl_string.h>
+#include <bsl_vector.h>
+
+namespace BloombergLP {
+namespace pybmq {
+
+struct DecodedPayload
+{
+    // The outcome of running a 'PayloadDecoder' on the payload of one message.
+    // A default constructed object delivers the payload as it was received.
+
+    // DATA
+    bool d_rejected;
+    bsl::string d_reason;  // why the payload was rejected, possibly empty
+    bsl::shared_ptr<char> d_data_sp;  // the decoded payload, or null
+    int d_length;  // the length of 'd_data_sp'
+
+    // CREATORS
+    DecodedPayload();
+};
+
+typedef bsl::vector<DecodedPayload> DecodedPayloads;
+// The outcomes for the messages of an event, in the order they were received.
+
+class PayloadDecoder
+{
+    // Run a decoder exported by another extension module through a 'PyCapsule',
+    // as described in 'blazingmq_decoder.h', on message payloads.  'decode' may
+    // be called from any thread, without the GIL.
+
+  private:
+    // DATA
+    PyObject* d_capsule;  // owned
+    const blazingmq_PayloadDecoder* d_decoder_p;  // held by 'd_capsule'
+
+    // NOT IMPLEMENTED
+    PayloadDecoder(const PayloadDecoder&);
+    PayloadDecoder& operator=(const PayloadDecoder&);
+
+  public:
+    // CLASS METHODS
+    static bsl::shared_ptr<const PayloadDecoder> from_capsule(PyObject* capsule);
+    // Return a decoder running the one held by the specified 'capsule', or null
+    // with a Python exception set if it is not a capsule named
+    // 'BLAZINGMQ_PAYLOAD_DECODER_CAPSULE_NAME' holding a decoder of a supported
+    // version.  The GIL must be held.
+
+    PayloadDecoder(PyObject* capsule, const blazingmq_PayloadDecoder* decoder);
+    // Create an object running the specified 'decoder', and keeping a new
+    // reference to the specified 'capsule' holding it.  The GIL must be held.
+
+    ~PayloadDecoder();
+    // Destroy this object, acquiring the GIL to release its capsule.
+
+    void decode(DecodedPayload* result, const bdlbb::Blob& payload) const;
+    // Run the decoder on the specified 'payload' and load its outcome into the
+    // specified 'result'.  The GIL need not be held.
+};
+
+}  // namespace pybmq
+}  // namespace BloombergLP
+
+#endif
@@ -0,0 +1,46 @@
+// Copyright 2019-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <pybmq_propertiestemplate.h>
+
+#include <pybmq_messageutils.h>
+
+namespace BloombergLP {
+namespace pybmq {
+
+PropertiesTemplate::PropertiesTemplate()
+: d_properties()
+{
+}
+
+PyObject*
+PropertiesTemplate::load(PyObject* py_properties)
+{
+    d_properties.clear();
+    if (!MessageUtils::load_message_properties(&d_properties, py_properties)) {
+        d_properties.clear();
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+const bmqa::MessageProperties&
+PropertiesTemplate::properties() const
+{
+    return d_properties;
+}
+
+}  // namespace pybmq
+}  // namespace BloombergLP
@@ -0,0 +1,57 @@
+// Copyright 2019-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_PYBMQ_PROPERTIESTEMPLATE
+#define INCLUDED_PYBMQ_PROPERTIESTEMPLATE
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <bmqa_messageproperties.h>
+
+namespace BloombergLP {
+namespace pybmq {
+
+class PropertiesTemplate
+{
+    // Message properties converted from Python once, and then copied into
+    // every message posted with them.  The GIL must be held to call 'load'.
+
+  private:
+    // DATA
+    bmqa::MessageProperties d_properties;
+
+    // NOT IMPLEMENTED
+    PropertiesTemplate(const PropertiesTemplate&);
+    PropertiesTemplate& operator=(const PropertiesTemplate&);
+
+  public:
+    PropertiesTemplate();
+
+    PyObject* load(PyObject* py_properties);
+    // Replace the properties of this template with the specified
+    // 'py_properties', given in the format accepted by
+    // 'MessageUtils::load_message_properties'.  Return 'None', or NULL with a
+    // Python exception set if any property is invalid, in which case this
+    // template holds no properties.
+
+    const bmqa::MessageProperties& properties() const;
+    // Return the properties of this template.
+};
+
+}  // namespace pybmq
+}  // namespace BloombergLP
+
+#endif
@@ -15,31 +15,49 @@
 
 #include <pybmq_session.h>
 
+#include <pybmq_criticalsectionguard.h>
+#include <pybmq_flowcontroller.h>
 #include <pybmq_gilreleaseguard.h>
+#include <pybmq_loopbacksession.h>
 #include <pybmq_messageutils.h>
 #include <pybmq_mocksession.h>
+#include <pybmq_openqueuebatch.h>
+#include <pybmq_payloaddecoder.h>
+#include <pybmq_propertiestemplate.h>
 #include <pybmq_refutils.h>
 #include <pybmq_sessioneventhandler.h>
+#include <pybmq_subscriptionutils.h>
 
+#include <bsl_map.h>
 #include <bsl_memory.h>
 #include <bsl_sstream.h>
 #include <bsl_stdexcept.h>
 #include <bsl_string.h>
+#include <bsl_utility.h>
+#include <bsl_vector.h>
 #include <bslma_default.h>
 #include <bslma_managedptr.h>
-#include <bslmt_readerwriterlockassert.h>
-#include <bslmt_readlockguard.h>
-#include <bslmt_writelockguard.h>
-
+#include <bslmt_lockguard.h>
+#include <bslstl_stringref.h>
+#include <bsls_assert.h>
+#include <bsls_systemtime.h>
+#include <bsls_types.h>
+
+#include <bmqa_confirmeventbuilder.h>
+#include <bmqt_correlationid.h>
+#include <bmqt_messageguid.h>
 #include <bmqt_queueflags.h>
 #include <bmqt_queueoptions.h>
 #include <bmqt_resultcode.h>
+#include <bmqt_sessioneventtype.h>
 #include <bmqt_sessionoptions.h>
+#include <bmqt_uri.h>
 
 namespace BloombergLP {
 namespace pybmq {
 static const char* const SESSION_STOPPED = "Method called after session was stopped";
 static const char* const QUEUE_NOT_OPENED = "Queue not opened";
+static const double k_DEFAULT_MIN_AVAILABLE_MEMORY = 0.05;
 
 namespace {
 
@@ -71,12 +89,450 @@ class BrokerTimeoutError : public bsl::runtime_error
     }
 };
 
+struct PostItem
+{
+    // A message to be posted by 'Session::post_many', converted from Python
+    // while the GIL was still held.
+
+    const char* d_payload;
+    size_t d_payload_length;
+    bool d_has_properties;
+    bmqa::MessageProperties d_properties;
+    PyObject* d_on_ack;
+    bmqt::CorrelationId d_correlation_id;
+};
+
+class BufferReleaser
+{
+    // Release, on destruction, every buffer exported into the held vector.
+    // The GIL must be held when the releaser is destroyed.
+
+    bsl::vector<Py_buffer>* d_buffers_p;
+
+  public:
+    explicit BufferReleaser(bsl::vector<Py_buffer>* buffers)
+    : d_buffers_p(buffers)
+    {
+    }
+
+    ~BufferReleaser()
+    {
+        for (size_t i = 0; i < d_buffers_p->size(); ++i) {
+            PyBuffer_Release(&(*d_buffers_p)[i]);
+        }
+    }
+};
+
+bool
+isAckCallback(PyObject* on_ack)
+{
+    // Ack ids are plain integers; anything else but 'None' is a callback whose
+    // reference is owned by the SDK once the message is posted.
+    return on_ack != Py_None && !PyLong_Check(on_ack);
+}
+
+bool
+loadCorrelationId(bmqt::CorrelationId* correlation_id, PyObject* on_ack)
+{
+    // Load into the specified 'correlation_id' the id to post a message whose
+    // ack is handled by the specified 'on_ack': unset for 'None', numeric for
+    // an integer ack id, and pointing at 'on_ack' otherwise.  Return false with
+    // a Python exception set if 'on_ack' is an ack id out of range.
+    if (on_ack == Py_None) {
+        *correlation_id = bmqt::CorrelationId();
+    } else if (PyLong_Check(on_ack)) {
+        const long long ack_id = PyLong_AsLongLong(on_ack);
+        if (ack_id == -1 && PyErr_Occurred()) {
+            return false;
+        }
+        if (ack_id < 0) {
+            PyErr_SetString(PyExc_ValueError, "ack ids must not be negative");
+            return false;
+        }
+        *correlation_id = bmqt::CorrelationId(static_cast<bsls::Types::Int64>(ack_id));
+    } else {
+        *correlation_id = bmqt::CorrelationId(on_ack);
+    }
+    return true;
+}
+
+bmqt::EventBuilderResult::Enum
+packMessage(
+        bmqa::MessageEventBuilder* builder,
+        const bmqa::QueueId& queue_id,
+        const char* payload,
+        size_t payload_length,
+        const bmqa::MessageProperties* properties,
+        const bmqt::CorrelationId& correlation_id,
+        bmqt::CompressionAlgorithmType::Enum compression_type,
+        CompressionPolicy* policy)
+{
+    // Pack a message into the specified 'builder', compressed as the specified
+    // 'policy' decides if it is not null, and with the specified
+    // 'compression_type' otherwise.
+    const bsl::size_t size =
+            payload_length + (properties ? properties->totalSize() : 0);
+    bool sample = false;
+    if (policy) {
+        compression_type = policy->algorithm_for(size, &sample);
+    }
+
+    bmqa::Message& message = builder->startMessage();
+
+    message.setDataRef(payload, payload_length);
+
+    if (properties) {
+        message.setPropertiesRef(properties);
+    }
+
+    if (!correlation_id.isUnset()) {
+        message.setCorrelationId(correlation_id);
+    }
+
+    message.setCompressionAlgorithmType(compression_type);
+
+    const int size_before = builder->messageEventSize();
+    bmqt::EventBuilderResult::Enum rc = builder->packMessage(queue_id);
+    if (sample && rc == bmqt::EventBuilderResult::e_SUCCESS) {
+        policy->record_sample(size, builder->messageEventSize() - size_before);
+    }
+    return rc;
+}
+
+bmqt::EventBuilderResult::Enum
+packItem(
+        bmqa::MessageEventBuilder* builder,
+        const bmqa::QueueId& queue_id,
+        const PostItem& item,
+        bmqt::CompressionAlgorithmType::Enum compression_type,
+        CompressionPolicy* policy)
+{
+    return packMessage(
+            builder,
+            queue_id,
+            item.d_payload,
+            item.d_payload_length,
+            item.d_has_properties ? &item.d_properties : NULL,
+            item.d_correlation_id,
+            compression_type,
+            policy);
+}
+
+void
+postEvent(
+        bmqa::AbstractSession* session,
+        SessionStats* stats,
+        bmqa::MessageEventBuilder* builder,
+        const char* queue_uri)
+{
+    const bool sampled = stats->record_posted_event(builder->messageEvent());
+    bmqt::PostResult::Enum post_rc =
+            (bmqt::PostResult::Enum)session->post(builder->messageEvent());
+    if (post_rc) {
+        if (sampled) {
+            stats->discard_posted_event(builder->messageEvent());
+        }
+        bsl::ostringstream oss;
+        oss << "Failed to post message to " << queue_uri << " queue: " << post_rc;
+        throw GenericError(oss.str());
+    }
+}
+
+bmqt::PostResult::Enum
+postEventWhileThrottled(
+        bmqa::AbstractSession* session,
+        SessionStats* stats,
+        WritableSignal* writable_signal,
+        const bmqa::MessageEvent& event,
+        bool block,
+        const bsl::optional<bsls::TimeInterval>& timeout)
+{
+    // Post the specified 'event', then, if the specified 'block' is true, post
+    // it again each time the specified 'writable_signal' wakes us up for as
+    // long as the SDK refuses it with 'e_BW_LIMIT', for at most the specified
+    // 'timeout' if it has a value.  Return the result of the last attempt.
+    // Only the attempt that succeeds is sampled in the specified 'stats'.  The
+    // GIL must not be held.
+    bsl::optional<bsls::TimeInterval> deadline;
+    if (timeout.has_value()) {
+        deadline = bsls::SystemTime::nowRealtimeClock() + timeout.value();
+    }
+    while (true) {
+        const WritableSignal::Generation generation = writable_signal->generation();
+        const bool sampled = stats->record_posted_event(event);
+        bmqt::PostResult::Enum post_rc = (bmqt::PostResult::Enum)session->post(event);
+        if (post_rc && sampled) {
+            stats->discard_posted_event(event);
+        }
+        if (post_rc != bmqt::PostResult::e_BW_LIMIT || !block
+            || !writable_signal->wait(generation, deadline))
+        {
+            return post_rc;
+        }
+    }
+}
+
+void
+recordPosts(
+        const bmqa::QueueId& queue_id,
+        const bsl::vector<PostItem>& items,
+        size_t begin,
+        size_t end)
+{
+    // Count the messages of the specified 'items' in the range from the
+    // specified 'begin' to the specified 'end' as posted to 'queue_id'.
+    QueueStats* queue_stats = QueueStats::from_queue_id(queue_id);
+    if (!queue_stats) {
+        return;
+    }
+    for (size_t i = begin; i < end; ++i) {
+        queue_stats->record_post(items[i].d_payload_length);
+    }
+}
+
+bool
+loadQueueUri(const char** uri, Py_ssize_t* uri_length, PyObject* py_uri)
+{
+    if (PyUnicode_Check(py_uri)) {
+        *uri = PyUnicode_AsUTF8AndSize(py_uri, uri_length);
+        return *uri != NULL;
+    }
+    if (PyBytes_Check(py_uri)) {
+        char* buffer;
+        if (PyBytes_AsStringAndSize(py_uri, &buffer, uri_length)) {
+            return false;
+        }
+        *uri = buffer;
+        return true;
+    }
+    bsl::ostringstream oss;
+    oss << "queue_uri must be str or bytes, not '" << Py_TYPE(py_uri)->tp_name << "'";
+    PyErr_SetString(PyExc_TypeError, oss.str().c_str());
+    return false;
+}
+
+void
+confirmEvent(bmqa::AbstractSession* session, bmqa::ConfirmEventBuilder* builder)
+{
+    bmqt::GenericResult::Enum confirm_rc =
+            (bmqt::GenericResult::Enum)session->confirmMessages(builder);
+    if (confirm_rc) {
+        bsl::ostringstream oss;
+        oss << "Failed to confirm messages: " << confirm_rc;
+        throw GenericError(oss.str());
+    }
+    builder->reset();
+}
+
+void
+recordConfirms(
+        const bsl::vector<bmqa::QueueId>& queue_ids,
+        const bsl::vector<bsl::pair<size_t, bmqt::MessageGUID> >& confirms,
+        size_t begin,
+        size_t end)
+{
+    // Count the specified 'confirms' in the range from the specified 'begin' to
+    // the specified 'end' as confirmed on their queue in 'queue_ids'.
+    for (size_t i = begin; i < end; ++i) {
+        QueueStats* queue_stats =
+                QueueStats::from_queue_id(queue_ids[confirms[i].first]);
+        if (queue_stats) {
+            queue_stats->record_confirms(1);
+        }
+    }
+}
+
+bsls::Types::Uint64
+makeQueueFlags(bool read, bool write)
+{
+    bsls::Types::Uint64 flags = 0;
+    if (read) {
+        bmqt::QueueFlagsUtil::setReader(&flags);
+    }
+    if (write) {
+        bmqt::QueueFlagsUtil::setWriter(&flags);
+    }
+    return flags;
+}
+
+bmqt::QueueOptions
+makeQueueOptions(
+        bsl::optional<int> consumer_priority,
+        bsl::optional<int> max_unconfirmed_messages,
+        bsl::optional<int> max_unconfirmed_bytes,
+        bsl::optional<bool> suspends_on_bad_host_health)
+{
+    bmqt::QueueOptions options;
+
+    if (consumer_priority) {
+        options.setConsumerPriority(*consumer_priority);
+    }
+
+    if (max_unconfirmed_messages) {
+        options.setMaxUnconfirmedMessages(*max_unconfirmed_messages);
+    }
+
+    if (max_unconfirmed_bytes) {
+        options.setMaxUnconfirmedBytes(*max_unconfirmed_bytes);
+    }
+
+    if (suspends_on_bad_host_health) {
+        options.setSuspendsOnBadHostHealth(*suspends_on_bad_host_health);
+    }
+
+    return options;
+}
+
+void
+clampLimits(bmqt::QueueOptions* options, const FlowControlPolicy& flow_control)
+{
+    // Clamp the unconfirmed limits of the specified 'options', or the default
+    // ones if they're not set, to the bounds of the specified 'flow_control'.
+    options->setMaxUnconfirmedMessages(
+            flow_control.clamp_messages(options->maxUnconfirmedMessages()));
+    options->setMaxUnconfirmedBytes(
+            flow_control.clamp_bytes(options->maxUnconfirmedBytes()));
+}
+
+class PendingOperationGuard
+{
+    // Register an asynchronous queue operation with a 'SessionEventHandler' on
+    // construction, and cancel it on destruction unless 'release' was called
+    // once the operation was successfully started.
+
+    SessionEventHandler* d_handler_p;
+    bmqt::SessionEventType::Enum d_result_type;
+    bsl::string d_queue_uri;
+    PyObject* d_on_complete;
+    bsl::shared_ptr<OpenQueueBatch> d_batch_sp;
+    int d_batch_index;
+
+    // NOT IMPLEMENTED
+    PendingOperationGuard(const PendingOperationGuard&);
+    PendingOperationGuard& operator=(const PendingOperationGuard&);
+
+  public:
+    PendingOperationGuard(
+            SessionEventHandler* handler,
+            bmqt::SessionEventType::Enum result_type,
+            const bsl::string& queue_uri,
+            PyObject* on_complete,
+            bool installed_policy)
+    : d_handler_p(handler)
+    , d_result_type(result_type)
+    , d_queue_uri(queue_uri)
+    , d_on_complete(on_complete)
+    , d_batch_sp()
+    , d_batch_index(-1)
+    {
+        d_handler_p->add_pending_operation(
+                d_result_type,
+                d_queue_uri,
+                d_on_complete,
+                installed_policy);
+    }
+
+    PendingOperationGuard(
+            SessionEventHandler* handler,
+            const bsl::string& queue_uri,
+            PyObject* on_complete,
+            const bsl::shared_ptr<OpenQueueBatch>& batch,
+            int batch_index,
+            bool installed_policy)
+    : d_handler_p(handler)
+    , d_result_type(bmqt::SessionEventType::e_QUEUE_OPEN_RESULT)
+    , d_queue_uri(queue_uri)
+    , d_on_complete(on_complete)
+    , d_batch_sp(batch)
+    , d_batch_index(batch_index)
+    {
+        // An opening is reported to the specified 'batch' if it isn't null, and
+        // to the specified 'on_complete' otherwise.
+        if (d_batch_sp) {
+            d_handler_p->add_pending_operation(
+                    d_queue_uri,
+                    d_batch_sp,
+                    d_batch_index,
+                    installed_policy);
+        } else {
+            d_handler_p->add_pending_operation(
+                    d_result_type,
+                    d_queue_uri,
+                    d_on_complete,
+                    installed_policy);
+        }
+    }
+
+    ~PendingOperationGuard()
+    {
+        if (!d_handler_p) {
+            return;
+        }
+        if (d_batch_sp) {
+            d_handler_p->cancel_pending_operation(
+                    d_queue_uri,
+                    d_batch_sp,
+                    d_batch_index);
+        } else {
+            d_handler_p->cancel_pending_operation(
+                    d_result_type,
+                    d_queue_uri,
+                    d_on_complete);
+        }
+    }
+
+    void release()
+    {
+        d_handler_p = NULL;
+    }
+};
+
+typedef bsl::shared_ptr<const bsl::vector<bsl::string> > ProjectionSp;
+typedef bsl::shared_ptr<const PayloadDecoder> DecoderSp;
+
+bool
+loadProjection(ProjectionSp* projection_sp, PyObject* py_projection)
+{
+    bslma::ManagedPtr<PyObject> names = RefUtils::toManagedPtr(PySequence_Fast(
+            py_projection,
+            "property_projection must be a sequence of property names"));
+    if (!names) {
+        return false;
+    }
+    CriticalSectionGuard names_guard(names.get());
+
+    bsl::shared_ptr<bsl::vector<bsl::string> > projection =
+            bsl::make_shared<bsl::vector<bsl::string> >();
+    const Py_ssize_t num_names = PySequence_Fast_GET_SIZE(names.get());
+    projection->reserve(num_names);
+    for (Py_ssize_t i = 0; i < num_names; ++i) {
+        PyObject* name = PySequence_Fast_GET_ITEM(names.get(), i);
+        char* buffer;
+        Py_ssize_t length;
+        if (!PyBytes_Check(name)) {
+            bsl::ostringstream oss;
+            oss << "property names must be bytes, not '" << Py_TYPE(name)->tp_name
+                << "'";
+            PyErr_SetString(PyExc_TypeError, oss.str().c_str());
+            return false;
+        }
+        if (PyBytes_AsStringAndSize(name, &buffer, &length)) {
+            return false;
+        }
+        projection->push_back(bsl::string(buffer, length));
+    }
+    *projection_sp = projection;
+    return true;
+}
+
 }  // namespace
 
 Session::Session(
         PyObject* py_session_event_callback,
         PyObject* py_message_event_callback,
         PyObject* py_ack_event_callback,
+        PyObject* py_ack_batch_event_callback,
+        PyObject* py_slow_callback_event_callback,
         const char* broker_uri,
         const char* script_name,
         bmqt::CompressionAlgorithmType::Enum message_compression_type,
@@ -92,21 +548,46 @@ Session::Session(
         const bsls::TimeInterval& close_queue_timeout,
         bool monitor_host_health,
         bsl::shared_ptr<bmqa::ManualHostHealthMonitor> fake_host_health_monitor_sp,
+        bsl::shared_ptr<SystemHostHealthMonitor> system_host_health_monitor_sp,
+        bool zero_copy_payloads,
+        bool pull_messages,
+        int num_dispatch_threads,
+        bool time_callbacks,
+        const bsls::TimeInterval& slow_callback_threshold,
         PyObject* error,
         PyObject* broker_timeout_error,
+        const LoopbackOptions* loopback,
         PyObject* mock)
-: d_started_lock()
-, d_started(false)
+: d_state()
+, d_stats()
+, d_writable_signal()
 , d_message_compression_type(bmqt::CompressionAlgorithmType::e_NONE)
+, d_compression_policies_lock()
+, d_compression_policies_sp(bsl::make_shared<CompressionPolicies>())
+, d_has_compression_policies(false)
 , d_error(error)
 , d_broker_timeout_error(broker_timeout_error)
 , d_session_mp()
+, d_event_handler_p(NULL)
+, d_flow_controller_lock()
+, d_flow_controller_mp()
+, d_has_flow_control(false)
 {
     bsl::shared_ptr<bmqpi::HostHealthMonitor> host_health_monitor_sp;
 
     if (fake_host_health_monitor_sp) {
         host_health_monitor_sp = fake_host_health_monitor_sp;
+    } else if (system_host_health_monitor_sp) {
+        host_health_monitor_sp = system_host_health_monitor_sp;
     } else if (monitor_host_health) {
+        // Only flag the host as unhealthy when it is about to run out of
+        // memory, as no other threshold is sensible on every host.
+        host_health_monitor_sp = bsl::make_shared<SystemHostHealthMonitor>(
+                bsl::nullopt,
+                k_DEFAULT_MIN_AVAILABLE_MEMORY,
+                bsl::string(),
+                bsl::string(),
+                bsls::TimeInterval(1.0));
     }
 
     if (message_compression_type
@@ -119,6 +600,9 @@ Session::Session(
     }
 
     d_message_compression_type = message_compression_type;
+    if (time_callbacks) {
+        d_stats.enable_callback_timing(slow_callback_threshold.totalNanoseconds());
+    }
     {
         pybmq::GilReleaseGuard guard;
         bmqt::SessionOptions options;
@@ -168,18 +652,29 @@ Session::Session(
             options.setCloseQueueTimeout(close_queue_timeout);
         }
 
-        bslma::ManagedPtr<bmqa::SessionEventHandler> handler(
-                new pybmq::SessionEventHandler(
-                        py_session_event_callback,
-                        py_message_event_callback,
-                        py_ack_event_callback));
-        if (mock == Py_None) {
+        d_event_handler_p = new pybmq::SessionEventHandler(
+                py_session_event_callback,
+                py_message_event_callback,
+                py_ack_event_callback,
+                py_ack_batch_event_callback,
+                py_slow_callback_event_callback,
+                zero_copy_payloads,
+                pull_messages,
+                num_dispatch_threads,
+                &d_stats,
+                &d_writable_signal);
+        bslma::ManagedPtr<bmqa::SessionEventHandler> handler(d_event_handler_p);
+        if (loopback) {
+            d_session_mp = bslma::ManagedPtr<bmqa::AbstractSession>(
+                    new pybmq::LoopbackSession(*loopback, handler, options));
+        } else if (mock == Py_None) {
             d_session_mp = bslma::ManagedPtr<bmqa::AbstractSession>(
                     new bmqa::Session(handler, options));
         } else {
             d_session_mp = bslma::ManagedPtr<bmqa::AbstractSession>(
                     new pybmq::MockSession(mock, handler, options));
         }
+        d_event_handler_p->set_session(d_session_mp.get());
     }
     Py_INCREF(d_error);
     Py_INCREF(d_broker_timeout_error);
@@ -189,8 +684,9 @@ Session::~Session()
 {
     Py_DECREF(d_broker_timeout_error);
     Py_DECREF(d_error);
-    BSLS_ASSERT(!d_started);
+    BSLS_ASSERT(!d_state.is_started());
     pybmq::GilReleaseGuard gil_release_guard;
+    d_flow_controller_mp.reset();
     d_session_mp.reset();
 }
 
@@ -203,7 +699,7 @@ Session::start(const bsls::TimeInterval& timeout)
         rc = (bmqt::GenericResult::Enum)d_session_mp->start(timeout);
     }
     if (rc == bmqt::GenericResult::e_SUCCESS) {
-        d_started = true;
+        d_state.start();
         Py_RETURN_NONE;
     }
     PyObject* error_class =
@@ -222,15 +718,30 @@ Session::stop(bool warn_if_started)
     bool generate_warning;
     {
         pybmq::GilReleaseGuard gil_release_guard;
-        {
-            bslmt::WriteLockGuard<bslmt::ReaderWriterLock> guard(&d_started_lock);
-            was_started = d_started;
-            generate_warning = d_started && warn_if_started;
-            d_started = false;
-        }
+        // Posts blocked on a full channel hold a 'SessionStateGuard', so wake
+        // them up before waiting for those guards to be released.
+        d_writable_signal.close();
+        // Deliver the messages already handed to the dispatch threads while
+        // the session can still confirm them, rather than after the SDK has
+        // stopped, when confirming would fail and they would be redelivered.
+        // Messages received from now on are dropped, and redelivered once
+        // the session is gone.
+        d_event_handler_p->stop_dispatching();
+        was_started = d_state.stop();
+        generate_warning = was_started && warn_if_started;
         if (was_started) {
-            // Note: Neither the GIL nor d_started_lock may be held here.
+            // The flow controller only reconfigures queues while 'd_state' is
+            // started, so it's idle by now.
+            {
+                bslmt::LockGuard<bslmt::Mutex> lock(&d_flow_controller_lock);
+                d_flow_controller_mp.reset();
+            }
+            // An SDK thread may be waiting for 'receive' to make room for the
+            // event it received, so release it before joining the SDK threads.
+            d_event_handler_p->stop_receiving();
+            // Note: Neither the GIL nor a 'SessionStateGuard' may be held here.
             d_session_mp->stop();
+            d_stats.discard_samples();
         }
     }
 
@@ -248,6 +759,7 @@ Session::stop(bool warn_if_started)
 
 PyObject*
 Session::open_queue_sync(
+        bmqa::QueueId* queue_id,
         const char* queue_uri,
         bool read,
         bool write,
@@ -255,52 +767,87 @@ Session::open_queue_sync(
         bsl::optional<int> max_unconfirmed_messages,
         bsl::optional<int> max_unconfirmed_bytes,
         bsl::optional<bool> suspends_on_bad_host_health,
-        const bsls::TimeInterval& timeout)
+        PyObject* subscriptions,
+        const bsls::TimeInterval& timeout,
+        bool lazy_properties,
+        PyObject* property_projection,
+        const CompressionPolicy* compression_policy,
+        PyObject* payload_decoder,
+        const FlowControlPolicy* flow_control)
 {
-    try {
-        pybmq::GilReleaseGuard gil_release_guard;
-        bslmt::ReadLockGuard<bslmt::ReaderWriterLock> guard(&d_started_lock);
-
-        if (!d_started) {
-            throw GenericError(SESSION_STOPPED);
-        }
-
-        bsls::Types::Uint64 flags = 0;
-        if (read) {
-            bmqt::QueueFlagsUtil::setReader(&flags);
-        }
-        if (write) {
-            bmqt::QueueFlagsUtil::setWriter(&flags);
+    PropertyPolicy policy = {lazy_properties, ProjectionSp(), DecoderSp()};
+    if (property_projection != Py_None
+        && !loadProjection(&policy.d_projection_sp, property_projection))
+    {
+        return NULL;
+    }
+    if (payload_decoder != Py_None) {
+        policy.d_decoder_sp = PayloadDecoder::from_capsule(payload_decoder);
+        if (!policy.d_decoder_sp) {
+            return NULL;
         }
+    }
 
-        bmqa::QueueId dummy;
-
-        bmqt::QueueOptions options;
+    bmqt::QueueOptions options = makeQueueOptions(
+            consumer_priority,
+            max_unconfirmed_messages,
+            max_unconfirmed_bytes,
+            suspends_on_bad_host_health);
+    if (subscriptions != Py_None
+        && !SubscriptionUtils::load_subscriptions(&options, subscriptions))
+    {
+        return NULL;
+    }
+    if (flow_control) {
+        clampLimits(&options, *flow_control);
+    }
 
-        if (consumer_priority) {
-            options.setConsumerPriority(*consumer_priority);
-        }
+    try {
+        pybmq::GilReleaseGuard gil_release_guard;
+        SessionStateGuard guard(&d_state);
 
-        if (max_unconfirmed_messages) {
-            options.setMaxUnconfirmedMessages(*max_unconfirmed_messages);
+        if (!guard.started()) {
+            throw GenericError(SESSION_STOPPED);
         }
 
-        if (max_unconfirmed_bytes) {
-            options.setMaxUnconfirmedBytes(*max_unconfirmed_bytes);
+        // Install the policies before the queue is opened so that they apply to
+        // the very first message, but never replace the policies of a queue
+        // that is already open.
+        const bsl::string uri = bmqt::Uri(queue_uri).asString();
+        bool installed_policy = false;
+        bmqa::QueueId existing;
+        const bool replaces_policies =
+                (policy.d_lazy || policy.d_projection_sp || policy.d_decoder_sp
+                 || compression_policy || d_has_compression_policies
+                 || flow_control || d_has_flow_control)
+                && d_session_mp->getQueueId(&existing, bmqt::Uri(queue_uri));
+        if (replaces_policies
+            && (policy.d_lazy || policy.d_projection_sp || policy.d_decoder_sp))
+        {
+            d_event_handler_p->set_property_policy(uri, policy);
+            installed_policy = true;
         }
-
-        if (suspends_on_bad_host_health) {
-            options.setSuspendsOnBadHostHealth(*suspends_on_bad_host_health);
+        if (replaces_policies) {
+            set_compression_policy(uri, compression_policy);
+            set_flow_control(uri, flow_control);
         }
 
+        d_stats.attach(queue_id, uri);
         bmqa::OpenQueueStatus oqs;
         oqs = d_session_mp->openQueueSync(
-                &dummy,
+                queue_id,
                 bmqt::Uri(queue_uri),
-                flags,
+                makeQueueFlags(read, write),
                 options,
                 timeout);
         if (oqs.result()) {
+            if (installed_policy) {
+                d_event_handler_p->clear_property_policy(uri);
+            }
+            if (replaces_policies) {
+                set_compression_policy(uri, NULL);
+                set_flow_control(uri, NULL);
+            }
             bsl::ostringstream oss;
             oss << "Failed to open " << queue_uri << " queue: " << oqs.result() << ": "
                 << oqs.errorDescription();
@@ -320,6 +867,66 @@ Session::open_queue_sync(
     Py_RETURN_NONE;
 }
 
+bmqt::OpenQueueResult::Enum
+Session::start_open_queue(
+        bmqa::QueueId* queue_id,
+        const char* queue_uri,
+        bsls::Types::Uint64 flags,
+        const bmqt::QueueOptions& options,
+        const bsls::TimeInterval& timeout,
+        const PropertyPolicy& policy,
+        const CompressionPolicy* compression_policy,
+        const FlowControlPolicy* flow_control,
+        PyObject* on_complete,
+        const bsl::shared_ptr<OpenQueueBatch>& batch,
+        int batch_index)
+{
+    // As in 'open_queue_sync', install the policies before the queue is opened,
+    // and only if it is not open yet.  A compression policy left behind by a
+    // failed open is replaced when the queue is next opened.
+    const bsl::string uri = bmqt::Uri(queue_uri).asString();
+    bool installed_policy = false;
+    bmqa::QueueId existing;
+    const bool replaces_policies =
+            (policy.d_lazy || policy.d_projection_sp || policy.d_decoder_sp
+             || compression_policy || d_has_compression_policies || flow_control
+             || d_has_flow_control)
+            && d_session_mp->getQueueId(&existing, bmqt::Uri(queue_uri));
+    if (replaces_policies
+        && (policy.d_lazy || policy.d_projection_sp || policy.d_decoder_sp))
+    {
+        d_event_handler_p->set_property_policy(uri, policy);
+        installed_policy = true;
+    }
+    if (replaces_policies) {
+        set_compression_policy(uri, compression_policy);
+        set_flow_control(uri, flow_control);
+    }
+
+    // Register the operation first, since its result may be delivered on the
+    // event handler thread before 'openQueueAsync' even returns.
+    PendingOperationGuard pending(
+            d_event_handler_p,
+            uri,
+            on_complete,
+            batch,
+            batch_index,
+            installed_policy);
+
+    d_stats.attach(queue_id, uri);
+    bmqt::OpenQueueResult::Enum rc =
+            (bmqt::OpenQueueResult::Enum)d_session_mp->openQueueAsync(
+                    queue_id,
+                    bmqt::Uri(queue_uri),
+                    flags,
+                    options,
+                    timeout);
+    if (rc == bmqt::OpenQueueResult::e_SUCCESS) {
+        pending.release();
+    }
+    return rc;
+}
+
 PyObject*
 Session::configure_queue_sync(
         const char* queue_uri,
@@ -327,13 +934,25 @@ Session::configure_queue_sync(
         bsl::optional<int> max_unconfirmed_messages,
         bsl::optional<int> max_unconfirmed_bytes,
         bsl::optional<bool> suspends_on_bad_host_health,
+        PyObject* subscriptions,
         const bsls::TimeInterval& timeout)
 {
+    bmqt::QueueOptions options = makeQueueOptions(
+            consumer_priority,
+            max_unconfirmed_messages,
+            max_unconfirmed_bytes,
+            suspends_on_bad_host_health);
+    if (subscriptions != Py_None
+        && !SubscriptionUtils::load_subscriptions(&options, subscriptions))
+    {
+        return NULL;
+    }
+
     try {
         pybmq::GilReleaseGuard gil_release_guard;
-        bslmt::ReadLockGuard<bslmt::ReaderWriterLock> guard(&d_started_lock);
+        SessionStateGuard guard(&d_state);
 
-        if (!d_started) {
+        if (!guard.started()) {
             throw GenericError(SESSION_STOPPED);
         }
 
@@ -342,24 +961,6 @@ Session::configure_queue_sync(
             throw GenericError(QUEUE_NOT_OPENED);
         }
 
-        bmqt::QueueOptions options;
-
-        if (consumer_priority) {
-            options.setConsumerPriority(*consumer_priority);
-        }
-
-        if (max_unconfirmed_messages) {
-            options.setMaxUnconfirmedMessages(*max_unconfirmed_messages);
-        }
-
-        if (max_unconfirmed_bytes) {
-            options.setMaxUnconfirmedBytes(*max_unconfirmed_bytes);
-        }
-
-        if (suspends_on_bad_host_health) {
-            options.setSuspendsOnBadHostHealth(*suspends_on_bad_host_health);
-        }
-
         bmqa::ConfigureQueueStatus cqs;
         cqs = d_session_mp->configureQueueSync(&queue_id, options, timeout);
 
@@ -388,9 +989,9 @@ Session::close_queue_sync(const char* queue_uri, const bsls::TimeInterval& timeo
 {
     try {
         pybmq::GilReleaseGuard gil_release_guard;
-        bslmt::ReadLockGuard<bslmt::ReaderWriterLock> guard(&d_started_lock);
+        SessionStateGuard guard(&d_state);
 
-        if (!d_started) {
+        if (!guard.started()) {
             throw GenericError(SESSION_STOPPED);
         }
 
@@ -399,6 +1000,11 @@ Session::close_queue_sync(const char* queue_uri, const bsls::TimeInterval& timeo
             throw GenericError(QUEUE_NOT_OPENED);
         }
 
+        // Stop adjusting the limits of a queue as soon as it's being closed.
+        if (d_has_flow_control) {
+            set_flow_control(queue_id.uri().asString(), NULL);
+        }
+
         bmqa::CloseQueueStatus cqs;
         cqs = d_session_mp->closeQueueSync(&queue_id, timeout);
 
@@ -411,6 +1017,7 @@ Session::close_queue_sync(const char* queue_uri, const bsls::TimeInterval& timeo
             }
             throw GenericError(oss.str());
         }
+        d_event_handler_p->clear_property_policy(bmqt::Uri(queue_uri).asString());
     } catch (const GenericError& exc) {
         PyErr_SetString(d_error, exc.what());
         return NULL;
@@ -423,96 +1030,553 @@ Session::close_queue_sync(const char* queue_uri, const bsls::TimeInterval& timeo
 }
 
 PyObject*
-Session::get_queue_options(const char* queue_uri)
+Session::open_queue_async(
+        bmqa::QueueId* queue_id,
+        const char* queue_uri,
+        bool read,
+        bool write,
+        bsl::optional<int> consumer_priority,
+        bsl::optional<int> max_unconfirmed_messages,
+        bsl::optional<int> max_unconfirmed_bytes,
+        bsl::optional<bool> suspends_on_bad_host_health,
+        PyObject* subscriptions,
+        const bsls::TimeInterval& timeout,
+        bool lazy_properties,
+        PyObject* property_projection,
+        const CompressionPolicy* compression_policy,
+        PyObject* payload_decoder,
+        const FlowControlPolicy* flow_control,
+        PyObject* on_complete)
 {
-    int max_unconfirmed_messages;
-    int max_unconfirmed_bytes;
-    int consumer_priority;
-    bool suspends_on_bad_host_health;
+    PropertyPolicy policy = {lazy_properties, ProjectionSp(), DecoderSp()};
+    if (property_projection != Py_None
+        && !loadProjection(&policy.d_projection_sp, property_projection))
+    {
+        return NULL;
+    }
+    if (payload_decoder != Py_None) {
+        policy.d_decoder_sp = PayloadDecoder::from_capsule(payload_decoder);
+        if (!policy.d_decoder_sp) {
+            return NULL;
+        }
+    }
+
+    bmqt::QueueOptions options = makeQueueOptions(
+            consumer_priority,
+            max_unconfirmed_messages,
+            max_unconfirmed_bytes,
+            suspends_on_bad_host_health);
+    if (subscriptions != Py_None
+        && !SubscriptionUtils::load_subscriptions(&options, subscriptions))
+    {
+        return NULL;
+    }
+    if (flow_control) {
+        clampLimits(&options, *flow_control);
+    }
+
+    bslma::ManagedPtr<PyObject> managed_on_complete =
+            RefUtils::toManagedPtr(RefUtils::ref(on_complete));
 
     try {
         pybmq::GilReleaseGuard gil_release_guard;
-        bslmt::ReadLockGuard<bslmt::ReaderWriterLock> guard(&d_started_lock);
+        SessionStateGuard guard(&d_state);
 
-        if (!d_started) {
+        if (!guard.started()) {
             throw GenericError(SESSION_STOPPED);
         }
 
-        bmqa::QueueId queue_id;
-        if (d_session_mp->getQueueId(&queue_id, bmqt::Uri(queue_uri))) {
-            throw GenericError(QUEUE_NOT_OPENED);
+        const bmqt::OpenQueueResult::Enum rc = start_open_queue(
+                queue_id,
+                queue_uri,
+                makeQueueFlags(read, write),
+                options,
+                timeout,
+                policy,
+                compression_policy,
+                flow_control,
+                on_complete,
+                bsl::shared_ptr<OpenQueueBatch>(),
+                -1);
+        if (rc) {
+            bsl::ostringstream oss;
+            oss << "Failed to open " << queue_uri << " queue: " << rc;
+            throw GenericError(oss.str());
         }
-
-        const bmqt::QueueOptions& options = queue_id.options();
-        max_unconfirmed_messages = options.maxUnconfirmedMessages();
-        max_unconfirmed_bytes = options.maxUnconfirmedBytes();
-        consumer_priority = options.consumerPriority();
-        suspends_on_bad_host_health = options.suspendsOnBadHostHealth();
+        // The event handler now owns the `on_complete` callback object, so release
+        // our reference without a DECREF.
+        managed_on_complete.release();
     } catch (const GenericError& exc) {
         PyErr_SetString(d_error, exc.what());
         return NULL;
     }
 
-    return Py_BuildValue(
-            "i i i O",
-            max_unconfirmed_messages,
-            max_unconfirmed_bytes,
-            consumer_priority,
-            suspends_on_bad_host_health ? Py_True : Py_False);
+    Py_RETURN_NONE;
 }
 
 PyObject*
-Session::post(
-        const char* queue_uri,
-        const char* payload,
-        size_t payload_length,
-        PyObject* properties,
-        PyObject* on_ack)
+Session::open_queues(
+        const bsl::vector<bmqa::QueueId*>& queue_ids,
+        const bsl::vector<bsl::string>& queue_uris,
+        bool read,
+        bool write,
+        bsl::optional<int> consumer_priority,
+        bsl::optional<int> max_unconfirmed_messages,
+        bsl::optional<int> max_unconfirmed_bytes,
+        bsl::optional<bool> suspends_on_bad_host_health,
+        PyObject* subscriptions,
+        const bsls::TimeInterval& timeout,
+        bool lazy_properties,
+        PyObject* property_projection,
+        const CompressionPolicy* compression_policy,
+        PyObject* payload_decoder,
+        const FlowControlPolicy* flow_control,
+        int max_in_flight)
 {
-    bslma::ManagedPtr<PyObject> managed_on_ack;
-    if (on_ack != Py_None) {
-        managed_on_ack = RefUtils::toManagedPtr(RefUtils::ref(on_ack));
-    }
+    BSLS_ASSERT(queue_ids.size() == queue_uris.size());
 
-    bmqa::MessageProperties c_properties;
-    if (properties != Py_None) {
-        d_session_mp->loadMessageProperties(&c_properties);
-        if (!pybmq::MessageUtils::load_message_properties(&c_properties, properties)) {
+    PropertyPolicy policy = {lazy_properties, ProjectionSp(), DecoderSp()};
+    if (property_projection != Py_None
+        && !loadProjection(&policy.d_projection_sp, property_projection))
+    {
+        return NULL;
+    }
+    if (payload_decoder != Py_None) {
+        policy.d_decoder_sp = PayloadDecoder::from_capsule(payload_decoder);
+        if (!policy.d_decoder_sp) {
             return NULL;
         }
     }
 
-    try {
-        pybmq::GilReleaseGuard gil_release_guard;
-        bslmt::ReadLockGuard<bslmt::ReaderWriterLock> guard(&d_started_lock);
-
-        if (!d_started) {
-            throw GenericError(SESSION_STOPPED);
-        }
-
-        bmqa::QueueId queue_id;
+    bmqt::QueueOptions options = makeQueueOptions(
+            consumer_priority,
+            max_unconfirmed_messages,
+            max_unconfirmed_bytes,
+            suspends_on_bad_host_health);
+    if (subscriptions != Py_None
+        && !SubscriptionUtils::load_subscriptions(&options, subscriptions))
+    {
+        return NULL;
+    }
+    if (flow_control) {
+        clampLimits(&options, *flow_control);
+    }
+
+    if (!d_state.is_started()) {
+        PyErr_SetString(d_error, SESSION_STOPPED);
+        return NULL;
+    }
+
+    const int num_queues = static_cast<int>(queue_uris.size());
+    bsl::shared_ptr<OpenQueueBatch> batch_sp =
+            bsl::make_shared<OpenQueueBatch>(num_queues, max_in_flight);
+    {
+        pybmq::GilReleaseGuard gil_release_guard;
+        for (int i = 0; i < num_queues; ++i) {
+            // Wait for a slot without a 'SessionStateGuard', which would hold up
+            // a concurrent 'stop'.
+            batch_sp->acquire();
+            SessionStateGuard guard(&d_state);
+            if (!guard.started()) {
+                batch_sp->complete(i, bmqt::GenericResult::e_UNKNOWN, SESSION_STOPPED);
+                continue;
+            }
+            const bmqt::OpenQueueResult::Enum rc = start_open_queue(
+                    queue_ids[i],
+                    queue_uris[i].c_str(),
+                    makeQueueFlags(read, write),
+                    options,
+                    timeout,
+                    policy,
+                    compression_policy,
+                    flow_control,
+                    NULL,
+                    batch_sp,
+                    i);
+            if (rc) {
+                bsl::ostringstream oss;
+                oss << "Failed to open " << queue_uris[i] << " queue: " << rc;
+                batch_sp->complete(i, rc, oss.str());
+            }
+        }
+        batch_sp->wait();
+    }
+
+    bslma::ManagedPtr<PyObject> results =
+            RefUtils::toManagedPtr(PyList_New(num_queues));
+    if (!results) {
+        return NULL;
+    }
+    for (int i = 0; i < num_queues; ++i) {
+        const OpenQueueBatch::Result& result = batch_sp->result(i);
+        PyObject* item;
+        if (result.d_status == 0) {
+            item = RefUtils::ref(Py_None);
+        } else {
+            item = Py_BuildValue(
+                    "(y# O)",
+                    result.d_error.c_str(),
+                    static_cast<Py_ssize_t>(result.d_error.length()),
+                    result.d_status == bmqt::GenericResult::e_TIMEOUT ? Py_True
+                                                                      : Py_False);
+            if (!item) {
+                return NULL;
+            }
+        }
+        PyList_SET_ITEM(results.get(), i, item);
+    }
+    return results.release().first;
+}
+
+PyObject*
+Session::configure_queue_async(
+        const char* queue_uri,
+        bsl::optional<int> consumer_priority,
+        bsl::optional<int> max_unconfirmed_messages,
+        bsl::optional<int> max_unconfirmed_bytes,
+        bsl::optional<bool> suspends_on_bad_host_health,
+        PyObject* subscriptions,
+        const bsls::TimeInterval& timeout,
+        PyObject* on_complete)
+{
+    bmqt::QueueOptions options = makeQueueOptions(
+            consumer_priority,
+            max_unconfirmed_messages,
+            max_unconfirmed_bytes,
+            suspends_on_bad_host_health);
+    if (subscriptions != Py_None
+        && !SubscriptionUtils::load_subscriptions(&options, subscriptions))
+    {
+        return NULL;
+    }
+
+    bslma::ManagedPtr<PyObject> managed_on_complete =
+            RefUtils::toManagedPtr(RefUtils::ref(on_complete));
+
+    try {
+        pybmq::GilReleaseGuard gil_release_guard;
+        SessionStateGuard guard(&d_state);
+
+        if (!guard.started()) {
+            throw GenericError(SESSION_STOPPED);
+        }
+
+        bmqa::QueueId queue_id;
         if (d_session_mp->getQueueId(&queue_id, bmqt::Uri(queue_uri))) {
             throw GenericError(QUEUE_NOT_OPENED);
         }
 
-        bmqa::MessageEventBuilder builder;
-        d_session_mp->loadMessageEventBuilder(&builder);
+        PendingOperationGuard pending(
+                d_event_handler_p,
+                bmqt::SessionEventType::e_QUEUE_CONFIGURE_RESULT,
+                queue_id.uri().asString(),
+                on_complete,
+                false);
+
+        bmqt::ConfigureQueueResult::Enum rc =
+                (bmqt::ConfigureQueueResult::Enum)d_session_mp->configureQueueAsync(
+                        &queue_id,
+                        options,
+                        timeout);
+        if (rc) {
+            bsl::ostringstream oss;
+            oss << "Failed to configure " << queue_uri << " queue: " << rc;
+            throw GenericError(oss.str());
+        }
+        pending.release();
+        managed_on_complete.release();
+    } catch (const GenericError& exc) {
+        PyErr_SetString(d_error, exc.what());
+        return NULL;
+    }
+
+    Py_RETURN_NONE;
+}
+
+PyObject*
+Session::close_queue_async(
+        const char* queue_uri,
+        const bsls::TimeInterval& timeout,
+        PyObject* on_complete)
+{
+    bslma::ManagedPtr<PyObject> managed_on_complete =
+            RefUtils::toManagedPtr(RefUtils::ref(on_complete));
+
+    try {
+        pybmq::GilReleaseGuard gil_release_guard;
+        SessionStateGuard guard(&d_state);
+
+        if (!guard.started()) {
+            throw GenericError(SESSION_STOPPED);
+        }
+
+        bmqa::QueueId queue_id;
+        if (d_session_mp->getQueueId(&queue_id, bmqt::Uri(queue_uri))) {
+            throw GenericError(QUEUE_NOT_OPENED);
+        }
+
+        if (d_has_flow_control) {
+            set_flow_control(queue_id.uri().asString(), NULL);
+        }
+
+        PendingOperationGuard pending(
+                d_event_handler_p,
+                bmqt::SessionEventType::e_QUEUE_CLOSE_RESULT,
+                queue_id.uri().asString(),
+                on_complete,
+                false);
+
+        bmqt::CloseQueueResult::Enum rc =
+                (bmqt::CloseQueueResult::Enum)
+                        d_session_mp->closeQueueAsync(&queue_id, timeout);
+        if (rc) {
+            bsl::ostringstream oss;
+            oss << "Failed to close " << queue_uri << " queue: " << rc;
+            throw GenericError(oss.str());
+        }
+        pending.release();
+        managed_on_complete.release();
+    } catch (const GenericError& exc) {
+        PyErr_SetString(d_error, exc.what());
+        return NULL;
+    }
+
+    Py_RETURN_NONE;
+}
 
-        bmqa::Message& message = builder.startMessage();
+PyObject*
+Session::get_queue_options(const char* queue_uri)
+{
+    bmqt::QueueOptions options;
 
-        message.setDataRef(payload, payload_length);
+    try {
+        pybmq::GilReleaseGuard gil_release_guard;
+        SessionStateGuard guard(&d_state);
 
-        if (properties != Py_None) {
-            message.setPropertiesRef(&c_properties);
+        if (!guard.started()) {
+            throw GenericError(SESSION_STOPPED);
         }
 
-        if (on_ack != Py_None) {
-            message.setCorrelationId(bmqt::CorrelationId(on_ack));
+        bmqa::QueueId queue_id;
+        if (d_session_mp->getQueueId(&queue_id, bmqt::Uri(queue_uri))) {
+            throw GenericError(QUEUE_NOT_OPENED);
+        }
+
+        options = queue_id.options();
+    } catch (const GenericError& exc) {
+        PyErr_SetString(d_error, exc.what());
+        return NULL;
+    }
+
+    return Py_BuildValue(
+            "i i i O N",
+            options.maxUnconfirmedMessages(),
+            options.maxUnconfirmedBytes(),
+            options.consumerPriority(),
+            options.suspendsOnBadHostHealth() ? Py_True : Py_False,
+            SubscriptionUtils::get_subscriptions(options));
+}
+
+bsl::shared_ptr<CompressionPolicy>
+Session::compression_policy(const bmqa::QueueId& queue_id)
+{
+    if (!d_has_compression_policies) {
+        return bsl::shared_ptr<CompressionPolicy>();
+    }
+    bsl::shared_ptr<const CompressionPolicies> policies_sp;
+    {
+        bslmt::LockGuard<bslmt::Mutex> lock(&d_compression_policies_lock);
+        policies_sp = d_compression_policies_sp;
+    }
+    CompressionPolicies::const_iterator it =
+            policies_sp->find(queue_id.uri().asString());
+    if (it == policies_sp->end()) {
+        return bsl::shared_ptr<CompressionPolicy>();
+    }
+    return it->second;
+}
+
+void
+Session::set_compression_policy(
+        const bsl::string& queue_uri,
+        const CompressionPolicy* compression_policy)
+{
+    bslmt::LockGuard<bslmt::Mutex> lock(&d_compression_policies_lock);
+    if (!compression_policy && !d_compression_policies_sp->count(queue_uri)) {
+        return;
+    }
+    bsl::shared_ptr<CompressionPolicies> policies_sp =
+            bsl::make_shared<CompressionPolicies>(*d_compression_policies_sp);
+    if (compression_policy) {
+        // Each queue adapts to its own messages, so it gets a policy of its own.
+        (*policies_sp)[queue_uri] = bsl::make_shared<CompressionPolicy>(
+                compression_policy->algorithm(),
+                compression_policy->min_size(),
+                compression_policy->adaptive());
+        d_has_compression_policies = true;
+    } else {
+        policies_sp->erase(queue_uri);
+    }
+    d_compression_policies_sp = policies_sp;
+}
+
+void
+Session::set_flow_control(
+        const bsl::string& queue_uri,
+        const FlowControlPolicy* flow_control)
+{
+    bslmt::LockGuard<bslmt::Mutex> lock(&d_flow_controller_lock);
+    if (!flow_control) {
+        if (d_flow_controller_mp) {
+            d_flow_controller_mp->set_policy(
+                    queue_uri,
+                    bsl::shared_ptr<const FlowControlPolicy>());
         }
+        return;
+    }
+    if (!d_flow_controller_mp) {
+        d_flow_controller_mp.load(new FlowController(
+                &d_state,
+                d_session_mp.get(),
+                d_event_handler_p,
+                &d_stats));
+        d_has_flow_control = true;
+    }
+    d_flow_controller_mp->set_policy(
+            queue_uri,
+            bsl::make_shared<FlowControlPolicy>(*flow_control));
+}
 
-        message.setCompressionAlgorithmType(d_message_compression_type);
+PyObject*
+Session::post(
+        const char* queue_uri,
+        const char* payload,
+        size_t payload_length,
+        PyObject* properties,
+        const PropertiesTemplate* properties_template,
+        PyObject* on_ack,
+        const bsl::optional<bmqt::CompressionAlgorithmType::Enum>& compression_algorithm,
+        bool block,
+        const bsl::optional<bsls::TimeInterval>& timeout,
+        bool raise_on_bw_limit)
+{
+    return post_impl(
+            NULL,
+            queue_uri,
+            payload,
+            payload_length,
+            properties,
+            properties_template,
+            on_ack,
+            compression_algorithm,
+            block,
+            timeout,
+            raise_on_bw_limit);
+}
 
-        bmqt::EventBuilderResult::Enum builder_rc = builder.packMessage(queue_id);
+PyObject*
+Session::post_to_queue(
+        const bmqa::QueueId& queue_id,
+        const char* payload,
+        size_t payload_length,
+        PyObject* properties,
+        const PropertiesTemplate* properties_template,
+        PyObject* on_ack,
+        const bsl::optional<bmqt::CompressionAlgorithmType::Enum>& compression_algorithm,
+        bool block,
+        const bsl::optional<bsls::TimeInterval>& timeout,
+        bool raise_on_bw_limit)
+{
+    return post_impl(
+            &queue_id,
+            queue_id.uri().asString().c_str(),
+            payload,
+            payload_length,
+            properties,
+            properties_template,
+            on_ack,
+            compression_algorithm,
+            block,
+            timeout,
+            raise_on_bw_limit);
+}
+
+PyObject*
+Session::post_impl(
+        const bmqa::QueueId* cached_queue_id,
+        const char* queue_uri,
+        const char* payload,
+        size_t payload_length,
+        PyObject* properties,
+        const PropertiesTemplate* properties_template,
+        PyObject* on_ack,
+        const bsl::optional<bmqt::CompressionAlgorithmType::Enum>& compression_algorithm,
+        bool block,
+        const bsl::optional<bsls::TimeInterval>& timeout,
+        bool raise_on_bw_limit)
+{
+    bmqt::CorrelationId correlation_id;
+    if (!loadCorrelationId(&correlation_id, on_ack)) {
+        return NULL;
+    }
+    bslma::ManagedPtr<PyObject> managed_on_ack;
+    if (isAckCallback(on_ack)) {
+        managed_on_ack = RefUtils::toManagedPtr(RefUtils::ref(on_ack));
+    }
+
+    bmqa::MessageProperties c_properties;
+    const bool has_properties = properties != Py_None || properties_template;
+    if (has_properties) {
+        d_session_mp->loadMessageProperties(&c_properties);
+        if (properties_template) {
+            c_properties = properties_template->properties();
+        }
+        if (properties != Py_None
+            && !pybmq::MessageUtils::load_message_properties(&c_properties, properties))
+        {
+            return NULL;
+        }
+    }
+
+    bool posted = true;
+    try {
+        pybmq::GilReleaseGuard gil_release_guard;
+        SessionStateGuard guard(&d_state);
+
+        if (!guard.started()) {
+            throw GenericError(SESSION_STOPPED);
+        }
+
+        bmqa::QueueId queue_id;
+        if (!cached_queue_id
+            && d_session_mp->getQueueId(&queue_id, bmqt::Uri(queue_uri)))
+        {
+            throw GenericError(QUEUE_NOT_OPENED);
+        }
+
+        const bmqa::QueueId& target_queue_id =
+                cached_queue_id ? *cached_queue_id : queue_id;
+        bsl::shared_ptr<CompressionPolicy> policy_sp;
+        bmqt::CompressionAlgorithmType::Enum compression_type =
+                d_message_compression_type;
+        if (compression_algorithm.has_value()) {
+            compression_type = compression_algorithm.value();
+        } else {
+            policy_sp = compression_policy(target_queue_id);
+        }
+
+        bmqa::MessageEventBuilder builder;
+        d_session_mp->loadMessageEventBuilder(&builder);
+
+        bmqt::EventBuilderResult::Enum builder_rc = packMessage(
+                &builder,
+                target_queue_id,
+                payload,
+                payload_length,
+                has_properties ? &c_properties : NULL,
+                correlation_id,
+                compression_type,
+                policy_sp.get());
         if (builder_rc) {
             bsl::ostringstream oss;
             oss << "Failed to construct message: " << builder_rc;
@@ -520,32 +1584,136 @@ Session::post(
         }
 
         const bmqa::MessageEvent& messageEvent = builder.messageEvent();
-        bmqt::PostResult::Enum post_rc =
-                (bmqt::PostResult::Enum)d_session_mp->post(messageEvent);
-        if (post_rc) {
+        bmqt::PostResult::Enum post_rc = postEventWhileThrottled(
+                d_session_mp.get(),
+                &d_stats,
+                &d_writable_signal,
+                messageEvent,
+                block,
+                timeout);
+        if (post_rc == bmqt::PostResult::e_BW_LIMIT && !raise_on_bw_limit) {
+            // The SDK never took ownership of the 'on_ack' callback object.
+            posted = false;
+        } else if (post_rc) {
             bsl::ostringstream oss;
             oss << "Failed to post message to " << queue_uri << " queue: " << post_rc;
             throw GenericError(oss.str());
+        } else {
+            QueueStats* queue_stats = QueueStats::from_queue_id(target_queue_id);
+            if (queue_stats) {
+                queue_stats->record_post(payload_length);
+            }
+            // We have a successful post and the SDK now owns the `on_ack` callback
+            // object so release our reference without a DECREF.
+            managed_on_ack.release();
         }
-        // We have a successful post and the SDK now owns the `on_ack` callback object
-        // so release our reference without a DECREF.
-        managed_on_ack.release();
     } catch (const GenericError& exc) {
         PyErr_SetString(d_error, exc.what());
         return NULL;
     }
 
-    Py_RETURN_NONE;
+    if (!posted) {
+        Py_RETURN_FALSE;
+    }
+    Py_RETURN_TRUE;
 }
 
 PyObject*
-Session::confirm(const char* queue_uri, const unsigned char* guid, size_t guid_length)
+Session::post_many(
+        const char* queue_uri,
+        PyObject* messages,
+        const PropertiesTemplate* properties_template)
 {
+    bslma::ManagedPtr<PyObject> iterator =
+            RefUtils::toManagedPtr(PyObject_GetIter(messages));
+    if (!iterator) {
+        if (PyErr_ExceptionMatches(PyExc_TypeError)) {
+            PyErr_SetString(PyExc_TypeError, "'messages' must be an iterable");
+        }
+        return NULL;
+    }
+    // The messages are copied into a tuple, which no other thread can resize,
+    // so its items stay alive while they are borrowed below, even when
+    // converting the properties runs arbitrary code.  Once the GIL is
+    // released, each payload is kept alive by its exported buffer and each
+    // 'on_ack' callback by the reference taken for the SDK.
+    bslma::ManagedPtr<PyObject> sequence =
+            RefUtils::toManagedPtr(PySequence_Tuple(iterator.get()));
+    if (!sequence) {
+        return NULL;
+    }
+
+    const Py_ssize_t num_messages = PyTuple_GET_SIZE(sequence.get());
+    bsl::vector<PostItem> items(num_messages);
+
+    // The payloads are packed straight from the exported buffers, so the
+    // exports are held until every event has been built and posted.
+    bsl::vector<Py_buffer> payload_buffers;
+    payload_buffers.reserve(num_messages);
+    BufferReleaser releaser(&payload_buffers);
+
+    for (Py_ssize_t i = 0; i < num_messages; ++i) {
+        PyObject* item = PyTuple_GET_ITEM(sequence.get(), i);
+        if (!PyTuple_Check(item) || PyTuple_GET_SIZE(item) != 3) {
+            PyErr_SetString(
+                    PyExc_TypeError,
+                    "each message must be a (payload, properties, on_ack) tuple");
+            return NULL;
+        }
+
+        PyObject* payload = PyTuple_GET_ITEM(item, 0);
+        PyObject* properties = PyTuple_GET_ITEM(item, 1);
+        if (!PyObject_CheckBuffer(payload)) {
+            bsl::ostringstream oss;
+            oss << "message payload must be a bytes-like object, not '"
+                << Py_TYPE(payload)->tp_name << "'";
+            PyErr_SetString(PyExc_TypeError, oss.str().c_str());
+            return NULL;
+        }
+
+        Py_buffer buffer;
+        if (0 != PyObject_GetBuffer(payload, &buffer, PyBUF_SIMPLE)) {
+            return NULL;
+        }
+        payload_buffers.push_back(buffer);
+
+        items[i].d_payload = static_cast<const char*>(buffer.buf);
+        items[i].d_payload_length = buffer.len;
+        items[i].d_has_properties = properties != Py_None || properties_template;
+        items[i].d_on_ack = PyTuple_GET_ITEM(item, 2);
+        if (!loadCorrelationId(&items[i].d_correlation_id, items[i].d_on_ack)) {
+            return NULL;
+        }
+
+        if (items[i].d_has_properties) {
+            d_session_mp->loadMessageProperties(&items[i].d_properties);
+            if (properties_template) {
+                items[i].d_properties = properties_template->properties();
+            }
+            if (properties != Py_None
+                && !pybmq::MessageUtils::load_message_properties(
+                        &items[i].d_properties,
+                        properties))
+            {
+                return NULL;
+            }
+        }
+    }
+
+    // Every message is valid; take the references that the SDK will own once
+    // each message has been successfully posted.
+    for (size_t i = 0; i < items.size(); ++i) {
+        if (isAckCallback(items[i].d_on_ack)) {
+            Py_INCREF(items[i].d_on_ack);
+        }
+    }
+
+    size_t num_posted = 0;
     try {
         pybmq::GilReleaseGuard gil_release_guard;
-        bslmt::ReadLockGuard<bslmt::ReaderWriterLock> guard(&d_started_lock);
+        SessionStateGuard guard(&d_state);
 
-        if (!d_started) {
+        if (!guard.started()) {
             throw GenericError(SESSION_STOPPED);
         }
 
@@ -553,6 +1721,106 @@ Session::confirm(const char* queue_uri, const unsigned char* guid, size_t guid_l
         if (d_session_mp->getQueueId(&queue_id, bmqt::Uri(queue_uri))) {
             throw GenericError(QUEUE_NOT_OPENED);
         }
+        const bsl::shared_ptr<CompressionPolicy> policy_sp =
+                compression_policy(queue_id);
+
+        bmqa::MessageEventBuilder builder;
+        d_session_mp->loadMessageEventBuilder(&builder);
+
+        size_t num_packed = 0;
+        for (size_t i = 0; i < items.size(); ++i) {
+            bmqt::EventBuilderResult::Enum builder_rc = packItem(
+                    &builder,
+                    queue_id,
+                    items[i],
+                    d_message_compression_type,
+                    policy_sp.get());
+            if (builder_rc == bmqt::EventBuilderResult::e_EVENT_TOO_BIG && num_packed) {
+                // The event is full: post it and retry with a fresh one.
+                postEvent(d_session_mp.get(), &d_stats, &builder, queue_uri);
+                recordPosts(queue_id, items, num_posted, num_posted + num_packed);
+                num_posted += num_packed;
+                num_packed = 0;
+                builder.reset();
+                builder_rc = packItem(
+                        &builder,
+                        queue_id,
+                        items[i],
+                        d_message_compression_type,
+                        policy_sp.get());
+            }
+            if (builder_rc) {
+                bsl::ostringstream oss;
+                oss << "Failed to construct message: " << builder_rc;
+                throw GenericError(oss.str());
+            }
+            ++num_packed;
+        }
+
+        if (num_packed) {
+            postEvent(d_session_mp.get(), &d_stats, &builder, queue_uri);
+            recordPosts(queue_id, items, num_posted, num_posted + num_packed);
+            num_posted += num_packed;
+        }
+    } catch (const GenericError& exc) {
+        // The SDK only owns the 'on_ack' callbacks of the messages it accepted.
+        for (size_t i = num_posted; i < items.size(); ++i) {
+            if (isAckCallback(items[i].d_on_ack)) {
+                Py_DECREF(items[i].d_on_ack);
+            }
+        }
+        bsl::ostringstream oss;
+        oss << exc.what() << " (" << num_posted << " of " << items.size()
+            << " messages posted)";
+        PyErr_SetString(d_error, oss.str().c_str());
+        return NULL;
+    }
+
+    Py_RETURN_NONE;
+}
+
+PyObject*
+Session::confirm(const char* queue_uri, const unsigned char* guid, size_t guid_length)
+{
+    return confirm_impl(NULL, queue_uri, guid, guid_length);
+}
+
+PyObject*
+Session::confirm_on_queue(
+        const bmqa::QueueId& queue_id,
+        const unsigned char* guid,
+        size_t guid_length)
+{
+    return confirm_impl(
+            &queue_id,
+            queue_id.uri().asString().c_str(),
+            guid,
+            guid_length);
+}
+
+PyObject*
+Session::confirm_impl(
+        const bmqa::QueueId* cached_queue_id,
+        const char* queue_uri,
+        const unsigned char* guid,
+        size_t guid_length)
+{
+    try {
+        pybmq::GilReleaseGuard gil_release_guard;
+        SessionStateGuard guard(&d_state);
+
+        if (!guard.started()) {
+            throw GenericError(SESSION_STOPPED);
+        }
+
+        bmqa::QueueId looked_up_queue_id;
+        if (!cached_queue_id
+            && d_session_mp->getQueueId(&looked_up_queue_id, bmqt::Uri(queue_uri)))
+        {
+            throw GenericError(QUEUE_NOT_OPENED);
+        }
+        const bmqa::QueueId& queue_id =
+                cached_queue_id ? *cached_queue_id : looked_up_queue_id;
 
         if (!queue_id.isValid()) {
             bsl::ostringstream oss;
@@ -577,6 +1845,10 @@ Session::confirm(const char* queue_uri, const unsigned char* guid, size_t guid_l
             oss << "Failed to confirm message [" << c_guid << "]: " << confirm_rc;
             throw GenericError(oss.str());
         }
+        QueueStats* queue_stats = QueueStats::from_queue_id(queue_id);
+        if (queue_stats) {
+            queue_stats->record_confirms(1);
+        }
     } catch (const GenericError& exc) {
         PyErr_SetString(d_error, exc.what());
         return NULL;
@@ -585,5 +1857,173 @@ Session::confirm(const char* queue_uri, const unsigned char* guid, size_t guid_l
     Py_RETURN_NONE;
 }
 
+PyObject*
+Session::confirm_many(PyObject* messages)
+{
+    bslma::ManagedPtr<PyObject> sequence = RefUtils::toManagedPtr(
+            PySequence_Fast(messages, "'messages' must be an iterable"));
+    if (!sequence) {
+        return NULL;
+    }
+    // A list is not copied by 'PySequence_Fast', so keep other threads from
+    // resizing it while its items are borrowed.
+    CriticalSectionGuard sequence_guard(sequence.get());
+
+    // Most batches hold messages from a handful of queues, so each distinct
+    // URI is only resolved to a 'bmqa::QueueId' once.
+    bsl::vector<bsl::string> queue_uris;
+    bsl::vector<bsl::pair<size_t, bmqt::MessageGUID> > confirms;
+
+    const Py_ssize_t num_messages = PySequence_Fast_GET_SIZE(sequence.get());
+    confirms.reserve(num_messages);
+    for (Py_ssize_t i = 0; i < num_messages; ++i) {
+        PyObject* message = PySequence_Fast_GET_ITEM(sequence.get(), i);
+        bslma::ManagedPtr<PyObject> py_queue_uri =
+                RefUtils::toManagedPtr(PyObject_GetAttrString(message, "queue_uri"));
+        if (!py_queue_uri) {
+            return NULL;
+        }
+        bslma::ManagedPtr<PyObject> py_guid =
+                RefUtils::toManagedPtr(PyObject_GetAttrString(message, "guid"));
+        if (!py_guid) {
+            return NULL;
+        }
+
+        const char* uri;
+        Py_ssize_t uri_length;
+        if (!loadQueueUri(&uri, &uri_length, py_queue_uri.get())) {
+            return NULL;
+        }
+        const bslstl::StringRef uri_ref(uri, uri_length);
+        size_t uri_index = 0;
+        while (uri_index < queue_uris.size()
+               && bslstl::StringRef(queue_uris[uri_index]) != uri_ref)
+        {
+            ++uri_index;
+        }
+        if (uri_index == queue_uris.size()) {
+            queue_uris.push_back(bsl::string(uri, uri_length));
+        }
+
+        if (!PyBytes_Check(py_guid.get())
+            || PyBytes_GET_SIZE(py_guid.get()) != bmqt::MessageGUID::e_SIZE_BINARY)
+        {
+            PyErr_SetString(d_error, "Invalid GUID provided");
+            return NULL;
+        }
+        bmqt::MessageGUID guid;
+        guid.fromBinary(reinterpret_cast<const unsigned char*>(
+                PyBytes_AS_STRING(py_guid.get())));
+        confirms.push_back(bsl::make_pair(uri_index, guid));
+    }
+
+    size_t num_confirmed = 0;
+    try {
+        pybmq::GilReleaseGuard gil_release_guard;
+        SessionStateGuard guard(&d_state);
+
+        if (!guard.started()) {
+            throw GenericError(SESSION_STOPPED);
+        }
+
+        bsl::vector<bmqa::QueueId> queue_ids(queue_uris.size());
+        for (size_t i = 0; i < queue_uris.size(); ++i) {
+            if (d_session_mp->getQueueId(&queue_ids[i], bmqt::Uri(queue_uris[i]))) {
+                throw GenericError(QUEUE_NOT_OPENED);
+            }
+
+            if (!queue_ids[i].isValid()) {
+                bsl::ostringstream oss;
+                oss << "Attempting to confirm message on a closing queue. Please "
+                       "ensure that you are invoking configure with 0 max "
+                       "unconfirmed messages before closing the queue<"
+                    << queue_uris[i] << ">";
+                throw GenericError(oss.str());
+            }
+        }
+
+        bmqa::ConfirmEventBuilder builder;
+        d_session_mp->loadConfirmEventBuilder(&builder);
+
+        size_t num_added = 0;
+        for (size_t i = 0; i < confirms.size(); ++i) {
+            const bmqa::MessageConfirmationCookie cookie(
+                    queue_ids[confirms[i].first],
+                    confirms[i].second);
+            bmqt::EventBuilderResult::Enum builder_rc =
+                    builder.addMessageConfirmation(cookie);
+            if (builder_rc == bmqt::EventBuilderResult::e_EVENT_TOO_BIG && num_added) {
+                // The event is full: send it and retry with a fresh one.
+                confirmEvent(d_session_mp.get(), &builder);
+                recordConfirms(
+                        queue_ids,
+                        confirms,
+                        num_confirmed,
+                        num_confirmed + num_added);
+                num_confirmed += num_added;
+                num_added = 0;
+                builder_rc = builder.addMessageConfirmation(cookie);
+            }
+            if (builder_rc) {
+                bsl::ostringstream oss;
+                oss << "Failed to confirm message [" << confirms[i].second
+                    << "]: " << builder_rc;
+                throw GenericError(oss.str());
+            }
+            ++num_added;
+        }
+
+        if (num_added) {
+            confirmEvent(d_session_mp.get(), &builder);
+            recordConfirms(
+                    queue_ids,
+                    confirms,
+                    num_confirmed,
+                    num_confirmed + num_added);
+            num_confirmed += num_added;
+        }
+    } catch (const GenericError& exc) {
+        bsl::ostringstream oss;
+        oss << exc.what() << " (" << num_confirmed << " of " << confirms.size()
+            << " messages confirmed)";
+        PyErr_SetString(d_error, oss.str().c_str());
+        return NULL;
+    }
+
+    Py_RETURN_NONE;
+}
+
+PyObject*
+Session::receive(int max_messages, const bsl::optional<bsls::TimeInterval>& timeout)
+{
+    if (!d_state.is_started()) {
+        PyErr_SetString(d_error, SESSION_STOPPED);
+        return NULL;
+    }
+    // No 'SessionStateGuard' can be held while waiting, or 'stop' would block
+    // until the wait ends; 'stop' wakes any waiting caller instead.
+    return d_event_handler_p->receive_messages(max_messages, timeout);
+}
+
+PyObject*
+Session::stats()
+{
+    return d_stats.snapshot();
+}
+
+PyObject*
+Session::notification_fd()
+{
+    if (!d_event_handler_p->pull_messages()) {
+        PyErr_SetString(d_error, "Session was not created with pull_messages");
+        return NULL;
+    }
+    const int fd = d_event_handler_p->notification_fd();
+    if (fd == -1) {
+        return PyErr_SetFromErrno(PyExc_OSError);
+    }
+    return PyLong_FromLong(fd);
+}
+
 }  // namespace pybmq
 }  // namespace BloombergLP
@@ -19,38 +19,144 @@
 #define PY_SSIZE_T_CLEAN
 #include <Python.h>
 
+#include <pybmq_compressionpolicy.h>
+#include <pybmq_hosthealthmonitor.h>
+#include <pybmq_sessionstate.h>
+#include <pybmq_stats.h>
+#include <pybmq_writablesignal.h>
+
 #include <bmqa_abstractsession.h>
 #include <bmqa_manualhosthealthmonitor.h>
+#include <bmqa_queueid.h>
 #include <bmqt_compressionalgorithmtype.h>
+#include <bmqt_queueoptions.h>
+#include <bmqt_resultcode.h>
 
+#include <bsl_map.h>
 #include <bsl_memory.h>
 #include <bsl_optional.h>
+#include <bsl_string.h>
+#include <bsl_vector.h>
 #include <bslma_managedptr.h>
-#include <bslmt_readerwriterlock.h>
+#include <bslmt_mutex.h>
+#include <bsls_atomic.h>
 #include <bsls_timeinterval.h>
+#include <bsls_types.h>
 
 namespace BloombergLP {
 namespace pybmq {
 
+class FlowControlPolicy;
+class FlowController;
+class LoopbackOptions;
+class OpenQueueBatch;
+class PropertiesTemplate;
+struct PropertyPolicy;
+class SessionEventHandler;
+
 class Session
 {
   private:
+    // PRIVATE TYPES
+    typedef bsl::map<bsl::string, bsl::shared_ptr<CompressionPolicy> >
+            CompressionPolicies;
+    // The compression policy of each queue opened with one, by URI.
+
     // DATA
-    bslmt::ReaderWriterLock d_started_lock;
-    bool d_started;
+    SessionState d_state;
+    SessionStats d_stats;  // must outlive 'd_session_mp'
+    WritableSignal d_writable_signal;  // must outlive 'd_session_mp'
     bmqt::CompressionAlgorithmType::Enum d_message_compression_type;
+    bslmt::Mutex d_compression_policies_lock;
+    bsl::shared_ptr<const CompressionPolicies> d_compression_policies_sp;
+    // Replaced rather than modified, so that posts don't hold
+    // 'd_compression_policies_lock' while packing messages.
+    bsls::AtomicBool d_has_compression_policies;  // never reset once set
     PyObject* d_error;
     PyObject* d_broker_timeout_error;
     bslma::ManagedPtr<bmqa::AbstractSession> d_session_mp;
+    SessionEventHandler* d_event_handler_p;  // owned by 'd_session_mp'
+    bslmt::Mutex d_flow_controller_lock;
+    bslma::ManagedPtr<FlowController> d_flow_controller_mp;  // null until needed
+    bsls::AtomicBool d_has_flow_control;  // never reset once set
 
     // NOT IMPLEMENTED
     Session(const Session&);
     Session& operator=(const Session&);
 
+    // PRIVATE MANIPULATORS
+    bsl::shared_ptr<CompressionPolicy>
+    compression_policy(const bmqa::QueueId& queue_id);
+    // Return the compression policy of the queue identified by the specified
+    // 'queue_id', or null if it was opened without one.
+
+    void set_compression_policy(
+            const bsl::string& queue_uri,
+            const CompressionPolicy* compression_policy);
+    // Compress the messages subsequently posted to the queue with the
+    // specified 'queue_uri' with a new policy configured like the specified
+    // 'compression_policy', or as the session does if it is null.
+
+    void set_flow_control(
+            const bsl::string& queue_uri,
+            const FlowControlPolicy* flow_control);
+    // Adjust the unconfirmed limits of the queue with the specified
+    // 'queue_uri' as a new policy configured like the specified
+    // 'flow_control' decides, starting the flow controller if needed, or stop
+    // adjusting them if it is null.
+
+    bmqt::OpenQueueResult::Enum start_open_queue(
+            bmqa::QueueId* queue_id,
+            const char* queue_uri,
+            bsls::Types::Uint64 flags,
+            const bmqt::QueueOptions& options,
+            const bsls::TimeInterval& timeout,
+            const PropertyPolicy& policy,
+            const CompressionPolicy* compression_policy,
+            const FlowControlPolicy* flow_control,
+            PyObject* on_complete,
+            const bsl::shared_ptr<OpenQueueBatch>& batch,
+            int batch_index);
+    // Install the policies of the queue with the specified 'queue_uri' and
+    // send the request to open it, reporting its outcome to the specified
+    // 'batch' at the specified 'batch_index' if 'batch' is not null, and to
+    // the specified 'on_complete' otherwise.  Return the result of sending the
+    // request, having forgotten the operation if it is not 'e_SUCCESS'.  The
+    // GIL must be released and a 'SessionStateGuard' held.
+
+    PyObject* post_impl(
+            const bmqa::QueueId* queue_id,
+            const char* queue_uri,
+            const char* payload,
+            size_t payload_length,
+            PyObject* properties,
+            const PropertiesTemplate* properties_template,
+            PyObject* on_ack,
+            const bsl::optional<bmqt::CompressionAlgorithmType::Enum>&
+                    compression_algorithm,
+            bool block,
+            const bsl::optional<bsls::TimeInterval>& timeout,
+            bool raise_on_bw_limit);
+    // Post a message to the queue with the specified 'queue_uri', using the
+    // specified 'queue_id' instead of looking the queue up if it is not null.
+    // Return 'True' if the message was posted, or 'False' if the SDK refused
+    // it with 'e_BW_LIMIT' and the specified 'raise_on_bw_limit' is false.
+
+    PyObject* confirm_impl(
+            const bmqa::QueueId* queue_id,
+            const char* queue_uri,
+            const unsigned char* guid,
+            size_t guid_length);
+    // Confirm a message received on the queue with the specified 'queue_uri',
+    // using the specified 'queue_id' instead of looking the queue up if it is
+    // not null.
+
   public:
     Session(PyObject* py_session_event_callback,
             PyObject* py_message_event_callback,
             PyObject* py_ack_event_callback,
+            PyObject* py_ack_batch_event_callback,
+            PyObject* py_slow_callback_event_callback,
             const char* broker_uri,
             const char* script_name,
             bmqt::CompressionAlgorithmType::Enum message_compression_type,
@@ -66,8 +172,15 @@ class Session
             const bsls::TimeInterval& close_queue_timeout,
             bool monitor_host_health,
             bsl::shared_ptr<bmqa::ManualHostHealthMonitor> fake_host_health_monitor,
+            bsl::shared_ptr<SystemHostHealthMonitor> system_host_health_monitor,
+            bool zero_copy_payloads,
+            bool pull_messages,
+            int num_dispatch_threads,
+            bool time_callbacks,
+            const bsls::TimeInterval& slow_callback_threshold,
             PyObject* d_error,
             PyObject* d_broker_timeout_error,
+            const LoopbackOptions* loopback,
             PyObject* mock);
 
     ~Session();
@@ -76,6 +189,7 @@ class Session
     PyObject* stop(bool warn_if_started);
 
     PyObject* open_queue_sync(
+            bmqa::QueueId* queue_id,
             const char* queue_uri,
             bool read,
             bool write,
@@ -83,7 +197,34 @@ class Session
             bsl::optional<int> max_unconfirmed_messages,
             bsl::optional<int> max_unconfirmed_bytes,
             bsl::optional<bool> suspends_on_bad_host_health,
-            const bsls::TimeInterval& timeout);
+            PyObject* subscriptions,
+            const bsls::TimeInterval& timeout,
+            bool lazy_properties,
+            PyObject* property_projection,
+            const CompressionPolicy* compression_policy,
+            PyObject* payload_decoder,
+            const FlowControlPolicy* flow_control);
+    // Open the queue with the specified 'queue_uri', and load its
+    // 'bmqa::QueueId' into the specified 'queue_id'.  If the specified
+    // 'lazy_properties' is true, the properties of messages received on it are
+    // decoded only when accessed.  If the specified 'property_projection' is a
+    // sequence of 'bytes' rather than 'None', only the properties it names are
+    // ever decoded.  If the specified 'compression_policy' is not null, the
+    // messages posted to the queue are compressed as a new policy configured
+    // like it decides, rather than with the session's compression algorithm.
+    // If the specified 'subscriptions' is not 'None', it is a sequence of
+    // subscriptions as described by 'SubscriptionUtils', and the broker only
+    // delivers the messages matching one of them.  If the specified
+    // 'payload_decoder' is not 'None', it is a 'PyCapsule' accepted by
+    // 'PayloadDecoder::from_capsule', and the decoder it holds is run on the
+    // payload of every message received on the queue before the GIL is
+    // acquired to deliver it, as described by
+    // 'SessionEventHandler::set_property_policy'.  The messages whose payload
+    // it rejects are confirmed and reported to the session event callback
+    // instead of being delivered.  If the specified 'flow_control' is not
+    // null, the queue is opened with its unconfirmed limits clamped to the
+    // bounds of 'flow_control', and a 'FlowController' then adjusts them to
+    // the consumer's measured rate as a new policy configured like it decides.
 
     PyObject* configure_queue_sync(
             const char* queue_uri,
@@ -91,11 +232,87 @@ class Session
             bsl::optional<int> max_unconfirmed_messages,
             bsl::optional<int> max_unconfirmed_bytes,
             bsl::optional<bool> suspends_on_bad_host_health,
+            PyObject* subscriptions,
             const bsls::TimeInterval& timeout);
+    // Configure the queue with the specified 'queue_uri', leaving each option
+    // that isn't specified unchanged.  If the specified 'subscriptions' is not
+    // 'None', it replaces the subscriptions of the queue as in
+    // 'open_queue_sync'; an empty sequence removes all of them.
 
     PyObject*
     close_queue_sync(const char* queue_uri, const bsls::TimeInterval& timeout);
 
+    PyObject* open_queue_async(
+            bmqa::QueueId* queue_id,
+            const char* queue_uri,
+            bool read,
+            bool write,
+            bsl::optional<int> consumer_priority,
+            bsl::optional<int> max_unconfirmed_messages,
+            bsl::optional<int> max_unconfirmed_bytes,
+            bsl::optional<bool> suspends_on_bad_host_health,
+            PyObject* subscriptions,
+            const bsls::TimeInterval& timeout,
+            bool lazy_properties,
+            PyObject* property_projection,
+            const CompressionPolicy* compression_policy,
+            PyObject* payload_decoder,
+            const FlowControlPolicy* flow_control,
+            PyObject* on_complete);
+    // Start opening the queue with the specified 'queue_uri' as
+    // 'open_queue_sync' does, without waiting for the broker's response.  The
+    // specified 'on_complete' is invoked from the event handler thread once
+    // the queue is opened or fails to open, as described by
+    // 'SessionEventHandler::add_pending_operation'.
+
+    PyObject* open_queues(
+            const bsl::vector<bmqa::QueueId*>& queue_ids,
+            const bsl::vector<bsl::string>& queue_uris,
+            bool read,
+            bool write,
+            bsl::optional<int> consumer_priority,
+            bsl::optional<int> max_unconfirmed_messages,
+            bsl::optional<int> max_unconfirmed_bytes,
+            bsl::optional<bool> suspends_on_bad_host_health,
+            PyObject* subscriptions,
+            const bsls::TimeInterval& timeout,
+            bool lazy_properties,
+            PyObject* property_projection,
+            const CompressionPolicy* compression_policy,
+            PyObject* payload_decoder,
+            const FlowControlPolicy* flow_control,
+            int max_in_flight);
+    // Open each queue of the specified 'queue_uris' as 'open_queue_sync' does,
+    // loading its 'bmqa::QueueId' into the element of the specified
+    // 'queue_ids' at the same index, with at most the specified
+    // 'max_in_flight' requests sent to the broker at any time.  Wait with the
+    // GIL released until every queue has opened or failed to open, and return
+    // a list holding, for each queue, 'None' if it opened, or a tuple of an
+    // error message as 'bytes' and whether the request timed out otherwise.
+    // Raise an error without opening any queue if the session is stopped or
+    // the options are invalid.
+
+    PyObject* configure_queue_async(
+            const char* queue_uri,
+            bsl::optional<int> consumer_priority,
+            bsl::optional<int> max_unconfirmed_messages,
+            bsl::optional<int> max_unconfirmed_bytes,
+            bsl::optional<bool> suspends_on_bad_host_health,
+            PyObject* subscriptions,
+            const bsls::TimeInterval& timeout,
+            PyObject* on_complete);
+    // Start configuring the queue with the specified 'queue_uri' as
+    // 'configure_queue_sync' does, invoking the specified 'on_complete' once the
+    // broker responds.
+
+    PyObject* close_queue_async(
+            const char* queue_uri,
+            const bsls::TimeInterval& timeout,
+            PyObject* on_complete);
+    // Start closing the queue with the specified 'queue_uri' as
+    // 'close_queue_sync' does, invoking the specified 'on_complete' once the
+    // broker responds.
+
     PyObject* get_queue_options(const char* queue_uri);
 
     PyObject*
@@ -103,10 +320,83 @@ class Session
          const char* payload,
          size_t payload_length,
          PyObject* properties,
-         PyObject* on_ack);
+         const PropertiesTemplate* properties_template,
+         PyObject* on_ack,
+         const bsl::optional<bmqt::CompressionAlgorithmType::Enum>&
+                 compression_algorithm,
+         bool block,
+         const bsl::optional<bsls::TimeInterval>& timeout,
+         bool raise_on_bw_limit);
+    // Post a message to the queue with the specified 'queue_uri'.  If the
+    // specified 'properties_template' is not null, the message carries its
+    // properties, overridden by any of the specified 'properties'.  The
+    // message is compressed with the specified 'compression_algorithm' if it
+    // has a value, and as the queue's compression policy or the session
+    // decides otherwise.  If the SDK refuses the message with 'e_BW_LIMIT'
+    // because its channel to the broker is full and the specified 'block' is
+    // true, wait with the GIL released for the channel to drain and post it
+    // again, for at most the specified 'timeout' if it has a value.  Return
+    // 'True' once the message is posted.  If it is still refused with
+    // 'e_BW_LIMIT', return 'False' if the specified 'raise_on_bw_limit' is
+    // false, and raise an error like for any other failure otherwise.
+
+    PyObject* post_to_queue(
+            const bmqa::QueueId& queue_id,
+            const char* payload,
+            size_t payload_length,
+            PyObject* properties,
+            const PropertiesTemplate* properties_template,
+            PyObject* on_ack,
+            const bsl::optional<bmqt::CompressionAlgorithmType::Enum>&
+                    compression_algorithm,
+            bool block,
+            const bsl::optional<bsls::TimeInterval>& timeout,
+            bool raise_on_bw_limit);
+    // Post a message like 'post' does, to the queue identified by the
+    // specified 'queue_id' as loaded by 'open_queue_sync', without parsing a
+    // URI or looking the queue up.
+
+    PyObject* post_many(
+            const char* queue_uri,
+            PyObject* messages,
+            const PropertiesTemplate* properties_template);
+    // Post every '(payload, properties, on_ack)' tuple in the specified
+    // 'messages' sequence to the queue with the specified 'queue_uri',
+    // packing as many messages as fit into each event and releasing the GIL
+    // only once for the whole batch.  If the specified 'properties_template'
+    // is not null, every message carries its properties, overridden by the
+    // message's own.
 
     PyObject*
     confirm(const char* queue_uri, const unsigned char* guid, size_t guid_length);
+
+    PyObject* confirm_on_queue(
+            const bmqa::QueueId& queue_id,
+            const unsigned char* guid,
+            size_t guid_length);
+    // Confirm a message like 'confirm' does, on the queue identified by the
+    // specified 'queue_id' as loaded by 'open_queue_sync'.
+
+    PyObject* confirm_many(PyObject* messages);
+    // Confirm every message in the specified 'messages' iterable, packing as
+    // many confirmations as fit into each event and releasing the GIL only
+    // once for the whole batch.
+
+    PyObject*
+    receive(int max_messages, const bsl::optional<bsls::TimeInterval>& timeout);
+    // Return a list of up to the specified 'max_messages' messages received by
+    // a session created with 'pull_messages', waiting for at most the specified
+    // 'timeout' for one to arrive, as described by
+    // 'SessionEventHandler::receive_messages'.
+
+    PyObject* stats();
+    // Return a snapshot of the counters kept for this session and each queue
+    // it opened, as described by 'SessionStats::snapshot'.
+
+    PyObject* notification_fd();
+    // Return, as an 'int', a file descriptor that is readable whenever 'receive'
+    // has messages to return immediately, for use with an event loop, as
+    // described by 'SessionEventHandler::notification_fd'.
 };
 
 }  // namespace pybmq
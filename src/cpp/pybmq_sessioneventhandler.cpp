@@ -16,8 +16,12 @@
 #include <pybmq_sessioneventhandler.h>
 
 #include <pybmq_gilacquireguard.h>
+#include <pybmq_gilreleaseguard.h>
 #include <pybmq_messageutils.h>
+#include <pybmq_openqueuebatch.h>
+#include <pybmq_payloaddecoder.h>
 #include <pybmq_refutils.h>
+#include <pybmq_stats.h>
 
 #include <bmqa_message.h>
 #include <bmqa_messageiterator.h>
@@ -25,29 +29,158 @@
 #include <bmqt_resultcode.h>
 #include <bmqt_sessioneventtype.h>
 
+#include <bdlf_memfn.h>
+#include <bsl_algorithm.h>
+#include <bsl_cstddef.h>
+#include <bsl_sstream.h>
+#include <bsl_stdexcept.h>
 #include <bsl_string.h>
+#include <bsl_vector.h>
 #include <bslma_managedptr.h>
+#include <bslmt_lockguard.h>
+#include <bsls_platform.h>
+#include <bsls_systemtime.h>
+#include <bsls_timeutil.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#ifdef BSLS_PLATFORM_OS_LINUX
+#include <sys/eventfd.h>
+#endif
 
 namespace BloombergLP {
 namespace pybmq {
 
+namespace {
+
+int
+openNotificationFds(int fds[2])
+{
+#ifdef BSLS_PLATFORM_OS_LINUX
+    fds[0] = fds[1] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    return fds[0] < 0 ? -1 : 0;
+#else
+    if (pipe(fds)) {
+        return -1;
+    }
+    for (int i = 0; i < 2; ++i) {
+        if (fcntl(fds[i], F_SETFL, fcntl(fds[i], F_GETFL) | O_NONBLOCK)
+            || fcntl(fds[i], F_SETFD, FD_CLOEXEC))
+        {
+            const int saved_errno = errno;
+            close(fds[0]);
+            close(fds[1]);
+            fds[0] = fds[1] = -1;
+            errno = saved_errno;
+            return -1;
+        }
+    }
+    return 0;
+#endif
+}
+
+void
+closeNotificationFds(int fds[2])
+{
+    if (fds[0] >= 0) {
+        close(fds[0]);
+    }
+    if (fds[1] >= 0 && fds[1] != fds[0]) {
+        close(fds[1]);
+    }
+}
+
+void
+setReadable(int write_fd)
+{
+    // Only one notification is ever outstanding, so the write can't block.
+    const uint64_t one = 1;
+    ssize_t rc;
+    do {
+        rc = write(write_fd, &one, sizeof(one));
+    } while (rc < 0 && errno == EINTR);
+}
+
+void
+clearReadable(int read_fd)
+{
+    uint64_t value;
+    ssize_t rc;
+    do {
+        rc = read(read_fd, &value, sizeof(value));
+    } while (rc > 0 || (rc < 0 && errno == EINTR));
+}
+
+}  // close unnamed namespace
+
 SessionEventHandler::SessionEventHandler(
         PyObject* py_session_event_callback,
         PyObject* py_message_event_callback,
-        PyObject* py_ack_event_callback)
+        PyObject* py_ack_event_callback,
+        PyObject* py_ack_batch_event_callback,
+        PyObject* py_slow_callback_event_callback,
+        bool zero_copy_payloads,
+        bool pull_messages,
+        int num_dispatch_threads,
+        SessionStats* stats,
+        WritableSignal* writable_signal)
 : d_py_session_event_callback(py_session_event_callback)
 , d_py_message_event_callback(py_message_event_callback)
 , d_py_ack_event_callback(py_ack_event_callback)
+, d_py_ack_batch_event_callback(py_ack_batch_event_callback)
+, d_py_slow_callback_event_callback(py_slow_callback_event_callback)
+, d_zero_copy_payloads(zero_copy_payloads)
+, d_stats_p(stats)
+, d_writable_signal_p(writable_signal)
+, d_session_p(NULL)
+, d_property_policies_sp(bsl::make_shared<PropertyPolicies>())
+, d_has_payload_decoders(false)
+, d_pull_messages(pull_messages)
+, d_num_pulled_messages(0)
+, d_receiving_stopped(false)
+, d_dispatcher_mp()
 {
+    d_notification_fds[0] = d_notification_fds[1] = -1;
+
+    if (num_dispatch_threads > 0) {
+        d_dispatcher_mp.load(new MessageDispatcher(
+                num_dispatch_threads,
+                bdlf::MemFnUtil::memFn(&SessionEventHandler::deliver_messages, this)));
+        if (d_dispatcher_mp->start()) {
+            throw bsl::runtime_error("Failed to start the message dispatch threads");
+        }
+    }
+
     GilAcquireGuard guard;
     Py_INCREF(d_py_session_event_callback);
     Py_INCREF(d_py_message_event_callback);
     Py_INCREF(d_py_ack_event_callback);
+    Py_INCREF(d_py_ack_batch_event_callback);
+    Py_INCREF(d_py_slow_callback_event_callback);
 }
 
 SessionEventHandler::~SessionEventHandler()
 {
+    stop_dispatching();
+    closeNotificationFds(d_notification_fds);
     GilAcquireGuard guard;
+    d_string_cache.clear();
+    for (PendingOperations::iterator it = d_pending_operations.begin();
+         it != d_pending_operations.end();
+         ++it)
+    {
+        for (bsl::deque<PendingOperation>::iterator op = it->second.begin();
+             op != it->second.end();
+             ++op)
+        {
+            Py_XDECREF(op->d_on_complete);
+        }
+    }
+    Py_DECREF(d_py_slow_callback_event_callback);
+    Py_DECREF(d_py_ack_batch_event_callback);
     Py_DECREF(d_py_ack_event_callback);
     Py_DECREF(d_py_message_event_callback);
     Py_DECREF(d_py_session_event_callback);
@@ -56,9 +189,21 @@ SessionEventHandler::~SessionEventHandler()
 void
 SessionEventHandler::onSessionEvent(const bmqa::SessionEvent& event)
 {
-    GilAcquireGuard guard;
+    if (event.type() == bmqt::SessionEventType::e_CONNECTED
+        || event.type() == bmqt::SessionEventType::e_RECONNECTED
+        || event.type() == bmqt::SessionEventType::e_STATE_RESTORED)
+    {
+        d_writable_signal_p->notify();
+    }
+
+    bsls::Types::Int64 gil_wait_ns = 0;
+    GilAcquireGuard guard(d_stats_p->times_callbacks() ? &gil_wait_ns : NULL);
     bsl::string uri;
 
+    if (complete_pending_operation(event)) {
+        return;
+    }
+
     if (event.type() == bmqt::SessionEventType::e_QUEUE_REOPEN_RESULT
         || event.type() == bmqt::SessionEventType::e_QUEUE_SUSPENDED
         || event.type() == bmqt::SessionEventType::e_QUEUE_RESUMED)
@@ -66,6 +211,7 @@ SessionEventHandler::onSessionEvent(const bmqa::SessionEvent& event)
         uri = event.queueId().uri().asString();
     }
 
+    bsls::Types::Int64 start_ns = bsls::TimeUtil::getTimer();
     bslma::ManagedPtr<PyObject> rv = RefUtils::toManagedPtr(PyObject_CallFunction(
             d_py_session_event_callback,
             "(N (i N i N s#))",
@@ -82,21 +228,296 @@ SessionEventHandler::onSessionEvent(const bmqa::SessionEvent& event)
     if (!rv) {
         PyErr_Print();
     }
+    record_callback_timing(
+            "on_session_event",
+            gil_wait_ns,
+            0,
+            bsls::TimeUtil::getTimer() - start_ns);
+}
+
+void
+SessionEventHandler::on_ack_event(
+        const bmqa::MessageEvent& event,
+        bsls::Types::Int64 gil_wait_ns)
+{
+    const bsls::Types::Int64 conversion_start_ns = bsls::TimeUtil::getTimer();
+    bslma::ManagedPtr<PyObject> ack_ids = RefUtils::toManagedPtr(PyList_New(0));
+    bslma::ManagedPtr<PyObject> ack_statuses = RefUtils::toManagedPtr(PyList_New(0));
+    if (!ack_ids || !ack_statuses) {
+        PyErr_Print();
+        return;
+    }
+
+    bslma::ManagedPtr<PyObject> acks = RefUtils::toManagedPtr(MessageUtils::get_acks(
+            event,
+            &d_string_cache,
+            ack_ids.get(),
+            ack_statuses.get()));
+    if (!acks) {
+        PyErr_Print();
+        return;
+    }
+    const bsls::Types::Int64 conversion_ns =
+            bsls::TimeUtil::getTimer() - conversion_start_ns;
+
+    // Both ack callbacks may be invoked for one event; their timing is
+    // recorded as one invocation, so the GIL wait and conversion are counted
+    // once.
+    bsls::Types::Int64 callback_ns = 0;
+    const char* callback_name = "on_ack";
+
+    if (PyList_GET_SIZE(acks.get())) {
+        bsls::Types::Int64 start_ns = bsls::TimeUtil::getTimer();
+        bslma::ManagedPtr<PyObject> rv =
+                RefUtils::toManagedPtr(PyObject_CallFunctionObjArgs(
+                        d_py_ack_event_callback,
+                        acks.get(),
+                        NULL));
+        const bsls::Types::Int64 duration_ns = bsls::TimeUtil::getTimer() - start_ns;
+        d_stats_p->record_ack_callback(duration_ns);
+        callback_ns += duration_ns;
+        if (!rv) {
+            PyErr_Print();
+        }
+    }
+
+    if (PyList_GET_SIZE(ack_ids.get())) {
+        bsls::Types::Int64 start_ns = bsls::TimeUtil::getTimer();
+        bslma::ManagedPtr<PyObject> rv =
+                RefUtils::toManagedPtr(PyObject_CallFunctionObjArgs(
+                        d_py_ack_batch_event_callback,
+                        ack_ids.get(),
+                        ack_statuses.get(),
+                        NULL));
+        const bsls::Types::Int64 duration_ns = bsls::TimeUtil::getTimer() - start_ns;
+        d_stats_p->record_ack_callback(duration_ns);
+        callback_name = callback_ns ? "on_ack and on_acks" : "on_acks";
+        callback_ns += duration_ns;
+        if (!rv) {
+            PyErr_Print();
+        }
+    }
+
+    record_callback_timing(callback_name, gil_wait_ns, conversion_ns, callback_ns);
+}
+
+void
+SessionEventHandler::record_callback_timing(
+        const char* callback_name,
+        bsls::Types::Int64 gil_wait_ns,
+        bsls::Types::Int64 conversion_ns,
+        bsls::Types::Int64 callback_ns)
+{
+    if (!d_stats_p->times_callbacks()
+        || !d_stats_p->record_callback_timing(gil_wait_ns, conversion_ns, callback_ns))
+    {
+        return;
+    }
+    bslma::ManagedPtr<PyObject> rv = RefUtils::toManagedPtr(PyObject_CallFunction(
+            d_py_slow_callback_event_callback,
+            "(s d d)",
+            callback_name,
+            callback_ns / 1e9,
+            d_stats_p->slow_callback_threshold_ns() / 1e9));
+    if (!rv) {
+        PyErr_Print();
+    }
+}
+
+bool
+SessionEventHandler::complete_pending_operation(const bmqa::SessionEvent& event)
+{
+    const char* operation;
+    switch (event.type()) {
+        case bmqt::SessionEventType::e_QUEUE_OPEN_RESULT: {
+            operation = "open";
+        } break;
+        case bmqt::SessionEventType::e_QUEUE_CONFIGURE_RESULT: {
+            operation = "configure";
+        } break;
+        case bmqt::SessionEventType::e_QUEUE_CLOSE_RESULT: {
+            operation = "close";
+        } break;
+        default: {
+            return false;
+        }
+    }
+
+    const bsl::string uri = event.queueId().uri().asString();
+    PendingOperation pending;
+    {
+        bslmt::LockGuard<bslmt::Mutex> lock(&d_pending_operations_lock);
+        PendingOperations::iterator it =
+                d_pending_operations.find(bsl::make_pair((int)event.type(), uri));
+        if (it == d_pending_operations.end()) {
+            return false;
+        }
+        pending = it->second.front();
+        it->second.pop_front();
+        if (it->second.empty()) {
+            d_pending_operations.erase(it);
+        }
+    }
+    const bool succeeded = event.statusCode() == 0;
+    if (pending.d_batch_sp) {
+        if (!succeeded && pending.d_installed_policy) {
+            clear_property_policy(uri);
+        }
+        bsl::string error;
+        if (!succeeded) {
+            bsl::ostringstream oss;
+            oss << "Failed to " << operation << " " << uri << " queue: "
+                << bmqt::GenericResult::toAscii(
+                           static_cast<bmqt::GenericResult::Enum>(event.statusCode()))
+                << ": " << event.errorDescription();
+            error = oss.str();
+        }
+        pending.d_batch_sp->complete(pending.d_batch_index, event.statusCode(), error);
+        return true;
+    }
+    if (!pending.d_on_complete) {
+        // Started by the session's flow controller, which retries on its next
+        // adjustment, so a failure is only reported.
+        if (event.statusCode() != 0) {
+            bsl::ostringstream oss;
+            oss << "Failed to adjust the unconfirmed limits of " << uri
+                << " queue: "
+                << bmqt::GenericResult::toAscii(
+                           static_cast<bmqt::GenericResult::Enum>(event.statusCode()))
+                << ": " << event.errorDescription();
+            bslma::ManagedPtr<PyObject> rv =
+                    RefUtils::toManagedPtr(PyObject_CallFunction(
+                            d_py_session_event_callback,
+                            "(N)",
+                            PyBytes_FromString(oss.str().c_str())));
+            if (!rv) {
+                PyErr_Print();
+            }
+        }
+        return true;
+    }
+    bslma::ManagedPtr<PyObject> on_complete =
+            RefUtils::toManagedPtr(pending.d_on_complete);
+
+    if (succeeded ? event.type() == bmqt::SessionEventType::e_QUEUE_CLOSE_RESULT
+                  : pending.d_installed_policy)
+    {
+        clear_property_policy(uri);
+    }
+
+    bslma::ManagedPtr<PyObject> error;
+    if (succeeded) {
+        error = RefUtils::toManagedPtr(RefUtils::ref(Py_None));
+    } else {
+        bsl::ostringstream oss;
+        oss << "Failed to " << operation << " " << uri << " queue: "
+            << bmqt::GenericResult::toAscii(
+                       static_cast<bmqt::GenericResult::Enum>(event.statusCode()))
+            << ": " << event.errorDescription();
+        const bsl::string message = oss.str();
+        error = RefUtils::toManagedPtr(
+                PyBytes_FromStringAndSize(message.c_str(), message.length()));
+        if (!error) {
+            PyErr_Print();
+            return true;
+        }
+    }
+
+    bslma::ManagedPtr<PyObject> rv = RefUtils::toManagedPtr(PyObject_CallFunction(
+            on_complete.get(),
+            "(O O)",
+            error.get(),
+            event.statusCode() == bmqt::GenericResult::e_TIMEOUT ? Py_True : Py_False));
+    if (!rv) {
+        PyErr_Print();
+    }
+    return true;
 }
 
 void
 SessionEventHandler::onMessageEvent(const bmqa::MessageEvent& event)
 {
-    GilAcquireGuard guard;
+    // Counting needs no GIL, so it's done before acquiring it.
+    if (event.type() == bmqt::MessageEventType::e_PUSH) {
+        d_stats_p->record_push_event(event);
+    } else if (event.type() == bmqt::MessageEventType::e_ACK) {
+        d_stats_p->record_ack_event(event);
+        // The broker acknowledging messages means the channel has been draining.
+        d_writable_signal_p->notify();
+    }
+
+    // Payloads are decoded before the GIL is acquired, so that the payloads
+    // rejected by a decoder are confirmed without ever being converted.  The
+    // dispatch threads decode the payloads of the messages they deliver.
+    bsl::shared_ptr<const PropertyPolicies> policies_sp;
+    bsl::shared_ptr<DecodedPayloads> decoded_sp;
+    if (event.type() == bmqt::MessageEventType::e_PUSH
+        && (d_pull_messages || !d_dispatcher_mp))
+    {
+        policies_sp = property_policies();
+        decoded_sp = decode_payloads(event, *policies_sp);
+    }
+
+    if (d_pull_messages && event.type() == bmqt::MessageEventType::e_PUSH) {
+        // Keep the event, and its message buffers, until 'receive_messages'
+        // converts it; the GIL isn't needed until then.
+        PulledEvent pulled = {event, 0, 0, decoded_sp};
+        bmqa::MessageIterator message_iterator = event.messageIterator();
+        while (message_iterator.nextMessage()) {
+            ++pulled.d_num_messages;
+        }
+        {
+            // Wait for room rather than growing without bound, which keeps
+            // the SDK from reading more events from the broker.  An event
+            // larger than the limit is kept once nothing else is waiting.
+            bslmt::LockGuard<bslmt::Mutex> lock(&d_pulled_events_lock);
+            while (!d_receiving_stopped && !d_pulled_events.empty()
+                   && d_num_pulled_messages + pulled.d_num_messages
+                              > k_MAX_PULLED_MESSAGES)
+            {
+                d_pulled_space_condition.wait(&d_pulled_events_lock);
+            }
+            if (d_receiving_stopped) {
+                // Nothing will retrieve it; the broker redelivers its messages
+                // once the session is gone.
+                return;
+            }
+            if (d_pulled_events.empty() && d_notification_fds[1] != -1) {
+                setReadable(d_notification_fds[1]);
+            }
+            d_pulled_events.push_back(pulled);
+            d_num_pulled_messages += pulled.d_num_messages;
+        }
+        d_pulled_events_condition.signal();
+        return;
+    }
+
+    if (d_dispatcher_mp && event.type() == bmqt::MessageEventType::e_PUSH) {
+        d_dispatcher_mp->dispatch(event);
+        return;
+    }
+
+    bsls::Types::Int64 gil_wait_ns = 0;
+    GilAcquireGuard guard(d_stats_p->times_callbacks() ? &gil_wait_ns : NULL);
+
+    if (event.type() == bmqt::MessageEventType::e_ACK) {
+        on_ack_event(event, gil_wait_ns);
+        return;
+    }
+
     PyObject* callback;
     PyObject* py_event;
+    const bsls::Types::Int64 conversion_start_ns = bsls::TimeUtil::getTimer();
 
     if (event.type() == bmqt::MessageEventType::e_PUSH) {
         callback = d_py_message_event_callback;
-        py_event = MessageUtils::get_messages(event, d_py_session_event_callback);
-    } else if (event.type() == bmqt::MessageEventType::e_ACK) {
-        callback = d_py_ack_event_callback;
-        py_event = MessageUtils::get_acks(event);
+        py_event = MessageUtils::get_messages(
+                event,
+                d_py_session_event_callback,
+                d_zero_copy_payloads,
+                *policies_sp,
+                decoded_sp.get(),
+                &d_string_cache);
     } else {
         bsl::ostringstream oss;
         oss << "Received an unexpected message event of type " << (int)event.type()
@@ -104,11 +525,388 @@ SessionEventHandler::onMessageEvent(const bmqa::MessageEvent& event)
         callback = d_py_session_event_callback;
         py_event = PyBytes_FromString(oss.str().c_str());
     }
+    bsls::Types::Int64 start_ns = bsls::TimeUtil::getTimer();
     bslma::ManagedPtr<PyObject> rv =
             RefUtils::toManagedPtr(PyObject_CallFunction(callback, "(N)", py_event));
+    const bsls::Types::Int64 end_ns = bsls::TimeUtil::getTimer();
+    if (!rv) {
+        PyErr_Print();
+    }
+    if (callback == d_py_message_event_callback) {
+        d_stats_p->record_message_callback(end_ns - start_ns);
+        record_callback_timing(
+                "on_message",
+                gil_wait_ns,
+                start_ns - conversion_start_ns,
+                end_ns - start_ns);
+    }
+}
+
+bsl::shared_ptr<const PropertyPolicies>
+SessionEventHandler::property_policies()
+{
+    bslmt::LockGuard<bslmt::Mutex> lock(&d_property_policies_lock);
+    return d_property_policies_sp;
+}
+
+void
+SessionEventHandler::decode_payload(
+        DecodedPayload* result,
+        const bmqa::Message& message,
+        const PropertyPolicies& policies)
+{
+    if (!MessageUtils::decode_payload(result, message, policies)) {
+        return;
+    }
+    QueueStats* queue_stats = QueueStats::from_queue_id(message.queueId());
+    if (queue_stats) {
+        queue_stats->record_rejection();
+    }
+    const int rc = d_session_p ? d_session_p->confirmMessage(
+                                         message.confirmationCookie())
+                               : -1;
+    if (rc) {
+        bsl::ostringstream oss;
+        oss << result->d_reason << (result->d_reason.empty() ? "" : " ")
+            << "(failed to confirm the message: " << rc << ")";
+        result->d_reason = oss.str();
+    } else if (queue_stats) {
+        queue_stats->record_confirms(1);
+    }
+}
+
+bsl::shared_ptr<DecodedPayloads>
+SessionEventHandler::decode_payloads(
+        const bmqa::MessageEvent& event,
+        const PropertyPolicies& policies)
+{
+    if (!d_has_payload_decoders) {
+        return bsl::shared_ptr<DecodedPayloads>();
+    }
+    bsl::shared_ptr<DecodedPayloads> decoded_sp = bsl::make_shared<DecodedPayloads>();
+    bmqa::MessageIterator message_iterator = event.messageIterator();
+    while (message_iterator.nextMessage()) {
+        decoded_sp->resize(decoded_sp->size() + 1);
+        decode_payload(&decoded_sp->back(), message_iterator.message(), policies);
+    }
+    return decoded_sp;
+}
+
+void
+SessionEventHandler::deliver_messages(const bsl::vector<bmqa::Message>& messages)
+{
+    const bsl::shared_ptr<const PropertyPolicies> policies_sp = property_policies();
+    DecodedPayloads decoded;
+    if (d_has_payload_decoders) {
+        decoded.resize(messages.size());
+        for (bsl::size_t i = 0; i < messages.size(); ++i) {
+            decode_payload(&decoded[i], messages[i], *policies_sp);
+        }
+    }
+
+    bsls::Types::Int64 gil_wait_ns = 0;
+    GilAcquireGuard guard(d_stats_p->times_callbacks() ? &gil_wait_ns : NULL);
+    const bsls::Types::Int64 conversion_start_ns = bsls::TimeUtil::getTimer();
+    bslma::ManagedPtr<PyObject> py_messages = RefUtils::toManagedPtr(PyList_New(0));
+    if (!py_messages) {
+        PyErr_Print();
+        return;
+    }
+    for (bsl::size_t i = 0; i < messages.size(); ++i) {
+        if (!MessageUtils::append_message(
+                    py_messages.get(),
+                    messages[i],
+                    d_py_session_event_callback,
+                    d_zero_copy_payloads,
+                    *policies_sp,
+                    decoded.empty() ? NULL : &decoded[i],
+                    &d_string_cache))
+        {
+            PyErr_Print();
+            return;
+        }
+    }
+    bsls::Types::Int64 start_ns = bsls::TimeUtil::getTimer();
+    bslma::ManagedPtr<PyObject> rv = RefUtils::toManagedPtr(
+            PyObject_CallFunctionObjArgs(
+                    d_py_message_event_callback,
+                    py_messages.get(),
+                    NULL));
+    const bsls::Types::Int64 end_ns = bsls::TimeUtil::getTimer();
     if (!rv) {
         PyErr_Print();
     }
+    d_stats_p->record_message_callback(end_ns - start_ns);
+    record_callback_timing(
+            "on_message",
+            gil_wait_ns,
+            start_ns - conversion_start_ns,
+            end_ns - start_ns);
+}
+
+void
+SessionEventHandler::set_property_policy(
+        const bsl::string& queue_uri,
+        const PropertyPolicy& policy)
+{
+    if (policy.d_decoder_sp) {
+        d_has_payload_decoders = true;
+    }
+    bslmt::LockGuard<bslmt::Mutex> lock(&d_property_policies_lock);
+    bsl::shared_ptr<PropertyPolicies> policies_sp =
+            bsl::make_shared<PropertyPolicies>(*d_property_policies_sp);
+    (*policies_sp)[queue_uri] = policy;
+    d_property_policies_sp = policies_sp;
+}
+
+void
+SessionEventHandler::clear_property_policy(const bsl::string& queue_uri)
+{
+    bslmt::LockGuard<bslmt::Mutex> lock(&d_property_policies_lock);
+    if (!d_property_policies_sp->count(queue_uri)) {
+        return;
+    }
+    bsl::shared_ptr<PropertyPolicies> policies_sp =
+            bsl::make_shared<PropertyPolicies>(*d_property_policies_sp);
+    policies_sp->erase(queue_uri);
+    d_property_policies_sp = policies_sp;
+}
+
+void
+SessionEventHandler::insert_pending_operation(
+        bmqt::SessionEventType::Enum result_type,
+        const bsl::string& queue_uri,
+        const PendingOperation& pending)
+{
+    bslmt::LockGuard<bslmt::Mutex> lock(&d_pending_operations_lock);
+    d_pending_operations[bsl::make_pair((int)result_type, queue_uri)].push_back(
+            pending);
+}
+
+void
+SessionEventHandler::erase_pending_operation(
+        bmqt::SessionEventType::Enum result_type,
+        const bsl::string& queue_uri,
+        PyObject* on_complete,
+        const OpenQueueBatch* batch,
+        int batch_index)
+{
+    bool installed_policy = false;
+    {
+        bslmt::LockGuard<bslmt::Mutex> lock(&d_pending_operations_lock);
+        PendingOperations::iterator it = d_pending_operations.find(
+                bsl::make_pair((int)result_type, queue_uri));
+        if (it == d_pending_operations.end()) {
+            return;
+        }
+        bsl::deque<PendingOperation>& operations = it->second;
+        for (bsl::deque<PendingOperation>::iterator op = operations.begin();
+             op != operations.end();
+             ++op)
+        {
+            if (op->d_on_complete == on_complete && op->d_batch_sp.get() == batch
+                && op->d_batch_index == batch_index)
+            {
+                installed_policy = op->d_installed_policy;
+                operations.erase(op);
+                break;
+            }
+        }
+        if (operations.empty()) {
+            d_pending_operations.erase(it);
+        }
+    }
+    if (installed_policy) {
+        clear_property_policy(queue_uri);
+    }
+}
+
+void
+SessionEventHandler::add_pending_operation(
+        bmqt::SessionEventType::Enum result_type,
+        const bsl::string& queue_uri,
+        PyObject* on_complete,
+        bool installed_policy)
+{
+    PendingOperation pending = {
+            on_complete,
+            bsl::shared_ptr<OpenQueueBatch>(),
+            -1,
+            installed_policy};
+    insert_pending_operation(result_type, queue_uri, pending);
+}
+
+void
+SessionEventHandler::add_pending_operation(
+        const bsl::string& queue_uri,
+        const bsl::shared_ptr<OpenQueueBatch>& batch,
+        int batch_index,
+        bool installed_policy)
+{
+    PendingOperation pending = {NULL, batch, batch_index, installed_policy};
+    insert_pending_operation(
+            bmqt::SessionEventType::e_QUEUE_OPEN_RESULT,
+            queue_uri,
+            pending);
+}
+
+void
+SessionEventHandler::cancel_pending_operation(
+        bmqt::SessionEventType::Enum result_type,
+        const bsl::string& queue_uri,
+        PyObject* on_complete)
+{
+    erase_pending_operation(result_type, queue_uri, on_complete, NULL, -1);
+}
+
+void
+SessionEventHandler::cancel_pending_operation(
+        const bsl::string& queue_uri,
+        const bsl::shared_ptr<OpenQueueBatch>& batch,
+        int batch_index)
+{
+    erase_pending_operation(
+            bmqt::SessionEventType::e_QUEUE_OPEN_RESULT,
+            queue_uri,
+            NULL,
+            batch.get(),
+            batch_index);
+}
+
+PyObject*
+SessionEventHandler::receive_messages(
+        int max_messages,
+        const bsl::optional<bsls::TimeInterval>& timeout)
+{
+    bslma::ManagedPtr<PyObject> messages = RefUtils::toManagedPtr(PyList_New(0));
+    if (!messages) {
+        return NULL;
+    }
+    if (max_messages <= 0) {
+        return messages.release().first;
+    }
+
+    // Each entry is an event along with the range of its messages to convert.
+    typedef bsl::vector<bsl::pair<PulledEvent, bsl::pair<int, int> > > Segments;
+    Segments segments;
+    {
+        GilReleaseGuard gil_release_guard;
+        bslmt::LockGuard<bslmt::Mutex> lock(&d_pulled_events_lock);
+
+        if (timeout.has_value()) {
+            const bsls::TimeInterval deadline =
+                    bsls::SystemTime::nowRealtimeClock() + timeout.value();
+            while (d_pulled_events.empty() && !d_receiving_stopped) {
+                if (d_pulled_events_condition.timedWait(
+                            &d_pulled_events_lock,
+                            deadline))
+                {
+                    break;
+                }
+            }
+        } else {
+            while (d_pulled_events.empty() && !d_receiving_stopped) {
+                d_pulled_events_condition.wait(&d_pulled_events_lock);
+            }
+        }
+
+        int num_taken = 0;
+        while (!d_receiving_stopped && !d_pulled_events.empty()
+               && num_taken < max_messages)
+        {
+            PulledEvent& pulled = d_pulled_events.front();
+            const int begin = pulled.d_num_consumed;
+            const int end = bsl::min(
+                    pulled.d_num_messages,
+                    begin + (max_messages - num_taken));
+            segments.push_back(bsl::make_pair(pulled, bsl::make_pair(begin, end)));
+            num_taken += end - begin;
+            pulled.d_num_consumed = end;
+            if (pulled.d_num_consumed == pulled.d_num_messages) {
+                d_pulled_events.pop_front();
+            }
+        }
+        d_num_pulled_messages -= num_taken;
+        if (d_pulled_events.empty() && !segments.empty()
+            && d_notification_fds[0] != -1)
+        {
+            clearReadable(d_notification_fds[0]);
+        }
+    }
+    if (!segments.empty()) {
+        d_pulled_space_condition.broadcast();
+    }
+
+    const bsl::shared_ptr<const PropertyPolicies> policies_sp = property_policies();
+    for (Segments::const_iterator it = segments.begin(); it != segments.end(); ++it)
+    {
+        const DecodedPayloads* decoded = it->first.d_decoded_sp.get();
+        bmqa::MessageIterator message_iterator = it->first.d_event.messageIterator();
+        for (int i = 0; i < it->second.second && message_iterator.nextMessage(); ++i)
+        {
+            if (i < it->second.first) {
+                continue;
+            }
+            if (!MessageUtils::append_message(
+                        messages.get(),
+                        message_iterator.message(),
+                        d_py_session_event_callback,
+                        d_zero_copy_payloads,
+                        *policies_sp,
+                        decoded ? &(*decoded)[i] : NULL,
+                        &d_string_cache))
+            {
+                return NULL;
+            }
+        }
+    }
+    return messages.release().first;
+}
+
+void
+SessionEventHandler::stop_dispatching()
+{
+    if (d_dispatcher_mp) {
+        d_dispatcher_mp->stop();
+    }
+}
+
+void
+SessionEventHandler::stop_receiving()
+{
+    {
+        bslmt::LockGuard<bslmt::Mutex> lock(&d_pulled_events_lock);
+        d_receiving_stopped = true;
+    }
+    d_pulled_events_condition.broadcast();
+    d_pulled_space_condition.broadcast();
+}
+
+int
+SessionEventHandler::notification_fd()
+{
+    bslmt::LockGuard<bslmt::Mutex> lock(&d_pulled_events_lock);
+    if (d_notification_fds[0] == -1) {
+        if (openNotificationFds(d_notification_fds)) {
+            return -1;
+        }
+        if (!d_pulled_events.empty()) {
+            setReadable(d_notification_fds[1]);
+        }
+    }
+    return d_notification_fds[0];
+}
+
+void
+SessionEventHandler::set_session(bmqa::AbstractSession* session)
+{
+    d_session_p = session;
+}
+
+bool
+SessionEventHandler::pull_messages() const
+{
+    return d_pull_messages;
 }
 
 }  // namespace pybmq
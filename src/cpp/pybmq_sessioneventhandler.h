@@ -18,32 +18,298 @@
 
 #define PY_SSIZE_T_CLEAN
 #include <Python.h>
+
+#include <pybmq_messagedispatcher.h>
+#include <pybmq_messageutils.h>
+#include <pybmq_stats.h>
+#include <pybmq_stringcache.h>
+#include <pybmq_writablesignal.h>
+
+#include <bmqa_abstractsession.h>
+#include <bmqa_message.h>
 #include <bmqa_messageevent.h>
 #include <bmqa_session.h>
 #include <bmqa_sessionevent.h>
+#include <bmqt_sessioneventtype.h>
 
+#include <bsl_deque.h>
+#include <bsl_map.h>
+#include <bsl_memory.h>
+#include <bsl_optional.h>
+#include <bsl_string.h>
+#include <bsl_utility.h>
+#include <bsl_vector.h>
+#include <bslma_managedptr.h>
+#include <bslmt_condition.h>
+#include <bslmt_mutex.h>
+#include <bsls_atomic.h>
 #include <bsls_keyword.h>
+#include <bsls_timeinterval.h>
+#include <bsls_types.h>
 
 namespace BloombergLP {
 namespace pybmq {
 
+class OpenQueueBatch;
+
 class SessionEventHandler : public bmqa::SessionEventHandler
 {
+  public:
+    // TYPES
+    enum { k_MAX_PULLED_MESSAGES = 65536 };
+    // The number of messages kept in pull mode beyond which the SDK thread
+    // that received an event waits for 'receive_messages' to make room.
+
   private:
+    struct PendingOperation
+    {
+        // An asynchronous queue operation waiting for its result event.
+
+        PyObject* d_on_complete;  // owned, or null if not reported on success
+        bsl::shared_ptr<OpenQueueBatch> d_batch_sp;  // null unless in a batch
+        int d_batch_index;
+        bool d_installed_policy;
+    };
+
+    typedef bsl::map<bsl::pair<int, bsl::string>, bsl::deque<PendingOperation> >
+            PendingOperations;
+    // Operations keyed on the type of their result event and their queue URI, in
+    // the order they were started.
+
+    struct PulledEvent
+    {
+        // A message event waiting to be consumed by 'receive_messages'.
+
+        bmqa::MessageEvent d_event;
+        int d_num_messages;
+        int d_num_consumed;
+        bsl::shared_ptr<const DecodedPayloads> d_decoded_sp;  // null if none
+    };
+
     PyObject* d_py_session_event_callback;
     PyObject* d_py_message_event_callback;
     PyObject* d_py_ack_event_callback;
+    PyObject* d_py_ack_batch_event_callback;
+    PyObject* d_py_slow_callback_event_callback;
+    bool d_zero_copy_payloads;
+    SessionStats* d_stats_p;  // held, not owned
+    WritableSignal* d_writable_signal_p;  // held, not owned
+    bmqa::AbstractSession* d_session_p;  // held, not owned
+    StringCache d_string_cache;  // protected by the GIL
+    bslmt::Mutex d_property_policies_lock;
+    bsl::shared_ptr<const PropertyPolicies> d_property_policies_sp;
+    // Replaced rather than modified, so that messages are converted without
+    // holding 'd_property_policies_lock' while Python objects are created.
+    bsls::AtomicBool d_has_payload_decoders;  // never reset once set
+    bslmt::Mutex d_pending_operations_lock;
+    PendingOperations d_pending_operations;
+    bool d_pull_messages;
+    bslmt::Mutex d_pulled_events_lock;
+    bslmt::Condition d_pulled_events_condition;
+    bslmt::Condition d_pulled_space_condition;
+    bsl::deque<PulledEvent> d_pulled_events;
+    int d_num_pulled_messages;  // not yet consumed from 'd_pulled_events'
+    bool d_receiving_stopped;
+    int d_notification_fds[2];  // read and write ends, or -1 until requested
+    bslma::ManagedPtr<MessageDispatcher> d_dispatcher_mp;  // null if disabled
+
+    // PRIVATE MANIPULATORS
+    bool complete_pending_operation(const bmqa::SessionEvent& event);
+    // Invoke the callback of the oldest pending operation waiting for the
+    // specified 'event', if any, and return whether there was one.  The GIL must
+    // be held.
+
+    void insert_pending_operation(
+            bmqt::SessionEventType::Enum result_type,
+            const bsl::string& queue_uri,
+            const PendingOperation& pending);
+    // Queue the specified 'pending' operation behind those waiting for the same
+    // 'result_type' on the queue with the specified 'queue_uri'.
+
+    void erase_pending_operation(
+            bmqt::SessionEventType::Enum result_type,
+            const bsl::string& queue_uri,
+            PyObject* on_complete,
+            const OpenQueueBatch* batch,
+            int batch_index);
+    // Forget the pending operation with the specified 'on_complete', 'batch'
+    // and 'batch_index' waiting for the specified 'result_type' on the queue
+    // with the specified 'queue_uri', if any, and clear the property policy of
+    // the queue if the operation installed it.
+
+    void on_ack_event(
+            const bmqa::MessageEvent& event,
+            bsls::Types::Int64 gil_wait_ns);
+    // Dispatch the acknowledgements in the specified 'event' to the ack
+    // callbacks, after waiting the specified 'gil_wait_ns' for the GIL.  The
+    // GIL must be held.
+
+    void record_callback_timing(
+            const char* callback_name,
+            bsls::Types::Int64 gil_wait_ns,
+            bsls::Types::Int64 conversion_ns,
+            bsls::Types::Int64 callback_ns);
+    // Record the timing of one invocation of the callback with the specified
+    // 'callback_name' if callback timing is enabled, and report it to the slow
+    // callback event callback if it lasted the specified 'callback_ns' beyond
+    // the threshold.  The GIL must be held.
+
+    bsl::shared_ptr<const PropertyPolicies> property_policies();
+    // Return the current property policies.
+
+    void decode_payload(
+            DecodedPayload* result,
+            const bmqa::Message& message,
+            const PropertyPolicies& policies);
+    // Run the payload decoder of the queue of the specified 'message' in the
+    // specified 'policies' as 'MessageUtils::decode_payload' does, loading the
+    // outcome into the specified 'result', and confirm the message if the
+    // decoder rejected it.  The GIL must not be held.
+
+    bsl::shared_ptr<DecodedPayloads>
+    decode_payloads(const bmqa::MessageEvent& event, const PropertyPolicies& policies);
+    // Return the outcome of 'decode_payload' for every message in the specified
+    // 'event', or null if no queue has a payload decoder.  The GIL must not be
+    // held.
+
+    void deliver_messages(const bsl::vector<bmqa::Message>& messages);
+    // Pass the specified 'messages' to the message callback in a single call,
+    // acquiring the GIL to do so.  The GIL must not be held.
 
   public:
     SessionEventHandler(
             PyObject* py_session_event_callback,
             PyObject* py_message_event_callback,
-            PyObject* py_ack_event_callback);
+            PyObject* py_ack_event_callback,
+            PyObject* py_ack_batch_event_callback,
+            PyObject* py_slow_callback_event_callback,
+            bool zero_copy_payloads,
+            bool pull_messages,
+            int num_dispatch_threads,
+            SessionStats* stats,
+            WritableSignal* writable_signal);
+    // If the specified 'pull_messages' is true, received messages are kept
+    // until they are retrieved with 'receive_messages' instead of being passed
+    // to the specified 'py_message_event_callback'.  Acknowledgements of
+    // messages posted with a numeric ack id are passed to the specified
+    // 'py_ack_batch_event_callback' as a list of ids and a list of statuses,
+    // once per event, and all others to the specified 'py_ack_event_callback'.
+    // If the specified 'num_dispatch_threads' is positive, received messages
+    // are passed to 'py_message_event_callback' by that many threads of this
+    // object's own, each delivering the messages of some of the queues, rather
+    // than by the SDK's threads.  Received messages and callback invocations
+    // are counted in the specified 'stats', and the specified 'writable_signal'
+    // is notified of the events after which the channel to the broker may
+    // accept more data; both must outlive this object.  Callback invocations
+    // that 'stats' finds slow are reported to the specified
+    // 'py_slow_callback_event_callback' with the name of the callback, and how
+    // long it lasted and the threshold in seconds.  Throw 'bsl::runtime_error'
+    // if the dispatch threads can't be started.
 
     ~SessionEventHandler();
+    // Destroy this object, calling 'stop_dispatching' first.  The GIL must not
+    // be held.
 
     void onSessionEvent(const bmqa::SessionEvent& event) BSLS_KEYWORD_OVERRIDE;
     void onMessageEvent(const bmqa::MessageEvent& event) BSLS_KEYWORD_OVERRIDE;
+
+    void set_session(bmqa::AbstractSession* session);
+    // Confirm the messages whose payload is rejected by a payload decoder
+    // through the specified 'session', which must outlive this object.  This
+    // must be called before the session is started.
+
+    void
+    set_property_policy(const bsl::string& queue_uri, const PropertyPolicy& policy);
+    // Convert the properties of messages subsequently received on the queue with
+    // the specified 'queue_uri' as described by the specified 'policy'.  If it
+    // has a payload decoder, the decoder is run on each payload by the thread
+    // that received the message, or by the dispatch thread delivering it, before
+    // the GIL is acquired.
+
+    void clear_property_policy(const bsl::string& queue_uri);
+    // Go back to converting all the properties of messages received on the queue
+    // with the specified 'queue_uri' eagerly.
+
+    void add_pending_operation(
+            bmqt::SessionEventType::Enum result_type,
+            const bsl::string& queue_uri,
+            PyObject* on_complete,
+            bool installed_policy);
+    // Take ownership of a reference to the specified 'on_complete' and invoke it
+    // with the outcome of the next session event of the specified 'result_type'
+    // for the queue with the specified 'queue_uri', instead of passing that event
+    // to the session event callback.  'on_complete' is called with an error
+    // message as 'bytes', or 'None' on success, and whether the operation timed
+    // out.  If the specified 'installed_policy' is true, clear the property
+    // policy of the queue if the operation fails.  If 'on_complete' is null,
+    // the event is dropped if the operation succeeded, and its failure is
+    // reported to the session event callback otherwise.  The GIL need not be
+    // held.
+
+    void add_pending_operation(
+            const bsl::string& queue_uri,
+            const bsl::shared_ptr<OpenQueueBatch>& batch,
+            int batch_index,
+            bool installed_policy);
+    // Record the outcome of the next 'e_QUEUE_OPEN_RESULT' event for the queue
+    // with the specified 'queue_uri' as that of the queue at the specified
+    // 'batch_index' of the specified 'batch', instead of passing that event to
+    // the session event callback.  If the specified 'installed_policy' is
+    // true, clear the property policy of the queue if it fails to open.  The
+    // GIL need not be held.
+
+    void cancel_pending_operation(
+            bmqt::SessionEventType::Enum result_type,
+            const bsl::string& queue_uri,
+            PyObject* on_complete);
+    // Forget the specified 'on_complete' previously passed to
+    // 'add_pending_operation' with the specified 'result_type' and 'queue_uri',
+    // giving ownership of its reference back to the caller, and clear the
+    // property policy of the queue if the operation installed it.  The GIL need
+    // not be held.
+
+    void cancel_pending_operation(
+            const bsl::string& queue_uri,
+            const bsl::shared_ptr<OpenQueueBatch>& batch,
+            int batch_index);
+    // Forget the opening of the queue at the specified 'batch_index' of the
+    // specified 'batch' previously passed to 'add_pending_operation' with the
+    // specified 'queue_uri', and clear the property policy of the queue if the
+    // operation installed it.  The GIL need not be held.
+
+    PyObject* receive_messages(
+            int max_messages,
+            const bsl::optional<bsls::TimeInterval>& timeout);
+    // Return a list of up to the specified 'max_messages' messages kept in pull
+    // mode, in the format of 'MessageUtils::get_messages', waiting with the GIL
+    // released for at least one to arrive for at most the specified 'timeout',
+    // or indefinitely if it has no value.  Return an empty list on timeout or
+    // once 'stop_receiving' is called.  The GIL must be held.  Once
+    // 'k_MAX_PULLED_MESSAGES' messages are waiting, the SDK thread receiving
+    // the next event blocks until enough of them are retrieved, so that the
+    // SDK stops reading from the broker rather than the queue growing.
+
+    void stop_dispatching();
+    // Deliver every message waiting for a dispatch thread, then stop those
+    // threads.  Messages received afterwards are dropped.  This is called
+    // before the SDK session is stopped, so that the messages delivered can
+    // still be confirmed.  The GIL must not be held.
+
+    void stop_receiving();
+    // Wake up every caller blocked in 'receive_messages' and make subsequent
+    // calls return immediately, and drop the events that the SDK's threads
+    // are waiting to keep, or receive afterwards, in pull mode.  This must be
+    // called before the SDK session is stopped.  The GIL need not be held.
+
+    int notification_fd();
+    // Return a non-blocking file descriptor, created on the first call, that is
+    // readable whenever messages kept in pull mode are waiting to be retrieved
+    // with 'receive_messages'.  It is an eventfd where available, and the read
+    // end of a pipe elsewhere.  Return -1 with 'errno' set if it can't be
+    // created.  The GIL need not be held.
+
+    bool pull_messages() const;
+    // Return whether received messages are kept for 'receive_messages'.
 };
 
 }  // namespace pybmq
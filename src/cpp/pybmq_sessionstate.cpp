@@ -0,0 +1,123 @@
+// Copyright 2019-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <pybmq_sessionstate.h>
+
+#include <bslmt_threadutil.h>
+#include <bsls_assert.h>
+#include <bsls_types.h>
+
+namespace BloombergLP {
+namespace pybmq {
+
+namespace {
+
+int
+currentThreadSlot()
+{
+    // Thread ids are often addresses sharing their low bits, so mix every bit
+    // of the id into the top bits before picking a slot from them.
+    const bsls::Types::Uint64 hash =
+            bslmt::ThreadUtil::selfIdAsUint64() * 0x9E3779B97F4A7C15ULL;
+    return static_cast<int>(hash >> 32) % SessionState::k_NUM_SLOTS;
+}
+
+}  // namespace
+
+SessionState::SessionState()
+: d_started(false)
+{
+    for (int i = 0; i < k_NUM_SLOTS; ++i) {
+        d_slots[i].d_count = 0;
+    }
+}
+
+void
+SessionState::start()
+{
+    d_started = true;
+}
+
+bool
+SessionState::stop()
+{
+    const bool was_started = d_started.testAndSwap(true, false);
+
+    // Every operation increments its counter before checking 'd_started', and
+    // both are sequentially consistent, so any operation not counted below has
+    // seen the session as stopped.
+    for (int spins = 0;; ++spins) {
+        int in_flight = 0;
+        for (int i = 0; i < k_NUM_SLOTS; ++i) {
+            in_flight += d_slots[i].d_count;
+        }
+        if (!in_flight) {
+            break;
+        }
+        if (spins < 100) {
+            bslmt::ThreadUtil::yield();
+        } else {
+            bslmt::ThreadUtil::microSleep(100);
+        }
+    }
+    return was_started;
+}
+
+int
+SessionState::enter()
+{
+    const int slot = currentThreadSlot();
+    ++d_slots[slot].d_count;
+    if (!d_started) {
+        --d_slots[slot].d_count;
+        return -1;
+    }
+    return slot;
+}
+
+void
+SessionState::leave(int slot)
+{
+    BSLS_ASSERT(0 <= slot && slot < k_NUM_SLOTS);
+    --d_slots[slot].d_count;
+}
+
+bool
+SessionState::is_started() const
+{
+    return d_started;
+}
+
+SessionStateGuard::SessionStateGuard(SessionState* state)
+: d_state_p(state)
+, d_slot(state->enter())
+{
+}
+
+SessionStateGuard::~SessionStateGuard()
+{
+    if (d_slot >= 0) {
+        d_state_p->leave(d_slot);
+    }
+}
+
+bool
+SessionStateGuard::started() const
+{
+    return d_slot >= 0;
+}
+
+}  // namespace pybmq
+}  // namespace BloombergLP
@@ -0,0 +1,103 @@
+// Copyright 2019-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_PYBMQ_SESSIONSTATE
+#define INCLUDED_PYBMQ_SESSIONSTATE
+
+#include <bsls_atomic.h>
+
+namespace BloombergLP {
+namespace pybmq {
+
+class SessionState
+{
+    // Whether a session is started, along with the operations using it while
+    // it is, tracked without any lock shared by concurrent operations.  Each
+    // operation registers itself in one of several in-flight counters picked
+    // by the calling thread's id, each on its own cache line, so that callers
+    // on different threads rarely write to the same memory.  'stop' marks the
+    // session as stopped, then waits until every registered operation ends.
+
+  public:
+    // TYPES
+    enum { k_NUM_SLOTS = 64, k_CACHE_LINE_SIZE = 64 };
+
+  private:
+    // PRIVATE TYPES
+    struct Slot
+    {
+        bsls::AtomicInt d_count;
+        char d_padding[k_CACHE_LINE_SIZE - sizeof(bsls::AtomicInt)];
+    };
+
+    // DATA
+    Slot d_slots[k_NUM_SLOTS];
+    bsls::AtomicBool d_started;
+
+    // NOT IMPLEMENTED
+    SessionState(const SessionState&);
+    SessionState& operator=(const SessionState&);
+
+  public:
+    SessionState();
+
+    void start();
+    // Mark the session as started.
+
+    bool stop();
+    // Mark the session as stopped, and wait until every operation registered
+    // with 'enter' has called 'leave'.  Return whether the session was started
+    // and this call is the one that stopped it.
+
+    int enter();
+    // Register an operation using the session and return the slot it was
+    // registered in, to be passed to 'leave', if the session is started.
+    // Return -1, registering nothing, otherwise.
+
+    void leave(int slot);
+    // Unregister an operation from the specified 'slot' returned by 'enter'.
+
+    bool is_started() const;
+    // Return whether the session is started.
+};
+
+class SessionStateGuard
+{
+    // Register an operation with a 'SessionState' for the lifetime of this
+    // object, if the session is started when the guard is created.
+
+  private:
+    // DATA
+    SessionState* d_state_p;
+    int d_slot;
+
+    // NOT IMPLEMENTED
+    SessionStateGuard(const SessionStateGuard&);
+    SessionStateGuard& operator=(const SessionStateGuard&);
+
+  public:
+    explicit SessionStateGuard(SessionState* state);
+
+    ~SessionStateGuard();
+
+    bool started() const;
+    // Return whether the session was started when this guard was created, in
+    // which case it can't be stopped until this guard is destroyed.
+};
+
+}  // namespace pybmq
+}  // namespace BloombergLP
+
+#endif
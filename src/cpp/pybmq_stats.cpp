@@ -0,0 +1,525 @@
+// Copyright 2019-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <pybmq_stats.h>
+
+#include <pybmq_refutils.h>
+
+#include <bmqa_message.h>
+#include <bmqa_messageiterator.h>
+#include <bmqt_ackresult.h>
+#include <bmqt_correlationid.h>
+
+#include <bslmt_lockguard.h>
+#include <bsls_timeutil.h>
+
+#include <bsl_utility.h>
+#include <bsl_vector.h>
+
+namespace BloombergLP {
+namespace pybmq {
+
+namespace {
+
+const bmqt::AckResult::Enum k_ACK_STATUSES[] = {
+        bmqt::AckResult::e_SUCCESS,
+        bmqt::AckResult::e_UNKNOWN,
+        bmqt::AckResult::e_TIMEOUT,
+        bmqt::AckResult::e_NOT_CONNECTED,
+        bmqt::AckResult::e_CANCELED,
+        bmqt::AckResult::e_NOT_SUPPORTED,
+        bmqt::AckResult::e_REFUSED,
+        bmqt::AckResult::e_INVALID_ARGUMENT,
+        bmqt::AckResult::e_NOT_READY,
+        bmqt::AckResult::e_LIMIT_MESSAGES,
+        bmqt::AckResult::e_LIMIT_BYTES,
+        bmqt::AckResult::e_STORAGE_FAILURE,
+};
+
+const int k_NUM_KNOWN_ACK_STATUSES = sizeof k_ACK_STATUSES / sizeof *k_ACK_STATUSES;
+
+const double k_NS_PER_SECOND = 1e9;
+
+int
+ackStatusIndex(int status)
+{
+    // Return the index into 'k_ACK_STATUSES' of the specified 'status', or
+    // 'k_NUM_KNOWN_ACK_STATUSES' if it isn't one of them.
+    int index = 0;
+    while (index < k_NUM_KNOWN_ACK_STATUSES && k_ACK_STATUSES[index] != status) {
+        ++index;
+    }
+    return index;
+}
+
+bool
+setItem(PyObject* dict, const char* key, PyObject* value)
+{
+    // Store the specified 'value', a new reference that is consumed, under the
+    // specified 'key' of the specified 'dict'.  Return false with a Python
+    // exception set if 'value' is NULL or can't be stored.
+    bslma::ManagedPtr<PyObject> owned = RefUtils::toManagedPtr(value);
+    return owned && 0 == PyDict_SetItemString(dict, key, owned.get());
+}
+
+PyObject*
+callbackSnapshot(const bsls::AtomicInt64& calls, const bsls::AtomicInt64& duration_ns)
+{
+    // Return a new 'dict' holding the specified number of 'calls' of a
+    // callback and the total 'duration_ns' they took, in seconds.
+    return Py_BuildValue(
+            "{s:L,s:d}",
+            "calls",
+            calls.loadRelaxed(),
+            "seconds",
+            duration_ns.loadRelaxed() / k_NS_PER_SECOND);
+}
+
+}  // namespace
+
+LatencyHistogram::LatencyHistogram()
+: d_counts()
+, d_sum_ns()
+{
+}
+
+void
+LatencyHistogram::record(bsls::Types::Int64 duration_ns)
+{
+    int bucket = 0;
+    bsls::Types::Int64 bound_ns = 1000;
+    while (bucket < k_NUM_BOUNDED_BUCKETS && duration_ns > bound_ns) {
+        ++bucket;
+        bound_ns *= 2;
+    }
+    d_counts[bucket].addRelaxed(1);
+    d_sum_ns.addRelaxed(duration_ns);
+}
+
+PyObject*
+LatencyHistogram::snapshot() const
+{
+    bslma::ManagedPtr<PyObject> bounds =
+            RefUtils::toManagedPtr(PyList_New(k_NUM_BOUNDED_BUCKETS));
+    bslma::ManagedPtr<PyObject> counts =
+            RefUtils::toManagedPtr(PyList_New(k_NUM_BOUNDED_BUCKETS + 1));
+    if (!bounds || !counts) {
+        return NULL;
+    }
+
+    bsls::Types::Int64 total = 0;
+    for (int i = 0; i <= k_NUM_BOUNDED_BUCKETS; ++i) {
+        bsls::Types::Int64 count = d_counts[i].loadRelaxed();
+        total += count;
+        PyObject* py_count = PyLong_FromLongLong(count);
+        if (!py_count) {
+            return NULL;
+        }
+        PyList_SET_ITEM(counts.get(), i, py_count);
+        if (i == k_NUM_BOUNDED_BUCKETS) {
+            break;
+        }
+        PyObject* py_bound = PyFloat_FromDouble((1000LL << i) / k_NS_PER_SECOND);
+        if (!py_bound) {
+            return NULL;
+        }
+        PyList_SET_ITEM(bounds.get(), i, py_bound);
+    }
+
+    bslma::ManagedPtr<PyObject> ret = RefUtils::toManagedPtr(PyDict_New());
+    if (!ret || PyDict_SetItemString(ret.get(), "bounds", bounds.get())
+        || PyDict_SetItemString(ret.get(), "counts", counts.get())
+        || !setItem(ret.get(), "count", PyLong_FromLongLong(total))
+        || !setItem(
+                ret.get(),
+                "sum",
+                PyFloat_FromDouble(d_sum_ns.loadRelaxed() / k_NS_PER_SECOND)))
+    {
+        return NULL;
+    }
+    return ret.release().first;
+}
+
+QueueStats*
+QueueStats::from_queue_id(const bmqa::QueueId& queue_id)
+{
+    const bmqt::CorrelationId& correlation_id = queue_id.correlationId();
+    if (!correlation_id.isPointer()) {
+        return NULL;
+    }
+    return static_cast<QueueStats*>(correlation_id.thePointer());
+}
+
+QueueStats::QueueStats()
+: d_messages_posted()
+, d_bytes_posted()
+, d_acks()
+, d_confirms()
+, d_messages_delivered()
+, d_bytes_delivered()
+, d_messages_rejected()
+, d_post_to_ack_latency()
+{
+}
+
+void
+QueueStats::record_post(size_t payload_length)
+{
+    d_messages_posted.addRelaxed(1);
+    d_bytes_posted.addRelaxed(static_cast<bsls::Types::Int64>(payload_length));
+}
+
+void
+QueueStats::record_ack(int status)
+{
+    d_acks[ackStatusIndex(status)].addRelaxed(1);
+}
+
+void
+QueueStats::record_confirms(int count)
+{
+    d_confirms.addRelaxed(count);
+}
+
+void
+QueueStats::record_delivery(size_t payload_length)
+{
+    d_messages_delivered.addRelaxed(1);
+    d_bytes_delivered.addRelaxed(static_cast<bsls::Types::Int64>(payload_length));
+}
+
+void
+QueueStats::record_rejection()
+{
+    d_messages_rejected.addRelaxed(1);
+}
+
+LatencyHistogram&
+QueueStats::post_to_ack_latency()
+{
+    return d_post_to_ack_latency;
+}
+
+bsls::Types::Int64
+QueueStats::confirms() const
+{
+    return d_confirms.loadRelaxed();
+}
+
+bsls::Types::Int64
+QueueStats::messages_delivered() const
+{
+    return d_messages_delivered.loadRelaxed();
+}
+
+bsls::Types::Int64
+QueueStats::bytes_delivered() const
+{
+    return d_bytes_delivered.loadRelaxed();
+}
+
+PyObject*
+QueueStats::snapshot() const
+{
+    bslma::ManagedPtr<PyObject> acks = RefUtils::toManagedPtr(PyDict_New());
+    if (!acks) {
+        return NULL;
+    }
+    bsls::Types::Int64 nacks = 0;
+    for (int i = 0; i < k_NUM_ACK_STATUSES; ++i) {
+        bsls::Types::Int64 count = d_acks[i].loadRelaxed();
+        if (i != ackStatusIndex(bmqt::AckResult::e_SUCCESS)) {
+            nacks += count;
+        }
+        if (!count) {
+            continue;
+        }
+        const char* name = i < k_NUM_KNOWN_ACK_STATUSES
+                                   ? bmqt::AckResult::toAscii(k_ACK_STATUSES[i])
+                                   : "UNRECOGNIZED";
+        if (!setItem(acks.get(), name, PyLong_FromLongLong(count))) {
+            return NULL;
+        }
+    }
+
+    bslma::ManagedPtr<PyObject> ret = RefUtils::toManagedPtr(PyDict_New());
+    if (!ret
+        || !setItem(
+                ret.get(),
+                "messages_posted",
+                PyLong_FromLongLong(d_messages_posted.loadRelaxed()))
+        || !setItem(
+                ret.get(),
+                "bytes_posted",
+                PyLong_FromLongLong(d_bytes_posted.loadRelaxed()))
+        || PyDict_SetItemString(ret.get(), "acks", acks.get())
+        || !setItem(ret.get(), "nacks", PyLong_FromLongLong(nacks))
+        || !setItem(
+                ret.get(),
+                "confirms",
+                PyLong_FromLongLong(d_confirms.loadRelaxed()))
+        || !setItem(
+                ret.get(),
+                "messages_delivered",
+                PyLong_FromLongLong(d_messages_delivered.loadRelaxed()))
+        || !setItem(
+                ret.get(),
+                "bytes_delivered",
+                PyLong_FromLongLong(d_bytes_delivered.loadRelaxed()))
+        || !setItem(
+                ret.get(),
+                "messages_rejected",
+                PyLong_FromLongLong(d_messages_rejected.loadRelaxed()))
+        || !setItem(ret.get(), "post_to_ack_latency", d_post_to_ack_latency.snapshot()))
+    {
+        return NULL;
+    }
+    return ret.release().first;
+}
+
+SessionStats::SessionStats()
+: d_message_callback_calls()
+, d_message_callback_ns()
+, d_ack_callback_calls()
+, d_ack_callback_ns()
+, d_num_posted_events()
+, d_times_callbacks(false)
+, d_slow_callback_threshold_ns(0)
+, d_gil_wait()
+, d_conversion()
+, d_callback()
+, d_queues_lock()
+, d_queues()
+, d_samples_lock()
+, d_samples()
+, d_num_samples()
+{
+}
+
+void
+SessionStats::attach(bmqa::QueueId* queue_id, const bsl::string& queue_uri)
+{
+    bsl::shared_ptr<QueueStats> queue_stats;
+    {
+        bslmt::LockGuard<bslmt::Mutex> lock(&d_queues_lock);
+        bsl::shared_ptr<QueueStats>& slot = d_queues[queue_uri];
+        if (!slot) {
+            slot = bsl::make_shared<QueueStats>();
+        }
+        queue_stats = slot;
+    }
+    *queue_id = bmqa::QueueId(bmqt::CorrelationId(queue_stats.get()));
+}
+
+bool
+SessionStats::record_posted_event(const bmqa::MessageEvent& event)
+{
+    if (d_num_posted_events.addRelaxed(1) % k_SAMPLE_PERIOD != 1
+        || d_num_samples.loadRelaxed() >= k_MAX_SAMPLES)
+    {
+        return false;
+    }
+
+    Sample sample;
+    sample.d_posted_at_ns = bsls::TimeUtil::getTimer();
+
+    bslmt::LockGuard<bslmt::Mutex> lock(&d_samples_lock);
+    bmqa::MessageIterator iter = event.messageIterator();
+    while (iter.nextMessage() && d_samples.size() < k_MAX_SAMPLES) {
+        const bmqa::Message& message = iter.message();
+        if (message.correlationId().isUnset()) {
+            // No ack was requested, so no latency can be measured.
+            continue;
+        }
+        sample.d_queue_stats_p = QueueStats::from_queue_id(message.queueId());
+        if (sample.d_queue_stats_p) {
+            d_samples[message.messageGUID()] = sample;
+        }
+    }
+    d_num_samples.storeRelaxed(static_cast<int>(d_samples.size()));
+    return true;
+}
+
+void
+SessionStats::discard_posted_event(const bmqa::MessageEvent& event)
+{
+    // The event is sampled before it is posted, since its acknowledgement may
+    // otherwise arrive first, so a failed post has to take its samples back
+    // for them not to fill 'd_samples' with messages that are never acked.
+    bslmt::LockGuard<bslmt::Mutex> lock(&d_samples_lock);
+    bmqa::MessageIterator iter = event.messageIterator();
+    while (iter.nextMessage()) {
+        d_samples.erase(iter.message().messageGUID());
+    }
+    d_num_samples.storeRelaxed(static_cast<int>(d_samples.size()));
+}
+
+void
+SessionStats::record_ack_event(const bmqa::MessageEvent& event)
+{
+    bsls::Types::Int64 now_ns = 0;
+    bool has_samples = d_num_samples.loadRelaxed() > 0;
+    if (has_samples) {
+        now_ns = bsls::TimeUtil::getTimer();
+    }
+
+    bmqa::MessageIterator iter = event.messageIterator();
+    while (iter.nextMessage()) {
+        const bmqa::Message& message = iter.message();
+        QueueStats* queue_stats = QueueStats::from_queue_id(message.queueId());
+        if (queue_stats) {
+            queue_stats->record_ack(message.ackStatus());
+        }
+        if (!has_samples) {
+            continue;
+        }
+        bslmt::LockGuard<bslmt::Mutex> lock(&d_samples_lock);
+        Samples::iterator it = d_samples.find(message.messageGUID());
+        if (it == d_samples.end()) {
+            continue;
+        }
+        it->second.d_queue_stats_p->post_to_ack_latency().record(
+                now_ns - it->second.d_posted_at_ns);
+        d_samples.erase(it);
+        d_num_samples.storeRelaxed(static_cast<int>(d_samples.size()));
+    }
+}
+
+void
+SessionStats::discard_samples()
+{
+    bslmt::LockGuard<bslmt::Mutex> lock(&d_samples_lock);
+    d_samples.clear();
+    d_num_samples.storeRelaxed(0);
+}
+
+void
+SessionStats::record_push_event(const bmqa::MessageEvent& event)
+{
+    bmqa::MessageIterator iter = event.messageIterator();
+    while (iter.nextMessage()) {
+        QueueStats* queue_stats = QueueStats::from_queue_id(iter.message().queueId());
+        if (queue_stats) {
+            queue_stats->record_delivery(iter.message().dataSize());
+        }
+    }
+}
+
+void
+SessionStats::record_message_callback(bsls::Types::Int64 duration_ns)
+{
+    d_message_callback_calls.addRelaxed(1);
+    d_message_callback_ns.addRelaxed(duration_ns);
+}
+
+void
+SessionStats::record_ack_callback(bsls::Types::Int64 duration_ns)
+{
+    d_ack_callback_calls.addRelaxed(1);
+    d_ack_callback_ns.addRelaxed(duration_ns);
+}
+
+void
+SessionStats::enable_callback_timing(bsls::Types::Int64 slow_callback_threshold_ns)
+{
+    d_times_callbacks = true;
+    d_slow_callback_threshold_ns = slow_callback_threshold_ns;
+}
+
+bool
+SessionStats::times_callbacks() const
+{
+    return d_times_callbacks;
+}
+
+bsls::Types::Int64
+SessionStats::message_callback_ns() const
+{
+    return d_message_callback_ns.loadRelaxed();
+}
+
+bsls::Types::Int64
+SessionStats::slow_callback_threshold_ns() const
+{
+    return d_slow_callback_threshold_ns;
+}
+
+bool
+SessionStats::record_callback_timing(
+        bsls::Types::Int64 gil_wait_ns,
+        bsls::Types::Int64 conversion_ns,
+        bsls::Types::Int64 callback_ns)
+{
+    d_gil_wait.record(gil_wait_ns);
+    d_conversion.record(conversion_ns);
+    d_callback.record(callback_ns);
+    return d_slow_callback_threshold_ns > 0
+           && callback_ns > d_slow_callback_threshold_ns;
+}
+
+PyObject*
+SessionStats::snapshot()
+{
+    bsl::vector<bsl::pair<bsl::string, bsl::shared_ptr<QueueStats> > > queues;
+    {
+        bslmt::LockGuard<bslmt::Mutex> lock(&d_queues_lock);
+        queues.assign(d_queues.begin(), d_queues.end());
+    }
+
+    bslma::ManagedPtr<PyObject> py_queues = RefUtils::toManagedPtr(PyDict_New());
+    if (!py_queues) {
+        return NULL;
+    }
+    for (size_t i = 0; i < queues.size(); ++i) {
+        PyObject* queue_snapshot = queues[i].second->snapshot();
+        if (!setItem(py_queues.get(), queues[i].first.c_str(), queue_snapshot)) {
+            return NULL;
+        }
+    }
+
+    bslma::ManagedPtr<PyObject> ret = RefUtils::toManagedPtr(PyDict_New());
+    if (!ret
+        || !setItem(
+                ret.get(),
+                "message_callback",
+                callbackSnapshot(d_message_callback_calls, d_message_callback_ns))
+        || !setItem(
+                ret.get(),
+                "ack_callback",
+                callbackSnapshot(d_ack_callback_calls, d_ack_callback_ns))
+        || PyDict_SetItemString(ret.get(), "queues", py_queues.get()))
+    {
+        return NULL;
+    }
+    if (d_times_callbacks
+        && !setItem(
+                ret.get(),
+                "callback_timing",
+                Py_BuildValue(
+                        "{s:N,s:N,s:N}",
+                        "gil_wait",
+                        d_gil_wait.snapshot(),
+                        "conversion",
+                        d_conversion.snapshot(),
+                        "callback",
+                        d_callback.snapshot())))
+    {
+        return NULL;
+    }
+    return ret.release().first;
+}
+
+}  // namespace pybmq
+}  // namespace BloombergLP
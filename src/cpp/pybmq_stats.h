@@ -0,0 +1,254 @@
+// Copyright 2019-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_PYBMQ_STATS
+#define INCLUDED_PYBMQ_STATS
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <bmqa_messageevent.h>
+#include <bmqa_queueid.h>
+#include <bmqt_messageguid.h>
+
+#include <bsl_map.h>
+#include <bsl_memory.h>
+#include <bsl_string.h>
+#include <bsl_unordered_map.h>
+#include <bslh_hash.h>
+#include <bslmt_mutex.h>
+#include <bsls_atomic.h>
+#include <bsls_types.h>
+
+namespace BloombergLP {
+namespace pybmq {
+
+class LatencyHistogram
+{
+    // A histogram of durations, in buckets whose upper bounds double from one
+    // microsecond, plus one bucket for anything longer.  Updates use relaxed
+    // atomic operations and may be made from any thread.
+
+  public:
+    // TYPES
+    enum { k_NUM_BOUNDED_BUCKETS = 24 };
+
+  private:
+    // DATA
+    bsls::AtomicInt64 d_counts[k_NUM_BOUNDED_BUCKETS + 1];
+    bsls::AtomicInt64 d_sum_ns;
+
+    // NOT IMPLEMENTED
+    LatencyHistogram(const LatencyHistogram&);
+    LatencyHistogram& operator=(const LatencyHistogram&);
+
+  public:
+    LatencyHistogram();
+
+    void record(bsls::Types::Int64 duration_ns);
+    // Count one occurrence of the specified 'duration_ns'.
+
+    PyObject* snapshot() const;
+    // Return a new 'dict' holding the 'bounds' of the buckets in seconds, the
+    // 'counts' of every bucket, and the total 'count' and 'sum' in seconds of
+    // the recorded durations, or NULL with a Python exception set on failure.
+    // The GIL must be held.
+};
+
+class QueueStats
+{
+    // Counters for the messages exchanged on one queue.  Updates use relaxed
+    // atomic operations and may be made from any thread.
+
+  public:
+    // TYPES
+    enum { k_NUM_ACK_STATUSES = 13 };  // the known statuses, then any other
+
+  private:
+    // DATA
+    bsls::AtomicInt64 d_messages_posted;
+    bsls::AtomicInt64 d_bytes_posted;
+    bsls::AtomicInt64 d_acks[k_NUM_ACK_STATUSES];
+    bsls::AtomicInt64 d_confirms;
+    bsls::AtomicInt64 d_messages_delivered;
+    bsls::AtomicInt64 d_bytes_delivered;
+    bsls::AtomicInt64 d_messages_rejected;
+    LatencyHistogram d_post_to_ack_latency;
+
+    // NOT IMPLEMENTED
+    QueueStats(const QueueStats&);
+    QueueStats& operator=(const QueueStats&);
+
+  public:
+    // CLASS METHODS
+    static QueueStats* from_queue_id(const bmqa::QueueId& queue_id);
+    // Return the stats attached to the specified 'queue_id' by
+    // 'SessionStats::attach', or null if there are none.
+
+    QueueStats();
+
+    void record_post(size_t payload_length);
+    // Count one message posted with a payload of the specified
+    // 'payload_length' bytes.
+
+    void record_ack(int status);
+    // Count one acknowledgement with the specified 'status'.
+
+    void record_confirms(int count);
+    // Count the specified 'count' messages confirmed.
+
+    void record_delivery(size_t payload_length);
+    // Count one message received from the broker with a payload of the
+    // specified 'payload_length' bytes.
+
+    void record_rejection();
+    // Count one received message whose payload was rejected by the payload
+    // decoder of the queue.
+
+    LatencyHistogram& post_to_ack_latency();
+    // Return the histogram of the time between posting a message and
+    // receiving its acknowledgement.
+
+    bsls::Types::Int64 confirms() const;
+    // Return the number of messages confirmed so far.
+
+    bsls::Types::Int64 messages_delivered() const;
+    // Return the number of messages received so far.
+
+    bsls::Types::Int64 bytes_delivered() const;
+    // Return the total size of the payloads of the messages received so far.
+
+    PyObject* snapshot() const;
+    // Return a new 'dict' holding every counter, or NULL with a Python
+    // exception set on failure.  The GIL must be held.
+};
+
+class SessionStats
+{
+    // Counters for a session, and for each queue it opens.  Every counter is
+    // updated with relaxed atomic operations, so recording costs no lock on
+    // the paths taken for each message, except that one posted event in every
+    // 'k_SAMPLE_PERIOD' has the time it was posted at noted under a mutex in
+    // order to measure how long its messages take to be acknowledged.  Once
+    // 'enable_callback_timing' is called, every callback invocation also has
+    // the time spent waiting for the GIL, converting the event, and in the
+    // callback itself recorded in histograms.
+
+  public:
+    // TYPES
+    enum { k_SAMPLE_PERIOD = 16, k_MAX_SAMPLES = 1024 };
+
+  private:
+    // PRIVATE TYPES
+    struct Sample
+    {
+        QueueStats* d_queue_stats_p;
+        bsls::Types::Int64 d_posted_at_ns;
+    };
+
+    typedef bsl::map<bsl::string, bsl::shared_ptr<QueueStats> > QueueStatsMap;
+    typedef bsl::unordered_map<bmqt::MessageGUID, Sample, bslh::Hash<> > Samples;
+
+    // DATA
+    bsls::AtomicInt64 d_message_callback_calls;
+    bsls::AtomicInt64 d_message_callback_ns;
+    bsls::AtomicInt64 d_ack_callback_calls;
+    bsls::AtomicInt64 d_ack_callback_ns;
+    bsls::AtomicUint64 d_num_posted_events;
+    bool d_times_callbacks;  // only set before the session is started
+    bsls::Types::Int64 d_slow_callback_threshold_ns;  // or 0 to never warn
+    LatencyHistogram d_gil_wait;
+    LatencyHistogram d_conversion;
+    LatencyHistogram d_callback;
+    bslmt::Mutex d_queues_lock;
+    QueueStatsMap d_queues;
+    bslmt::Mutex d_samples_lock;
+    Samples d_samples;
+    bsls::AtomicInt d_num_samples;
+
+    // NOT IMPLEMENTED
+    SessionStats(const SessionStats&);
+    SessionStats& operator=(const SessionStats&);
+
+  public:
+    SessionStats();
+
+    void attach(bmqa::QueueId* queue_id, const bsl::string& queue_uri);
+    // Give the specified 'queue_id', about to be opened for the specified
+    // 'queue_uri', a correlation id pointing at the stats of that queue,
+    // which are kept for as long as this object exists.
+
+    bool record_posted_event(const bmqa::MessageEvent& event);
+    // Note that the specified 'event' is about to be posted, sampling the
+    // time it was posted at if it is due for a sample.  Return whether it was
+    // sampled.
+
+    void discard_posted_event(const bmqa::MessageEvent& event);
+    // Forget the messages of the specified 'event' sampled by
+    // 'record_posted_event', which the SDK then refused to post.
+
+    void record_ack_event(const bmqa::MessageEvent& event);
+    // Count every acknowledgement in the specified 'event', along with the
+    // latency of any message sampled by 'record_posted_event'.
+
+    void discard_samples();
+    // Forget the messages sampled by 'record_posted_event' whose
+    // acknowledgement hasn't been received.
+
+    void record_push_event(const bmqa::MessageEvent& event);
+    // Count every message in the specified 'event'.
+
+    void record_message_callback(bsls::Types::Int64 duration_ns);
+    // Count one invocation of the message callback lasting the specified
+    // 'duration_ns'.
+
+    void record_ack_callback(bsls::Types::Int64 duration_ns);
+    // Count one invocation of an ack callback lasting the specified
+    // 'duration_ns'.
+
+    void enable_callback_timing(bsls::Types::Int64 slow_callback_threshold_ns);
+    // Start recording how long each callback invocation takes, and report
+    // those lasting longer than the specified 'slow_callback_threshold_ns' if
+    // it is positive.  This must be called before any event is received.
+
+    bool times_callbacks() const;
+    // Return whether 'enable_callback_timing' was called.
+
+    bsls::Types::Int64 message_callback_ns() const;
+    // Return the total time spent in the message callback so far.
+
+    bsls::Types::Int64 slow_callback_threshold_ns() const;
+    // Return the duration beyond which a callback invocation is slow, or 0 if
+    // none is.
+
+    bool record_callback_timing(
+            bsls::Types::Int64 gil_wait_ns,
+            bsls::Types::Int64 conversion_ns,
+            bsls::Types::Int64 callback_ns);
+    // Record one callback invocation that waited the specified 'gil_wait_ns'
+    // for the GIL, took the specified 'conversion_ns' to convert its event,
+    // and lasted the specified 'callback_ns'.  Return whether it was slow.
+
+    PyObject* snapshot();
+    // Return a new 'dict' holding the session's counters, those of every
+    // queue by URI under 'queues', and the callback timing histograms under
+    // 'callback_timing' if enabled, or NULL with a Python exception set on
+    // failure.  The GIL must be held.
+};
+
+}  // namespace pybmq
+}  // namespace BloombergLP
+
+#endif
@@ -0,0 +1,125 @@
+// Copyright 2019-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <pybmq_stringcache.h>
+
+#include <pybmq_refutils.h>
+
+#include <bsls_assert.h>
+
+namespace BloombergLP {
+namespace pybmq {
+
+#ifdef Py_GIL_DISABLED
+namespace {  // unnamed
+
+class CacheLockGuard
+{
+    // Lock a 'PyMutex' for the lifetime of this guard.  Waiting for a
+    // 'PyMutex' detaches the thread, so it can't keep the thread holding it
+    // from running a garbage collection.
+
+    PyMutex* d_lock_p;
+
+  public:
+    explicit CacheLockGuard(PyMutex* lock)
+    : d_lock_p(lock)
+    {
+        PyMutex_Lock(d_lock_p);
+    }
+
+    ~CacheLockGuard() { PyMutex_Unlock(d_lock_p); }
+};
+
+}  // namespace
+#endif
+
+StringCache::StringCache()
+: d_strings()
+, d_enumerators()
+#ifdef Py_GIL_DISABLED
+, d_lock()
+#endif
+{
+}
+
+StringCache::~StringCache()
+{
+    BSLS_ASSERT(d_strings.empty());
+    BSLS_ASSERT(d_enumerators.empty());
+}
+
+PyObject*
+StringCache::get(const bsl::string& value)
+{
+#ifdef Py_GIL_DISABLED
+    CacheLockGuard guard(&d_lock);
+#endif
+    bsl::unordered_map<bsl::string, PyObject*>::const_iterator it =
+            d_strings.find(value);
+    if (it != d_strings.end()) {
+        return RefUtils::ref(it->second);
+    }
+    PyObject* str = PyUnicode_FromStringAndSize(value.c_str(), value.length());
+    if (!str) {
+        return NULL;
+    }
+    d_strings[value] = str;
+    return RefUtils::ref(str);
+}
+
+PyObject*
+StringCache::get(int enumerator, const char* name)
+{
+#ifdef Py_GIL_DISABLED
+    CacheLockGuard guard(&d_lock);
+#endif
+    bsl::unordered_map<int, PyObject*>::const_iterator it =
+            d_enumerators.find(enumerator);
+    if (it != d_enumerators.end()) {
+        return RefUtils::ref(it->second);
+    }
+    PyObject* str = PyUnicode_FromString(name);
+    if (!str) {
+        return NULL;
+    }
+    d_enumerators[enumerator] = str;
+    return RefUtils::ref(str);
+}
+
+void
+StringCache::clear()
+{
+#ifdef Py_GIL_DISABLED
+    CacheLockGuard guard(&d_lock);
+#endif
+    for (bsl::unordered_map<bsl::string, PyObject*>::iterator it = d_strings.begin();
+         it != d_strings.end();
+         ++it)
+    {
+        Py_DECREF(it->second);
+    }
+    d_strings.clear();
+    for (bsl::unordered_map<int, PyObject*>::iterator it = d_enumerators.begin();
+         it != d_enumerators.end();
+         ++it)
+    {
+        Py_DECREF(it->second);
+    }
+    d_enumerators.clear();
+}
+
+}  // namespace pybmq
+}  // namespace BloombergLP
@@ -0,0 +1,70 @@
+// Copyright 2019-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_PYBMQ_STRINGCACHE
+#define INCLUDED_PYBMQ_STRINGCACHE
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <bsl_string.h>
+#include <bsl_unordered_map.h>
+
+namespace BloombergLP {
+namespace pybmq {
+
+class StringCache
+{
+    // A cache of the Python 'str' objects for strings that recur in every
+    // event, such as queue URIs and status names, so that each is only created
+    // once.  The GIL must be held to call any method.  On free-threaded builds
+    // the calls are serialized by a mutex of this object's own instead.
+
+  private:
+    // DATA
+    bsl::unordered_map<bsl::string, PyObject*> d_strings;  // owned references
+    bsl::unordered_map<int, PyObject*> d_enumerators;      // owned references
+#ifdef Py_GIL_DISABLED
+    PyMutex d_lock;
+#endif
+
+    // NOT IMPLEMENTED
+    StringCache(const StringCache&);
+    StringCache& operator=(const StringCache&);
+
+  public:
+    StringCache();
+
+    ~StringCache();
+    // Destroy this object.  'clear' must have been called beforehand if any
+    // string was cached.
+
+    PyObject* get(const bsl::string& value);
+    // Return a new reference to a 'str' equal to the specified UTF-8 'value',
+    // or NULL with a Python exception set on failure.
+
+    PyObject* get(int enumerator, const char* name);
+    // Return a new reference to a 'str' equal to the specified 'name' of the
+    // specified 'enumerator', looking it up by 'enumerator' alone once cached.
+    // Return NULL with a Python exception set on failure.
+
+    void clear();
+    // Release every cached string.
+};
+
+}  // namespace pybmq
+}  // namespace BloombergLP
+
+#endif
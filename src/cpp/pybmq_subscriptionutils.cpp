@@ -0,0 +1,175 @@
+// Copyright 2019-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <pybmq_subscriptionutils.h>
+
+#include <pybmq_criticalsectionguard.h>
+#include <pybmq_refutils.h>
+
+#include <bmqt_correlationid.h>
+#include <bmqt_subscription.h>
+
+#include <bsl_sstream.h>
+#include <bsl_string.h>
+#include <bslma_managedptr.h>
+
+#include <limits.h>
+
+namespace BloombergLP {
+namespace pybmq {
+
+namespace {
+
+bool
+loadInt(int* value, PyObject* py_value, const char* name)
+{
+    long result = PyLong_AsLong(py_value);
+    if (result == -1 && PyErr_Occurred()) {
+        return false;
+    }
+    if (result < INT_MIN || result > INT_MAX) {
+        PyErr_Format(PyExc_OverflowError, "subscription %s is out of range", name);
+        return false;
+    }
+    *value = static_cast<int>(result);
+    return true;
+}
+
+PyObject*
+optionalInt(bool has_value, int value)
+{
+    if (!has_value) {
+        return RefUtils::ref(Py_None);
+    }
+    return PyLong_FromLong(value);
+}
+
+}  // namespace
+
+bool
+SubscriptionUtils::load_subscriptions(
+        bmqt::QueueOptions* options,
+        PyObject* py_subscriptions)
+{
+    bslma::ManagedPtr<PyObject> subscriptions = RefUtils::toManagedPtr(
+            PySequence_Fast(py_subscriptions, "subscriptions must be a sequence"));
+    if (!subscriptions) {
+        return false;
+    }
+    CriticalSectionGuard subscriptions_guard(subscriptions.get());
+
+    options->removeAllSubscriptions();
+    const Py_ssize_t num_subscriptions = PySequence_Fast_GET_SIZE(subscriptions.get());
+    for (Py_ssize_t i = 0; i < num_subscriptions; ++i) {
+        const char* expression;
+        Py_ssize_t expression_length;
+        PyObject* py_consumer_priority;
+        PyObject* py_max_unconfirmed_messages;
+        PyObject* py_max_unconfirmed_bytes;
+        if (!PyArg_ParseTuple(
+                    PySequence_Fast_GET_ITEM(subscriptions.get(), i),
+                    "y#OOO:subscription",
+                    &expression,
+                    &expression_length,
+                    &py_consumer_priority,
+                    &py_max_unconfirmed_messages,
+                    &py_max_unconfirmed_bytes))
+        {
+            return false;
+        }
+
+        bmqt::Subscription subscription;
+        subscription.setExpression(bmqt::SubscriptionExpression(
+                bsl::string(expression, expression_length),
+                bmqt::SubscriptionExpression::e_VERSION_1));
+
+        int value;
+        if (py_consumer_priority != Py_None) {
+            if (!loadInt(&value, py_consumer_priority, "consumer_priority")) {
+                return false;
+            }
+            subscription.setConsumerPriority(value);
+        }
+        if (py_max_unconfirmed_messages != Py_None) {
+            if (!loadInt(&value,
+                         py_max_unconfirmed_messages,
+                         "max_unconfirmed_messages"))
+            {
+                return false;
+            }
+            subscription.setMaxUnconfirmedMessages(value);
+        }
+        if (py_max_unconfirmed_bytes != Py_None) {
+            if (!loadInt(&value, py_max_unconfirmed_bytes, "max_unconfirmed_bytes")) {
+                return false;
+            }
+            subscription.setMaxUnconfirmedBytes(value);
+        }
+
+        // Every subscription gets a handle of its own, as they are always
+        // replaced all at once.
+        bsl::string error;
+        if (!options->addOrUpdateSubscription(
+                    &error,
+                    bmqt::SubscriptionHandle(bmqt::CorrelationId::autoValue()),
+                    subscription))
+        {
+            bsl::ostringstream oss;
+            oss << "Invalid subscription '"
+                << bsl::string(expression, expression_length) << "': " << error;
+            PyErr_SetString(PyExc_ValueError, oss.str().c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+PyObject*
+SubscriptionUtils::get_subscriptions(const bmqt::QueueOptions& options)
+{
+    bmqt::QueueOptions::SubscriptionsSnapshot snapshot;
+    options.loadSubscriptions(&snapshot);
+
+    bslma::ManagedPtr<PyObject> py_subscriptions =
+            RefUtils::toManagedPtr(PyList_New(snapshot.size()));
+    if (!py_subscriptions) {
+        return NULL;
+    }
+    for (size_t i = 0; i < snapshot.size(); ++i) {
+        const bmqt::Subscription& subscription = snapshot[i].second;
+        const bsl::string& expression = subscription.expression().text();
+        PyObject* py_subscription = Py_BuildValue(
+                "(y# N N N)",
+                expression.c_str(),
+                (Py_ssize_t)expression.length(),
+                optionalInt(
+                        subscription.hasConsumerPriority(),
+                        subscription.consumerPriority()),
+                optionalInt(
+                        subscription.hasMaxUnconfirmedMessages(),
+                        subscription.maxUnconfirmedMessages()),
+                optionalInt(
+                        subscription.hasMaxUnconfirmedBytes(),
+                        subscription.maxUnconfirmedBytes()));
+        if (!py_subscription) {
+            return NULL;
+        }
+        PyList_SET_ITEM(py_subscriptions.get(), i, py_subscription);
+    }
+    return py_subscriptions.release().first;
+}
+
+}  // namespace pybmq
+}  // namespace BloombergLP
@@ -0,0 +1,52 @@
+// Copyright 2019-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_PYBMQ_SUBSCRIPTIONUTILS
+#define INCLUDED_PYBMQ_SUBSCRIPTIONUTILS
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <bmqt_queueoptions.h>
+
+namespace BloombergLP {
+namespace pybmq {
+
+struct SubscriptionUtils
+{
+    // This utility provides functions for converting the subscriptions of a
+    // 'bmqt::QueueOptions' from and to Python.  A subscription is represented
+    // in Python by an '(expression, consumer_priority,
+    // max_unconfirmed_messages, max_unconfirmed_bytes)' tuple, where the
+    // expression is 'bytes' and each other item is an 'int', or 'None' if it
+    // is not set.  The GIL must be held.
+
+    // CLASS METHODS
+    static bool
+    load_subscriptions(bmqt::QueueOptions* options, PyObject* py_subscriptions);
+    // Replace the subscriptions of the specified 'options' with those in the
+    // specified 'py_subscriptions' sequence.  Return false with a Python
+    // exception set if 'py_subscriptions' isn't a sequence of valid
+    // subscriptions.
+
+    static PyObject* get_subscriptions(const bmqt::QueueOptions& options);
+    // Return a new list of the subscriptions of the specified 'options', or
+    // NULL with a Python exception set on failure.
+};
+
+}  // namespace pybmq
+}  // namespace BloombergLP
+
+#endif
@@ -0,0 +1,93 @@
+// Copyright 2019-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <pybmq_writablesignal.h>
+
+#include <bslmt_lockguard.h>
+#include <bsls_systemtime.h>
+
+namespace BloombergLP {
+namespace pybmq {
+
+WritableSignal::WritableSignal()
+: d_lock()
+, d_condition()
+, d_generation(0)
+, d_num_waiters(0)
+, d_closed(false)
+{
+}
+
+WritableSignal::Generation
+WritableSignal::generation() const
+{
+    return d_generation.load();
+}
+
+void
+WritableSignal::notify()
+{
+    // The waiters check the generation after registering themselves, and this
+    // checks for waiters after changing it, so one of the two sees the other.
+    ++d_generation;
+    if (d_num_waiters.load() == 0) {
+        return;
+    }
+    {
+        bslmt::LockGuard<bslmt::Mutex> lock(&d_lock);
+    }
+    d_condition.broadcast();
+}
+
+bool
+WritableSignal::wait(
+        Generation generation,
+        const bsl::optional<bsls::TimeInterval>& deadline)
+{
+    bsls::TimeInterval now = bsls::SystemTime::nowRealtimeClock();
+    if (deadline.has_value() && now >= deadline.value()) {
+        return false;
+    }
+    bsls::TimeInterval wake_up = now;
+    wake_up.addMilliseconds(k_MAX_WAIT_MS);
+    if (deadline.has_value() && deadline.value() < wake_up) {
+        wake_up = deadline.value();
+    }
+
+    bslmt::LockGuard<bslmt::Mutex> lock(&d_lock);
+    ++d_num_waiters;
+    while (!d_closed && d_generation.load() == generation) {
+        if (d_condition.timedWait(&d_lock, wake_up)) {
+            break;
+        }
+    }
+    --d_num_waiters;
+    return !d_closed
+           && (!deadline.has_value()
+               || bsls::SystemTime::nowRealtimeClock() < deadline.value());
+}
+
+void
+WritableSignal::close()
+{
+    {
+        bslmt::LockGuard<bslmt::Mutex> lock(&d_lock);
+        d_closed = true;
+    }
+    d_condition.broadcast();
+}
+
+}  // namespace pybmq
+}  // namespace BloombergLP
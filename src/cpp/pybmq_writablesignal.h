@@ -0,0 +1,87 @@
+// Copyright 2019-2023 Bloomberg Finance L.P.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_PYBMQ_WRITABLESIGNAL
+#define INCLUDED_PYBMQ_WRITABLESIGNAL
+
+#include <bsl_optional.h>
+#include <bslmt_condition.h>
+#include <bslmt_mutex.h>
+#include <bsls_atomic.h>
+#include <bsls_timeinterval.h>
+#include <bsls_types.h>
+
+namespace BloombergLP {
+namespace pybmq {
+
+class WritableSignal
+{
+    // Wake up the threads waiting to post again after the SDK refused a post
+    // with 'e_BW_LIMIT' because its channel to the broker reached its high
+    // watermark.  The SDK doesn't tell its applications when that channel
+    // drains, so waiters are woken by the notifications that follow it
+    // draining: the connection being established or restored, and
+    // acknowledgements arriving from the broker.  Since none of these is
+    // guaranteed to come while the channel drains, a waiter also gives up
+    // after 'k_MAX_WAIT_MS' milliseconds so that its caller retries anyway.
+
+  public:
+    // TYPES
+    typedef bsls::Types::Uint64 Generation;
+
+    enum { k_MAX_WAIT_MS = 10 };
+
+  private:
+    // DATA
+    bslmt::Mutex d_lock;
+    bslmt::Condition d_condition;
+    bsls::AtomicUint64 d_generation;
+    bsls::AtomicInt d_num_waiters;  // modified while holding 'd_lock'
+    bool d_closed;  // protected by 'd_lock'
+
+    // NOT IMPLEMENTED
+    WritableSignal(const WritableSignal&);
+    WritableSignal& operator=(const WritableSignal&);
+
+  public:
+    WritableSignal();
+
+    Generation generation() const;
+    // Return the number of notifications so far, to be passed to 'wait' if the
+    // post attempted after calling this is refused.
+
+    void notify();
+    // Wake up every caller of 'wait'.  This is cheap when there are none, so it
+    // may be called for every event received by the session.  The GIL need not
+    // be held.
+
+    bool
+    wait(Generation generation, const bsl::optional<bsls::TimeInterval>& deadline);
+    // Wait until 'notify' is called after the specified 'generation' was
+    // returned by 'generation', or at most 'k_MAX_WAIT_MS' milliseconds, or
+    // until the specified 'deadline' on the realtime clock passes if it has a
+    // value.
+    // Return whether the caller should post again, which is the case unless the
+    // deadline passed or 'close' was called.  The GIL must not be held.
+
+    void close();
+    // Wake up every caller of 'wait' and make subsequent calls return 'false'
+    // immediately.  The GIL need not be held.
+};
+
+}  // namespace pybmq
+}  // namespace BloombergLP
+
+#endif
@@ -20,3 +20,8 @@ cdef extern from "bmqa_manualhosthealthmonitor.h" namespace "BloombergLP::bmqa"
     cdef cppclass ManualHostHealthMonitor:
         ManualHostHealthMonitor(HostHealthState) except +
         void setState(HostHealthState) except +
+
+
+cdef extern from "bmqa_queueid.h" namespace "BloombergLP::bmqa" nogil:
+    cdef cppclass QueueId:
+        QueueId() except +
@@ -16,10 +16,14 @@
 from bsl cimport optional
 from bsl cimport pair
 from bsl cimport shared_ptr
+from bsl cimport string
+from bsl cimport vector
 from bsl.bsls cimport TimeInterval
+from cpython.object cimport PyTypeObject
 from libcpp cimport bool as cppbool
 
 from bmq.bmqa cimport ManualHostHealthMonitor
+from bmq.bmqa cimport QueueId
 from bmq.bmqt cimport CompressionAlgorithmType
 
 
@@ -31,14 +35,89 @@ cdef extern from 'pybmq_ballutil.h' namespace 'BloombergLP::pybmq':
             object context,
         ) except +
 
+        @staticmethod
+        object setCategoryLevel(const char* category_prefix, int level) except +
+
         @staticmethod
         object shutDownBallSingleton() except +
 
+cdef extern from "pybmq_compressionpolicy.h" namespace "BloombergLP::pybmq" nogil:
+    cdef cppclass CompressionPolicy:
+        CompressionPolicy(CompressionAlgorithmType algorithm,
+                          size_t min_size,
+                          cppbool adaptive) except+
+
+cdef extern from "pybmq_flowcontroller.h" namespace "BloombergLP::pybmq" nogil:
+    cdef cppclass FlowControlPolicy:
+        FlowControlPolicy(int min_messages,
+                          int max_messages,
+                          int min_bytes,
+                          int max_bytes,
+                          const TimeInterval& window,
+                          const TimeInterval& interval) except+
+
+cdef extern from "pybmq_hosthealthmonitor.h" namespace "BloombergLP::pybmq" nogil:
+    cdef cppclass SystemHostHealthMonitor:
+        SystemHostHealthMonitor(const optional[double]& max_load_average,
+                                const optional[double]& min_available_memory,
+                                const string& probe_file,
+                                const string& probe_command,
+                                const TimeInterval& interval) except+
+
+cdef extern from "pybmq_loopbacksession.h" namespace "BloombergLP::pybmq" nogil:
+    cdef cppclass LoopbackOptions:
+        LoopbackOptions(const TimeInterval& latency,
+                        int batch_size,
+                        double nack_ratio) except+
+
+cdef extern from "pybmq_messagetypes.h" namespace "BloombergLP::pybmq":
+    cdef cppclass MessageTypes:
+        @staticmethod
+        bint initialize(object error,
+                        object property_types,
+                        object ack_statuses,
+                        object unrecognized_ack_status,
+                        object lazy_properties_factory) except 0
+
+        @staticmethod
+        PyTypeObject* message_type()
+
+        @staticmethod
+        PyTypeObject* message_handle_type()
+
+        @staticmethod
+        PyTypeObject* ack_type()
+
+        @staticmethod
+        object create_message(object data,
+                              object data_buffers,
+                              object guid,
+                              object queue_uri,
+                              object properties,
+                              object property_types,
+                              cppbool property_type_codes)
+
+        @staticmethod
+        object create_message_handle(object message, object ext_session)
+
+        @staticmethod
+        object create_ack(object guid,
+                          object status,
+                          object status_description,
+                          object queue_uri)
+
+cdef extern from "pybmq_propertiestemplate.h" namespace "BloombergLP::pybmq" nogil:
+    cdef cppclass PropertiesTemplate:
+        PropertiesTemplate() except+
+        object load(object properties) except+
+
 cdef extern from "pybmq_session.h" namespace "BloombergLP::pybmq" nogil:
     cdef cppclass Session:
         Session(object on_session_event,
                 object on_message_event,
                 object on_ack_event,
+                object on_ack_batch_event,
+                object on_slow_callback_event,
                 const char* broker_uri,
                 const char* script_name,
                 CompressionAlgorithmType message_compression_algorithm,
@@ -54,36 +133,123 @@ cdef extern from "pybmq_session.h" namespace "BloombergLP::pybmq" nogil:
                 TimeInterval close_queue_timeout,
                 bint monitor_host_health,
                 shared_ptr[ManualHostHealthMonitor] fake_host_health_monitor_sp,
+                shared_ptr[SystemHostHealthMonitor] system_host_health_monitor_sp,
+                bint zero_copy_payloads,
+                bint pull_messages,
+                int num_dispatch_threads,
+                bint time_callbacks,
+                TimeInterval slow_callback_threshold,
                 object error,
                 object broker_timeout_error,
+                const LoopbackOptions* loopback,
                 object mock) except+
 
         object start(TimeInterval) except+
         object stop(bint) except+
 
-        object open_queue_sync(const char* queue_uri,
+        object open_queue_sync(QueueId* queue_id,
+                               const char* queue_uri,
                                bint read,
                                bint write,
                                optional[int] consumer_priority,
                                optional[int] max_unconfirmed_messages,
                                optional[int] max_unconfirmed_bytes,
                                optional[cppbool] suspends_on_bad_host_health,
-                               TimeInterval timeout) except+
+                               object subscriptions,
+                               TimeInterval timeout,
+                               bint lazy_properties,
+                               object property_projection,
+                               const CompressionPolicy* compression_policy,
+                               object payload_decoder,
+                               const FlowControlPolicy* flow_control) except+
 
         object configure_queue_sync(const char* queue_uri,
                                     optional[int] consumer_priority,
                                     optional[int] max_unconfirmed_messages,
                                     optional[int] max_unconfirmed_bytes,
                                     optional[cppbool] suspends_on_bad_host_health,
+                                    object subscriptions,
                                     TimeInterval timeout) except+
 
         object close_queue_sync(const char* queue_uri, TimeInterval timeout) except+
 
+        object open_queue_async(QueueId* queue_id,
+                                const char* queue_uri,
+                                bint read,
+                                bint write,
+                                optional[int] consumer_priority,
+                                optional[int] max_unconfirmed_messages,
+                                optional[int] max_unconfirmed_bytes,
+                                optional[cppbool] suspends_on_bad_host_health,
+                                object subscriptions,
+                                TimeInterval timeout,
+                                bint lazy_properties,
+                                object property_projection,
+                                const CompressionPolicy* compression_policy,
+                                object payload_decoder,
+                                const FlowControlPolicy* flow_control,
+                                object on_complete) except+
+
+        object open_queues(const vector[QueueId*]& queue_ids,
+                           const vector[string]& queue_uris,
+                           bint read,
+                           bint write,
+                           optional[int] consumer_priority,
+                           optional[int] max_unconfirmed_messages,
+                           optional[int] max_unconfirmed_bytes,
+                           optional[cppbool] suspends_on_bad_host_health,
+                           object subscriptions,
+                           TimeInterval timeout,
+                           bint lazy_properties,
+                           object property_projection,
+                           const CompressionPolicy* compression_policy,
+                           object payload_decoder,
+                           const FlowControlPolicy* flow_control,
+                           int max_in_flight) except+
+
+        object configure_queue_async(const char* queue_uri,
+                                     optional[int] consumer_priority,
+                                     optional[int] max_unconfirmed_messages,
+                                     optional[int] max_unconfirmed_bytes,
+                                     optional[cppbool] suspends_on_bad_host_health,
+                                     object subscriptions,
+                                     TimeInterval timeout,
+                                     object on_complete) except+
+
+        object close_queue_async(const char* queue_uri,
+                                 TimeInterval timeout,
+                                 object on_complete) except+
+
         object get_queue_options(const char* queue_uri) except+
 
         object post(const char* queue_uri,
                     const char* payload,
                     size_t payload_length,
                     object properties,
-                    object on_ack) except+
+                    const PropertiesTemplate* properties_template,
+                    object on_ack,
+                    optional[CompressionAlgorithmType] compression_algorithm,
+                    cppbool block,
+                    optional[TimeInterval] timeout,
+                    cppbool raise_on_bw_limit) except+
+        object post_to_queue(const QueueId& queue_id,
+                             const char* payload,
+                             size_t payload_length,
+                             object properties,
+                             const PropertiesTemplate* properties_template,
+                             object on_ack,
+                             optional[CompressionAlgorithmType] compression_algorithm,
+                             cppbool block,
+                             optional[TimeInterval] timeout,
+                             cppbool raise_on_bw_limit) except+
+        object post_many(const char* queue_uri,
+                         object messages,
+                         const PropertiesTemplate* properties_template) except+
         object confirm(const char* queue_uri, const unsigned char* guid, size_t guid_length) except+
+        object confirm_on_queue(const QueueId& queue_id,
+                                const unsigned char* guid,
+                                size_t guid_length) except+
+        object confirm_many(object messages) except+
+        object receive(int max_messages, optional[TimeInterval] timeout) except+
+        object notification_fd() except+
+        object stats() except+
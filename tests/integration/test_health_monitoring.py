@@ -14,6 +14,7 @@
 # limitations under the License.
 
 import threading
+import time
 
 import mock
 import pytest
@@ -23,6 +24,7 @@ from blazingmq import Error
 from blazingmq import QueueOptions
 from blazingmq import Session
 from blazingmq import session_events
+from blazingmq._ext import Session as ExtSession
 from blazingmq.testing import HostHealth
 
 
@@ -80,6 +82,30 @@ def test_enabling_real_host_health_monitoring():
     ]
 
 
+def test_native_host_health_monitoring_keeps_host_healthy(unique_queue):
+    # GIVEN
+    spy = mock.MagicMock()
+    queue_uri = unique_queue.encode("utf-8")
+    session = ExtSession(spy, monitor_host_health=True)
+    session.open_queue_sync(
+        queue_uri, read=False, write=True, suspends_on_bad_host_health=True
+    )
+
+    # WHEN
+    time.sleep(3.0)  # let the monitor take a few samples
+    session.post(queue_uri, b"blah")
+    session.stop()
+
+    # THEN
+    assert not any(
+        isinstance(
+            call.args[0],
+            (session_events.HostUnhealthy, session_events.QueueSuspended),
+        )
+        for call in spy.call_args_list
+    )
+
+
 def test_disabling_host_health_monitoring():
     # GIVEN
     spy = mock.MagicMock()
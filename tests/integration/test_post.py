@@ -23,6 +23,7 @@ from blazingmq import AckStatus
 from blazingmq import CompressionAlgorithmType
 from blazingmq import QueueOptions
 from blazingmq import Session
+from blazingmq import Subscription
 from blazingmq import exceptions
 from blazingmq.session_events import log_session_event
 
@@ -143,6 +144,33 @@ def test_post_consume(unique_queue):
     assert message.queue_uri == unique_queue
 
 
+def test_post_consume_with_subscription(unique_queue):
+    # GIVEN
+    received = queue.Queue()
+
+    def on_message_event(message, message_handle):
+        received.put(message)
+        message_handle.confirm()
+
+    session = Session(log_session_event, on_message=on_message_event)
+    session.open_queue(
+        unique_queue,
+        read=True,
+        write=True,
+        options=QueueOptions(subscriptions=[Subscription("price > 25")]),
+    )
+
+    # WHEN
+    session.post(unique_queue, b"cheap", properties={"price": 10})
+    session.post(unique_queue, b"expensive", properties={"price": 30})
+    message = received.get(timeout=5)
+
+    # THEN
+    session.stop()
+    assert message.data == b"expensive"
+    assert received.empty()
+
+
 def test_post_with_successful_ack(default_session, unique_queue, zeroed_queue_options):
     # GIVEN
     default_session.open_queue(
@@ -0,0 +1,258 @@
+# Copyright 2019-2023 Bloomberg Finance L.P.
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import asyncio
+import concurrent.futures
+import os
+import threading
+
+import pytest
+
+from blazingmq import AsyncSession
+from blazingmq import Error
+from blazingmq import MessageHandle
+from blazingmq import QueueOptions
+from blazingmq._aio import _resolve_ack
+from blazingmq._messages import create_ack
+from blazingmq._messages import create_message
+from blazingmq._session import DEFAULT_TIMEOUT
+
+from .support import dummy_callback
+from .support import mock
+
+
+def test_async_session_requires_running_loop(ext):
+    # GIVEN
+    ext.mock_add_spec([])
+
+    # WHEN
+    with pytest.raises(Exception) as exc:
+        AsyncSession(dummy_callback)
+
+    # THEN
+    assert exc.type is RuntimeError
+
+
+def test_async_session_bad_max_batch_size(ext):
+    # GIVEN
+    ext.mock_add_spec([])
+
+    async def main():
+        AsyncSession(dummy_callback, max_batch_size=0)
+
+    # WHEN
+    with pytest.raises(Exception) as exc:
+        asyncio.run(main())
+
+    # THEN
+    assert exc.type is ValueError
+    assert exc.match("max_batch_size must be positive, was 0")
+
+
+def test_async_session_delivers_batches_on_event_loop(ext):
+    # GIVEN
+    ext.mock_add_spec(["notification_fd", "receive", "stop"])
+    read_fd, write_fd = os.pipe()
+    ext.notification_fd.return_value = read_fd
+    msgs = [
+        create_message(b"data1", b"guid1", "queue_uri", {}, {}),
+        create_message(b"data2", b"guid2", "queue_uri", {}, {}),
+    ]
+
+    def receive(max_messages, timeout):
+        os.read(read_fd, 1)
+        return msgs
+
+    ext.receive.side_effect = receive
+    received = []
+
+    async def main():
+        done = asyncio.Event()
+        loop_thread = threading.get_ident()
+
+        def on_message(message, message_handle):
+            assert threading.get_ident() == loop_thread
+            received.append((message, message_handle))
+            if len(received) == len(msgs):
+                done.set()
+
+        session = AsyncSession(dummy_callback, on_message, max_batch_size=10)
+        os.write(write_fd, b"x")
+        await asyncio.wait_for(done.wait(), timeout=5)
+        await session.stop()
+
+    # WHEN
+    try:
+        asyncio.run(main())
+    finally:
+        os.close(read_fd)
+        os.close(write_fd)
+
+    # THEN
+    ext.receive.assert_called_once_with(10, 0)
+    assert [message for message, _ in received] == msgs
+    assert all(isinstance(handle, MessageHandle) for _, handle in received)
+    ext.stop.assert_called_once_with()
+
+
+def test_async_session_without_on_message_does_not_watch_messages(ext):
+    # GIVEN
+    ext.mock_add_spec(["notification_fd", "stop"])
+
+    async def main():
+        session = AsyncSession(dummy_callback)
+        with pytest.raises(Exception) as exc:
+            await session.open_queue("queue_uri", read=True)
+        await session.stop()
+        return exc
+
+    # WHEN
+    exc = asyncio.run(main())
+
+    # THEN
+    assert exc.type is Error
+    assert exc.match(
+        "Can't open queue queue_uri in read mode: no "
+        "on_message callback was provided at AsyncSession construction"
+    )
+    ext.notification_fd.assert_not_called()
+    ext.stop.assert_called_once_with()
+
+
+def test_async_session_queue_operations(ext):
+    # GIVEN
+    ext.mock_add_spec([])
+    queue = object()
+    options = QueueOptions(max_unconfirmed_messages=0)
+
+    def completed(result):
+        future = concurrent.futures.Future()
+        future.set_result(result)
+        return future
+
+    async def main():
+        session = AsyncSession(dummy_callback)
+        session._session = mock.MagicMock()
+        session._session.open_queue_async.return_value = completed(queue)
+        session._session.configure_queue_async.return_value = completed(None)
+        session._session.close_queue_async.return_value = completed(None)
+        opened = await session.open_queue("queue_uri", write=True)
+        await session.configure_queue("queue_uri", options)
+        await session.close_queue("queue_uri", timeout=5.0)
+        session.get_queue_options("queue_uri")
+        return session._session, opened
+
+    # WHEN
+    inner, opened = asyncio.run(main())
+
+    # THEN
+    assert opened is queue
+    inner.open_queue_async.assert_called_once_with(
+        "queue_uri",
+        read=False,
+        write=True,
+        options=QueueOptions(),
+        timeout=DEFAULT_TIMEOUT,
+        lazy_properties=False,
+        property_projection=None,
+        compression_policy=None,
+        payload_decoder=None,
+        flow_control=None,
+    )
+    inner.configure_queue_async.assert_called_once_with(
+        "queue_uri", options, DEFAULT_TIMEOUT
+    )
+    inner.close_queue_async.assert_called_once_with("queue_uri", 5.0)
+    inner.get_queue_options.assert_called_once_with("queue_uri")
+
+
+def test_async_session_post_resolves_with_ack(ext):
+    # GIVEN
+    ext.mock_add_spec(["post"])
+    ack = create_ack(b"guid", 0, "SUCCESS", "queue_uri")
+
+    def post(queue_uri, message, properties, on_ack, properties_template, **kwargs):
+        threading.Thread(target=on_ack, args=(ack,)).start()
+
+    ext.post.side_effect = post
+
+    async def main():
+        session = AsyncSession(dummy_callback)
+        return await asyncio.wait_for(session.post("queue_uri", b"data"), timeout=5)
+
+    # WHEN
+    result = asyncio.run(main())
+
+    # THEN
+    assert result is ack
+    ext.post.assert_called_once_with(
+        b"queue_uri",
+        b"data",
+        properties=None,
+        on_ack=mock.ANY,
+        properties_template=None,
+        compression_algorithm=None,
+        block=False,
+        timeout=None,
+    )
+
+
+def test_async_session_ack_after_cancelled_post_is_dropped():
+    # GIVEN
+    ack = create_ack(b"guid", 0, "SUCCESS", "queue_uri")
+
+    async def main():
+        future = asyncio.get_running_loop().create_future()
+        future.cancel()
+
+        # WHEN
+        _resolve_ack(future, ack)
+        return future
+
+    # THEN
+    assert asyncio.run(main()).cancelled()
+
+
+def test_async_session_confirm(ext):
+    # GIVEN
+    ext.mock_add_spec(["confirm", "confirm_many"])
+    msgs = [create_message(b"data", b"guid1", "queue_uri", {}, {})]
+
+    async def main():
+        session = AsyncSession(dummy_callback)
+        await session.confirm(msgs[0])
+        await session.confirm_many(msgs)
+
+    # WHEN
+    asyncio.run(main())
+
+    # THEN
+    ext.confirm.assert_called_once_with(msgs[0])
+    ext.confirm_many.assert_called_once_with(msgs)
+
+
+def test_async_session_as_context_manager(ext):
+    # GIVEN
+    ext.mock_add_spec(["stop"])
+
+    async def main():
+        async with AsyncSession(dummy_callback):
+            ext.stop.assert_not_called()
+
+    # WHEN
+    asyncio.run(main())
+
+    # THEN
+    ext.stop.assert_called_once_with()
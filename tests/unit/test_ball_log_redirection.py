@@ -82,3 +82,36 @@ def test_ball_logger_python_exception_handling():
 
     # THEN
     assert b"Exception ignored in: 'BlazingMQ C++ log observer'" in stderr
+
+
+@pytest.mark.parametrize(
+    "category,emitted",
+    [("", False), ("pybmq", False), ("pybmq_ballutil_other", True), ("BMQ", True)],
+)
+def test_ball_logger_category_level(category, emitted):
+    # GIVEN
+    program = textwrap.dedent(
+        """
+        import blazingmq
+        import logging
+        logging.basicConfig(level="DEBUG")
+        blazingmq.set_sdk_log_level(logging.INFO, %r)
+        """
+        % category
+    )
+
+    env = os.environ.copy()
+    env["_PYBMQ_ENABLE_DIAGNOSTICS"] = "1"
+    process = subprocess.Popen(
+        [sys.executable, "-c", program],
+        stdout=subprocess.PIPE,
+        stderr=subprocess.PIPE,
+        env=env,
+    )
+
+    # WHEN
+    stdout, stderr = process.communicate()
+
+    # THEN
+    msg = b"DEBUG:blazingmq.pybmq_ballutil:Shutting down BALL redirection"
+    assert (msg in stderr) is emitted
@@ -13,10 +13,13 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
+import ctypes
 import queue
+import select
 
 import pytest
 
+from blazingmq import Error
 from blazingmq._enums import PropertyType
 from blazingmq._ext import Session
 from blazingmq._messages import AckStatus
@@ -115,6 +118,140 @@ def test_multiple_message_consumption():
     assert m4.data == b"payload4"
 
 
+def test_zero_copy_message_consumption():
+    # GIVEN
+    small_payload = b"payload1"
+    large_payload = bytes(range(256)) * 16
+    messages = [
+        [
+            (small_payload, b"1000000000003039CD8101000000270F", QUEUE_NAME, {}),
+            (large_payload, b"2000000000003039CD8101000000270F", QUEUE_NAME, {}),
+        ],
+    ]
+    mock = sdk_mock(start=0, openQueueSync=0, enqueue_messages=messages, stop=None)
+    q = queue.Queue()
+
+    def go_on(*args):
+        q.put(*args)
+
+    session = Session(
+        dummy_callback, on_message=go_on, zero_copy_payloads=True, _mock=mock
+    )
+
+    # WHEN
+    session.open_queue_sync(
+        QUEUE_NAME,
+        read=True,
+        write=False,
+        consumer_priority=0,
+        max_unconfirmed_messages=0,
+        max_unconfirmed_bytes=0,
+    )
+
+    # THEN
+    m1 = q.get(timeout=1)
+    assert isinstance(m1.data, memoryview)
+    assert m1.data.readonly
+    assert m1.data == small_payload
+    assert m1.data_buffers == [m1.data]
+
+    m2 = q.get()
+    assert len(m2.data_buffers) > 1
+    assert all(buf.readonly for buf in m2.data_buffers)
+    assert b"".join(m2.data_buffers) == large_payload
+    assert isinstance(m2.data, memoryview)
+    assert m2.data == large_payload
+
+
+def test_pull_mode_message_consumption():
+    # GIVEN
+    messages = [
+        [
+            (b"payload1", b"1000000000003039CD8101000000270F", QUEUE_NAME, {}),
+            (b"payload2", b"2000000000003039CD8101000000270F", QUEUE_NAME, {}),
+            (b"payload3", b"3000000000003039CD8101000000270F", QUEUE_NAME, {}),
+        ],
+    ]
+    mock = sdk_mock(start=0, openQueueSync=0, enqueue_messages=messages, stop=None)
+    session = Session(dummy_callback, pull_messages=True, _mock=mock)
+    session.open_queue_sync(
+        QUEUE_NAME,
+        read=True,
+        write=False,
+        consumer_priority=0,
+        max_unconfirmed_messages=0,
+        max_unconfirmed_bytes=0,
+    )
+
+    # WHEN
+    first = session.receive(2, timeout=1)
+    second = session.receive(2, timeout=1)
+    third = session.receive(2, timeout=0)
+
+    # THEN
+    assert [m.data for m in first] == [b"payload1", b"payload2"]
+    assert [pretty_hex(m.guid) for m in second] == ["3000000000003039CD8101000000270F"]
+    assert second[0].queue_uri == QUEUE_NAME.decode("utf8")
+    assert first[0].queue_uri is first[1].queue_uri is second[0].queue_uri
+    assert third == []
+
+
+def test_pull_mode_receive_after_stop_raises():
+    # GIVEN
+    mock = sdk_mock(start=0, stop=None)
+    session = Session(dummy_callback, pull_messages=True, _mock=mock)
+    session.stop()
+
+    # WHEN
+    with pytest.raises(Exception) as exc:
+        session.receive(1, timeout=0)
+
+    # THEN
+    assert exc.type is Error
+    assert exc.match("Method called after session was stopped")
+
+
+def test_pull_mode_notification_fd_tracks_pending_messages():
+    # GIVEN
+    messages = [
+        [(b"payload1", b"1000000000003039CD8101000000270F", QUEUE_NAME, {})],
+    ]
+    mock = sdk_mock(start=0, openQueueSync=0, enqueue_messages=messages, stop=None)
+    session = Session(dummy_callback, pull_messages=True, _mock=mock)
+    fd = session.notification_fd()
+    assert select.select([fd], [], [], 0)[0] == []
+
+    # WHEN
+    session.open_queue_sync(
+        QUEUE_NAME,
+        read=True,
+        write=False,
+        consumer_priority=0,
+        max_unconfirmed_messages=0,
+        max_unconfirmed_bytes=0,
+    )
+
+    # THEN
+    assert select.select([fd], [], [], 1)[0] == [fd]
+    assert [m.data for m in session.receive(10, timeout=0)] == [b"payload1"]
+    assert select.select([fd], [], [], 0)[0] == []
+    assert session.notification_fd() == fd
+
+
+def test_notification_fd_without_pull_mode_raises():
+    # GIVEN
+    mock = sdk_mock(start=0, stop=None)
+    session = Session(dummy_callback, _mock=mock)
+
+    # WHEN
+    with pytest.raises(Exception) as exc:
+        session.notification_fd()
+
+    # THEN
+    assert exc.type is Error
+    assert exc.match("Session was not created with pull_messages")
+
+
 @pytest.mark.parametrize(
     "params",
     [
@@ -263,6 +400,7 @@ def test_multiple_ack_consumption():
 
     # THEN
     ack = q1.get(timeout=1)
+    first_q1_ack = ack
     assert ack.status == AckStatus.SUCCESS
     assert pretty_hex(ack.guid) == "1000000000003039CD8101000000270F"
     assert ack.queue_uri == q1_name.decode("utf8")
@@ -286,6 +424,7 @@ def test_multiple_ack_consumption():
     assert ack.status == AckStatus.LIMIT_MESSAGES
     assert ack.guid is None
     assert ack.queue_uri == q1_name.decode("utf8")
+    assert ack.queue_uri is first_q1_ack.queue_uri
     assert (
         repr(ack) == "<Ack LIMIT_MESSAGES for "
         "bmq://bmq.dummy_domain.some_namespace/dummy_queue1>"
@@ -301,6 +440,89 @@ def test_multiple_ack_consumption():
     )
 
 
+def test_numbered_acks_delivered_in_batches():
+    # GIVEN
+    batches = queue.Queue()
+    singles = queue.Queue()
+
+    def on_acks(ack_ids, statuses):
+        batches.put((ack_ids, statuses))
+
+    acks = [
+        [
+            (0, b"1000000000003039CD8101000000270F", QUEUE_NAME, 7),
+            (-2, b"FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF", QUEUE_NAME, singles.put),
+            (-100, b"FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF", QUEUE_NAME, 8),
+        ],
+    ]
+    mock = sdk_mock(start=0, openQueueSync=0, post=0, enqueue_acks=acks, stop=None)
+    session = Session(dummy_callback, on_acks=on_acks, _mock=mock)
+
+    # WHEN
+    session.open_queue_sync(QUEUE_NAME, read=False, write=True)
+    session.post(QUEUE_NAME, b"fea", on_ack=7)
+
+    # THEN
+    assert batches.get(timeout=1) == (
+        [7, 8],
+        [AckStatus.SUCCESS, AckStatus.LIMIT_MESSAGES],
+    )
+    assert singles.get(timeout=1).status == AckStatus.UNKNOWN
+    assert batches.empty()
+
+
+def test_stats_count_posts_and_acks_per_queue():
+    # GIVEN
+    acks = [
+        [
+            (0, b"1000000000003039CD8101000000270F", QUEUE_NAME, 7),
+            (-100, b"FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF", QUEUE_NAME, 8),
+        ],
+    ]
+    mock = sdk_mock(start=0, openQueueSync=0, post=0, enqueue_acks=acks, stop=None)
+    batches = queue.Queue()
+    session = Session(
+        dummy_callback, on_acks=lambda *args: batches.put(args), _mock=mock
+    )
+    session.open_queue_sync(QUEUE_NAME, read=False, write=True)
+
+    # WHEN
+    session.post(QUEUE_NAME, b"fea", on_ack=7)
+    batches.get(timeout=1)
+    session.stop()
+    stats = session.stats()
+
+    # THEN
+    assert stats["ack_callback"]["calls"] == 1
+    assert stats["message_callback"] == {"calls": 0, "seconds": 0.0}
+    queue_stats = stats["queues"][QUEUE_NAME.decode()]
+    assert queue_stats["messages_posted"] == 1
+    assert queue_stats["bytes_posted"] == 3
+    assert queue_stats["acks"] == {"SUCCESS": 1, "LIMIT_MESSAGES": 1}
+    assert queue_stats["nacks"] == 1
+    assert queue_stats["confirms"] == 0
+    assert queue_stats["messages_delivered"] == 0
+    latency = queue_stats["post_to_ack_latency"]
+    assert len(latency["counts"]) == len(latency["bounds"]) + 1
+    assert latency["bounds"][0] == 1e-06
+    assert sum(latency["counts"]) == latency["count"]
+
+
+def test_post_with_negative_ack_id_raises():
+    # GIVEN
+    mock = sdk_mock(start=0, openQueueSync=0, stop=None)
+    session = Session(dummy_callback, on_acks=dummy_callback, _mock=mock)
+    session.open_queue_sync(QUEUE_NAME, read=False, write=True)
+
+    # WHEN
+    with pytest.raises(Exception) as exc:
+        session.post(QUEUE_NAME, b"fea", on_ack=-1)
+
+    # THEN
+    assert exc.type is ValueError
+    assert exc.match("^ack ids must not be negative$")
+
+
 def test_enqueue_acks_with_invalid_guid():
     acks = [[(0, b"100000000003039CD8101000000270F", QUEUE_NAME, dummy_callback)]]
     mock = sdk_mock(start=0, openQueueSync=0, enqueue_acks=acks, post=0, stop=None)
@@ -490,3 +712,280 @@ def test_interface_error_on_non_utf8_string_property():
     # THEN
     expected_error = "STRING property 'prop' has non-UTF-8 data\n"
     assert repr(q.get()) == "<InterfaceError: %s>" % expected_error
+
+
+def _receive_with_property_options(properties, **open_queue_kwargs):
+    messages = [
+        [
+            (
+                b"payload1",
+                b"1000000000003039CD8101000000270F",
+                QUEUE_NAME,
+                properties,
+            ),
+        ],
+    ]
+    mock = sdk_mock(start=0, openQueueSync=0, enqueue_messages=messages, stop=None)
+    q = queue.Queue()
+
+    def go_on(*args):
+        q.put(*args)
+
+    session = Session(dummy_callback, on_message=go_on, _mock=mock)
+    session.open_queue_sync(
+        QUEUE_NAME,
+        read=True,
+        write=False,
+        consumer_priority=0,
+        max_unconfirmed_messages=0,
+        max_unconfirmed_bytes=0,
+        **open_queue_kwargs,
+    )
+    return q.get(timeout=1)
+
+
+def test_receiving_lazy_message_properties():
+    # GIVEN
+    properties = {
+        b"a_bool": (True, BOOL),
+        b"a_string": (b"af\xC3\xA4ae", STRING),
+        b"an_int64": (54321, INT64),
+    }
+
+    # WHEN
+    m1 = _receive_with_property_options(properties, lazy_properties=True)
+
+    # THEN
+    assert m1.properties["a_string"] == "af\xE4ae"
+    assert "missing" not in m1.properties
+    assert m1.properties == {"a_bool": True, "a_string": "af\xE4ae", "an_int64": 54321}
+    assert m1.property_types == {
+        "a_bool": PropertyType.BOOL,
+        "a_string": PropertyType.STRING,
+        "an_int64": PropertyType.INT64,
+    }
+
+
+def test_receiving_lazy_message_properties_with_non_str_name():
+    # GIVEN
+    m1 = _receive_with_property_options({b"a_bool": (True, BOOL)}, lazy_properties=True)
+
+    # WHEN
+    with pytest.raises(Exception) as exc:
+        m1.properties[b"a_bool"]
+
+    # THEN
+    assert exc.type is TypeError
+    assert exc.match("property names must be str, not 'bytes'")
+
+
+def test_receiving_lazy_non_utf8_string_property_raises_on_access():
+    # GIVEN
+    m1 = _receive_with_property_options(
+        {b"prop": (b"\xC3", STRING)}, lazy_properties=True
+    )
+
+    # WHEN
+    with pytest.raises(Exception) as exc:
+        m1.properties["prop"]
+
+    # THEN
+    assert exc.type is UnicodeDecodeError
+    assert m1.property_types == {"prop": PropertyType.STRING}
+
+
+@pytest.mark.parametrize("lazy_properties", [False, True])
+def test_receiving_projected_message_properties(lazy_properties):
+    # GIVEN
+    properties = {
+        b"a_bool": (True, BOOL),
+        b"a_string": (b"abc", STRING),
+        b"an_int64": (54321, INT64),
+    }
+
+    # WHEN
+    m1 = _receive_with_property_options(
+        properties,
+        lazy_properties=lazy_properties,
+        property_projection=[b"an_int64", b"a_string", b"not_present"],
+    )
+
+    # THEN
+    assert m1.properties == {"a_string": "abc", "an_int64": 54321}
+    assert m1.property_types == {
+        "a_string": PropertyType.STRING,
+        "an_int64": PropertyType.INT64,
+    }
+    assert "a_bool" not in m1.properties
+
+
+def test_open_queue_with_invalid_property_projection():
+    # GIVEN
+    mock = sdk_mock(start=0, openQueueSync=0, stop=None)
+    session = Session(dummy_callback, on_message=dummy_callback, _mock=mock)
+
+    # WHEN
+    with pytest.raises(Exception) as exc:
+        session.open_queue_sync(
+            QUEUE_NAME,
+            read=True,
+            write=False,
+            property_projection=["a_string"],
+        )
+
+    # THEN
+    assert exc.type is TypeError
+    assert exc.match("property names must be bytes, not 'str'")
+
+
+class _PayloadSegment(ctypes.Structure):
+    _fields_ = [("data", ctypes.c_void_p), ("length", ctypes.c_size_t)]
+
+
+_ALLOCATE = ctypes.CFUNCTYPE(ctypes.c_void_p, ctypes.c_void_p, ctypes.c_size_t)
+
+
+class _DecodeResult(ctypes.Structure):
+    _fields_ = [
+        ("sink", ctypes.c_void_p),
+        ("allocate", _ALLOCATE),
+        ("reason", ctypes.c_char_p),
+    ]
+
+
+_DECODE = ctypes.CFUNCTYPE(
+    ctypes.c_int,
+    ctypes.c_void_p,
+    ctypes.POINTER(_PayloadSegment),
+    ctypes.c_size_t,
+    ctypes.POINTER(_DecodeResult),
+)
+
+
+class _PayloadDecoder(ctypes.Structure):
+    _fields_ = [
+        ("version", ctypes.c_int),
+        ("decode", _DECODE),
+        ("context", ctypes.c_void_p),
+    ]
+
+
+_CAPSULE_NAME = b"blazingmq.PayloadDecoder"
+_REJECTION_REASON = b"not lowercase"
+
+
+def _make_payload_decoder(version=1):
+    # A decoder written in Python through ctypes, which upper-cases lowercase
+    # payloads and rejects any other.
+    @_DECODE
+    def decode(context, segments, num_segments, result):
+        payload = b"".join(
+            ctypes.string_at(segments[i].data, segments[i].length)
+            for i in range(num_segments)
+        )
+        if not payload.islower():
+            result.contents.reason = _REJECTION_REASON
+            return 1
+        buffer = result.contents.allocate(result.contents.sink, len(payload))
+        ctypes.memmove(buffer, payload.upper(), len(payload))
+        return 0
+
+    decoder = _PayloadDecoder(version, decode, None)
+    capsule_new = ctypes.pythonapi.PyCapsule_New
+    capsule_new.restype = ctypes.py_object
+    capsule_new.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_void_p]
+    capsule = capsule_new(ctypes.addressof(decoder), _CAPSULE_NAME, None)
+    # The capsule only points at the decoder, so both must be kept alive.
+    return capsule, decoder
+
+
+@pytest.mark.parametrize("pull_messages", [False, True])
+def test_payload_decoder_replaces_and_rejects_payloads(pull_messages):
+    # GIVEN
+    messages = [
+        [
+            (b"payload1", b"1000000000003039CD8101000000270F", QUEUE_NAME, {}),
+            (b"Payload2", b"2000000000003039CD8101000000270F", QUEUE_NAME, {}),
+            (b"payload3", b"3000000000003039CD8101000000270F", QUEUE_NAME, {}),
+        ],
+    ]
+    mock = sdk_mock(
+        start=0,
+        openQueueSync=0,
+        confirmMessage=0,
+        enqueue_messages=messages,
+        stop=None,
+    )
+    events = queue.Queue()
+    received = queue.Queue()
+    capsule, decoder = _make_payload_decoder()
+    if pull_messages:
+        session = Session(events.put, pull_messages=True, _mock=mock)
+    else:
+        session = Session(events.put, on_message=received.put, _mock=mock)
+
+    # WHEN
+    session.open_queue_sync(
+        QUEUE_NAME,
+        read=True,
+        write=False,
+        consumer_priority=0,
+        max_unconfirmed_messages=0,
+        max_unconfirmed_bytes=0,
+        payload_decoder=capsule,
+    )
+    if pull_messages:
+        for message in session.receive(3, timeout=1):
+            received.put(message)
+
+    # THEN
+    m1 = received.get(timeout=1)
+    m3 = received.get(timeout=1)
+    assert m1.data == b"PAYLOAD1"
+    assert m1.data.readonly
+    assert m3.guid.hex().upper() == "3000000000003039CD8101000000270F"
+    assert m3.data == b"PAYLOAD3"
+    assert received.empty()
+    assert repr(events.get(timeout=1)) == (
+        "<InterfaceError: Rejected the payload of message "
+        "2000000000003039CD8101000000270F received on %s: not lowercase>"
+        % QUEUE_NAME.decode()
+    )
+    mock.confirmMessage.assert_called_once_with(
+        queue_uri=QUEUE_NAME, guid=bytes.fromhex("2000000000003039CD8101000000270F")
+    )
+    del decoder
+
+
+@pytest.mark.parametrize(
+    "make_payload_decoder, message",
+    [
+        (
+            lambda: (object(), None),
+            "PyCapsule_GetPointer called with invalid PyCapsule object",
+        ),
+        (
+            lambda: _make_payload_decoder(version=2),
+            "Unsupported payload decoder version 2, expected 1",
+        ),
+    ],
+)
+def test_open_queue_with_invalid_payload_decoder(make_payload_decoder, message):
+    # GIVEN
+    mock = sdk_mock(start=0, openQueueSync=0, stop=None)
+    session = Session(dummy_callback, on_message=dummy_callback, _mock=mock)
+    payload_decoder, decoder = make_payload_decoder()
+
+    # WHEN
+    with pytest.raises(Exception) as exc:
+        session.open_queue_sync(
+            QUEUE_NAME,
+            read=True,
+            write=False,
+            payload_decoder=payload_decoder,
+        )
+
+    # THEN
+    assert exc.type is ValueError
+    assert exc.match(message)
+    del decoder
@@ -19,6 +19,7 @@ import pytest
 
 from blazingmq import exceptions
 from blazingmq._ext import Session
+from blazingmq._messages import MessageHandle
 from blazingmq._messages import create_message
 
 from .support import QUEUE_NAME
@@ -201,3 +202,173 @@ def test_message_handle_can_confirm():
         queue_uri=QUEUE_NAME,
         guid=b"\x10\x00\x00\x00\x00\x0009\xcd\x81\x01\x00\x00\x00'\x0f",
     )
+
+
+def test_confirm_many_successful():
+    # GIVEN
+    mock = sdk_mock(start=0, openQueueSync=0, confirmMessages=0, stop=None)
+    session = Session(dummy_callback, _mock=mock)
+    for queue_uri in (QUEUE_NAME + b"1", QUEUE_NAME + b"2"):
+        session.open_queue_sync(
+            queue_uri,
+            read=True,
+            write=False,
+            consumer_priority=0,
+            max_unconfirmed_messages=0,
+            max_unconfirmed_bytes=0,
+        )
+    guid = b"\x00\x00\x0f\x00\x07\xd9\xd1z\xd0\xe1\x8c.z\x86\xe1T"
+
+    # WHEN
+    session.confirm_many(
+        [
+            create_message(b"blah", guid, QUEUE_NAME + b"1", {}, {}),
+            create_message(b"blah", guid, (QUEUE_NAME + b"2").decode(), {}, {}),
+            create_message(b"blah", guid, QUEUE_NAME + b"1", {}, {}),
+        ]
+    )
+
+    # THEN
+    mock.confirmMessages.assert_called_once_with(message_count=3)
+
+
+def test_confirm_many_with_no_messages():
+    # GIVEN
+    mock = sdk_mock(start=0, openQueueSync=0, confirmMessages=0, stop=None)
+    session = Session(dummy_callback, _mock=mock)
+
+    # WHEN
+    session.confirm_many(iter([]))
+
+    # THEN
+    mock.confirmMessages.assert_not_called()
+
+
+@pytest.mark.parametrize(
+    "confirm_rc, confirm_error",
+    [(-1, "UNKNOWN"), (-3, "NOT_CONNECTED"), (-5, "NOT_SUPPORTED"), (-8, "NOT_READY")],
+)
+def test_confirm_many_fails_with_error(confirm_rc, confirm_error):
+    # GIVEN
+    mock = sdk_mock(start=0, openQueueSync=0, confirmMessages=confirm_rc, stop=None)
+    session = Session(dummy_callback, _mock=mock)
+    session.open_queue_sync(
+        QUEUE_NAME,
+        read=True,
+        write=False,
+        consumer_priority=0,
+        max_unconfirmed_messages=0,
+        max_unconfirmed_bytes=0,
+    )
+    guid = b"\x00\x00\x0f\x00\x07\xd9\xd1z\xd0\xe1\x8c.z\x86\xe1T"
+
+    # WHEN
+    with pytest.raises(Exception) as exc:
+        session.confirm_many([create_message(b"blah", guid, QUEUE_NAME, {}, {})])
+
+    # THEN
+    assert exc.type is exceptions.Error
+    assert exc.match(
+        rf"^Failed to confirm messages: {confirm_error} \(0 of 1 messages confirmed\)$"
+    )
+
+
+def test_confirm_many_with_invalid_guid():
+    # GIVEN
+    mock = sdk_mock(start=0, openQueueSync=0, confirmMessages=0, stop=None)
+    session = Session(dummy_callback, _mock=mock)
+
+    # WHEN
+    with pytest.raises(Exception) as exc:
+        session.confirm_many(
+            [create_message(b"blah", b"\x00\x00\x0f\x00", QUEUE_NAME, {}, {})]
+        )
+
+    # THEN
+    assert exc.type is exceptions.Error
+    assert exc.match("^Invalid GUID provided$")
+    mock.confirmMessages.assert_not_called()
+
+
+def test_confirm_many_with_invalid_queue():
+    # GIVEN
+    mock = sdk_mock(start=0, openQueueSync=0, confirmMessages=0, stop=None)
+    session = Session(dummy_callback, _mock=mock)
+    guid = b"\x00\x00\x0f\x00\x07\xd9\xd1z\xd0\xe1\x8c.z\x86\xe1T"
+
+    # WHEN
+    with pytest.raises(Exception) as exc:
+        session.confirm_many([create_message(b"blah", guid, QUEUE_NAME, {}, {})])
+
+    # THEN
+    assert exc.type is exceptions.Error
+    assert exc.match(r"^Queue not opened \(0 of 1 messages confirmed\)$")
+    mock.confirmMessages.assert_not_called()
+
+
+def test_confirm_many_with_closing_queue():
+    # GIVEN
+    mock = sdk_mock(
+        start=0, openQueueSync=0, confirmMessages=0, close_on_get=True, stop=None
+    )
+    session = Session(dummy_callback, _mock=mock)
+    session.open_queue_sync(
+        QUEUE_NAME,
+        read=True,
+        write=False,
+        consumer_priority=0,
+        max_unconfirmed_messages=0,
+        max_unconfirmed_bytes=0,
+    )
+    guid = b"\x00\x00\x0f\x00\x07\xd9\xd1z\xd0\xe1\x8c.z\x86\xe1T"
+
+    # WHEN
+    with pytest.raises(Exception) as exc:
+        session.confirm_many([create_message(b"blah", guid, QUEUE_NAME, {}, {})])
+
+    # THEN
+    assert exc.type is exceptions.Error
+    assert exc.match("Attempting to confirm message on a closing queue.")
+    assert exc.match("queue<%s>" % QUEUE_NAME.decode("ascii"))
+    mock.confirmMessages.assert_not_called()
+
+
+def test_message_handles_can_confirm_many():
+    # GIVEN
+    messages = [
+        [
+            (b"data", b"1000000000003039CD8101000000270F", QUEUE_NAME, {}),
+            (b"data", b"2000000000003039CD8101000000270F", QUEUE_NAME, {}),
+        ]
+    ]
+    _mock = sdk_mock(
+        start=0,
+        openQueueSync=0,
+        confirmMessages=0,
+        enqueue_messages=messages,
+        stop=None,
+    )
+    handles = []
+    waiting = threading.Event()
+
+    def on_message(_, msg_handle):
+        handles.append(msg_handle)
+        if len(handles) == 2:
+            MessageHandle.confirm_many(handles)
+            waiting.set()
+
+    session = Session(dummy_callback, on_message=on_message, _mock=_mock)
+
+    # WHEN
+    session.open_queue_sync(
+        QUEUE_NAME,
+        read=True,
+        write=False,
+        consumer_priority=0,
+        max_unconfirmed_messages=0,
+        max_unconfirmed_bytes=0,
+    )
+    waiting.wait()
+
+    # THEN
+    _mock.confirmMessages.assert_called_once_with(message_count=2)
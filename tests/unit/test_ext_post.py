@@ -13,16 +13,22 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
+import array
+import os
 import weakref
 
+import mock as mock_lib
 import pytest
 
 from blazingmq import CompressionAlgorithmType
 from blazingmq import exceptions
 from blazingmq._ext import COMPRESSION_ALGO_FROM_PY_MAPPING as compression_map
+from blazingmq._ext import CompressionPolicy
+from blazingmq._ext import PropertiesTemplate
 from blazingmq._ext import Session
 
 from .support import QUEUE_NAME
+from .support import STRING
 from .support import dummy_callback
 from .support import sdk_mock
 
@@ -81,6 +87,107 @@ def test_post_failure_reference_not_leaked():
     assert not cb_ref()
 
 
+BW_LIMIT = -100
+
+
+def _open_session_for_writing(mock):
+    session = Session(dummy_callback, _mock=mock)
+    session.open_queue_sync(
+        QUEUE_NAME,
+        read=False,
+        write=True,
+        consumer_priority=0,
+        max_unconfirmed_messages=0,
+        max_unconfirmed_bytes=0,
+    )
+    return session
+
+
+def test_post_fails_on_bw_limit_without_block():
+    # GIVEN
+    mock = sdk_mock(start=0, openQueueSync=0, post=BW_LIMIT, stop=None)
+    session = _open_session_for_writing(mock)
+
+    # WHEN
+    with pytest.raises(Exception) as exc:
+        session.post(QUEUE_NAME, b"bladiblah")
+
+    # THEN
+    assert exc.type is exceptions.Error
+    assert exc.match("Failed to post message to .+dummy_queue queue: BW_LIMIT")
+    assert mock.post.call_count == 1
+
+
+def test_blocking_post_retries_until_accepted():
+    # GIVEN
+    mock = sdk_mock(start=0, openQueueSync=0, post=0, stop=None)
+    mock.post.side_effect = [BW_LIMIT, BW_LIMIT, 0]
+    session = _open_session_for_writing(mock)
+
+    # WHEN
+    session.post(QUEUE_NAME, b"bladiblah", block=True, timeout=5.0)
+
+    # THEN
+    assert mock.post.call_count == 3
+
+
+def test_blocking_post_fails_on_timeout():
+    # GIVEN
+    mock = sdk_mock(start=0, openQueueSync=0, post=BW_LIMIT, stop=None)
+    session = _open_session_for_writing(mock)
+
+    def go_on(*args):
+        pass
+
+    cb_ref = weakref.ref(go_on)
+
+    # WHEN
+    with pytest.raises(Exception) as exc:
+        session.post(QUEUE_NAME, b"bladiblah", on_ack=go_on, block=True, timeout=0.05)
+    del go_on
+
+    # THEN
+    assert exc.type is exceptions.Error
+    assert exc.match("Failed to post message to .+dummy_queue queue: BW_LIMIT")
+    assert mock.post.call_count > 1
+    assert not cb_ref()
+
+
+@pytest.mark.parametrize("post_rc, expected", [(0, True), (BW_LIMIT, False)])
+def test_try_post(post_rc, expected):
+    # GIVEN
+    mock = sdk_mock(start=0, openQueueSync=0, post=post_rc, stop=None)
+    session = _open_session_for_writing(mock)
+
+    def go_on(*args):
+        pass
+
+    cb_ref = weakref.ref(go_on)
+
+    # WHEN
+    result = session.try_post(QUEUE_NAME, b"bladiblah", on_ack=go_on)
+    del go_on
+
+    # THEN
+    assert result is expected
+    assert mock.post.call_count == 1
+    assert bool(cb_ref()) is expected
+
+
+def test_try_post_fails_on_other_errors():
+    # GIVEN
+    mock = sdk_mock(start=0, openQueueSync=0, post=-3, stop=None)
+    session = _open_session_for_writing(mock)
+
+    # WHEN
+    with pytest.raises(Exception) as exc:
+        session.try_post(QUEUE_NAME, b"bladiblah")
+
+    # THEN
+    assert exc.type is exceptions.Error
+    assert exc.match("Failed to post message to .+dummy_queue queue: NOT_CONNECTED")
+
+
 def test_post_invalid_queue_reference_not_leaked():
     # GIVEN
     mock = sdk_mock(start=0, openQueueSync=0, post=0, stop=None)
@@ -265,6 +372,237 @@ def test_session_with_valid_compression(compression):
     )
 
 
+
+def _posted_compression_algorithms(mock):
+    return [call[1]["compression_algorithm_type"] for call in mock.post.call_args_list]
+
+
+def test_compression_policy_skips_small_payloads():
+    # GIVEN
+    mock = sdk_mock(start=0, openQueueSync=0, post=0, stop=None)
+    session = Session(dummy_callback, _mock=mock)
+    queue = session.open_queue_sync(
+        QUEUE_NAME,
+        read=False,
+        write=True,
+        compression_policy=CompressionPolicy(
+            CompressionAlgorithmType.ZLIB, 1500, False
+        ),
+    )
+
+    # WHEN
+    queue.post(b"x" * 1499)
+    queue.post(b"x" * 1500)
+    session.post(QUEUE_NAME, b"x" * 2048)
+    session.post_many(
+        QUEUE_NAME, [(b"x" * 1499, None, None), (b"x" * 2048, None, None)]
+    )
+    session.stop()
+
+    # THEN
+    none = compression_map[CompressionAlgorithmType.NONE]
+    zlib = compression_map[CompressionAlgorithmType.ZLIB]
+    assert _posted_compression_algorithms(mock) == [none, zlib, zlib, none, zlib]
+
+
+def test_post_compression_algorithm_overrides_policy():
+    # GIVEN
+    mock = sdk_mock(start=0, openQueueSync=0, post=0, stop=None)
+    session = Session(dummy_callback, _mock=mock)
+    queue = session.open_queue_sync(
+        QUEUE_NAME,
+        read=False,
+        write=True,
+        compression_policy=CompressionPolicy(CompressionAlgorithmType.ZLIB, 0, False),
+    )
+
+    # WHEN
+    queue.post(b"x" * 2048, compression_algorithm=CompressionAlgorithmType.NONE)
+    session.post(
+        QUEUE_NAME, b"x" * 2048, compression_algorithm=CompressionAlgorithmType.NONE
+    )
+    session.try_post(
+        QUEUE_NAME, b"x" * 2048, compression_algorithm=CompressionAlgorithmType.NONE
+    )
+    session.stop()
+
+    # THEN
+    none = compression_map[CompressionAlgorithmType.NONE]
+    assert _posted_compression_algorithms(mock) == [none, none, none]
+
+
+def test_post_compression_algorithm_overrides_session_default():
+    # GIVEN
+    mock = sdk_mock(start=0, openQueueSync=0, post=0, stop=None)
+    session = Session(
+        dummy_callback,
+        message_compression_algorithm=CompressionAlgorithmType.NONE,
+        _mock=mock,
+    )
+    session.open_queue_sync(QUEUE_NAME, read=False, write=True)
+
+    # WHEN
+    session.post(
+        QUEUE_NAME, b"x" * 2048, compression_algorithm=CompressionAlgorithmType.ZLIB
+    )
+    session.stop()
+
+    # THEN
+    zlib = compression_map[CompressionAlgorithmType.ZLIB]
+    assert _posted_compression_algorithms(mock) == [zlib]
+
+
+@pytest.mark.parametrize(
+    "payload, compressed_after_adapting",
+    [(b"x" * 2048, True), (os.urandom(2048), False)],
+)
+def test_adaptive_compression_policy(payload, compressed_after_adapting):
+    # GIVEN
+    mock = sdk_mock(start=0, openQueueSync=0, post=0, stop=None)
+    session = Session(dummy_callback, _mock=mock)
+    queue = session.open_queue_sync(
+        QUEUE_NAME,
+        read=False,
+        write=True,
+        compression_policy=CompressionPolicy(CompressionAlgorithmType.ZLIB, 0, True),
+    )
+
+    # WHEN
+    for _ in range(1100):
+        queue.post(payload)
+    session.stop()
+
+    # THEN
+    none = compression_map[CompressionAlgorithmType.NONE]
+    zlib = compression_map[CompressionAlgorithmType.ZLIB]
+    algorithms = _posted_compression_algorithms(mock)
+    assert algorithms[0] == zlib
+    assert algorithms[-1] == (zlib if compressed_after_adapting else none)
+
+@pytest.mark.parametrize(
+    "payload",
+    [
+        bytearray(b"payload"),
+        memoryview(b"xxpayloadxx")[2:-2],
+        array.array("B", b"payload"),
+    ],
+)
+def test_post_buffer_payload(payload):
+    # GIVEN
+    mock = sdk_mock(start=0, openQueueSync=0, post=0, stop=None)
+    session = Session(dummy_callback, _mock=mock)
+    session.open_queue_sync(
+        QUEUE_NAME,
+        read=False,
+        write=True,
+        consumer_priority=0,
+        max_unconfirmed_messages=0,
+        max_unconfirmed_bytes=0,
+    )
+
+    # WHEN
+    session.post(QUEUE_NAME, payload)
+    session.post_many(QUEUE_NAME, [(payload, None, None)])
+    session.stop()
+
+    # THEN
+    assert mock.post.call_args_list == 2 * [
+        mock_lib.call(
+            payload=b"payload",
+            queue_uri=QUEUE_NAME,
+            properties=({}, {}),
+            compression_algorithm_type=compression_map[CompressionAlgorithmType.NONE],
+        )
+    ]
+
+
+def test_post_releases_buffer_payload():
+    # GIVEN
+    mock = sdk_mock(start=0, openQueueSync=0, post=0, stop=None)
+    session = Session(dummy_callback, _mock=mock)
+    session.open_queue_sync(
+        QUEUE_NAME,
+        read=False,
+        write=True,
+        consumer_priority=0,
+        max_unconfirmed_messages=0,
+        max_unconfirmed_bytes=0,
+    )
+    payload = bytearray(b"payload")
+
+    # WHEN
+    session.post(QUEUE_NAME, payload)
+    session.post_many(QUEUE_NAME, [(payload, None, None)])
+
+    # THEN
+    payload.extend(b" resized")  # raises BufferError if an export is still held
+    assert payload == b"payload resized"
+
+
+def test_post_non_contiguous_payload_fails():
+    # GIVEN
+    mock = sdk_mock(start=0, openQueueSync=0, stop=None)
+    session = Session(dummy_callback, _mock=mock)
+    session.open_queue_sync(
+        QUEUE_NAME,
+        read=False,
+        write=True,
+        consumer_priority=0,
+        max_unconfirmed_messages=0,
+        max_unconfirmed_bytes=0,
+    )
+
+    # WHEN
+    with pytest.raises(Exception) as exc:
+        session.post(QUEUE_NAME, memoryview(b"payload")[::2])
+
+    # THEN
+    assert exc.type is BufferError
+
+
+def test_post_with_properties_template():
+    # GIVEN
+    mock = sdk_mock(start=0, openQueueSync=0, post=0, stop=None)
+    session = Session(dummy_callback, _mock=mock)
+    queue = session.open_queue_sync(
+        QUEUE_NAME,
+        read=False,
+        write=True,
+        consumer_priority=0,
+        max_unconfirmed_messages=0,
+        max_unconfirmed_bytes=0,
+    )
+    template = PropertiesTemplate({b"a": (b"x", STRING), b"b": (b"y", STRING)})
+
+    # WHEN
+    session.post(QUEUE_NAME, b"one", properties_template=template)
+    queue.post(b"two", {b"b": (b"z", STRING)}, properties_template=template)
+    session.post_many(
+        QUEUE_NAME,
+        [(b"three", None, None), (b"four", {b"c": (b"w", STRING)}, None)],
+        properties_template=template,
+    )
+    session.stop()
+
+    # THEN
+    assert [kwargs["properties"][0] for _, kwargs in mock.post.call_args_list] == [
+        {"a": "x", "b": "y"},
+        {"a": "x", "b": "z"},
+        {"a": "x", "b": "y"},
+        {"a": "x", "b": "y", "c": "w"},
+    ]
+
+
+def test_properties_template_with_invalid_property():
+    # GIVEN / WHEN
+    with pytest.raises(Exception) as exc:
+        PropertiesTemplate({b"a": (1, STRING)})
+
+    # THEN
+    assert exc.type is TypeError
+    assert exc.match("'a' value is of the incorrect type")
+
+
 def test_session_with_invalid_compression():
     # GIVEN
     mock = sdk_mock(start=0, openQueueSync=0, post=0, stop=None)
@@ -279,3 +617,183 @@ def test_session_with_invalid_compression():
 
     # THEN
     assert exc.type is KeyError
+
+
+def test_post_many_posts_every_message():
+    # GIVEN
+    mock = sdk_mock(start=0, openQueueSync=0, post=0, stop=None)
+    session = Session(dummy_callback, _mock=mock)
+    session.open_queue_sync(
+        QUEUE_NAME,
+        read=False,
+        write=True,
+        consumer_priority=0,
+        max_unconfirmed_messages=0,
+        max_unconfirmed_bytes=0,
+    )
+
+    # WHEN
+    session.post_many(
+        QUEUE_NAME,
+        [
+            (b"payload1", None, None),
+            (b"payload2", {b"key": (b"value", STRING)}, None),
+            (b"payload3", None, dummy_callback),
+        ],
+    )
+    session.stop()
+
+    # THEN
+    no_properties = ({}, {})
+    assert mock.post.call_args_list == [
+        mock_lib.call(
+            payload=b"payload1",
+            queue_uri=QUEUE_NAME,
+            properties=no_properties,
+            compression_algorithm_type=compression_map[CompressionAlgorithmType.NONE],
+        ),
+        mock_lib.call(
+            payload=b"payload2",
+            queue_uri=QUEUE_NAME,
+            properties=({"key": "value"}, {"key": STRING}),
+            compression_algorithm_type=compression_map[CompressionAlgorithmType.NONE],
+        ),
+        mock_lib.call(
+            payload=b"payload3",
+            queue_uri=QUEUE_NAME,
+            properties=no_properties,
+            compression_algorithm_type=compression_map[CompressionAlgorithmType.NONE],
+        ),
+    ]
+
+
+def test_post_many_with_no_messages():
+    # GIVEN
+    mock = sdk_mock(start=0, openQueueSync=0, post=0, stop=None)
+    session = Session(dummy_callback, _mock=mock)
+    session.open_queue_sync(
+        QUEUE_NAME,
+        read=False,
+        write=True,
+        consumer_priority=0,
+        max_unconfirmed_messages=0,
+        max_unconfirmed_bytes=0,
+    )
+
+    # WHEN
+    session.post_many(QUEUE_NAME, iter([]))
+
+    # THEN
+    mock.post.assert_not_called()
+
+
+def test_post_many_fails_with_error():
+    # GIVEN
+    mock = sdk_mock(start=0, openQueueSync=0, post=-3, stop=None)
+    session = Session(dummy_callback, _mock=mock)
+    session.open_queue_sync(
+        QUEUE_NAME,
+        read=False,
+        write=True,
+        consumer_priority=0,
+        max_unconfirmed_messages=0,
+        max_unconfirmed_bytes=0,
+    )
+
+    def go_on(*args):
+        pass
+
+    cb_ref = weakref.ref(go_on)
+
+    # WHEN
+    with pytest.raises(Exception) as exc:
+        session.post_many(
+            QUEUE_NAME, [(b"payload1", None, go_on), (b"payload2", None, go_on)]
+        )
+    del go_on
+
+    # THEN
+    assert exc.type is exceptions.Error
+    assert exc.match(
+        "Failed to post message to .+dummy_queue queue: NOT_CONNECTED"
+        r" \(0 of 2 messages posted\)"
+    )
+    assert not cb_ref()
+
+
+def test_post_many_invalid_queue_reference_not_leaked():
+    # GIVEN
+    mock = sdk_mock(start=0, openQueueSync=0, post=0, stop=None)
+    session = Session(dummy_callback, _mock=mock)
+
+    def go_on(*args):
+        pass
+
+    cb_ref = weakref.ref(go_on)
+
+    # WHEN
+    with pytest.raises(Exception) as exc:
+        session.post_many(QUEUE_NAME, [(b"payload", None, go_on)])
+    del go_on
+
+    # THEN
+    assert exc.type is exceptions.Error
+    assert exc.match("^Queue not opened")
+    assert not cb_ref()
+
+
+@pytest.mark.parametrize(
+    "message, expected_error",
+    [
+        ((b"payload", None), "each message must be a"),
+        ([b"payload", None, None], "each message must be a"),
+        (
+            ("payload", None, None),
+            "message payload must be a bytes-like object, not 'str'",
+        ),
+    ],
+)
+def test_post_many_with_invalid_message(message, expected_error):
+    # GIVEN
+    mock = sdk_mock(start=0, openQueueSync=0, post=0, stop=None)
+    session = Session(dummy_callback, _mock=mock)
+    session.open_queue_sync(
+        QUEUE_NAME,
+        read=False,
+        write=True,
+        consumer_priority=0,
+        max_unconfirmed_messages=0,
+        max_unconfirmed_bytes=0,
+    )
+
+    # WHEN
+    with pytest.raises(Exception) as exc:
+        session.post_many(QUEUE_NAME, [(b"valid", None, None), message])
+
+    # THEN
+    assert exc.type is TypeError
+    assert exc.match(expected_error)
+    mock.post.assert_not_called()
+
+
+def test_post_many_with_invalid_properties():
+    # GIVEN
+    mock = sdk_mock(start=0, openQueueSync=0, post=0, stop=None)
+    session = Session(dummy_callback, _mock=mock)
+    session.open_queue_sync(
+        QUEUE_NAME,
+        read=False,
+        write=True,
+        consumer_priority=0,
+        max_unconfirmed_messages=0,
+        max_unconfirmed_bytes=0,
+    )
+
+    # WHEN
+    with pytest.raises(Exception) as exc:
+        session.post_many(QUEUE_NAME, [(b"payload", {b"the_key": []}, None)])
+
+    # THEN
+    assert exc.type is TypeError
+    assert exc.match("'the_key' value is not a tuple.")
+    mock.post.assert_not_called()
@@ -13,12 +13,20 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
+import re
+
+import mock as mock_lib
 import pytest
 
+from blazingmq import CompressionAlgorithmType
 from blazingmq import exceptions
+from blazingmq._ext import COMPRESSION_ALGO_FROM_PY_MAPPING as compression_map
+from blazingmq._ext import Queue
 from blazingmq._ext import Session
+from blazingmq._messages import create_message
 
 from .support import QUEUE_NAME
+from .support import STRING
 from .support import dummy_callback
 from .support import sdk_mock
 
@@ -51,6 +59,7 @@ def test_open_flags_are_correct(read, write, flags):
             "max_unconfirmed_bytes": 0,
             "max_unconfirmed_messages": 0,
             "suspends_on_bad_host_health": False,
+            "subscriptions": [],
         },
         timeout=0,
     )
@@ -81,6 +90,7 @@ def test_open_timeout_propagated():
             "max_unconfirmed_bytes": 0,
             "max_unconfirmed_messages": 0,
             "suspends_on_bad_host_health": False,
+            "subscriptions": [],
         },
         timeout=123,
     )
@@ -134,11 +144,45 @@ def test_open_options_are_correctly_propagated():
             "max_unconfirmed_messages": 2,
             "max_unconfirmed_bytes": 3,
             "suspends_on_bad_host_health": True,
+            "subscriptions": [],
         },
         timeout=0,
     )
 
 
+def test_open_subscriptions_are_correctly_propagated():
+    # GIVEN
+    mock = sdk_mock(start=0, openQueueSync=0, stop=None)
+    session = Session(dummy_callback, _mock=mock)
+
+    # WHEN
+    session.open_queue_sync(
+        QUEUE_NAME,
+        read=True,
+        write=False,
+        subscriptions=[(b"price > 25", 2, 10, None)],
+    )
+
+    # THEN
+    _, kwargs = mock.openQueueSync.call_args
+    assert kwargs["options"]["subscriptions"] == [(b"price > 25", 2, 10, None)]
+
+
+def test_open_rejects_malformed_subscriptions():
+    # GIVEN
+    mock = sdk_mock(start=0, stop=None)
+    session = Session(dummy_callback, _mock=mock)
+
+    # WHEN
+    with pytest.raises(Exception) as exc:
+        session.open_queue_sync(
+            QUEUE_NAME, read=True, write=False, subscriptions=[(b"price > 25",)]
+        )
+
+    # THEN
+    assert exc.type is TypeError
+
+
 def test_open_fails_with_timeout():
     # GIVEN
     mock = sdk_mock(start=0, openQueueSync=-2, stop=None)
@@ -277,6 +321,7 @@ def test_configure_arguments_propagate():
             "max_unconfirmed_messages": 2,
             "max_unconfirmed_bytes": 3,
             "suspends_on_bad_host_health": True,
+            "subscriptions": [],
         },
         timeout=0.0,
     )
@@ -312,6 +357,7 @@ def test_configure_timeout_propagates():
             "max_unconfirmed_messages": 2,
             "max_unconfirmed_bytes": 3,
             "suspends_on_bad_host_health": False,
+            "subscriptions": [],
         },
         timeout=1.0,
     )
@@ -344,3 +390,340 @@ def test_configure_fails_with_timeout():
     assert exc.match(
         "Failed to configure .+dummy_queue queue: TIMEOUT: the_error_string"
     )
+
+
+def test_open_returns_queue_handle_that_posts():
+    # GIVEN
+    mock = sdk_mock(start=0, openQueueSync=0, post=0, stop=None)
+    session = Session(dummy_callback, _mock=mock)
+
+    # WHEN
+    queue = session.open_queue_sync(
+        QUEUE_NAME,
+        read=False,
+        write=True,
+        consumer_priority=0,
+        max_unconfirmed_messages=0,
+        max_unconfirmed_bytes=0,
+    )
+    queue.post(b"payload", {b"key": (b"value", STRING)})
+
+    # THEN
+    assert queue.uri == QUEUE_NAME
+    mock.post.assert_called_once_with(
+        payload=b"payload",
+        queue_uri=QUEUE_NAME,
+        properties=({"key": "value"}, {"key": STRING}),
+        compression_algorithm_type=compression_map[CompressionAlgorithmType.NONE],
+    )
+
+
+def test_queue_handle_confirms():
+    # GIVEN
+    mock = sdk_mock(start=0, openQueueSync=0, confirmMessage=0, stop=None)
+    session = Session(dummy_callback, _mock=mock)
+    queue = session.open_queue_sync(
+        QUEUE_NAME,
+        read=True,
+        write=False,
+        consumer_priority=0,
+        max_unconfirmed_messages=0,
+        max_unconfirmed_bytes=0,
+    )
+    guid = b"\x00\x00\x0f\x00\x07\xd9\xd1z\xd0\xe1\x8c.z\x86\xe1T"
+
+    # WHEN
+    queue.confirm(create_message(b"blah", guid, QUEUE_NAME, {}, {}))
+
+    # THEN
+    mock.confirmMessage.assert_called_once_with(queue_uri=QUEUE_NAME, guid=guid)
+
+
+def test_queue_handle_rejects_message_from_another_queue():
+    # GIVEN
+    mock = sdk_mock(start=0, openQueueSync=0, confirmMessage=0, stop=None)
+    session = Session(dummy_callback, _mock=mock)
+    queue = session.open_queue_sync(
+        QUEUE_NAME,
+        read=True,
+        write=False,
+        consumer_priority=0,
+        max_unconfirmed_messages=0,
+        max_unconfirmed_bytes=0,
+    )
+    other_queue = QUEUE_NAME + b"_other"
+    guid = b"\x00\x00\x0f\x00\x07\xd9\xd1z\xd0\xe1\x8c.z\x86\xe1T"
+
+    # WHEN
+    with pytest.raises(Exception) as confirm_exc:
+        queue.confirm(create_message(b"blah", guid, other_queue, {}, {}))
+
+    # THEN
+    assert confirm_exc.type is exceptions.Error
+    assert confirm_exc.match("^Message from queue .+ cannot be confirmed on queue")
+    mock.confirmMessage.assert_not_called()
+
+
+def test_queue_handle_invalidated_by_close():
+    # GIVEN
+    mock = sdk_mock(start=0, openQueueSync=0, closeQueueSync=0, post=0, stop=None)
+    session = Session(dummy_callback, _mock=mock)
+    queue = session.open_queue_sync(
+        QUEUE_NAME,
+        read=False,
+        write=True,
+        consumer_priority=0,
+        max_unconfirmed_messages=0,
+        max_unconfirmed_bytes=0,
+    )
+
+    # WHEN
+    session.close_queue_sync(QUEUE_NAME)
+    with pytest.raises(Exception) as post_exc:
+        queue.post(b"payload")
+    with pytest.raises(Exception) as confirm_exc:
+        queue.confirm(create_message(b"blah", b"guid", QUEUE_NAME, {}, {}))
+
+    # THEN
+    assert post_exc.type is exceptions.Error
+    assert post_exc.match("^Queue .+ is no longer open$")
+    assert confirm_exc.type is exceptions.Error
+    assert confirm_exc.match("^Queue .+ is no longer open$")
+    assert repr(queue).endswith(" (closed)>")
+    mock.post.assert_not_called()
+
+
+def test_queue_handle_not_revived_by_reopen():
+    # GIVEN
+    mock = sdk_mock(start=0, openQueueSync=0, closeQueueSync=0, post=0, stop=None)
+    session = Session(dummy_callback, _mock=mock)
+    open_args = dict(
+        read=False,
+        write=True,
+        consumer_priority=0,
+        max_unconfirmed_messages=0,
+        max_unconfirmed_bytes=0,
+    )
+    old_queue = session.open_queue_sync(QUEUE_NAME, **open_args)
+    session.close_queue_sync(QUEUE_NAME)
+
+    # WHEN
+    new_queue = session.open_queue_sync(QUEUE_NAME, **open_args)
+    new_queue.post(b"payload")
+
+    # THEN
+    with pytest.raises(exceptions.Error):
+        old_queue.post(b"payload")
+    mock.post.assert_called_once()
+
+
+def test_queue_handle_has_no_public_constructor():
+    # GIVEN / WHEN
+    with pytest.raises(Exception) as exc:
+        Queue()
+
+    # THEN
+    assert exc.type is exceptions.Error
+    assert exc.match("^The Queue class does not have a public constructor.")
+
+
+def test_open_async_completes_with_queue_handle():
+    # GIVEN
+    mock = sdk_mock(start=0, openQueueAsync=0, post=0, stop=None)
+    session = Session(dummy_callback, _mock=mock)
+    on_complete = mock_lib.MagicMock()
+
+    # WHEN
+    session.open_queue_async(
+        QUEUE_NAME,
+        read=False,
+        write=True,
+        consumer_priority=0,
+        max_unconfirmed_messages=0,
+        max_unconfirmed_bytes=0,
+        timeout=123,
+        on_complete=on_complete,
+    )
+
+    # THEN
+    mock.openQueueAsync.assert_called_once_with(
+        uri=QUEUE_NAME,
+        flags=4,
+        options={
+            "consumer_priority": 0,
+            "max_unconfirmed_bytes": 0,
+            "max_unconfirmed_messages": 0,
+            "suspends_on_bad_host_health": False,
+            "subscriptions": [],
+        },
+        timeout=123,
+    )
+    on_complete.assert_called_once()
+    (queue, error), _ = on_complete.call_args
+    assert error is None
+    assert queue.uri == QUEUE_NAME
+    queue.post(b"payload")
+    mock.post.assert_called_once()
+
+
+@pytest.mark.parametrize(
+    "open_rc, open_error, error_type",
+    [
+        (-1, "UNKNOWN", exceptions.Error),
+        (-2, "TIMEOUT", exceptions.BrokerTimeoutError),
+        (-3, "NOT_CONNECTED", exceptions.Error),
+    ],
+)
+def test_open_async_completes_with_error(open_rc, open_error, error_type):
+    # GIVEN
+    mock = sdk_mock(start=0, openQueueAsync=open_rc, stop=None)
+    session = Session(dummy_callback, _mock=mock)
+    on_complete = mock_lib.MagicMock()
+
+    # WHEN
+    session.open_queue_async(
+        QUEUE_NAME,
+        read=True,
+        write=False,
+        on_complete=on_complete,
+    )
+
+    # THEN
+    on_complete.assert_called_once()
+    (queue, error), _ = on_complete.call_args
+    assert queue is None
+    assert type(error) is error_type
+    assert re.match(
+        f"Failed to open .+dummy_queue queue: {open_error}: the_error_string",
+        str(error),
+    )
+
+
+def test_open_queues_returns_queue_handles_in_order():
+    # GIVEN
+    mock = sdk_mock(start=0, openQueueAsync=0, stop=None)
+    session = Session(dummy_callback, _mock=mock)
+    other_queue_name = QUEUE_NAME + b"_2"
+
+    # WHEN
+    results = session.open_queues(
+        [QUEUE_NAME, other_queue_name],
+        read=False,
+        write=True,
+        max_in_flight=1,
+    )
+
+    # THEN
+    assert mock.openQueueAsync.call_count == 2
+    assert [type(queue) for queue in results] == [Queue, Queue]
+    assert [queue.uri for queue in results] == [QUEUE_NAME, other_queue_name]
+
+
+@pytest.mark.parametrize(
+    "open_rc, open_error, error_type",
+    [
+        (-1, "UNKNOWN", exceptions.Error),
+        (-2, "TIMEOUT", exceptions.BrokerTimeoutError),
+    ],
+)
+def test_open_queues_returns_each_error(open_rc, open_error, error_type):
+    # GIVEN
+    mock = sdk_mock(start=0, openQueueAsync=open_rc, stop=None)
+    session = Session(dummy_callback, _mock=mock)
+
+    # WHEN
+    results = session.open_queues(
+        [QUEUE_NAME, QUEUE_NAME], read=True, write=False, max_in_flight=8
+    )
+
+    # THEN
+    assert len(results) == 2
+    for error in results:
+        assert type(error) is error_type
+        assert re.match(
+            f"Failed to open .+dummy_queue queue: {open_error}: the_error_string",
+            str(error),
+        )
+
+
+def test_configure_async_completes():
+    # GIVEN
+    mock = sdk_mock(start=0, openQueueSync=0, configureQueueAsync=0, stop=None)
+    session = Session(dummy_callback, _mock=mock)
+    session.open_queue_sync(QUEUE_NAME, read=True, write=False)
+    on_complete = mock_lib.MagicMock()
+
+    # WHEN
+    session.configure_queue_async(
+        QUEUE_NAME,
+        consumer_priority=2,
+        max_unconfirmed_messages=3,
+        max_unconfirmed_bytes=4,
+        timeout=123,
+        on_complete=on_complete,
+    )
+
+    # THEN
+    mock.configureQueueAsync.assert_called_once_with(
+        options={
+            "consumer_priority": 2,
+            "max_unconfirmed_bytes": 4,
+            "max_unconfirmed_messages": 3,
+            "suspends_on_bad_host_health": False,
+            "subscriptions": [],
+        },
+        timeout=123,
+    )
+    on_complete.assert_called_once_with(None, None)
+
+
+def test_close_async_invalidates_queue_handle():
+    # GIVEN
+    mock = sdk_mock(start=0, openQueueSync=0, closeQueueAsync=0, post=0, stop=None)
+    session = Session(dummy_callback, _mock=mock)
+    queue = session.open_queue_sync(QUEUE_NAME, read=False, write=True)
+    on_complete = mock_lib.MagicMock()
+
+    # WHEN
+    session.close_queue_async(QUEUE_NAME, timeout=123, on_complete=on_complete)
+
+    # THEN
+    mock.closeQueueAsync.assert_called_once_with(timeout=123)
+    on_complete.assert_called_once_with(None, None)
+    with pytest.raises(exceptions.Error):
+        queue.post(b"payload")
+
+
+def test_close_async_completes_with_error():
+    # GIVEN
+    mock = sdk_mock(start=0, openQueueSync=0, closeQueueAsync=-1, post=0, stop=None)
+    session = Session(dummy_callback, _mock=mock)
+    queue = session.open_queue_sync(QUEUE_NAME, read=False, write=True)
+    on_complete = mock_lib.MagicMock()
+
+    # WHEN
+    session.close_queue_async(QUEUE_NAME, on_complete=on_complete)
+
+    # THEN
+    on_complete.assert_called_once()
+    (result, error), _ = on_complete.call_args
+    assert result is None
+    assert type(error) is exceptions.Error
+    assert re.match("Failed to close .+dummy_queue queue: UNKNOWN", str(error))
+    queue.post(b"payload")
+
+
+def test_configure_async_before_open_fails():
+    # GIVEN
+    mock = sdk_mock(start=0, stop=None)
+    session = Session(dummy_callback, _mock=mock)
+    on_complete = mock_lib.MagicMock()
+
+    # WHEN
+    with pytest.raises(Exception) as exc:
+        session.configure_queue_async(QUEUE_NAME, on_complete=on_complete)
+
+    # THEN
+    assert exc.type is exceptions.Error
+    assert exc.match("^Queue not opened$")
+    on_complete.assert_not_called()
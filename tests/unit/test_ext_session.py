@@ -16,15 +16,20 @@
 import os
 import queue
 import sys
+import threading
+import time
 import weakref
 
 import pytest
 
 from blazingmq import Timeouts
 from blazingmq import exceptions
+from blazingmq import AckStatus
+from blazingmq._ext import LoopbackBroker
 from blazingmq._ext import Session
 from blazingmq._ext import ensure_stop_session
 from blazingmq.session_events import InterfaceError
+from blazingmq.session_events import SlowCallback
 
 from .support import QUEUE_NAME
 from .support import dummy_callback
@@ -117,6 +122,46 @@ def test_stopped_session_not_stopped_on_dealloc():
     mock.stop.assert_called_once_with()
 
 
+def test_concurrent_posts_race_stop():
+    # GIVEN
+    mock = sdk_mock(start=0, openQueueSync=0, post=0, stop=None)
+    session = Session(dummy_callback, _mock=mock)
+    session.open_queue_sync(
+        QUEUE_NAME,
+        read=False,
+        write=True,
+        consumer_priority=0,
+        max_unconfirmed_messages=0,
+        max_unconfirmed_bytes=0,
+    )
+    posting = threading.Barrier(5)
+    errors = queue.Queue()
+
+    def post_until_stopped():
+        posting.wait()
+        while True:
+            try:
+                session.post(QUEUE_NAME, b"payload")
+            except exceptions.Error as exc:
+                errors.put(exc)
+                return
+
+    threads = [threading.Thread(target=post_until_stopped) for _ in range(4)]
+    for thread in threads:
+        thread.start()
+
+    # WHEN
+    posting.wait()
+    session.stop()
+    for thread in threads:
+        thread.join()
+
+    # THEN
+    mock.stop.assert_called_once_with()
+    for _ in threads:
+        assert str(errors.get_nowait()) == "Method called after session was stopped"
+
+
 def test_start_connect_timeout():
     # GIVEN
     mock = sdk_mock(start=0, stop=None)
@@ -349,3 +394,141 @@ def test_message_handle_keeps_session_alive():
     assert session_wr() is not None
     del msg_handle
     assert session_wr() is None
+
+
+def test_dispatch_threads_deliver_messages_in_order():
+    # GIVEN
+    messages = [
+        [
+            (b"data1", b"1000000000003039CD8101000000270F", QUEUE_NAME, {}, {}),
+            (b"data2", b"1000000000003039CD8101000000271F", QUEUE_NAME, {}, {}),
+        ],
+        [(b"data3", b"1000000000003039CD8101000000272F", QUEUE_NAME, {}, {})],
+    ]
+    _mock = sdk_mock(start=0, openQueueSync=0, enqueue_messages=messages, stop=None)
+    received = queue.Queue()
+    session = Session(
+        dummy_callback,
+        on_message=lambda msg, msg_handle: received.put(
+            (msg.data, threading.get_ident())
+        ),
+        num_dispatch_threads=2,
+        _mock=_mock,
+    )
+
+    # WHEN
+    session.open_queue_sync(
+        QUEUE_NAME,
+        read=True,
+        write=False,
+        consumer_priority=0,
+        max_unconfirmed_messages=0,
+        max_unconfirmed_bytes=0,
+    )
+    session.stop()
+
+    # THEN
+    delivered = [received.get_nowait() for _ in range(3)]
+    assert [data for data, _ in delivered] == [b"data1", b"data2", b"data3"]
+    assert threading.get_ident() not in {thread for _, thread in delivered}
+
+
+def test_loopback_broker_acks_and_delivers_posted_messages():
+    # GIVEN
+    received = queue.Queue()
+    acks = queue.Queue()
+    session = Session(
+        dummy_callback,
+        on_message=lambda msg, msg_handle: received.put(msg),
+        loopback=LoopbackBroker(latency=0.0, batch_size=2, nack_ratio=0.0),
+    )
+    session.open_queue_sync(QUEUE_NAME, read=True, write=True)
+
+    # WHEN
+    for payload in (b"data1", b"data2", b"data3"):
+        session.post(QUEUE_NAME, payload, on_ack=acks.put)
+    delivered = [received.get(timeout=5) for _ in range(3)]
+    acked = [acks.get(timeout=5) for _ in range(3)]
+    session.stop()
+
+    # THEN
+    assert [msg.data for msg in delivered] == [b"data1", b"data2", b"data3"]
+    assert all(ack.status == AckStatus.SUCCESS for ack in acked)
+    assert [ack.guid for ack in acked] == [msg.guid for msg in delivered]
+    assert len({msg.guid for msg in delivered}) == 3
+
+
+def test_loopback_broker_rejects_nack_ratio_of_messages():
+    # GIVEN
+    received = queue.Queue()
+    acks = queue.Queue()
+    session = Session(
+        dummy_callback,
+        on_message=lambda msg, msg_handle: received.put(msg),
+        loopback=LoopbackBroker(latency=0.0, batch_size=16, nack_ratio=0.5),
+    )
+    session.open_queue_sync(QUEUE_NAME, read=True, write=True)
+
+    # WHEN
+    for payload in (b"data1", b"data2", b"data3", b"data4"):
+        session.post(QUEUE_NAME, payload, on_ack=acks.put)
+    statuses = [acks.get(timeout=5).status for _ in range(4)]
+    delivered = [received.get(timeout=5).data for _ in range(2)]
+    session.stop()
+
+    # THEN
+    assert statuses == [
+        AckStatus.SUCCESS,
+        AckStatus.REFUSED,
+        AckStatus.SUCCESS,
+        AckStatus.REFUSED,
+    ]
+    assert delivered == [b"data1", b"data3"]
+    assert received.empty()
+
+
+def test_loopback_broker_cancels_messages_held_at_stop():
+    # GIVEN
+    acks = queue.Queue()
+    session = Session(
+        dummy_callback,
+        loopback=LoopbackBroker(latency=60.0, batch_size=16, nack_ratio=0.0),
+    )
+    session.open_queue_sync(QUEUE_NAME, read=False, write=True)
+    session.post(QUEUE_NAME, b"data", on_ack=acks.put)
+
+    # WHEN
+    session.stop()
+
+    # THEN
+    assert acks.get(timeout=5).status == AckStatus.CANCELED
+
+
+def test_slow_callback_is_timed_and_reported():
+    # GIVEN
+    slow_callbacks = queue.Queue()
+
+    def on_session_event(event):
+        if isinstance(event, SlowCallback):
+            slow_callbacks.put(event)
+
+    session = Session(
+        on_session_event,
+        on_message=lambda msg, msg_handle: time.sleep(0.05),
+        time_callbacks=True,
+        slow_callback_threshold=0.01,
+        loopback=LoopbackBroker(latency=0.0, batch_size=16, nack_ratio=0.0),
+    )
+    session.open_queue_sync(QUEUE_NAME, read=True, write=True)
+
+    # WHEN
+    session.post(QUEUE_NAME, b"data")
+    event = slow_callbacks.get(timeout=5)
+    timing = session.stats()["callback_timing"]
+    session.stop()
+
+    # THEN
+    assert repr(event).startswith("<SlowCallback: on_message took ")
+    assert timing["callback"]["count"] >= 1
+    assert timing["callback"]["sum"] >= 0.05
+    assert set(timing) == {"gil_wait", "conversion", "callback"}
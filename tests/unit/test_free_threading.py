@@ -0,0 +1,48 @@
+# Copyright 2019-2023 Bloomberg Finance L.P.
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import os
+import subprocess
+import sys
+import sysconfig
+import textwrap
+
+import pytest
+
+
+@pytest.mark.skipif(
+    not sysconfig.get_config_var("Py_GIL_DISABLED"),
+    reason="requires a free-threaded Python build",
+)
+def test_importing_extension_keeps_gil_disabled():
+    # GIVEN
+    program = textwrap.dedent(
+        """
+        import sys
+        import blazingmq
+        print(sys._is_gil_enabled())
+        """
+    )
+
+    env = os.environ.copy()
+    env.pop("PYTHON_GIL", None)
+
+    # WHEN
+    output = subprocess.check_output(
+        [sys.executable, "-W", "error::RuntimeWarning", "-c", program], env=env
+    )
+
+    # THEN
+    assert output.strip() == b"False"
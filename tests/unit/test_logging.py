@@ -0,0 +1,40 @@
+# Copyright 2019-2023 Bloomberg Finance L.P.
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import logging
+
+from blazingmq import set_sdk_log_level
+
+from .support import mock
+
+
+def test_set_sdk_log_level_for_category():
+    # GIVEN
+    with mock.patch("blazingmq._logging._ext") as ext:
+        # WHEN
+        set_sdk_log_level(logging.WARNING, "BMQIMPL")
+
+    # THEN
+    ext.set_sdk_log_level.assert_called_once_with(b"BMQIMPL", logging.WARNING)
+
+
+def test_set_sdk_log_level_for_every_category():
+    # GIVEN
+    with mock.patch("blazingmq._logging._ext") as ext:
+        # WHEN
+        set_sdk_log_level(logging.ERROR)
+
+    # THEN
+    ext.set_sdk_log_level.assert_called_once_with(b"", logging.ERROR)
@@ -20,6 +20,7 @@ import pytest
 import blazingmq
 from blazingmq import _callbacks
 from blazingmq._messages import create_ack
+from blazingmq._messages import create_lazy_properties
 from blazingmq._messages import create_message
 from blazingmq._messages import create_message_handle
 
@@ -44,6 +45,65 @@ def test_create_message():
     assert m.property_types["foo"] == property_types["foo"]
 
 
+def test_create_message_data_buffers():
+    # GIVEN
+    data = b"bytes"
+
+    # WHEN
+    m = create_message(data, b"guid", "bmq://foo/bar", {}, {})
+
+    # THEN
+    assert len(m.data_buffers) == 1
+    assert m.data_buffers[0] == data
+    assert m.data_buffers is m.data_buffers
+
+
+def test_create_message_from_data_buffers_flattens_lazily():
+    # GIVEN
+    buffers = [memoryview(b"by"), memoryview(b"tes")]
+
+    # WHEN
+    m = create_message(None, b"guid", "bmq://foo/bar", {}, {}, buffers)
+
+    # THEN
+    assert m.data_buffers is buffers
+    assert isinstance(m.data, memoryview)
+    assert m.data.readonly
+    assert m.data == b"bytes"
+    assert m.data is m.data
+
+
+def test_create_message_without_payload():
+    # GIVEN
+    # WHEN
+    with pytest.raises(Exception) as exc:
+        create_message(None, b"guid", "bmq://foo/bar", {}, {})
+
+    # THEN
+    assert exc.type is ValueError
+    assert exc.match("either data or data_buffers must be provided")
+
+
+def test_message_attributes_are_settable():
+    # GIVEN
+    m = create_message(b"bytes", b"guid", "bmq://foo/bar", {}, {})
+    ack = create_ack(b"guid", blazingmq.AckStatus.SUCCESS, "SUCCESS", "bmq://foo/bar")
+
+    # WHEN
+    m.guid = b"other"
+    m.data = b"payload"
+    m.extra = 1
+    ack.guid = None
+
+    # THEN
+    assert m.guid == b"other"
+    assert m.data == b"payload"
+    assert [bytes(b) for b in m.data_buffers] == [b"payload"]
+    assert m.extra == 1
+    assert ack.guid is None
+    assert ack._status_description == "SUCCESS"
+
+
 def test_construct_message():
     # GIVEN
     # WHEN
@@ -148,21 +208,91 @@ def test_message_received_in_callback():
         pass
 
     ext_session = FakeSession()
-    raw = (b"data", b"guid", b"queue_uri", ({}, {}))
+    message = create_message(b"data", b"guid", "queue_uri", {}, {})
 
     # WHEN
-    _callbacks.on_message(spy, weakref.ref(ext_session), {}, [raw])
+    _callbacks.on_message(
+        spy, weakref.ref(ext_session), create_message_handle, [message]
+    )
 
     # THEN
     spy.assert_called_once()
     args, kwargs = spy.call_args
     assert not kwargs
     (msg, msg_handle) = args
-    assert isinstance(msg, blazingmq.Message)
+    assert msg is message
     assert isinstance(msg_handle, blazingmq.MessageHandle)
-    assert msg.data == raw[0]
-    assert msg.guid == raw[1]
-    assert msg.queue_uri == raw[2].decode("utf-8")
+    assert repr(msg_handle) == "<MessageHandle[67756964] for queue_uri>"
+
+
+def test_create_lazy_properties():
+    # GIVEN
+    native = mock.MagicMock()
+    native.mock_add_spec(["types", "get"])
+    native.types.return_value = {"foo": 5, "bar": 3}
+    native.get.side_effect = lambda name: {"foo": "x", "bar": 7}[name]
+    property_type_to_py = {
+        5: blazingmq.PropertyType.STRING,
+        3: blazingmq.PropertyType.INT32,
+    }
+
+    # WHEN
+    properties, property_types = create_lazy_properties(property_type_to_py, native)
+
+    # THEN
+    native.types.assert_not_called()
+    native.get.assert_not_called()
+    assert properties["foo"] == "x"
+    assert properties["foo"] == "x"
+    native.get.assert_called_once_with("foo")
+    assert len(properties) == 2
+    assert repr(properties) == "{'foo': 'x', 'bar': 7}"
+    assert property_types["bar"] is blazingmq.PropertyType.INT32
+    assert repr(property_types) == (
+        "{'foo': <PropertyType.STRING>, 'bar': <PropertyType.INT32>}"
+    )
+    native.types.assert_called_once_with()
+
+
+def test_ack_received_in_callback():
+    # GIVEN
+    spy = mock.MagicMock()
+    ack = create_ack(b"guid", blazingmq.AckStatus.SUCCESS, "SUCCESS", "queue_uri")
+
+    # WHEN
+    _callbacks.on_ack([(ack, spy)])
+
+    # THEN
+    spy.assert_called_once_with(ack)
+
+
+def test_numbered_acks_received_in_callback():
+    # GIVEN
+    spy = mock.MagicMock()
+    mapping = {0: blazingmq.AckStatus.SUCCESS}
+
+    # WHEN
+    _callbacks.on_acks(spy, mapping, [1, 2], [0, -12345])
+
+    # THEN
+    spy.assert_called_once_with(
+        [1, 2], [blazingmq.AckStatus.SUCCESS, blazingmq.AckStatus.UNRECOGNIZED]
+    )
+
+
+def test_numbered_acks_without_callback_emit_interface_error():
+    # GIVEN
+    spy = mock.MagicMock()
+
+    # WHEN
+    _callbacks.on_acks_create_interface_error(spy, [1], [0])
+
+    # THEN
+    spy.assert_called_once_with(
+        blazingmq.session_events.InterfaceError(
+            "Acks received but no on_acks callback configured"
+        )
+    )
 
 
 def test_construct_message_handle():
@@ -200,3 +330,27 @@ def test_call_confirm_on_message_handle():
 
     # THEN
     ext_session.confirm.assert_called_with(message)
+
+
+def test_call_confirm_many_on_message_handles():
+    # GIVEN
+    messages = [
+        create_message(b"bytes", b"guid%d" % i, QUEUE_NAME.decode("utf-8"), {}, {})
+        for i in range(3)
+    ]
+    ext_session1 = mock.MagicMock()
+    ext_session1.mock_add_spec(["confirm_many"])
+    ext_session2 = mock.MagicMock()
+    ext_session2.mock_add_spec(["confirm_many"])
+    msg_handles = [
+        create_message_handle(messages[0], ext_session1),
+        create_message_handle(messages[1], ext_session2),
+        create_message_handle(messages[2], ext_session1),
+    ]
+
+    # WHEN
+    blazingmq.MessageHandle.confirm_many(msg_handles)
+
+    # THEN
+    ext_session1.confirm_many.assert_called_once_with([messages[0], messages[2]])
+    ext_session2.confirm_many.assert_called_once_with([messages[1]])
@@ -51,6 +51,7 @@ def test_queue_options_default_to_none():
     assert options.max_unconfirmed_bytes is None
     assert options.max_unconfirmed_messages is None
     assert options.suspends_on_bad_host_health is None
+    assert options.subscriptions is None
 
 
 def test_queue_options_equality():
@@ -73,6 +74,7 @@ def test_queue_options_equality():
         blazingmq.QueueOptions(max_unconfirmed_messages=1),
         blazingmq.QueueOptions(max_unconfirmed_bytes=1),
         blazingmq.QueueOptions(consumer_priority=1),
+        blazingmq.QueueOptions(subscriptions=[]),
     ],
 )
 def test_queue_options_other_inequality(right):
@@ -81,3 +83,43 @@ def test_queue_options_other_inequality(right):
 
     # THEN
     assert not left == right
+
+
+def test_queue_options_with_subscriptions_repr():
+    # WHEN
+    options = blazingmq.QueueOptions(
+        subscriptions=(
+            blazingmq.Subscription("price > 25"),
+            blazingmq.Subscription(
+                "firmId == 1234",
+                max_unconfirmed_messages=10,
+                max_unconfirmed_bytes=1024,
+                consumer_priority=2,
+            ),
+        )
+    )
+
+    # THEN
+    assert (
+        "QueueOptions(subscriptions=["
+        "Subscription('price > 25'),"
+        " Subscription('firmId == 1234',"
+        " max_unconfirmed_messages=10,"
+        " max_unconfirmed_bytes=1024,"
+        " consumer_priority=2)])" == repr(options)
+    )
+
+
+def test_subscription_equality():
+    # GIVEN
+    left = blazingmq.Subscription("price > 25", consumer_priority=2)
+
+    # WHEN
+    right = blazingmq.Subscription("price > 25", consumer_priority=2)
+
+    # THEN
+    assert left == right
+    assert (left != right) is False
+    assert left != blazingmq.Subscription("price > 25")
+    assert left != blazingmq.Subscription("price > 26", consumer_priority=2)
+    assert left != "price > 25"
@@ -17,17 +17,24 @@ import re
 
 import pytest
 
+from blazingmq import AdaptiveFlowControl
 from blazingmq import BasicHealthMonitor
 from blazingmq import CompressionAlgorithmType
+from blazingmq import CompressionPolicy
 from blazingmq import Error
+from blazingmq import Queue
 from blazingmq import QueueOptions
 from blazingmq import Session
 from blazingmq import SessionOptions
+from blazingmq import Subscription
+from blazingmq import SystemHealthMonitor
 from blazingmq import Timeouts
 from blazingmq._messages import create_message
 from blazingmq._session import DEFAULT_TIMEOUT
 from blazingmq.testing import HostHealth
+from blazingmq.testing import LoopbackBroker
 
+from .support import INT64
 from .support import dummy_callback
 from .support import make_session
 from .support import mock
@@ -62,6 +69,7 @@ def test_session_constructed(ext_cls):
     ext_cls.assert_called_once_with(
         dummy1,
         on_message=dummy2,
+        on_acks=None,
         broker=b"some_uri",
         message_compression_algorithm=CompressionAlgorithmType.NONE,
         num_processing_threads=1,
@@ -78,6 +86,13 @@ def test_session_constructed(ext_cls):
         ),
         monitor_host_health=False,
         fake_host_health_monitor=None,
+        system_host_health_monitor=None,
+        zero_copy_payloads=False,
+        pull_messages=False,
+        num_dispatch_threads=0,
+        time_callbacks=False,
+        slow_callback_threshold=None,
+        loopback=None,
     )
 
 
@@ -118,6 +133,7 @@ def test_session_constructed_with_timeouts(ext_cls):
     ext_cls.assert_called_once_with(
         dummy1,
         on_message=dummy2,
+        on_acks=None,
         broker=b"some_uri",
         message_compression_algorithm=CompressionAlgorithmType.NONE,
         num_processing_threads=1,
@@ -128,6 +144,13 @@ def test_session_constructed_with_timeouts(ext_cls):
         timeouts=timeouts,
         monitor_host_health=False,
         fake_host_health_monitor=None,
+        system_host_health_monitor=None,
+        zero_copy_payloads=False,
+        pull_messages=False,
+        num_dispatch_threads=0,
+        time_callbacks=False,
+        slow_callback_threshold=None,
+        loopback=None,
     )
 
 
@@ -162,6 +185,7 @@ def test_session_constructed_with_default_timeouts(ext_cls):
     ext_cls.assert_called_once_with(
         dummy1,
         on_message=dummy2,
+        on_acks=None,
         broker=b"some_uri",
         message_compression_algorithm=CompressionAlgorithmType.NONE,
         num_processing_threads=1,
@@ -172,6 +196,13 @@ def test_session_constructed_with_default_timeouts(ext_cls):
         timeouts=timeouts,
         monitor_host_health=False,
         fake_host_health_monitor=None,
+        system_host_health_monitor=None,
+        zero_copy_payloads=False,
+        pull_messages=False,
+        num_dispatch_threads=0,
+        time_callbacks=False,
+        slow_callback_threshold=None,
+        loopback=None,
     )
 
 
@@ -197,6 +228,7 @@ def test_session_default_with_options(ext_cls):
     ext_cls.assert_called_once_with(
         dummy1,
         on_message=dummy2,
+        on_acks=None,
         broker=b"some_uri",
         message_compression_algorithm=CompressionAlgorithmType.NONE,
         num_processing_threads=None,
@@ -207,6 +239,13 @@ def test_session_default_with_options(ext_cls):
         timeouts=Timeouts(),
         monitor_host_health=False,
         fake_host_health_monitor=None,
+        system_host_health_monitor=None,
+        zero_copy_payloads=False,
+        pull_messages=False,
+        num_dispatch_threads=0,
+        time_callbacks=False,
+        slow_callback_threshold=None,
+        loopback=None,
     )
 
 
@@ -238,17 +277,25 @@ def test_session_with_options(ext_cls):
         channel_high_watermark=8000000,
         event_queue_watermarks=(6000000, 7000000),
         stats_dump_interval=30.0,
+        zero_copy_payloads=True,
+        num_dispatch_threads=4,
+        slow_callback_threshold=0.5,
     )
 
     # WHEN
     Session.with_options(
-        dummy1, on_message=dummy2, broker="some_uri", session_options=session_options
+        dummy1,
+        on_message=dummy2,
+        broker="some_uri",
+        session_options=session_options,
+        on_acks=dummy_callback,
     )
 
     # THEN
     ext_cls.assert_called_once_with(
         dummy1,
         on_message=dummy2,
+        on_acks=dummy_callback,
         broker=b"some_uri",
         message_compression_algorithm=CompressionAlgorithmType.NONE,
         num_processing_threads=1,
@@ -259,9 +306,60 @@ def test_session_with_options(ext_cls):
         timeouts=timeouts,
         monitor_host_health=False,
         fake_host_health_monitor=None,
+        system_host_health_monitor=None,
+        zero_copy_payloads=True,
+        pull_messages=False,
+        num_dispatch_threads=4,
+        time_callbacks=True,
+        slow_callback_threshold=0.5,
+        loopback=None,
     )
 
 
+@mock.patch("blazingmq._session.ExtSession")
+def test_session_bad_num_dispatch_threads(ext_cls):
+    # GIVEN
+    ext_cls.mock_add_spec([])
+
+    # WHEN
+    with pytest.raises(Exception) as exc:
+        Session(dummy_callback, num_dispatch_threads=0)
+
+    # THEN
+    assert exc.type is ValueError
+    assert exc.match("num_dispatch_threads must be > 0, was 0")
+    ext_cls.assert_not_called()
+
+
+@mock.patch("blazingmq._session.ExtSession")
+def test_session_bad_slow_callback_threshold(ext_cls):
+    # GIVEN
+    ext_cls.mock_add_spec([])
+
+    # WHEN
+    with pytest.raises(Exception) as exc:
+        Session(dummy_callback, slow_callback_threshold=0.0)
+
+    # THEN
+    assert exc.type is ValueError
+    assert exc.match("slow_callback_threshold must be > 0.0, was 0.0")
+    ext_cls.assert_not_called()
+
+
+@mock.patch("blazingmq._session.ExtSession")
+def test_session_time_callbacks(ext_cls):
+    # GIVEN
+    ext_cls.mock_add_spec([])
+
+    # WHEN
+    Session(dummy_callback, time_callbacks=True)
+
+    # THEN
+    _, kwargs = ext_cls.call_args
+    assert kwargs["time_callbacks"] is True
+    assert kwargs["slow_callback_threshold"] is None
+
+
 @mock.patch("blazingmq._session.ExtSession")
 def test_session_basic_monitor(ext_cls):
     # GIVEN
@@ -288,6 +386,7 @@ def test_session_basic_monitor(ext_cls):
     ext_cls.assert_called_once_with(
         dummy1,
         on_message=dummy2,
+        on_acks=None,
         broker=b"some_uri",
         message_compression_algorithm=CompressionAlgorithmType.NONE,
         num_processing_threads=None,
@@ -304,7 +403,130 @@ def test_session_basic_monitor(ext_cls):
         ),
         monitor_host_health=True,
         fake_host_health_monitor=monitor._monitor,
+        system_host_health_monitor=None,
+        zero_copy_payloads=False,
+        pull_messages=False,
+        num_dispatch_threads=0,
+        time_callbacks=False,
+        slow_callback_threshold=None,
+        loopback=None,
+    )
+
+
+@mock.patch("blazingmq._session.ExtSession")
+@mock.patch("blazingmq._monitors.SystemHostHealthMonitor")
+def test_session_system_monitor(native_cls, ext_cls):
+    # GIVEN
+    ext_cls.mock_add_spec([])
+    native_cls.mock_add_spec([])
+    monitor = SystemHealthMonitor(max_load_average=8.0, probe_file="/drain")
+
+    # WHEN
+    Session(dummy_callback, host_health_monitor=monitor)
+
+    # THEN
+    native_cls.assert_called_once_with(
+        max_load_average=8.0,
+        min_available_memory=0.05,
+        probe_file=b"/drain",
+        probe_command=b"",
+        interval=1.0,
     )
+    _, kwargs = ext_cls.call_args
+    assert kwargs["monitor_host_health"] is True
+    assert kwargs["fake_host_health_monitor"] is None
+    assert kwargs["system_host_health_monitor"] is native_cls.return_value
+
+
+@mock.patch("blazingmq._monitors.SystemHostHealthMonitor")
+def test_system_monitor_keeps_zero_thresholds(native_cls):
+    # GIVEN
+    native_cls.mock_add_spec([])
+
+    # WHEN
+    SystemHealthMonitor(max_load_average=0.0, min_available_memory=0.0)
+    SystemHealthMonitor(min_available_memory=None)
+
+    # THEN
+    assert native_cls.call_args_list == [
+        mock.call(
+            max_load_average=0.0,
+            min_available_memory=0.0,
+            probe_file=b"",
+            probe_command=b"",
+            interval=1.0,
+        ),
+        mock.call(
+            max_load_average=None,
+            min_available_memory=None,
+            probe_file=b"",
+            probe_command=b"",
+            interval=1.0,
+        ),
+    ]
+
+
+@pytest.mark.parametrize(
+    "kwargs,error",
+    [
+        ({"interval": 0.0}, "interval must be > 0.0, was 0.0"),
+        ({"max_load_average": -1.0}, "max_load_average must be >= 0.0, was -1.0"),
+        (
+            {"min_available_memory": -0.5},
+            "min_available_memory must be between 0.0 and 1.0, was -0.5",
+        ),
+        (
+            {"min_available_memory": 1.5},
+            "min_available_memory must be between 0.0 and 1.0, was 1.5",
+        ),
+    ],
+)
+def test_system_monitor_bad_arguments(kwargs, error):
+    # GIVEN
+    # WHEN
+    with pytest.raises(Exception) as exc:
+        SystemHealthMonitor(**kwargs)
+
+    # THEN
+    assert exc.type is ValueError
+    assert exc.match(error)
+
+
+@mock.patch("blazingmq._session.ExtSession")
+@mock.patch("blazingmq._loopback.ExtLoopbackBroker")
+def test_session_loopback_broker(native_cls, ext_cls):
+    # GIVEN
+    ext_cls.mock_add_spec([])
+    native_cls.mock_add_spec([])
+    broker = LoopbackBroker(latency=0.5, batch_size=16, nack_ratio=0.25)
+
+    # WHEN
+    Session(dummy_callback, broker=broker)
+
+    # THEN
+    native_cls.assert_called_once_with(latency=0.5, batch_size=16, nack_ratio=0.25)
+    _, kwargs = ext_cls.call_args
+    assert kwargs["broker"] == b"loopback"
+    assert kwargs["loopback"] is native_cls.return_value
+
+
+@pytest.mark.parametrize(
+    "kwargs,error",
+    [
+        ({"latency": -1.0}, "latency must be >= 0.0, was -1.0"),
+        ({"batch_size": 0}, "batch_size must be > 0, was 0"),
+        ({"nack_ratio": 1.5}, "nack_ratio must be between 0.0 and 1.0, was 1.5"),
+    ],
+)
+def test_loopback_broker_bad_arguments(kwargs, error):
+    # GIVEN
+    # WHEN
+    with pytest.raises(Exception) as exc:
+        LoopbackBroker(**kwargs)
+
+    # THEN
+    assert exc.type is ValueError
+    assert exc.match(error)
 
 
 @mock.patch("blazingmq._session.ExtSession")
@@ -325,6 +547,7 @@ def test_session_default_constructed(ext_cls):
     ext_cls.assert_called_once_with(
         dummy1,
         on_message=dummy2,
+        on_acks=None,
         broker=b"tcp://localhost:30114",
         message_compression_algorithm=CompressionAlgorithmType.NONE,
         num_processing_threads=None,
@@ -335,6 +558,13 @@ def test_session_default_constructed(ext_cls):
         timeouts=Timeouts(),
         monitor_host_health=False,
         fake_host_health_monitor=None,
+        system_host_health_monitor=None,
+        zero_copy_payloads=False,
+        pull_messages=False,
+        num_dispatch_threads=0,
+        time_callbacks=False,
+        slow_callback_threshold=None,
+        loopback=None,
     )
 
 
@@ -395,6 +625,12 @@ def test_session_open_queue(ext):
         consumer_priority=consumer_priority,
         timeout=timeout,
         suspends_on_bad_host_health=suspends_on_bad_host_health,
+        subscriptions=None,
+        lazy_properties=False,
+        property_projection=None,
+        compression_policy=None,
+        payload_decoder=None,
+        flow_control=None,
     )
 
 
@@ -415,10 +651,335 @@ def test_session_open_queue_defaults(ext):
         max_unconfirmed_messages=None,
         max_unconfirmed_bytes=None,
         suspends_on_bad_host_health=None,
+        subscriptions=None,
+        timeout=None,
+        lazy_properties=False,
+        property_projection=None,
+        compression_policy=None,
+        payload_decoder=None,
+        flow_control=None,
+    )
+
+
+def test_session_open_queue_with_subscriptions(ext):
+    # GIVEN
+    ext.mock_add_spec(["open_queue_sync"])
+    session = make_session()
+    options = QueueOptions(
+        subscriptions=[
+            Subscription("price > 25", consumer_priority=2),
+            Subscription("firmId == 1234", max_unconfirmed_messages=10),
+        ]
+    )
+
+    # WHEN
+    session.open_queue("queue_uri", read=True, options=options)
+
+    # THEN
+    _, kwargs = ext.open_queue_sync.call_args
+    assert kwargs["subscriptions"] == [
+        (b"price > 25", 2, None, None),
+        (b"firmId == 1234", None, 10, None),
+    ]
+
+
+def test_session_configure_queue_removes_subscriptions(ext):
+    # GIVEN
+    ext.mock_add_spec(["configure_queue_sync"])
+    session = make_session()
+
+    # WHEN
+    session.configure_queue("queue_uri", QueueOptions(subscriptions=[]))
+
+    # THEN
+    _, kwargs = ext.configure_queue_sync.call_args
+    assert kwargs["subscriptions"] == []
+
+
+def test_session_get_queue_options_with_subscriptions(ext):
+    # GIVEN
+    ext.mock_add_spec(["get_queue_options"])
+    ext.get_queue_options.return_value = (
+        100,
+        2048,
+        5,
+        False,
+        [(b"price > 25", 2, None, 1024)],
+    )
+    session = make_session()
+
+    # WHEN
+    options = session.get_queue_options("queue_uri")
+
+    # THEN
+    ext.get_queue_options.assert_called_once_with(b"queue_uri")
+    assert options == QueueOptions(
+        max_unconfirmed_messages=100,
+        max_unconfirmed_bytes=2048,
+        consumer_priority=5,
+        suspends_on_bad_host_health=False,
+        subscriptions=[
+            Subscription("price > 25", max_unconfirmed_bytes=1024, consumer_priority=2)
+        ],
+    )
+
+
+def test_session_get_queue_options_without_subscriptions(ext):
+    # GIVEN
+    ext.mock_add_spec(["get_queue_options"])
+    ext.get_queue_options.return_value = (100, 2048, 5, False, [])
+    session = make_session()
+
+    # WHEN
+    options = session.get_queue_options("queue_uri")
+
+    # THEN
+    assert options.subscriptions is None
+
+
+def test_session_open_queue_with_property_decoding_options(ext):
+    # GIVEN
+    ext.mock_add_spec(["open_queue_sync"])
+    session = make_session()
+
+    # WHEN
+    session.open_queue(
+        "queue_uri",
+        read=True,
+        lazy_properties=True,
+        property_projection=("routing_key", b"tenant"),
+    )
+
+    # THEN
+    ext.open_queue_sync.assert_called_once_with(
+        b"queue_uri",
+        write=False,
+        read=True,
+        consumer_priority=None,
+        max_unconfirmed_messages=None,
+        max_unconfirmed_bytes=None,
+        suspends_on_bad_host_health=None,
+        subscriptions=None,
+        timeout=None,
+        lazy_properties=True,
+        property_projection=[b"routing_key", b"tenant"],
+        compression_policy=None,
+        payload_decoder=None,
+        flow_control=None,
+    )
+
+
+def test_session_open_queue_with_compression_policy(ext):
+    # GIVEN
+    ext.mock_add_spec(["open_queue_sync"])
+    session = make_session()
+    policy = CompressionPolicy(min_payload_size=1024, adaptive=True)
+
+    # WHEN
+    session.open_queue("queue_uri", write=True, compression_policy=policy)
+
+    # THEN
+    ext.open_queue_sync.assert_called_once_with(
+        b"queue_uri",
+        write=True,
+        read=False,
+        consumer_priority=None,
+        max_unconfirmed_messages=None,
+        max_unconfirmed_bytes=None,
+        suspends_on_bad_host_health=None,
+        subscriptions=None,
+        timeout=None,
+        lazy_properties=False,
+        property_projection=None,
+        compression_policy=policy._ext,
+        payload_decoder=None,
+        flow_control=None,
+    )
+
+
+@mock.patch("blazingmq._session.ExtCompressionPolicy")
+def test_compression_policy(ext_policy_cls):
+    # GIVEN / WHEN
+    policy = CompressionPolicy(
+        CompressionAlgorithmType.NONE, min_payload_size=512, adaptive=True
+    )
+
+    # THEN
+    ext_policy_cls.assert_called_once_with(CompressionAlgorithmType.NONE, 512, True)
+    assert policy._ext is ext_policy_cls.return_value
+    assert policy == CompressionPolicy(CompressionAlgorithmType.NONE, 512, True)
+    assert policy != CompressionPolicy(CompressionAlgorithmType.NONE, 512)
+    assert repr(policy) == (
+        "CompressionPolicy(algorithm=<CompressionAlgorithmType.NONE>,"
+        " min_payload_size=512, adaptive=True)"
+    )
+
+
+def test_compression_policy_bad_min_payload_size():
+    # GIVEN / WHEN
+    with pytest.raises(Exception) as exc:
+        CompressionPolicy(min_payload_size=-1)
+
+    # THEN
+    assert exc.type is ValueError
+    assert exc.match("min_payload_size must be non-negative, was -1")
+
+
+@mock.patch("blazingmq._session.ExtFlowControlPolicy")
+def test_session_open_queue_with_flow_control(ext_policy_cls, ext):
+    # GIVEN
+    ext.mock_add_spec(["open_queue_sync"])
+    session = make_session()
+    flow_control = AdaptiveFlowControl(window=0.5)
+
+    # WHEN
+    session.open_queue("queue_uri", read=True, flow_control=flow_control)
+
+    # THEN
+    ext.open_queue_sync.assert_called_once_with(
+        b"queue_uri",
+        write=False,
+        read=True,
+        consumer_priority=None,
+        max_unconfirmed_messages=None,
+        max_unconfirmed_bytes=None,
+        suspends_on_bad_host_health=None,
+        subscriptions=None,
         timeout=None,
+        lazy_properties=False,
+        property_projection=None,
+        compression_policy=None,
+        payload_decoder=None,
+        flow_control=ext_policy_cls.return_value,
+    )
+
+
+@mock.patch("blazingmq._session.ExtFlowControlPolicy")
+def test_adaptive_flow_control(ext_policy_cls):
+    # GIVEN / WHEN
+    flow_control = AdaptiveFlowControl(10, 1000, 4096, 65536, window=2.0)
+
+    # THEN
+    ext_policy_cls.assert_called_once_with(10, 1000, 4096, 65536, 2.0, 1.0)
+    assert flow_control._ext is ext_policy_cls.return_value
+    assert flow_control == AdaptiveFlowControl(10, 1000, 4096, 65536, 2.0, 1.0)
+    assert flow_control != AdaptiveFlowControl(10, 1000, 4096, 65536)
+    assert repr(flow_control) == (
+        "AdaptiveFlowControl(min_unconfirmed_messages=10,"
+        " max_unconfirmed_messages=1000, min_unconfirmed_bytes=4096,"
+        " max_unconfirmed_bytes=65536, window=2.0, interval=1.0)"
     )
 
 
+@pytest.mark.parametrize(
+    "kwargs, message",
+    [
+        (
+            dict(min_unconfirmed_messages=0),
+            "min_unconfirmed_messages must be positive, was 0",
+        ),
+        (
+            dict(min_unconfirmed_bytes=10, max_unconfirmed_bytes=5),
+            re.escape(
+                "min_unconfirmed_bytes (10) must not exceed max_unconfirmed_bytes (5)"
+            ),
+        ),
+        (dict(window=0), "window must be > 0.0, was 0"),
+        (dict(interval=-1.0), "interval must be > 0.0, was -1.0"),
+    ],
+)
+def test_adaptive_flow_control_bad_arguments(kwargs, message):
+    # GIVEN / WHEN
+    with pytest.raises(Exception) as exc:
+        AdaptiveFlowControl(**kwargs)
+
+    # THEN
+    assert exc.type is ValueError
+    assert exc.match(message)
+
+
+def test_session_open_queue_returns_queue_handle(ext):
+    # GIVEN
+    ext.mock_add_spec(["open_queue_sync"])
+    ext_queue = ext.open_queue_sync.return_value
+    ext_queue.mock_add_spec(["uri", "post", "try_post", "confirm"])
+    ext_queue.uri = b"queue_uri"
+    ext_queue.try_post.return_value = False
+    session = make_session()
+    message = create_message(b"bytes", b"guid", "queue_uri", {}, {})
+
+    # WHEN
+    queue = session.open_queue("queue_uri", read=True, write=True)
+    queue.post(b"data", properties={"a": 1}, on_ack=dummy_callback)
+    queue.post(b"more data")
+    queue.post(b"numbered", ack_id=3)
+    queue.post(b"blocking", block=True, timeout=1.5)
+    posted = queue.try_post(b"attempted")
+    queue.confirm(message)
+
+    # THEN
+    assert isinstance(queue, Queue)
+    assert queue.uri == "queue_uri"
+    assert repr(queue) == "<Queue for queue_uri>"
+    assert ext_queue.post.call_args_list == [
+        mock.call(
+            b"data",
+            properties={b"a": (1, INT64)},
+            on_ack=dummy_callback,
+            properties_template=None,
+            compression_algorithm=None,
+            block=False,
+            timeout=None,
+        ),
+        mock.call(
+            b"more data",
+            properties=None,
+            on_ack=None,
+            properties_template=None,
+            compression_algorithm=None,
+            block=False,
+            timeout=None,
+        ),
+        mock.call(
+            b"numbered",
+            properties=None,
+            on_ack=3,
+            properties_template=None,
+            compression_algorithm=None,
+            block=False,
+            timeout=None,
+        ),
+        mock.call(
+            b"blocking",
+            properties=None,
+            on_ack=None,
+            properties_template=None,
+            compression_algorithm=None,
+            block=True,
+            timeout=1.5,
+        ),
+    ]
+    assert posted is False
+    ext_queue.try_post.assert_called_once_with(
+        b"attempted",
+        properties=None,
+        on_ack=None,
+        properties_template=None,
+        compression_algorithm=None,
+    )
+    ext_queue.confirm.assert_called_once_with(message)
+
+
+def test_queue_has_no_public_constructor():
+    # GIVEN / WHEN
+    with pytest.raises(Exception) as exc:
+        Queue()
+
+    # THEN
+    assert exc.type is Error
+    assert exc.match("^The Queue class does not have a public constructor.")
+
+
 def test_session_open_queue_for_read_no_on_message_raises(ext):
     # GIVEN
     ext.mock_add_spec([])
@@ -436,6 +997,46 @@ def test_session_open_queue_for_read_no_on_message_raises(ext):
     )
 
 
+def test_session_pull_messages_with_on_message_raises(ext):
+    # GIVEN
+    ext.mock_add_spec([])
+
+    # WHEN
+    with pytest.raises(Exception) as exc:
+        Session(dummy_callback, on_message=dummy_callback, pull_messages=True)
+
+    # THEN
+    assert exc.type is Error
+    assert exc.match("on_message can't be provided when pull_messages is set")
+
+
+def test_session_open_queue_for_read_in_pull_mode(ext):
+    # GIVEN
+    ext.mock_add_spec(["open_queue_sync"])
+    session = Session(dummy_callback, host_health_monitor=None, pull_messages=True)
+
+    # WHEN
+    session.open_queue("queue_uri", read=True)
+
+    # THEN
+    ext.open_queue_sync.assert_called_once_with(
+        b"queue_uri",
+        write=False,
+        read=True,
+        consumer_priority=None,
+        max_unconfirmed_messages=None,
+        max_unconfirmed_bytes=None,
+        suspends_on_bad_host_health=None,
+        subscriptions=None,
+        timeout=None,
+        lazy_properties=False,
+        property_projection=None,
+        compression_policy=None,
+        payload_decoder=None,
+        flow_control=None,
+    )
+
+
 def test_session_open_with_suspension_without_health_monitoring(ext):
     # GIVEN
     ext.mock_add_spec(["open_queue_sync", "monitor_host_health"])
@@ -503,6 +1104,7 @@ def test_session_configure_queue(ext):
         max_unconfirmed_bytes=max_unconfirmed_bytes,
         consumer_priority=consumer_priority,
         suspends_on_bad_host_health=suspends_on_bad_host_health,
+        subscriptions=None,
         timeout=timeout,
     )
 
@@ -523,10 +1125,201 @@ def test_session_configure_queue_defaults(ext):
         max_unconfirmed_messages=None,
         max_unconfirmed_bytes=None,
         suspends_on_bad_host_health=None,
+        subscriptions=None,
         timeout=None,
     )
 
 
+def test_session_open_queue_async(ext):
+    # GIVEN
+    ext.mock_add_spec(["open_queue_async"])
+    ext_queue = mock.MagicMock()
+    ext_queue.mock_add_spec(["uri"])
+    ext_queue.uri = b"queue_uri"
+    session = make_session()
+
+    # WHEN
+    future = session.open_queue_async("queue_uri", read=True, timeout=60.0)
+
+    # THEN
+    ext.open_queue_async.assert_called_once_with(
+        b"queue_uri",
+        write=False,
+        read=True,
+        consumer_priority=None,
+        max_unconfirmed_messages=None,
+        max_unconfirmed_bytes=None,
+        suspends_on_bad_host_health=None,
+        subscriptions=None,
+        timeout=60.0,
+        lazy_properties=False,
+        property_projection=None,
+        compression_policy=None,
+        payload_decoder=None,
+        flow_control=None,
+        on_complete=mock.ANY,
+    )
+    assert not future.done()
+    _, kwargs = ext.open_queue_async.call_args
+    kwargs["on_complete"](ext_queue, None)
+    queue = future.result(timeout=0)
+    assert isinstance(queue, Queue)
+    assert queue.uri == "queue_uri"
+
+
+def test_session_open_queue_async_failure(ext):
+    # GIVEN
+    ext.mock_add_spec(["open_queue_async"])
+    session = make_session()
+    error = Error("Failed to open queue_uri queue: UNKNOWN")
+
+    # WHEN
+    future = session.open_queue_async("queue_uri", write=True)
+    _, kwargs = ext.open_queue_async.call_args
+    kwargs["on_complete"](None, error)
+
+    # THEN
+    assert future.exception(timeout=0) is error
+
+
+def test_session_open_queue_async_cancelled(ext):
+    # GIVEN
+    ext.mock_add_spec(["open_queue_async"])
+    session = make_session()
+    future = session.open_queue_async("queue_uri", write=True)
+    _, kwargs = ext.open_queue_async.call_args
+
+    # WHEN
+    assert future.cancel()
+    kwargs["on_complete"](mock.MagicMock(), None)
+
+    # THEN
+    assert future.cancelled()
+
+
+def test_session_open_queues(ext):
+    # GIVEN
+    ext.mock_add_spec(["open_queues"])
+    ext_queue = mock.MagicMock()
+    ext_queue.mock_add_spec(["uri"])
+    ext_queue.uri = b"queue_uri1"
+    error = Error("Failed to open queue_uri2 queue: UNKNOWN")
+    ext.open_queues.return_value = [ext_queue, error]
+    session = make_session()
+
+    # WHEN
+    results = session.open_queues(
+        ["queue_uri1", "queue_uri2"], write=True, max_in_flight=10
+    )
+
+    # THEN
+    ext.open_queues.assert_called_once_with(
+        [b"queue_uri1", b"queue_uri2"],
+        max_in_flight=10,
+        write=True,
+        read=False,
+        consumer_priority=None,
+        max_unconfirmed_messages=None,
+        max_unconfirmed_bytes=None,
+        suspends_on_bad_host_health=None,
+        subscriptions=None,
+        timeout=None,
+        lazy_properties=False,
+        property_projection=None,
+        compression_policy=None,
+        payload_decoder=None,
+        flow_control=None,
+    )
+    assert isinstance(results[0], Queue)
+    assert results[0].uri == "queue_uri1"
+    assert results[1] is error
+
+
+def test_session_open_queues_without_queues(ext):
+    # GIVEN
+    ext.mock_add_spec([])
+    session = make_session()
+
+    # WHEN
+    results = session.open_queues([], read=True)
+
+    # THEN
+    assert results == []
+
+
+def test_session_open_queues_bad_max_in_flight(ext):
+    # GIVEN
+    ext.mock_add_spec([])
+    session = make_session()
+
+    # WHEN
+    with pytest.raises(Exception) as exc:
+        session.open_queues(["queue_uri"], write=True, max_in_flight=0)
+
+    # THEN
+    assert exc.type is ValueError
+    assert exc.match("max_in_flight must be > 0, was 0")
+
+
+def test_session_open_queue_async_for_read_no_on_message_raises(ext):
+    # GIVEN
+    ext.mock_add_spec([])
+    session = Session(dummy_callback)
+
+    # WHEN
+    with pytest.raises(Exception) as exc:
+        session.open_queue_async("queue_uri", read=True)
+
+    # THEN
+    assert exc.type is Error
+    assert exc.match("no on_message callback was provided")
+
+
+def test_session_configure_queue_async(ext):
+    # GIVEN
+    ext.mock_add_spec(["configure_queue_async"])
+    session = make_session()
+
+    # WHEN
+    future = session.configure_queue_async(
+        "queue_uri", options=QueueOptions(consumer_priority=5), timeout=60.0
+    )
+
+    # THEN
+    ext.configure_queue_async.assert_called_once_with(
+        b"queue_uri",
+        consumer_priority=5,
+        max_unconfirmed_messages=None,
+        max_unconfirmed_bytes=None,
+        suspends_on_bad_host_health=None,
+        subscriptions=None,
+        timeout=60.0,
+        on_complete=mock.ANY,
+    )
+    _, kwargs = ext.configure_queue_async.call_args
+    kwargs["on_complete"](None, None)
+    assert future.result(timeout=0) is None
+
+
+def test_session_close_queue_async(ext):
+    # GIVEN
+    ext.mock_add_spec(["close_queue_async"])
+    session = make_session()
+
+    # WHEN
+    future = session.close_queue_async("queue_uri", timeout=60.0)
+
+    # THEN
+    ext.close_queue_async.assert_called_once_with(
+        b"queue_uri",
+        timeout=60.0,
+        on_complete=mock.ANY,
+    )
+    _, kwargs = ext.close_queue_async.call_args
+    kwargs["on_complete"](None, None)
+    assert future.result(timeout=0) is None
+
+
 def test_session_configure_suspension_without_health_monitoring(ext):
     # GIVEN
     ext.mock_add_spec(["configure_queue_sync", "monitor_host_health"])
@@ -576,6 +1369,10 @@ def test_session_post_no_ack_no_properties(ext):
         b"data",
         properties=None,
         on_ack=None,
+        properties_template=None,
+        compression_algorithm=None,
+        block=False,
+        timeout=None,
     )
 
 
@@ -596,6 +1393,157 @@ def test_session_post_with_ack(ext):
         b"data",
         properties=None,
         on_ack=dummy,
+        properties_template=None,
+        compression_algorithm=None,
+        block=False,
+        timeout=None,
+    )
+
+
+def test_session_post_with_ack_id(ext):
+    # GIVEN
+    ext.mock_add_spec(["post"])
+    session = make_session()
+
+    # WHEN
+    session.post("queue_uri", b"data", ack_id=42)
+
+    # THEN
+    ext.post.assert_called_once_with(
+        b"queue_uri",
+        b"data",
+        properties=None,
+        on_ack=42,
+        properties_template=None,
+        compression_algorithm=None,
+        block=False,
+        timeout=None,
+    )
+
+
+def test_session_post_with_ack_and_ack_id_raises(ext):
+    # GIVEN
+    ext.mock_add_spec(["post"])
+    session = make_session()
+
+    # WHEN
+    with pytest.raises(Exception) as exc:
+        session.post("queue_uri", b"data", on_ack=dummy_callback, ack_id=42)
+
+    # THEN
+    assert exc.type is Error
+    assert exc.match("^on_ack and ack_id can't both be provided$")
+    ext.post.assert_not_called()
+
+
+def test_session_post_blocking(ext):
+    # GIVEN
+    ext.mock_add_spec(["post"])
+    session = make_session()
+
+    # WHEN
+    session.post("queue_uri", b"data", block=True, timeout=2.5)
+
+    # THEN
+    ext.post.assert_called_once_with(
+        b"queue_uri",
+        b"data",
+        properties=None,
+        on_ack=None,
+        properties_template=None,
+        compression_algorithm=None,
+        block=True,
+        timeout=2.5,
+    )
+
+
+@pytest.mark.parametrize(
+    "block, timeout, expected_error",
+    [
+        (False, 1.0, "timeout can only be provided when block is True"),
+        (True, 0.0, "timeout must be greater than 0.0, was 0.0"),
+        (True, -1.0, "timeout must be greater than 0.0, was -1.0"),
+    ],
+)
+def test_session_post_bad_blocking_timeout(ext, block, timeout, expected_error):
+    # GIVEN
+    ext.mock_add_spec(["post"])
+    session = make_session()
+
+    # WHEN
+    with pytest.raises(Exception) as exc:
+        session.post("queue_uri", b"data", block=block, timeout=timeout)
+
+    # THEN
+    assert exc.type is ValueError
+    assert exc.match(expected_error)
+    ext.post.assert_not_called()
+
+
+
+def test_session_post_with_compression_algorithm(ext):
+    # GIVEN
+    ext.mock_add_spec(["post"])
+    session = make_session()
+
+    # WHEN
+    session.post(
+        "queue_uri", b"data", compression_algorithm=CompressionAlgorithmType.NONE
+    )
+
+    # THEN
+    ext.post.assert_called_once_with(
+        b"queue_uri",
+        b"data",
+        properties=None,
+        on_ack=None,
+        properties_template=None,
+        compression_algorithm=CompressionAlgorithmType.NONE,
+        block=False,
+        timeout=None,
+    )
+
+@pytest.mark.parametrize("posted", [True, False])
+def test_session_try_post(ext, posted):
+    # GIVEN
+    ext.mock_add_spec(["try_post"])
+    ext.try_post.return_value = posted
+    session = make_session()
+
+    # WHEN
+    result = session.try_post("queue_uri", b"data", ack_id=42)
+
+    # THEN
+    assert result is posted
+    ext.try_post.assert_called_once_with(
+        b"queue_uri",
+        b"data",
+        properties=None,
+        on_ack=42,
+        properties_template=None,
+        compression_algorithm=None,
+    )
+
+
+def test_session_post_many(ext):
+    # GIVEN
+    ext.mock_add_spec(["post_many"])
+    session = make_session()
+
+    def dummy():
+        pass
+
+    # WHEN
+    session.post_many(
+        "queue_uri",
+        iter([(b"data1", None, None), (b"data2", None, dummy)]),
+    )
+
+    # THEN
+    ext.post_many.assert_called_once_with(
+        b"queue_uri",
+        [(b"data1", None, None), (b"data2", None, dummy)],
+        properties_template=None,
     )
 
 
@@ -612,6 +1560,102 @@ def test_session_confirm(ext):
     ext.confirm.assert_called_once_with(msg)
 
 
+def test_session_confirm_many(ext):
+    # GIVEN
+    ext.mock_add_spec(["confirm_many"])
+    session = make_session()
+    msgs = [
+        create_message(b"data", b"guid1", "queue_uri", {}, {}),
+        create_message(b"data", b"guid2", "queue_uri", {}, {}),
+    ]
+
+    # WHEN
+    session.confirm_many(msgs)
+
+    # THEN
+    ext.confirm_many.assert_called_once_with(msgs)
+
+
+def test_session_receive(ext):
+    # GIVEN
+    ext.mock_add_spec(["receive"])
+    session = Session(dummy_callback, host_health_monitor=None, pull_messages=True)
+    msgs = [create_message(b"data", b"guid1", "queue_uri", {}, {})]
+    ext.receive.return_value = msgs
+
+    # WHEN
+    received = session.receive(10, timeout=0.5)
+
+    # THEN
+    ext.receive.assert_called_once_with(10, 0.5)
+    assert received is msgs
+
+
+def test_session_stats(ext):
+    # GIVEN
+    ext.mock_add_spec(["stats"])
+    session = Session(dummy_callback, host_health_monitor=None)
+    snapshot = {"message_callback": {"calls": 0, "seconds": 0.0}, "queues": {}}
+    ext.stats.return_value = snapshot
+
+    # WHEN
+    stats = session.stats()
+
+    # THEN
+    ext.stats.assert_called_once_with()
+    assert stats is snapshot
+
+
+def test_session_receive_defaults(ext):
+    # GIVEN
+    ext.mock_add_spec(["receive"])
+    session = Session(dummy_callback, host_health_monitor=None, pull_messages=True)
+
+    # WHEN
+    session.receive()
+
+    # THEN
+    ext.receive.assert_called_once_with(1, None)
+
+
+def test_session_receive_without_pull_messages_raises(ext):
+    # GIVEN
+    ext.mock_add_spec(["receive"])
+    session = make_session()
+
+    # WHEN
+    with pytest.raises(Exception) as exc:
+        session.receive()
+
+    # THEN
+    assert exc.type is Error
+    assert exc.match(r"receive\(\) requires a Session created with pull_messages")
+    ext.receive.assert_not_called()
+
+
+@pytest.mark.parametrize(
+    "max_messages, timeout, expected",
+    [
+        (0, None, "max_messages must be positive, was 0"),
+        (1, -1.0, "timeout must be nonnegative, was -1.0"),
+        (1, float("inf"), "timeout must be nonnegative, was inf"),
+    ],
+)
+def test_session_receive_bad_arguments(ext, max_messages, timeout, expected):
+    # GIVEN
+    ext.mock_add_spec(["receive"])
+    session = Session(dummy_callback, host_health_monitor=None, pull_messages=True)
+
+    # WHEN
+    with pytest.raises(Exception) as exc:
+        session.receive(max_messages, timeout)
+
+    # THEN
+    assert exc.type is ValueError
+    assert exc.match(expected)
+    ext.receive.assert_not_called()
+
+
 def test_session_as_context_manager(ext):
     # GIVEN
     ext.mock_add_spec(["stop"])
@@ -748,6 +1792,24 @@ def test_basic_monitor_repr():
     assert msg == "BasicHealthMonitor()"
 
 
+@mock.patch("blazingmq._monitors.SystemHostHealthMonitor")
+def test_system_monitor_repr(native_cls):
+    # GIVEN
+    # WHEN
+    msg = repr(SystemHealthMonitor(probe_command="true", interval=5.0))
+    # THEN
+    assert msg == "SystemHealthMonitor(None, 0.05, None, 'true', 5.0)"
+
+
+@mock.patch("blazingmq._loopback.ExtLoopbackBroker")
+def test_loopback_broker_repr(native_cls):
+    # GIVEN
+    # WHEN
+    msg = repr(LoopbackBroker(latency=0.01, nack_ratio=0.5))
+    # THEN
+    assert msg == "LoopbackBroker(latency=0.01, batch_size=1024, nack_ratio=0.5)"
+
+
 def test_host_health_repr():
     # GIVEN
     # WHEN
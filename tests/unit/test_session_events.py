@@ -248,6 +248,21 @@ def test_generating_interface_errors_without_an_sdk_event():
     assert args == (session_events.InterfaceError("some error message"),)
 
 
+def test_reporting_a_slow_callback():
+    # GIVEN
+    spy = mock.MagicMock()
+
+    # WHEN
+    _callbacks.on_slow_callback(spy, "on_message", 0.25, 0.1)
+
+    # THEN
+    spy.assert_called_once_with(
+        session_events.SlowCallback(
+            "on_message took 0.250s, exceeding the 0.100s threshold"
+        )
+    )
+
+
 @pytest.mark.parametrize(
     "event, expected_level_name",
     [
@@ -259,6 +274,7 @@ def test_generating_interface_errors_without_an_sdk_event():
         (session_events.ConnectionTimeout(None), "ERROR"),
         (session_events.SlowConsumerNormal(None), "INFO"),
         (session_events.SlowConsumerHighWaterMark(None), "WARN"),
+        (session_events.SlowCallback("on_message took 1.000s"), "WARN"),
         (session_events.Error("Error message: NOT_SUCCESS (42)"), "ERROR"),
         (session_events.QueueReopened("bmq://dummy_queue"), "INFO"),
         (
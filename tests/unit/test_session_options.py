@@ -29,6 +29,11 @@ def test_session_options_repr():
         channel_high_watermark=8000000,
         event_queue_watermarks=(6000000, 7000000),
         stats_dump_interval=30.0,
+        zero_copy_payloads=True,
+        pull_messages=True,
+        num_dispatch_threads=4,
+        time_callbacks=True,
+        slow_callback_threshold=0.25,
     )
     # THEN
     assert (
@@ -40,7 +45,12 @@ def test_session_options_repr():
         " blob_buffer_size=5000,"
         " channel_high_watermark=8000000,"
         " event_queue_watermarks=(6000000, 7000000),"
-        " stats_dump_interval=30.0)" == repr(one)
+        " stats_dump_interval=30.0,"
+        " zero_copy_payloads=True,"
+        " pull_messages=True,"
+        " num_dispatch_threads=4,"
+        " time_callbacks=True,"
+        " slow_callback_threshold=0.25)" == repr(one)
     )
 
 
@@ -63,6 +73,11 @@ def test_session_options_default_to_none():
     assert options.channel_high_watermark is None
     assert options.event_queue_watermarks is None
     assert options.stats_dump_interval is None
+    assert options.zero_copy_payloads is None
+    assert options.pull_messages is None
+    assert options.num_dispatch_threads is None
+    assert options.time_callbacks is None
+    assert options.slow_callback_threshold is None
 
 
 def test_session_options_equality():
@@ -92,6 +107,11 @@ def test_session_options_equality():
         blazingmq.SessionOptions(channel_high_watermark=8000000),
         blazingmq.SessionOptions(event_queue_watermarks=(6000000, 7000000)),
         blazingmq.SessionOptions(stats_dump_interval=30.0),
+        blazingmq.SessionOptions(zero_copy_payloads=False),
+        blazingmq.SessionOptions(pull_messages=False),
+        blazingmq.SessionOptions(num_dispatch_threads=2),
+        blazingmq.SessionOptions(time_callbacks=False),
+        blazingmq.SessionOptions(slow_callback_threshold=1.0),
     ],
 )
 def test_queue_options_other_inequality(right):
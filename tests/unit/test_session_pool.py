@@ -0,0 +1,223 @@
+# Copyright 2019-2023 Bloomberg Finance L.P.
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import pytest
+
+from blazingmq import Error
+from blazingmq import SessionPool
+from blazingmq._ext import create_message
+
+from .support import dummy_callback
+from .support import mock
+
+
+def _create_exts(ext_cls):
+    exts = []
+
+    def create(*args, **kwargs):
+        ext = mock.MagicMock()
+        ext.mock_add_spec(
+            [
+                "post",
+                "try_post",
+                "post_many",
+                "open_queue_async",
+                "close_queue_async",
+                "stats",
+                "stop",
+            ]
+        )
+        exts.append(ext)
+        return ext
+
+    ext_cls.side_effect = create
+    return exts
+
+
+@mock.patch("blazingmq._session.ExtSession")
+def test_session_pool_connects_to_each_broker_in_turn(ext_cls):
+    # GIVEN
+    exts = _create_exts(ext_cls)
+
+    # WHEN
+    pool = SessionPool(dummy_callback, num_sessions=3, broker=["uri1", "uri2"])
+
+    # THEN
+    assert len(exts) == 3
+    assert [s._ext for s in pool.sessions] == exts
+    brokers = [kwargs["broker"] for _, kwargs in ext_cls.call_args_list]
+    assert brokers == [b"uri1", b"uri2", b"uri1"]
+    assert all(kwargs["on_message"] is None for _, kwargs in ext_cls.call_args_list)
+
+
+@pytest.mark.parametrize("num_sessions", [0, -1])
+def test_session_pool_bad_num_sessions(num_sessions):
+    # GIVEN
+    # WHEN
+    with pytest.raises(Exception) as exc:
+        SessionPool(dummy_callback, num_sessions=num_sessions)
+
+    # THEN
+    assert exc.type is ValueError
+    assert exc.match(f"num_sessions must be > 0, was {num_sessions}")
+
+
+@mock.patch("blazingmq._session.ExtSession")
+def test_session_pool_stops_started_sessions_on_failure(ext_cls):
+    # GIVEN
+    first = mock.MagicMock()
+    first.mock_add_spec(["stop"])
+    error = Error("Failed to start session: TIMEOUT")
+    ext_cls.side_effect = [first, error]
+
+    # WHEN
+    with pytest.raises(Exception) as exc:
+        SessionPool(dummy_callback, num_sessions=3)
+
+    # THEN
+    assert exc.value is error
+    first.stop.assert_called_once_with()
+
+
+@mock.patch("blazingmq._session.ExtSession")
+def test_session_pool_posts_round_robin(ext_cls):
+    # GIVEN
+    exts = _create_exts(ext_cls)
+    pool = SessionPool(dummy_callback, num_sessions=2)
+
+    # WHEN
+    for payload in [b"a", b"b", b"c"]:
+        pool.post("queue_uri", payload)
+
+    # THEN
+    assert [c.args[1] for c in exts[0].post.call_args_list] == [b"a", b"c"]
+    assert [c.args[1] for c in exts[1].post.call_args_list] == [b"b"]
+
+
+@mock.patch("blazingmq._session.ExtSession")
+def test_session_pool_posts_equal_keys_through_one_session(ext_cls):
+    # GIVEN
+    exts = _create_exts(ext_cls)
+    pool = SessionPool(dummy_callback, num_sessions=4)
+
+    # WHEN
+    for payload in [b"a", b"b", b"c"]:
+        pool.post("queue_uri", payload, key="account-1")
+    pool.try_post("queue_uri", b"d", key="account-1")
+    pool.post_many("queue_uri", [(b"e", None, None)], key="account-1")
+
+    # THEN
+    (ext,) = [ext for ext in exts if ext.post.called]
+    assert [c.args[1] for c in ext.post.call_args_list] == [b"a", b"b", b"c"]
+    ext.try_post.assert_called_once()
+    ext.post_many.assert_called_once()
+
+
+@mock.patch("blazingmq._session.ExtSession")
+def test_session_pool_opens_and_closes_queue_on_every_session(ext_cls):
+    # GIVEN
+    exts = _create_exts(ext_cls)
+    error = Error("Failed to open queue_uri queue: UNKNOWN")
+    pool = SessionPool(dummy_callback, num_sessions=2)
+    for ext in exts:
+        ext.open_queue_async.side_effect = lambda uri, on_complete, **_: on_complete(
+            mock.MagicMock(), None
+        )
+        ext.close_queue_async.side_effect = lambda uri, on_complete, **_: on_complete(
+            None, None
+        )
+    exts[1].close_queue_async.side_effect = lambda uri, on_complete, **_: (
+        on_complete(None, error)
+    )
+
+    # WHEN
+    pool.open_queue("queue_uri")
+    with pytest.raises(Exception) as exc:
+        pool.close_queue("queue_uri")
+
+    # THEN
+    for ext in exts:
+        _, kwargs = ext.open_queue_async.call_args
+        assert kwargs["write"] is True
+        assert kwargs["read"] is False
+        ext.close_queue_async.assert_called_once()
+    assert exc.value is error
+
+
+@mock.patch("blazingmq._session.ExtSession")
+def test_session_pool_sums_stats(ext_cls):
+    # GIVEN
+    exts = _create_exts(ext_cls)
+    pool = SessionPool(dummy_callback, num_sessions=2)
+
+    def stats(posted, counts, acks):
+        return {
+            "message_callback": {"calls": 0, "seconds": 0.0},
+            "queues": {
+                "queue_uri": {
+                    "messages_posted": posted,
+                    "acks": acks,
+                    "post_to_ack_latency": {
+                        "bounds": [1e-6, 2e-6],
+                        "counts": counts,
+                        "count": sum(counts),
+                        "sum": 1.0,
+                    },
+                },
+            },
+        }
+
+    exts[0].stats.return_value = stats(3, [1, 2, 0], {"SUCCESS": 3})
+    exts[1].stats.return_value = stats(2, [0, 1, 1], {"UNKNOWN": 1, "SUCCESS": 1})
+
+    # WHEN
+    result = pool.stats()
+
+    # THEN
+    assert result == {
+        "message_callback": {"calls": 0, "seconds": 0.0},
+        "queues": {
+            "queue_uri": {
+                "messages_posted": 5,
+                "acks": {"SUCCESS": 4, "UNKNOWN": 1},
+                "post_to_ack_latency": {
+                    "bounds": [1e-6, 2e-6],
+                    "counts": [1, 3, 1],
+                    "count": 5,
+                    "sum": 2.0,
+                },
+            },
+        },
+    }
+    assert exts[0].stats.return_value == stats(3, [1, 2, 0], {"SUCCESS": 3})
+
+
+@mock.patch("blazingmq._session.ExtSession")
+def test_session_pool_stops_every_session(ext_cls):
+    # GIVEN
+    exts = _create_exts(ext_cls)
+    pool = SessionPool(dummy_callback, num_sessions=3)
+    error = Error("Failed to stop")
+    exts[0].stop.side_effect = error
+
+    # WHEN
+    with pytest.raises(Exception) as exc:
+        with pool:
+            pass
+
+    # THEN
+    assert exc.value is error
+    for ext in exts:
+        ext.stop.assert_called_once_with()
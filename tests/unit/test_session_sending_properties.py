@@ -16,6 +16,7 @@
 import pytest
 
 from blazingmq import Error
+from blazingmq import PropertiesTemplate
 from blazingmq import PropertyType
 
 from .support import BINARY
@@ -26,6 +27,7 @@ from .support import INT64
 from .support import SHORT
 from .support import STRING
 from .support import make_session
+from .support import mock
 
 
 def test_session_post_with_properties(ext):
@@ -50,6 +52,40 @@ def test_session_post_with_properties(ext):
         b"data",
         properties=merged,
         on_ack=None,
+        properties_template=None,
+        compression_algorithm=None,
+        block=False,
+        timeout=None,
+    )
+
+
+def test_session_post_many_with_properties(ext):
+    # GIVEN
+    ext.mock_add_spec(["post_many"])
+    session = make_session()
+    messages = [
+        (b"data1", None, None),
+        (b"data2", {"a": "b"}, None),
+        (b"data3", {"a": "b", "c": 1}, None),
+    ]
+    property_type_overrides = {"c": PropertyType.INT32}
+
+    # WHEN
+    session.post_many(
+        "queue_uri",
+        messages,
+        property_type_overrides=property_type_overrides,
+    )
+
+    # THEN
+    ext.post_many.assert_called_once_with(
+        b"queue_uri",
+        [
+            (b"data1", None, None),
+            (b"data2", {b"a": (b"b", STRING)}, None),
+            (b"data3", {b"a": (b"b", STRING), b"c": (1, INT32)}, None),
+        ],
+        properties_template=None,
     )
 
 
@@ -77,6 +113,10 @@ def test_session_post_property_default_types(ext):
         b"data",
         properties=merged,
         on_ack=None,
+        properties_template=None,
+        compression_algorithm=None,
+        block=False,
+        timeout=None,
     )
 
 
@@ -96,6 +136,10 @@ def test_session_post_property_default_for_byte_string_is_binary_in_3(ext):
         b"data",
         properties=merged,
         on_ack=None,
+        properties_template=None,
+        compression_algorithm=None,
+        block=False,
+        timeout=None,
     )
 
 
@@ -129,6 +173,10 @@ def test_session_post_property_type_overrides(ext):
         b"data",
         properties=merged,
         on_ack=None,
+        properties_template=None,
+        compression_algorithm=None,
+        block=False,
+        timeout=None,
     )
 
 
@@ -162,6 +210,10 @@ def test_session_post_property_type_overrides_mixed_bytes_unicode(ext):
         b"data",
         properties=merged,
         on_ack=None,
+        properties_template=None,
+        compression_algorithm=None,
+        block=False,
+        timeout=None,
     )
 
 
@@ -245,3 +297,88 @@ def test_session_post_unsupported_property_value(ext):
     # THEN
     assert exc.type is Error
     assert exc.match("Property values of type 'float' are not supported")
+
+
+@mock.patch("blazingmq._session.ExtPropertiesTemplate")
+def test_properties_template_converts_properties_once(ext_template_cls):
+    # GIVEN
+    properties = {"a": 1, "b": "x"}
+    property_type_overrides = {"a": PropertyType.INT32}
+
+    # WHEN
+    template = PropertiesTemplate(properties, property_type_overrides)
+
+    # THEN
+    ext_template_cls.assert_called_once_with({b"a": (1, INT32), b"b": (b"x", STRING)})
+    assert template.property_types == {
+        "a": PropertyType.INT32,
+        "b": PropertyType.STRING,
+    }
+    assert repr(template) == "<PropertiesTemplate ['a', 'b']>"
+
+
+@mock.patch("blazingmq._session.ExtPropertiesTemplate")
+def test_session_post_with_properties_template(ext_template_cls, ext):
+    # GIVEN
+    ext.mock_add_spec(["post"])
+    session = make_session()
+    template = PropertiesTemplate({"a": 1, "b": "x"}, {"a": PropertyType.INT32})
+
+    # WHEN
+    session.post("queue_uri", b"data1", properties_template=template)
+    session.post(
+        "queue_uri",
+        b"data2",
+        properties={"a": 2, "c": 3},
+        property_type_overrides={"c": PropertyType.SHORT},
+        properties_template=template,
+    )
+
+    # THEN
+    assert ext.post.call_args_list == [
+        mock.call(
+            b"queue_uri",
+            b"data1",
+            properties=None,
+            on_ack=None,
+            properties_template=ext_template_cls.return_value,
+            compression_algorithm=None,
+            block=False,
+            timeout=None,
+        ),
+        mock.call(
+            b"queue_uri",
+            b"data2",
+            properties={b"a": (2, INT32), b"c": (3, SHORT)},
+            on_ack=None,
+            properties_template=ext_template_cls.return_value,
+            compression_algorithm=None,
+            block=False,
+            timeout=None,
+        ),
+    ]
+
+
+@mock.patch("blazingmq._session.ExtPropertiesTemplate")
+def test_session_post_many_with_properties_template(ext_template_cls, ext):
+    # GIVEN
+    ext.mock_add_spec(["post_many"])
+    session = make_session()
+    template = PropertiesTemplate({"a": 1}, {"a": PropertyType.INT32})
+
+    # WHEN
+    session.post_many(
+        "queue_uri",
+        [(b"data1", None, None), (b"data2", {"a": 2, "b": True}, None)],
+        properties_template=template,
+    )
+
+    # THEN
+    ext.post_many.assert_called_once_with(
+        b"queue_uri",
+        [
+            (b"data1", None, None),
+            (b"data2", {b"a": (2, INT32), b"b": (True, BOOL)}, None),
+        ],
+        properties_template=ext_template_cls.return_value,
+    )